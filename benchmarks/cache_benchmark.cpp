@@ -0,0 +1,170 @@
+#include "benchmark.hpp"
+#include "caches.hpp"
+#include "config.hpp"
+#include "execution.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using config_t = tao::config::value;
+
+template <class T>
+struct cache_benchmark;
+
+template <class T>
+struct replay_thread : execution_thread {
+  replay_thread(cache_benchmark<T>& benchmark, std::uint32_t id, const execution& exec) :
+      execution_thread(id, exec),
+      _benchmark(benchmark) {}
+  void initialize(std::uint32_t num_threads) override;
+  void run() override;
+  [[nodiscard]] thread_report report() const override {
+    auto total = hits + misses;
+    tao::json::value data{
+      {"runtime", _runtime.count()},
+      {"hits", hits},
+      {"misses", misses},
+      {"hit_ratio", total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total)},
+    };
+    return {data, total};
+  }
+
+private:
+  cache_benchmark<T>& _benchmark;
+  std::vector<QUEUE_ITEM> _trace;
+  std::size_t _pos = 0;
+
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+};
+
+template <class T>
+struct cache_benchmark : benchmark {
+  void setup(const config_t& config) override;
+
+  std::unique_ptr<execution_thread>
+    create_thread(std::uint32_t id, const execution& exec, const std::string& type) override {
+    if (type == "replay") {
+      return std::make_unique<replay_thread<T>>(*this, id, exec);
+    }
+    throw std::runtime_error("Invalid thread type: " + type);
+  }
+
+  // Keys are ranked by popularity; we scatter the ranks over the key space (multiplication
+  // with an odd constant is a bijection on 32-bit integers), so that popular keys are not
+  // clustered.
+  static QUEUE_ITEM key_for_rank(std::size_t rank) {
+    return static_cast<QUEUE_ITEM>(static_cast<std::uint32_t>(rank) * 0x9E3779B1u);
+  }
+
+  std::unique_ptr<T> cache;
+  std::uint32_t batch_size = 0;
+  std::size_t trace_length = 0;
+  // the cumulative distribution function of the zipfian key distribution
+  std::vector<double> cdf;
+};
+
+template <class T>
+void cache_benchmark<T>::setup(const config_t& config) {
+  cache = cache_builder<T>::create(config.at("ds"));
+  batch_size = config.optional<std::uint32_t>("batch_size").value_or(100);
+  trace_length = config.optional<std::size_t>("trace_length").value_or(1 << 20);
+  auto key_range = config.optional<std::size_t>("key_range").value_or(1 << 20);
+  auto exponent = config.optional<double>("zipf_exponent").value_or(0.99);
+  if (key_range == 0 || trace_length == 0) {
+    throw std::runtime_error("key_range and trace_length must be greater than zero");
+  }
+  if (exponent < 0.0) {
+    throw std::runtime_error("zipf_exponent must be >= 0.0");
+  }
+
+  cdf.resize(key_range);
+  double sum = 0;
+  for (std::size_t i = 0; i < key_range; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+    cdf[i] = sum;
+  }
+  for (auto& v : cdf) {
+    v /= sum;
+  }
+}
+
+template <class T>
+void replay_thread<T>::initialize(std::uint32_t /*num_threads*/) {
+  // Every thread generates its own trace, so threads access the popular keys in different
+  // orders. The trace is generated before the benchmark starts and then replayed in a loop.
+  const auto& cdf = _benchmark.cdf;
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  _trace.resize(_benchmark.trace_length);
+  for (auto& key : _trace) {
+    auto rank = std::lower_bound(cdf.begin(), cdf.end(), dist(_randomizer)) - cdf.begin();
+    key = cache_benchmark<T>::key_for_rank(std::min(static_cast<std::size_t>(rank), cdf.size() - 1));
+  }
+  _pos = static_cast<std::size_t>(_randomizer() % _trace.size());
+}
+
+template <class T>
+void replay_thread<T>::run() {
+  T& cache = *_benchmark.cache;
+
+  const std::uint32_t n = _benchmark.batch_size;
+
+  std::uint64_t hit = 0;
+  std::uint64_t miss = 0;
+
+  [[maybe_unused]] region_guard_t<T> guard{};
+  for (std::uint32_t i = 0; i < n; ++i) {
+    auto key = _trace[_pos];
+    if (++_pos == _trace.size()) {
+      _pos = 0;
+    }
+
+    if (get_or_insert(cache, key)) {
+      ++hit;
+    } else {
+      ++miss;
+      // the workload simulates the cost of fetching the missing value
+      simulate_workload();
+    }
+  }
+
+  hits += hit;
+  misses += miss;
+}
+
+namespace {
+template <class T>
+inline std::shared_ptr<benchmark_builder> make_benchmark_builder() {
+  return std::make_shared<typed_benchmark_builder<T, cache_benchmark>>();
+}
+
+auto benchmark_variations() {
+  using namespace xenium; // NOLINT
+  return benchmark_builders{
+#ifdef WITH_CONCURRENT_CACHE
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<concurrent_cache<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<concurrent_cache<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::debra<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<
+      concurrent_cache<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      concurrent_cache<QUEUE_ITEM,
+                       QUEUE_ITEM,
+                       policy::reclaimer<reclamation::hazard_pointer<>::with<
+                         policy::allocation_strategy<reclamation::hp_allocation::dynamic_strategy<4>>>>>>(),
+  #endif
+#endif
+  };
+}
+} // namespace
+
+void register_cache_benchmark(registered_benchmarks& benchmarks) {
+  benchmarks.emplace("cache", benchmark_variations());
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "descriptor.hpp"
+#include "reclaimers.hpp"
+
+template <class T>
+struct cache_builder {
+  static auto create(const tao::config::value&) { return std::make_unique<T>(); }
+};
+
+#ifdef WITH_CONCURRENT_CACHE
+  #include <xenium/concurrent_cache.hpp>
+
+template <class Key, class Value, class... Policies>
+struct descriptor<xenium::concurrent_cache<Key, Value, Policies...>> {
+  static tao::json::value generate() {
+    using cache = xenium::concurrent_cache<Key, Value, Policies...>;
+    return {{"type", "concurrent_cache"},
+            {"capacity", DYNAMIC_PARAM},
+            {"segments", DYNAMIC_PARAM},
+            {"reclaimer", descriptor<typename cache::reclaimer>::generate()}};
+  }
+};
+
+template <class Key, class Value, class... Policies>
+struct cache_builder<xenium::concurrent_cache<Key, Value, Policies...>> {
+  static auto create(const tao::config::value& config) {
+    auto capacity = config.as<size_t>("capacity");
+    auto segments = config.optional<size_t>("segments").value_or(16);
+    return std::make_unique<xenium::concurrent_cache<Key, Value, Policies...>>(capacity, segments);
+  }
+};
+
+namespace { // NOLINT
+// returns true on a hit; on a miss the key is inserted.
+template <class Key, class Value, class... Policies>
+bool get_or_insert(xenium::concurrent_cache<Key, Value, Policies...>& cache, Key key) {
+  return !cache.get_or_emplace_lazy(key, [key]() { return static_cast<Value>(key); }).second;
+}
+} // namespace
+#endif
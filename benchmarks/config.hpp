@@ -9,19 +9,36 @@
 
 // defines which data structures shall be included
 #define WITH_MICHAEL_SCOTT_QUEUE
+#define WITH_HOFFMAN_BASKET_QUEUE
 #define WITH_RAMALHETE_QUEUE
+#define WITH_LCRQ_QUEUE
 #define WITH_VYUKOV_BOUNDED_QUEUE
 #define WITH_KIRSCH_BOUNDED_KFIFO_QUEUE
 #define WITH_KIRSCH_KFIFO_QUEUE
+#define WITH_NIKOLAEV_QUEUE
 #define WITH_NIKOLAEV_BOUNDED_QUEUE
+#define WITH_MULTI_QUEUE
+#define WITH_TREIBER_STACK
+
+#define WITH_CHASE_WORK_STEALING_DEQUE
+#define WITH_IDEMPOTENT_WORK_STEALING_DEQUE
 
 #define WITH_VYUKOV_HASH_MAP
 #define WITH_HARRIS_MICHAEL_HASH_MAP
+#define WITH_ART_MAP
+#define WITH_BTREE_MAP
+
+#define WITH_CONCURRENT_CACHE
 
 // defines which reclamation schemes shall be included
 #define WITH_HAZARD_POINTER
 #define WITH_QUIESCENT_STATE_BASED
 #define WITH_GENERIC_EPOCH_BASED
+#define WITH_HYALINE
+#define WITH_INTERVAL_BASED
+#ifdef __linux__
+  #define WITH_NBR
+#endif
 
 #ifdef WITH_LIBCDS
   #define WITH_CDS_MSQUEUE
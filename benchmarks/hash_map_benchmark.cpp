@@ -37,9 +37,22 @@ struct benchmark_thread : execution_thread {
       throw std::runtime_error("The sum of remove_ratio and insert_ratio must be <= 1.0");
     }
 
+    auto scan_ratio = config.optional<double>("scan_ratio").value_or(0.0);
+    if (scan_ratio < 0.0 || scan_ratio > 1.0) {
+      throw std::runtime_error("scan_ratio must be >= 0.0 and <= 1.0");
+    }
+    if (scan_ratio > 0.0 && !supports_range_scan<T>::value) {
+      throw std::runtime_error("scan_ratio must be 0.0 for data structures that do not support range scans");
+    }
+    if (update_ratio + scan_ratio > 1.0) {
+      throw std::runtime_error("The sum of remove_ratio, insert_ratio and scan_ratio must be <= 1.0");
+    }
+    _scan_length = config.optional<std::uint32_t>("scan_length").value_or(100);
+
     constexpr auto rand_range = std::numeric_limits<std::uint64_t>::max();
     _scale_insert = static_cast<std::uint64_t>(insert_ratio * static_cast<double>(rand_range));
     _scale_remove = static_cast<std::uint64_t>(update_ratio * static_cast<double>(rand_range));
+    _scale_scan = static_cast<std::uint64_t>((update_ratio + scan_ratio) * static_cast<double>(rand_range));
   }
   void initialize(std::uint32_t num_threads) override;
   void run() override;
@@ -49,14 +62,18 @@ struct benchmark_thread : execution_thread {
       {"insert", insert_operations},
       {"remove", remove_operations},
       {"get", get_operations},
+      {"scan", scan_operations},
+      {"scanned", scanned_entries},
     };
-    return {data, insert_operations + remove_operations + get_operations};
+    return {data, insert_operations + remove_operations + get_operations + scan_operations};
   }
 
 protected:
   std::uint64_t insert_operations = 0;
   std::uint64_t remove_operations = 0;
   std::uint64_t get_operations = 0;
+  std::uint64_t scan_operations = 0;
+  std::uint64_t scanned_entries = 0;
 
 private:
   hash_map_benchmark<T>& _benchmark;
@@ -65,6 +82,8 @@ private:
   std::uint64_t _key_offset = 0;
   std::uint64_t _scale_remove = 0;
   std::uint64_t _scale_insert = 0;
+  std::uint64_t _scale_scan = 0;
+  std::uint32_t _scan_length = 0;
 };
 
 template <class T>
@@ -126,6 +145,8 @@ void benchmark_thread<T>::run() {
   std::uint32_t insert = 0;
   std::uint32_t remove = 0;
   std::uint32_t get = 0;
+  std::uint32_t scan = 0;
+  std::uint64_t scanned = 0;
 
   [[maybe_unused]] region_guard_t<T> guard{};
   for (std::uint32_t i = 0; i < n; ++i) {
@@ -140,6 +161,11 @@ void benchmark_thread<T>::run() {
       if (try_remove(hash_map, key)) {
         ++remove;
       }
+    } else if (r < _scale_scan) {
+      if constexpr (supports_range_scan<T>::value) {
+        scanned += try_scan(hash_map, key, static_cast<unsigned>(key + _scan_length));
+        ++scan;
+      }
     } else {
       if (try_get(hash_map, key)) {
         ++get;
@@ -152,6 +178,8 @@ void benchmark_thread<T>::run() {
   insert_operations += insert;
   remove_operations += remove;
   get_operations += get;
+  scan_operations += scan;
+  scanned_entries += scanned;
 }
 
 namespace {
@@ -174,6 +202,16 @@ auto benchmark_variations() {
     make_benchmark_builder<
       vyukov_hash_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
   #endif
+  #ifdef WITH_HYALINE
+    make_benchmark_builder<vyukov_hash_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::hyaline<>>>>(),
+  #endif
+  #ifdef WITH_INTERVAL_BASED
+    make_benchmark_builder<
+      vyukov_hash_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::interval_based<>>>>(),
+  #endif
+  #ifdef WITH_NBR
+    make_benchmark_builder<vyukov_hash_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::nbr<>>>>(),
+  #endif
   #ifdef WITH_HAZARD_POINTER
     make_benchmark_builder<
       vyukov_hash_map<QUEUE_ITEM,
@@ -215,6 +253,43 @@ auto benchmark_variations() {
   #endif
 #endif
 
+#ifdef WITH_ART_MAP
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<art_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<art_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::new_epoch_based<>>>>(),
+    make_benchmark_builder<art_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::debra<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<art_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      art_map<QUEUE_ITEM,
+              QUEUE_ITEM,
+              policy::reclaimer<reclamation::hazard_pointer<>::with<
+                policy::allocation_strategy<reclamation::hp_allocation::dynamic_strategy<3>>>>>>(),
+  #endif
+#endif
+
+#ifdef WITH_BTREE_MAP
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<btree_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<
+      btree_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>, policy::node_size<512>>>(),
+    make_benchmark_builder<btree_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::debra<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<btree_map<QUEUE_ITEM, QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      btree_map<QUEUE_ITEM,
+                QUEUE_ITEM,
+                policy::reclaimer<reclamation::hazard_pointer<>::with<
+                  policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>>>(),
+  #endif
+#endif
+
 #ifdef WITH_CDS_MICHAEL_HASHMAP
     make_benchmark_builder<
       cds::container::MichaelHashMap<cds::gc::HP,
@@ -2,11 +2,17 @@
 #include "descriptor.hpp"
 #include "reclaimers.hpp"
 
+#include <type_traits>
+
 template <class T>
 struct hash_map_builder {
   static auto create(const tao::config::value&) { return std::make_unique<T>(); }
 };
 
+// Range scans are only supported by ordered maps that provide a `try_scan` overload.
+template <class T>
+struct supports_range_scan : std::false_type {};
+
 #ifdef WITH_VYUKOV_HASH_MAP
   #include <xenium/vyukov_hash_map.hpp>
 
@@ -79,6 +85,74 @@ bool try_get(xenium::harris_michael_hash_map<Key, Value, Policies...>& hash_map,
 } // namespace
 #endif
 
+#ifdef WITH_ART_MAP
+  #include <xenium/art_map.hpp>
+
+template <class Key, class Value, class... Policies>
+struct descriptor<xenium::art_map<Key, Value, Policies...>> {
+  static tao::json::value generate() {
+    using hash_map = xenium::art_map<Key, Value, Policies...>;
+    return {{"type", "art_map"}, {"reclaimer", descriptor<typename hash_map::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class Key, class Value, class... Policies>
+bool try_emplace(xenium::art_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.emplace(key, key);
+}
+
+template <class Key, class Value, class... Policies>
+bool try_remove(xenium::art_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.erase(key);
+}
+
+template <class Key, class Value, class... Policies>
+bool try_get(xenium::art_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.contains(key);
+}
+} // namespace
+#endif
+
+#ifdef WITH_BTREE_MAP
+  #include <xenium/btree_map.hpp>
+
+template <class Key, class Value, class... Policies>
+struct descriptor<xenium::btree_map<Key, Value, Policies...>> {
+  static tao::json::value generate() {
+    using hash_map = xenium::btree_map<Key, Value, Policies...>;
+    return {{"type", "btree_map"},
+            {"node_size", hash_map::node_size},
+            {"reclaimer", descriptor<typename hash_map::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class Key, class Value, class... Policies>
+bool try_emplace(xenium::btree_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.emplace(key, key);
+}
+
+template <class Key, class Value, class... Policies>
+bool try_remove(xenium::btree_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.erase(key);
+}
+
+template <class Key, class Value, class... Policies>
+bool try_get(xenium::btree_map<Key, Value, Policies...>& hash_map, Key key) {
+  return hash_map.contains(key);
+}
+
+template <class Key, class Value, class... Policies>
+std::size_t try_scan(xenium::btree_map<Key, Value, Policies...>& hash_map, Key first, Key last) {
+  return hash_map.scan(first, last, [](const auto&) {});
+}
+} // namespace
+
+template <class Key, class Value, class... Policies>
+struct supports_range_scan<xenium::btree_map<Key, Value, Policies...>> : std::true_type {};
+#endif
+
 #ifdef WITH_LIBCDS
   #include <cds/gc/dhp.h>
   #include <cds/gc/hp.h>
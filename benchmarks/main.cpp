@@ -25,6 +25,8 @@
 
 extern void register_queue_benchmark(registered_benchmarks&);
 extern void register_hash_map_benchmark(registered_benchmarks&);
+extern void register_work_stealing_benchmark(registered_benchmarks&);
+extern void register_cache_benchmark(registered_benchmarks&);
 
 namespace {
 
@@ -331,6 +333,8 @@ void parse_args(int argc, char* argv[], options& opts) {
 int main(int argc, char* argv[]) {
   register_queue_benchmark(benchmarks);
   register_hash_map_benchmark(benchmarks);
+  register_work_stealing_benchmark(benchmarks);
+  register_cache_benchmark(benchmarks);
 
 #if !defined(NDEBUG)
   std::cout << "==============================\n"
@@ -4,6 +4,9 @@
 #include "execution.hpp"
 #include "queues.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
@@ -25,6 +28,10 @@ struct benchmark_thread : execution_thread {
       {"push", push_operations},
       {"pop", pop_operations},
     };
+    if (_benchmark.order_deviation) {
+      auto avg = pop_operations == 0 ? 0.0 : static_cast<double>(deviation_sum) / static_cast<double>(pop_operations);
+      data.try_emplace("order_deviation", tao::json::value{{"avg", avg}, {"max", max_deviation}});
+    }
     return {data, push_operations + pop_operations};
   }
 
@@ -35,8 +42,11 @@ protected:
   }
   std::size_t push_operations = 0;
   std::size_t pop_operations = 0;
+  std::uint64_t deviation_sum = 0;
+  std::uint64_t max_deviation = 0;
 
 private:
+  void record_pop(unsigned value);
   queue_benchmark<T>& _benchmark;
   static constexpr unsigned ratio_bits = 8;
   unsigned _pop_ratio; // multiple of 2^ratio_bits;
@@ -89,12 +99,22 @@ struct queue_benchmark : benchmark {
   std::uint32_t number_of_elements = 100;
   std::uint32_t batch_size;
   config::prefill prefill;
+
+  // If enabled, every pushed element is a ticket from a global counter. When an element is
+  // popped, the difference between its ticket and the number of previously popped elements
+  // approximates its distance from the position it would have in a strict FIFO order. The
+  // shared counters add contention, so this should only be used to quantify the ordering
+  // quality of relaxed queues, not to measure throughput.
+  bool order_deviation = false;
+  std::atomic<std::uint32_t> push_ticket{0};
+  std::atomic<std::uint32_t> pop_ticket{0};
 };
 
 template <class T>
 void queue_benchmark<T>::setup(const config_t& config) {
   queue = queue_builder<T>::create(config.at("ds"));
   batch_size = config.optional<std::uint32_t>("batch_size").value_or(100);
+  order_deviation = config.optional<bool>("order_deviation").value_or(false);
   prefill.setup(config, 100);
 }
 
@@ -105,7 +125,9 @@ void benchmark_thread<T>::initialize(std::uint32_t num_threads) {
 
   [[maybe_unused]] region_guard_t<T> guard{};
   for (std::uint64_t i = 0, j = 0; i < cnt; ++i, j += 2) {
-    if (!try_push(*_benchmark.queue, static_cast<unsigned>(j))) {
+    auto value = _benchmark.order_deviation ? _benchmark.push_ticket.fetch_add(1, std::memory_order_relaxed)
+                                            : static_cast<unsigned>(j);
+    if (!try_push(*_benchmark.queue, value)) {
       throw initialization_failure();
     }
   }
@@ -131,9 +153,17 @@ void benchmark_thread<T>::run() {
       unsigned value;
       if (try_pop(queue, value)) {
         ++pop;
+        if (_benchmark.order_deviation) {
+          record_pop(value);
+        }
+      }
+    } else {
+      if (_benchmark.order_deviation) {
+        key = _benchmark.push_ticket.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (try_push(queue, key)) {
+        ++push;
       }
-    } else if (try_push(queue, key)) {
-      ++push;
     }
     simulate_workload();
   }
@@ -142,6 +172,16 @@ void benchmark_thread<T>::run() {
   pop_operations += pop;
 }
 
+template <class T>
+void benchmark_thread<T>::record_pop(unsigned value) {
+  auto expected = _benchmark.pop_ticket.fetch_add(1, std::memory_order_relaxed);
+  // tickets may wrap around, so we interpret the difference as a signed value
+  auto diff = static_cast<std::int32_t>(value - expected);
+  auto deviation = static_cast<std::uint64_t>(diff < 0 ? -static_cast<std::int64_t>(diff) : diff);
+  deviation_sum += deviation;
+  max_deviation = std::max(max_deviation, deviation);
+}
+
 namespace {
 template <class T>
 inline std::shared_ptr<benchmark_builder> make_benchmark_builder() {
@@ -160,6 +200,15 @@ auto benchmark_variations() {
   #ifdef WITH_QUIESCENT_STATE_BASED
     make_benchmark_builder<ramalhete_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::quiescent_state_based>>>(),
   #endif
+  #ifdef WITH_HYALINE
+    make_benchmark_builder<ramalhete_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::hyaline<>>>>(),
+  #endif
+  #ifdef WITH_INTERVAL_BASED
+    make_benchmark_builder<ramalhete_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::interval_based<>>>>(),
+  #endif
+  #ifdef WITH_NBR
+    make_benchmark_builder<ramalhete_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::nbr<>>>>(),
+  #endif
   #ifdef WITH_HAZARD_POINTER
     make_benchmark_builder<
       ramalhete_queue<QUEUE_ITEM*,
@@ -172,6 +221,40 @@ auto benchmark_variations() {
   #endif
 #endif
 
+#ifdef WITH_LCRQ_QUEUE
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<lcrq_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<
+      lcrq_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::epoch_based<>>, policy::entries_per_node<4096>>>(),
+    make_benchmark_builder<lcrq_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::new_epoch_based<>>>>(),
+    make_benchmark_builder<lcrq_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::debra<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<lcrq_queue<QUEUE_ITEM*, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      lcrq_queue<QUEUE_ITEM*,
+                 policy::reclaimer<reclamation::hazard_pointer<>::with<
+                   policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>>>(),
+  #endif
+#endif
+
+#ifdef WITH_NIKOLAEV_QUEUE
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<nikolaev_queue<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<nikolaev_queue<QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      nikolaev_queue<QUEUE_ITEM,
+                     policy::reclaimer<reclamation::hazard_pointer<>::with<
+                       policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>>>(),
+  #endif
+#endif
+
 #ifdef WITH_MICHAEL_SCOTT_QUEUE
   #ifdef WITH_GENERIC_EPOCH_BASED
     make_benchmark_builder<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
@@ -181,6 +264,15 @@ auto benchmark_variations() {
   #ifdef WITH_QUIESCENT_STATE_BASED
     make_benchmark_builder<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
   #endif
+  #ifdef WITH_HYALINE
+    make_benchmark_builder<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::hyaline<>>>>(),
+  #endif
+  #ifdef WITH_INTERVAL_BASED
+    make_benchmark_builder<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::interval_based<>>>>(),
+  #endif
+  #ifdef WITH_NBR
+    make_benchmark_builder<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::nbr<>>>>(),
+  #endif
   #ifdef WITH_HAZARD_POINTER
     make_benchmark_builder<
       michael_scott_queue<QUEUE_ITEM,
@@ -193,6 +285,42 @@ auto benchmark_variations() {
   #endif
 #endif
 
+#ifdef WITH_HOFFMAN_BASKET_QUEUE
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<hoffman_basket_queue<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<hoffman_basket_queue<QUEUE_ITEM, policy::reclaimer<reclamation::new_epoch_based<>>>>(),
+    make_benchmark_builder<hoffman_basket_queue<QUEUE_ITEM, policy::reclaimer<reclamation::debra<>>>>(),
+  #endif
+  #ifdef WITH_QUIESCENT_STATE_BASED
+    make_benchmark_builder<hoffman_basket_queue<QUEUE_ITEM, policy::reclaimer<reclamation::quiescent_state_based>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      hoffman_basket_queue<QUEUE_ITEM,
+                           policy::reclaimer<reclamation::hazard_pointer<>::with<
+                             policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>>>(),
+  #endif
+#endif
+
+#ifdef WITH_TREIBER_STACK
+  #ifdef WITH_GENERIC_EPOCH_BASED
+    make_benchmark_builder<treiber_stack<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>(),
+    make_benchmark_builder<
+      treiber_stack<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>, policy::elimination_slots<16>>>(),
+  #endif
+  #ifdef WITH_HAZARD_POINTER
+    make_benchmark_builder<
+      treiber_stack<QUEUE_ITEM,
+                    policy::reclaimer<reclamation::hazard_pointer<>::with<
+                      policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>>>(),
+    make_benchmark_builder<
+      treiber_stack<QUEUE_ITEM,
+                    policy::reclaimer<reclamation::hazard_pointer<>::with<
+                      policy::allocation_strategy<reclamation::hp_allocation::static_strategy<3>>>>,
+                    policy::elimination_slots<16>>>(),
+  #endif
+#endif
+
 #ifdef WITH_VYUKOV_BOUNDED_QUEUE
     make_benchmark_builder<vyukov_bounded_queue<QUEUE_ITEM, policy::default_to_weak<true>>>(),
     make_benchmark_builder<vyukov_bounded_queue<QUEUE_ITEM, policy::default_to_weak<false>>>(),
@@ -225,6 +353,17 @@ auto benchmark_variations() {
 
 #ifdef WITH_NIKOLAEV_BOUNDED_QUEUE
     make_benchmark_builder<nikolaev_bounded_queue<QUEUE_ITEM>>(),
+    make_benchmark_builder<nikolaev_bounded_queue<QUEUE_ITEM, policy::wait_free<true>>>(),
+#endif
+
+#if defined(WITH_MULTI_QUEUE) && defined(WITH_MICHAEL_SCOTT_QUEUE) && defined(WITH_GENERIC_EPOCH_BASED)
+    make_benchmark_builder<
+      multi_queue<QUEUE_ITEM,
+                  policy::container<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>>>(),
+    make_benchmark_builder<
+      multi_queue<QUEUE_ITEM,
+                  policy::container<michael_scott_queue<QUEUE_ITEM, policy::reclaimer<reclamation::epoch_based<>>>>,
+                  policy::stickiness<1>>>(),
 #endif
 
 #ifdef WITH_CDS_MSQUEUE
@@ -38,6 +38,66 @@ bool try_pop(xenium::ramalhete_queue<T*, Policies...>& queue, T& item) {
 } // namespace
 #endif
 
+#ifdef WITH_LCRQ_QUEUE
+  #include <xenium/lcrq_queue.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::lcrq_queue<T, Policies...>> {
+  static tao::json::value generate() {
+    using queue = xenium::lcrq_queue<T, Policies...>;
+    return {{"type", "lcrq_queue"},
+            {"entries_per_node", queue::entries_per_node},
+            {"reclaimer", descriptor<typename queue::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class T, class... Policies>
+bool try_push(xenium::lcrq_queue<T*, Policies...>& queue, T item) {
+  queue.push(new T(item));
+  return true;
+}
+
+template <class T, class... Policies>
+bool try_pop(xenium::lcrq_queue<T*, Policies...>& queue, T& item) {
+  T* value;
+  auto result = queue.try_pop(value);
+  if (result) {
+    item = *value;
+    delete value;
+  }
+  return result;
+}
+} // namespace
+#endif
+
+#ifdef WITH_NIKOLAEV_QUEUE
+  #include <xenium/nikolaev_queue.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::nikolaev_queue<T, Policies...>> {
+  static tao::json::value generate() {
+    using queue = xenium::nikolaev_queue<T, Policies...>;
+    return {{"type", "nikolaev_queue"},
+            {"entries_per_node", queue::entries_per_node},
+            {"reclaimer", descriptor<typename queue::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class T, class... Policies>
+bool try_push(xenium::nikolaev_queue<T, Policies...>& queue, T item) {
+  queue.push(std::move(item));
+  return true;
+}
+
+template <class T, class... Policies>
+bool try_pop(xenium::nikolaev_queue<T, Policies...>& queue, T& item) {
+  return queue.try_pop(item);
+}
+} // namespace
+#endif
+
 #ifdef WITH_MICHAEL_SCOTT_QUEUE
   #include <xenium/michael_scott_queue.hpp>
 
@@ -63,6 +123,58 @@ bool try_pop(xenium::michael_scott_queue<T, Policies...>& queue, T& item) {
 } // namespace
 #endif
 
+#ifdef WITH_HOFFMAN_BASKET_QUEUE
+  #include <xenium/hoffman_basket_queue.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::hoffman_basket_queue<T, Policies...>> {
+  static tao::json::value generate() {
+    using queue = xenium::hoffman_basket_queue<T, Policies...>;
+    return {{"type", "hoffman_basket_queue"}, {"reclaimer", descriptor<typename queue::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class T, class... Policies>
+bool try_push(xenium::hoffman_basket_queue<T, Policies...>& queue, T item) {
+  queue.push(std::move(item));
+  return true;
+}
+
+template <class T, class... Policies>
+bool try_pop(xenium::hoffman_basket_queue<T, Policies...>& queue, T& item) {
+  return queue.try_pop(item);
+}
+} // namespace
+#endif
+
+#ifdef WITH_TREIBER_STACK
+  #include <xenium/treiber_stack.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::treiber_stack<T, Policies...>> {
+  static tao::json::value generate() {
+    using stack = xenium::treiber_stack<T, Policies...>;
+    return {{"type", "treiber_stack"},
+            {"elimination_slots", stack::elimination_slots},
+            {"reclaimer", descriptor<typename stack::reclaimer>::generate()}};
+  }
+};
+
+namespace { // NOLINT
+template <class T, class... Policies>
+bool try_push(xenium::treiber_stack<T, Policies...>& stack, T item) {
+  stack.push(std::move(item));
+  return true;
+}
+
+template <class T, class... Policies>
+bool try_pop(xenium::treiber_stack<T, Policies...>& stack, T& item) {
+  return stack.try_pop(item);
+}
+} // namespace
+#endif
+
 #ifdef WITH_VYUKOV_BOUNDED_QUEUE
   #include <xenium/vyukov_bounded_queue.hpp>
 
@@ -198,7 +310,10 @@ bool try_pop(xenium::kirsch_bounded_kfifo_queue<T*, Policies...>& queue, T& item
 
 template <class T, class... Policies>
 struct descriptor<xenium::nikolaev_bounded_queue<T, Policies...>> {
-  static tao::json::value generate() { return {{"type", "nikolaev_bounded_queue"}, {"capacity", DYNAMIC_PARAM}}; }
+  static tao::json::value generate() {
+    using queue = xenium::nikolaev_bounded_queue<T, Policies...>;
+    return {{"type", "nikolaev_bounded_queue"}, {"wait_free", queue::wait_free}, {"capacity", DYNAMIC_PARAM}};
+  }
 };
 
 template <class T, class... Policies>
@@ -229,6 +344,47 @@ bool try_pop(xenium::nikolaev_bounded_queue<T, Policies...>& queue, T& item) {
 } // namespace
 #endif
 
+#ifdef WITH_MULTI_QUEUE
+  #include <xenium/multi_queue.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::multi_queue<T, Policies...>> {
+  static tao::json::value generate() {
+    using queue = xenium::multi_queue<T, Policies...>;
+    return {{"type", "multi_queue"},
+            {"queues", DYNAMIC_PARAM},
+            {"stickiness", queue::stickiness},
+            {"queue", descriptor<typename queue::queue>::generate()}};
+  }
+};
+
+template <class T, class... Policies>
+struct queue_builder<xenium::multi_queue<T, Policies...>> {
+  static auto create(const tao::config::value& config) {
+    auto queues = config.as<size_t>("queues");
+    return std::make_unique<xenium::multi_queue<T, Policies...>>(queues);
+  }
+};
+
+template <class T, class... Policies>
+struct region_guard<xenium::multi_queue<T, Policies...>> {
+  // multi_queue does not have a reclaimer itself, so we use the region_guard of the sub-queues.
+  using type = region_guard_t<typename xenium::multi_queue<T, Policies...>::queue>;
+};
+
+namespace { // NOLINT
+template <class T, class... Policies>
+bool try_push(xenium::multi_queue<T, Policies...>& queue, T item) {
+  return queue.try_push(std::move(item));
+}
+
+template <class T, class... Policies>
+bool try_pop(xenium::multi_queue<T, Policies...>& queue, T& item) {
+  return queue.try_pop(item);
+}
+} // namespace
+#endif
+
 #ifdef WITH_LIBCDS
   #include <cds/gc/dhp.h>
   #include <cds/gc/hp.h>
@@ -70,6 +70,39 @@ struct descriptor<xenium::reclamation::quiescent_state_based> {
 };
 #endif
 
+#ifdef WITH_HYALINE
+  #include <xenium/reclamation/hyaline.hpp>
+
+template <class Traits>
+struct descriptor<xenium::reclamation::hyaline<Traits>> {
+  static tao::json::value generate() {
+    return {{"type", "hyaline"}, {"slots", Traits::slots}, {"batch_size", Traits::batch_size}};
+  }
+};
+#endif
+
+#ifdef WITH_INTERVAL_BASED
+  #include <xenium/reclamation/interval_based.hpp>
+
+template <class Traits>
+struct descriptor<xenium::reclamation::interval_based<Traits>> {
+  static tao::json::value generate() {
+    return {{"type", "interval_based"}, {"scan_threshold", Traits::scan_threshold}};
+  }
+};
+#endif
+
+#ifdef WITH_NBR
+  #include <xenium/reclamation/nbr.hpp>
+
+template <class Traits>
+struct descriptor<xenium::reclamation::nbr<Traits>> {
+  static tao::json::value generate() {
+    return {{"type", "nbr"}, {"scan_threshold", Traits::scan_threshold}, {"ping_signal", Traits::ping_signal}};
+  }
+};
+#endif
+
 #ifdef WITH_HAZARD_POINTER
   #include <xenium/reclamation/hazard_pointer.hpp>
 
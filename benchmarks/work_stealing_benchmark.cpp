@@ -0,0 +1,136 @@
+#include "benchmark.hpp"
+#include "config.hpp"
+#include "execution.hpp"
+#include "work_stealing_deques.hpp"
+
+#include <iostream>
+#include <vector>
+
+using config_t = tao::config::value;
+
+template <class T>
+struct work_stealing_benchmark;
+
+template <class T>
+struct work_stealing_thread : execution_thread {
+  work_stealing_thread(work_stealing_benchmark<T>& benchmark, std::uint32_t id, const execution& exec, T& deque) :
+      execution_thread(id, exec),
+      _benchmark(benchmark),
+      _deque(deque) {}
+  void setup(const config_t& config) override {
+    execution_thread::setup(config);
+    auto ratio = config.optional<double>("steal_ratio").value_or(0.01);
+    if (ratio > 1.0 || ratio < 0.0) {
+      throw std::runtime_error("Invalid steal_ratio value");
+    }
+    _steal_ratio = static_cast<unsigned>(ratio * (static_cast<unsigned>(1) << ratio_bits));
+  }
+  void run() override;
+  [[nodiscard]] thread_report report() const override {
+    tao::json::value data{
+      {"runtime", _runtime.count()},
+      {"push", push_operations},
+      {"pop", pop_operations},
+      {"steal", steal_operations},
+    };
+    return {data, push_operations + pop_operations + steal_operations};
+  }
+
+private:
+  work_stealing_benchmark<T>& _benchmark;
+  T& _deque;
+  QUEUE_ITEM _item{};
+  static constexpr unsigned ratio_bits = 16;
+  unsigned _steal_ratio = 0; // multiple of 2^ratio_bits;
+
+  std::size_t push_operations = 0;
+  std::size_t pop_operations = 0;
+  std::size_t steal_operations = 0;
+};
+
+template <class T>
+struct work_stealing_benchmark : benchmark {
+  void setup(const config_t& config) override;
+
+  std::unique_ptr<execution_thread>
+    create_thread(std::uint32_t id, const execution& exec, const std::string& type) override {
+    if (type == "worker") {
+      // every worker owns its own deque; the threads are created before they start
+      // running, so the other workers can safely look up their victims at runtime.
+      deques.push_back(work_stealing_deque_builder<T>::create(*ds_config));
+      return std::make_unique<work_stealing_thread<T>>(*this, id, exec, *deques.back());
+    }
+    throw std::runtime_error("Invalid thread type: " + type);
+  }
+
+  std::vector<std::unique_ptr<T>> deques;
+  const config_t* ds_config = nullptr;
+  std::uint32_t batch_size = 0;
+};
+
+template <class T>
+void work_stealing_benchmark<T>::setup(const config_t& config) {
+  ds_config = &config.at("ds");
+  batch_size = config.optional<std::uint32_t>("batch_size").value_or(100);
+}
+
+template <class T>
+void work_stealing_thread<T>::run() {
+  const std::uint32_t n = _benchmark.batch_size;
+  const auto num_deques = _benchmark.deques.size();
+
+  std::size_t push = 0;
+  std::size_t pop = 0;
+  std::size_t steal = 0;
+
+  // The owner alternates between push and pop, so these operations dominate the
+  // result unless a high steal_ratio is configured.
+  [[maybe_unused]] region_guard_t<T> guard{};
+  typename T::value_type item{};
+  for (std::uint32_t i = 0; i < n; ++i) {
+    auto r = _randomizer();
+    auto action = r & ((1 << ratio_bits) - 1);
+    if (action < _steal_ratio) {
+      auto& victim = *_benchmark.deques[(r >> ratio_bits) % num_deques];
+      if (&victim != &_deque && victim.try_steal(item)) {
+        ++steal;
+      }
+    } else if (i % 2 == 0) {
+      if (_deque.try_push(&_item)) {
+        ++push;
+      }
+    } else if (_deque.try_pop(item)) {
+      ++pop;
+    }
+    simulate_workload();
+  }
+
+  push_operations += push;
+  pop_operations += pop;
+  steal_operations += steal;
+}
+
+namespace {
+template <class T>
+inline std::shared_ptr<benchmark_builder> make_benchmark_builder() {
+  return std::make_shared<typed_benchmark_builder<T, work_stealing_benchmark>>();
+}
+
+auto benchmark_variations() {
+  using namespace xenium; // NOLINT
+  return benchmark_builders{
+#ifdef WITH_CHASE_WORK_STEALING_DEQUE
+    make_benchmark_builder<chase_work_stealing_deque<QUEUE_ITEM>>(),
+#endif
+
+#ifdef WITH_IDEMPOTENT_WORK_STEALING_DEQUE
+    make_benchmark_builder<idempotent_work_stealing_deque<QUEUE_ITEM, policy::fifo<false>>>(),
+    make_benchmark_builder<idempotent_work_stealing_deque<QUEUE_ITEM, policy::fifo<true>>>(),
+#endif
+  };
+}
+} // namespace
+
+void register_work_stealing_benchmark(registered_benchmarks& benchmarks) {
+  benchmarks.emplace("work_stealing", benchmark_variations());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "descriptor.hpp"
+
+template <class T>
+struct work_stealing_deque_builder {
+  static auto create(const tao::config::value&) { return std::make_unique<T>(); }
+};
+
+#ifdef WITH_CHASE_WORK_STEALING_DEQUE
+  #include <xenium/chase_work_stealing_deque.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::chase_work_stealing_deque<T, Policies...>> {
+  static tao::json::value generate() { return {{"type", "chase_work_stealing_deque"}}; }
+};
+
+template <class T, class... Policies>
+struct region_guard<xenium::chase_work_stealing_deque<T, Policies...>> {
+  // chase_work_stealing_deque does not have a reclaimer, so we define an
+  // empty dummy type as region_guard placeholder.
+  struct type {};
+};
+#endif
+
+#ifdef WITH_IDEMPOTENT_WORK_STEALING_DEQUE
+  #include <xenium/idempotent_work_stealing_deque.hpp>
+
+template <class T, class... Policies>
+struct descriptor<xenium::idempotent_work_stealing_deque<T, Policies...>> {
+  static tao::json::value generate() {
+    using deque = xenium::idempotent_work_stealing_deque<T, Policies...>;
+    return {{"type", "idempotent_work_stealing_deque"}, {"fifo", deque::fifo}};
+  }
+};
+
+template <class T, class... Policies>
+struct region_guard<xenium::idempotent_work_stealing_deque<T, Policies...>> {
+  // idempotent_work_stealing_deque does not have a reclaimer, so we define an
+  // empty dummy type as region_guard placeholder.
+  struct type {};
+};
+#endif
@@ -0,0 +1,76 @@
+#include <xenium/array_allocator.hpp>
+#include <xenium/chase_work_stealing_deque.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/vyukov_bounded_queue.hpp>
+#include <xenium/vyukov_hash_map.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace {
+
+template <class Allocator>
+struct ArrayAllocator : ::testing::Test {};
+
+using Allocators = ::testing::Types<xenium::default_array_allocator,
+                                    xenium::huge_page_array_allocator<>,
+                                    xenium::huge_page_array_allocator<true, true, 4>>;
+TYPED_TEST_SUITE(ArrayAllocator, Allocators);
+
+TYPED_TEST(ArrayAllocator, allocate_returns_zero_initialized_and_aligned_memory) {
+  for (std::size_t size : {std::size_t(64), std::size_t(4096), std::size_t(5) * 1024 * 1024}) {
+    auto* mem = static_cast<char*>(TypeParam::allocate(size));
+    ASSERT_NE(nullptr, mem);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(mem) % 64);
+    for (std::size_t i = 0; i < size; i += 512) {
+      ASSERT_EQ(0, mem[i]) << i;
+    }
+    EXPECT_EQ(0, mem[size - 1]);
+    mem[0] = 1;
+    mem[size - 1] = 1;
+    TypeParam::deallocate(mem);
+  }
+}
+
+TYPED_TEST(ArrayAllocator, can_be_used_for_vyukov_hash_map) {
+  using hash_map = xenium::vyukov_hash_map<int,
+                                           int,
+                                           xenium::policy::reclaimer<xenium::reclamation::epoch_based<>>,
+                                           xenium::policy::array_allocator<TypeParam>>;
+  hash_map map(8);
+  for (int i = 0; i < 100000; ++i) {
+    EXPECT_TRUE(map.emplace(i, i));
+  }
+  for (int i = 0; i < 100000; ++i) {
+    typename hash_map::accessor acc;
+    ASSERT_TRUE(map.try_get_value(i, acc));
+    EXPECT_EQ(i, *acc);
+  }
+}
+
+TYPED_TEST(ArrayAllocator, can_be_used_for_vyukov_bounded_queue) {
+  xenium::vyukov_bounded_queue<std::unique_ptr<int>, xenium::policy::array_allocator<TypeParam>> queue(1 << 20);
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(42)));
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(43)));
+  std::unique_ptr<int> elem;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(42, *elem);
+}
+
+TYPED_TEST(ArrayAllocator, can_be_used_for_growing_circular_array) {
+  using container = xenium::detail::growing_circular_array<int, 64, 1 << 20, TypeParam>;
+  xenium::chase_work_stealing_deque<int, xenium::policy::container<container>> deque;
+  int values[1000];
+  for (auto& v : values) {
+    EXPECT_TRUE(deque.try_push(&v));
+  }
+  for (int i = 999; i >= 0; --i) {
+    int* elem;
+    ASSERT_TRUE(deque.try_pop(elem));
+    EXPECT_EQ(&values[i], elem);
+  }
+}
+
+} // namespace
@@ -0,0 +1,316 @@
+#include <xenium/art_map.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+#include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
+#include <xenium/reclamation/quiescent_state_based.hpp>
+#include <xenium/reclamation/stamp_it.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Reclaimer>
+struct ArtMap : ::testing::Test {
+  using map_type = xenium::art_map<int, int, xenium::policy::reclaimer<Reclaimer>>;
+  map_type map;
+};
+
+// Traversals and scans hold a guard for every node on the current path, so the
+// hazard based reclaimers have to use the dynamic allocation strategy.
+using Reclaimers =
+  ::testing::Types<xenium::reclamation::hazard_pointer<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::dynamic_strategy<3>>>,
+                   xenium::reclamation::hazard_eras<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::dynamic_strategy<3>>>,
+                   xenium::reclamation::quiescent_state_based,
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
+                   xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
+TYPED_TEST_SUITE(ArtMap, Reclaimers);
+
+TYPED_TEST(ArtMap, emplace_returns_true_for_successful_insert) {
+  EXPECT_TRUE(this->map.emplace(42, 42));
+}
+
+TYPED_TEST(ArtMap, emplace_returns_false_for_failed_insert) {
+  this->map.emplace(42, 42);
+  EXPECT_FALSE(this->map.emplace(42, 43));
+  int value = 0;
+  EXPECT_TRUE(this->map.try_get_value(42, value));
+  EXPECT_EQ(42, value);
+}
+
+TYPED_TEST(ArtMap, try_get_value_returns_false_for_missing_key) {
+  int value = 0;
+  EXPECT_FALSE(this->map.try_get_value(42, value));
+  this->map.emplace(41, 41);
+  EXPECT_FALSE(this->map.try_get_value(42, value));
+  EXPECT_FALSE(this->map.contains(42));
+}
+
+TYPED_TEST(ArtMap, try_get_value_returns_value_of_inserted_element) {
+  this->map.emplace(42, 43);
+  this->map.emplace(-42, -43);
+  int value = 0;
+  EXPECT_TRUE(this->map.try_get_value(42, value));
+  EXPECT_EQ(43, value);
+  EXPECT_TRUE(this->map.try_get_value(-42, value));
+  EXPECT_EQ(-43, value);
+  EXPECT_TRUE(this->map.contains(42));
+}
+
+TYPED_TEST(ArtMap, erase_nonexisting_element_returns_false) {
+  EXPECT_FALSE(this->map.erase(42));
+  this->map.emplace(43, 43);
+  EXPECT_FALSE(this->map.erase(42));
+}
+
+TYPED_TEST(ArtMap, erase_existing_element_returns_true_and_removes_element) {
+  this->map.emplace(42, 42);
+  this->map.emplace(43, 43);
+  EXPECT_TRUE(this->map.erase(42));
+  EXPECT_FALSE(this->map.contains(42));
+  EXPECT_TRUE(this->map.contains(43));
+  EXPECT_FALSE(this->map.erase(42));
+}
+
+TYPED_TEST(ArtMap, insert_and_drain_many_elements) {
+  // enough keys in a dense range to force nodes to grow to node256 and shrink again
+  constexpr int count = 2000;
+  for (int i = 0; i < count; ++i) {
+    EXPECT_TRUE(this->map.emplace(i * 7, i));
+  }
+  for (int i = 0; i < count; ++i) {
+    int value = -1;
+    EXPECT_TRUE(this->map.try_get_value(i * 7, value));
+    EXPECT_EQ(i, value);
+    EXPECT_FALSE(this->map.contains(i * 7 + 1));
+  }
+  for (int i = 0; i < count; i += 2) {
+    EXPECT_TRUE(this->map.erase(i * 7));
+  }
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(i % 2 == 1, this->map.contains(i * 7));
+  }
+  for (int i = 1; i < count; i += 2) {
+    EXPECT_TRUE(this->map.erase(i * 7));
+  }
+  for (int i = 0; i < count; ++i) {
+    EXPECT_FALSE(this->map.contains(i * 7));
+  }
+  EXPECT_TRUE(this->map.emplace(42, 42));
+  EXPECT_TRUE(this->map.contains(42));
+}
+
+TYPED_TEST(ArtMap, scan_visits_elements_in_range_in_ascending_order) {
+  for (int i = 100; i > -100; --i) {
+    this->map.emplace(i * 3, i);
+  }
+  std::vector<int> keys;
+  auto visited = this->map.scan(-30, 31, [&keys](const auto& entry) {
+    EXPECT_EQ(entry.first, entry.second * 3);
+    keys.push_back(entry.first);
+  });
+  ASSERT_EQ(21u, visited);
+  ASSERT_EQ(21u, keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(-30 + static_cast<int>(i) * 3, keys[i]);
+  }
+}
+
+TYPED_TEST(ArtMap, scan_stops_when_func_returns_false) {
+  for (int i = 0; i < 100; ++i) {
+    this->map.emplace(i, i);
+  }
+  int last = -1;
+  auto visited = this->map.scan(10, 100, [&last](const auto& entry) {
+    last = entry.first;
+    return entry.first < 14;
+  });
+  EXPECT_EQ(5u, visited);
+  EXPECT_EQ(14, last);
+}
+
+TYPED_TEST(ArtMap, scan_of_empty_range_visits_nothing) {
+  this->map.emplace(1, 1);
+  this->map.emplace(10, 10);
+  EXPECT_EQ(0u, this->map.scan(2, 10, [](const auto&) {}));
+  EXPECT_EQ(0u, this->map.scan(11, 100, [](const auto&) {}));
+}
+
+TYPED_TEST(ArtMap, uint64_keys_with_common_prefixes) {
+  using map_type = xenium::art_map<std::uint64_t, std::uint64_t, xenium::policy::reclaimer<TypeParam>>;
+  map_type map;
+  const std::uint64_t base = 0x0102030405060000;
+  for (std::uint64_t i = 0; i < 300; ++i) {
+    EXPECT_TRUE(map.emplace(base + i * 251, i));
+  }
+  EXPECT_TRUE(map.emplace(0x0102030000000000, 1000));
+  EXPECT_TRUE(map.emplace(0xff00000000000000, 1001));
+
+  std::vector<std::uint64_t> keys;
+  map.scan(0, 0xffffffffffffffff, [&keys](const auto& entry) { keys.push_back(entry.first); });
+  ASSERT_EQ(302u, keys.size());
+  EXPECT_EQ(0x0102030000000000u, keys.front());
+  EXPECT_EQ(0xff00000000000000u, keys.back());
+  for (std::size_t i = 1; i < keys.size(); ++i) {
+    EXPECT_LT(keys[i - 1], keys[i]);
+  }
+  for (std::uint64_t i = 0; i < 300; ++i) {
+    EXPECT_TRUE(map.erase(base + i * 251));
+  }
+  EXPECT_TRUE(map.contains(0x0102030000000000));
+  EXPECT_TRUE(map.contains(0xff00000000000000));
+}
+
+TYPED_TEST(ArtMap, string_keys_are_ordered_lexicographically) {
+  using map_type = xenium::art_map<std::string, int, xenium::policy::reclaimer<TypeParam>>;
+  map_type map;
+  std::vector<std::string> keys = {
+    "", "a", std::string("a\0", 2), "ab", "abc", "abd", "b", "ba", "bb", std::string("b\0c", 3)};
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(map.emplace(keys[i], static_cast<int>(i)));
+  }
+  for (auto& k : keys) {
+    EXPECT_TRUE(map.contains(k));
+  }
+  EXPECT_FALSE(map.contains("abcd"));
+  EXPECT_FALSE(map.contains(std::string("ab\0", 3)));
+
+  std::vector<std::string> expected = keys;
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::string> visited;
+  map.scan("", "c", [&visited](const auto& entry) { visited.push_back(entry.first); });
+  EXPECT_EQ(expected, visited);
+}
+
+TYPED_TEST(ArtMap, scan_prefix_visits_all_strings_with_prefix) {
+  using map_type = xenium::art_map<std::string, int, xenium::policy::reclaimer<TypeParam>>;
+  map_type map;
+  for (int i = 0; i < 100; ++i) {
+    map.emplace("user/" + std::to_string(i), i);
+    map.emplace("group/" + std::to_string(i), i);
+  }
+  map.emplace("user", -1);
+  map.emplace("users", -2);
+
+  std::vector<std::string> visited;
+  auto count = map.scan_prefix("user/1", [&visited](const auto& entry) { visited.push_back(entry.first); });
+  EXPECT_EQ(11u, count);
+  ASSERT_EQ(11u, visited.size());
+  EXPECT_EQ("user/1", visited.front());
+  EXPECT_EQ("user/19", visited.back());
+
+  EXPECT_EQ(102u, map.scan_prefix("user", [](const auto&) {}));
+  EXPECT_EQ(0u, map.scan_prefix("x", [](const auto&) {}));
+}
+
+#ifdef DEBUG
+const int MaxIterations = 2000;
+#else
+const int MaxIterations = 8000;
+#endif
+
+TYPED_TEST(ArtMap, parallel_usage) {
+  using Reclaimer = TypeParam;
+  using map_type = xenium::art_map<int, int, xenium::policy::reclaimer<Reclaimer>>;
+  map_type map;
+
+  static constexpr int keys_per_thread = 8;
+
+  // a few permanent entries, so scans always have something to visit
+  for (int k = 0; k < 8 * keys_per_thread; k += 7) {
+    map.emplace(-k - 1, -k - 1);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([i, &map] {
+      for (int k = i * keys_per_thread; k < (i + 1) * keys_per_thread; ++k) {
+        for (int j = 0; j < MaxIterations / keys_per_thread; ++j) {
+          [[maybe_unused]] typename Reclaimer::region_guard guard{};
+          EXPECT_TRUE(map.emplace(k, k));
+          int value = -1;
+          EXPECT_TRUE(map.try_get_value(k, value));
+          EXPECT_EQ(k, value);
+          if ((j + i) % 8 == 0) {
+            int last = std::numeric_limits<int>::min();
+            bool found = false;
+            map.scan(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), [&](const auto& entry) {
+              EXPECT_LT(last, entry.first);
+              EXPECT_EQ(entry.first, entry.second);
+              last = entry.first;
+              found |= entry.first == k;
+            });
+            EXPECT_TRUE(found);
+          }
+          EXPECT_TRUE(map.erase(k));
+          EXPECT_FALSE(map.contains(k));
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int k = 0; k < 8 * keys_per_thread; k += 7) {
+    EXPECT_TRUE(map.contains(-k - 1));
+  }
+}
+
+TYPED_TEST(ArtMap, parallel_usage_with_shared_keys) {
+  using Reclaimer = TypeParam;
+  using map_type = xenium::art_map<std::string, int, xenium::policy::reclaimer<Reclaimer>>;
+  map_type map;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([i, &map] {
+      for (int j = 0; j < MaxIterations / 4; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        auto key = "key/" + std::to_string((i + j) % 64);
+        if (j % 3 == 0) {
+          map.erase(key);
+        } else {
+          map.emplace(key, (i + j) % 64);
+        }
+        int value = -1;
+        if (map.try_get_value(key, value)) {
+          EXPECT_EQ((i + j) % 64, value);
+        }
+        if (j % 16 == 0) {
+          std::string last;
+          map.scan_prefix("key/", [&last](const auto& entry) {
+            EXPECT_LT(last, entry.first);
+            last = entry.first;
+          });
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+} // namespace
@@ -0,0 +1,259 @@
+#include <xenium/btree_map.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+#include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
+#include <xenium/reclamation/quiescent_state_based.hpp>
+#include <xenium/reclamation/stamp_it.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Reclaimer>
+struct BTreeMap : ::testing::Test {
+  using map_type = xenium::btree_map<int, int, xenium::policy::reclaimer<Reclaimer>>;
+  map_type map;
+};
+
+using Reclaimers =
+  ::testing::Types<xenium::reclamation::hazard_pointer<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::static_strategy<3>>>,
+                   xenium::reclamation::hazard_eras<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<3>>>,
+                   xenium::reclamation::quiescent_state_based,
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
+                   xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
+TYPED_TEST_SUITE(BTreeMap, Reclaimers);
+
+TYPED_TEST(BTreeMap, emplace_returns_true_for_successful_insert) {
+  EXPECT_TRUE(this->map.emplace(42, 42));
+}
+
+TYPED_TEST(BTreeMap, emplace_returns_false_for_failed_insert) {
+  this->map.emplace(42, 42);
+  EXPECT_FALSE(this->map.emplace(42, 43));
+  int value = 0;
+  EXPECT_TRUE(this->map.try_get_value(42, value));
+  EXPECT_EQ(42, value);
+}
+
+TYPED_TEST(BTreeMap, try_get_value_returns_false_for_missing_key) {
+  int value = 0;
+  EXPECT_FALSE(this->map.try_get_value(42, value));
+  this->map.emplace(41, 41);
+  EXPECT_FALSE(this->map.try_get_value(42, value));
+  EXPECT_FALSE(this->map.contains(42));
+}
+
+TYPED_TEST(BTreeMap, try_get_value_returns_value_of_inserted_element) {
+  this->map.emplace(42, 43);
+  this->map.emplace(-42, -43);
+  int value = 0;
+  EXPECT_TRUE(this->map.try_get_value(42, value));
+  EXPECT_EQ(43, value);
+  EXPECT_TRUE(this->map.try_get_value(-42, value));
+  EXPECT_EQ(-43, value);
+  EXPECT_TRUE(this->map.contains(42));
+}
+
+TYPED_TEST(BTreeMap, erase_nonexisting_element_returns_false) {
+  EXPECT_FALSE(this->map.erase(42));
+  this->map.emplace(43, 43);
+  EXPECT_FALSE(this->map.erase(42));
+}
+
+TYPED_TEST(BTreeMap, erase_existing_element_returns_true_and_removes_element) {
+  this->map.emplace(42, 42);
+  this->map.emplace(43, 43);
+  EXPECT_TRUE(this->map.erase(42));
+  EXPECT_FALSE(this->map.contains(42));
+  EXPECT_TRUE(this->map.contains(43));
+  EXPECT_FALSE(this->map.erase(42));
+}
+
+TYPED_TEST(BTreeMap, insert_and_drain_many_elements) {
+  // enough keys to build a tree with several levels
+  constexpr int count = 5000;
+  for (int i = 0; i < count; ++i) {
+    // insert in a scrambled order
+    int k = (i * 7919) % count;
+    EXPECT_TRUE(this->map.emplace(k, -k));
+  }
+  for (int i = 0; i < count; ++i) {
+    int value = 0;
+    EXPECT_TRUE(this->map.try_get_value(i, value));
+    EXPECT_EQ(-i, value);
+  }
+  EXPECT_FALSE(this->map.contains(count));
+  for (int i = 0; i < count; i += 2) {
+    EXPECT_TRUE(this->map.erase(i));
+  }
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(i % 2 == 1, this->map.contains(i));
+  }
+  for (int i = 1; i < count; i += 2) {
+    EXPECT_TRUE(this->map.erase(i));
+  }
+  for (int i = 0; i < count; ++i) {
+    EXPECT_FALSE(this->map.contains(i));
+  }
+  EXPECT_EQ(0u, this->map.scan(0, count, [](const auto&) {}));
+  EXPECT_TRUE(this->map.emplace(42, 42));
+  EXPECT_TRUE(this->map.contains(42));
+}
+
+TYPED_TEST(BTreeMap, scan_visits_elements_in_range_in_ascending_order) {
+  for (int i = 1000; i > -1000; --i) {
+    this->map.emplace(i * 3, i);
+  }
+  std::vector<int> keys;
+  auto visited = this->map.scan(-300, 301, [&keys](const auto& entry) {
+    EXPECT_EQ(entry.first, entry.second * 3);
+    keys.push_back(entry.first);
+  });
+  ASSERT_EQ(201u, visited);
+  ASSERT_EQ(201u, keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(-300 + static_cast<int>(i) * 3, keys[i]);
+  }
+  EXPECT_EQ(2000u, this->map.scan(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), [](const auto&) {}));
+}
+
+TYPED_TEST(BTreeMap, scan_stops_when_func_returns_false) {
+  for (int i = 0; i < 100; ++i) {
+    this->map.emplace(i, i);
+  }
+  int last = -1;
+  auto visited = this->map.scan(10, 100, [&last](const auto& entry) {
+    last = entry.first;
+    return entry.first < 14;
+  });
+  EXPECT_EQ(5u, visited);
+  EXPECT_EQ(14, last);
+}
+
+TYPED_TEST(BTreeMap, scan_of_empty_range_visits_nothing) {
+  this->map.emplace(1, 1);
+  this->map.emplace(10, 10);
+  EXPECT_EQ(0u, this->map.scan(2, 10, [](const auto&) {}));
+  EXPECT_EQ(0u, this->map.scan(11, 100, [](const auto&) {}));
+}
+
+TYPED_TEST(BTreeMap, scan_follows_sibling_links_after_leaves_have_been_removed) {
+  constexpr int count = 3000;
+  for (int i = 0; i < count; ++i) {
+    EXPECT_TRUE(this->map.emplace(i, i));
+  }
+  // removes a number of complete leaves, which requires their left siblings to be relinked
+  for (int i = 1000; i < 2000; ++i) {
+    EXPECT_TRUE(this->map.erase(i));
+  }
+  for (int i = 1500; i < 1600; ++i) {
+    EXPECT_TRUE(this->map.emplace(i, i));
+  }
+
+  std::vector<int> keys;
+  this->map.scan(0, count, [&keys](const auto& entry) { keys.push_back(entry.first); });
+  std::vector<int> expected;
+  for (int i = 0; i < count; ++i) {
+    if (i < 1000 || i >= 2000 || (i >= 1500 && i < 1600)) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(expected, keys);
+}
+
+TYPED_TEST(BTreeMap, larger_nodes_with_uint64_keys) {
+  using map_type = xenium::
+    btree_map<std::uint64_t, std::uint64_t, xenium::policy::reclaimer<TypeParam>, xenium::policy::node_size<1024>>;
+  map_type map;
+  for (std::uint64_t i = 0; i < 3000; ++i) {
+    EXPECT_TRUE(map.emplace(i << 40, i));
+  }
+  std::uint64_t expected = 0;
+  map.scan(0, std::numeric_limits<std::uint64_t>::max(), [&expected](const auto& entry) {
+    EXPECT_EQ(expected << 40, entry.first);
+    EXPECT_EQ(expected, entry.second);
+    ++expected;
+  });
+  EXPECT_EQ(3000u, expected);
+}
+
+#ifdef DEBUG
+const int MaxIterations = 2000;
+#else
+const int MaxIterations = 8000;
+#endif
+
+TYPED_TEST(BTreeMap, parallel_usage) {
+  using Reclaimer = TypeParam;
+  using map_type = xenium::btree_map<int, int, xenium::policy::reclaimer<Reclaimer>>;
+  map_type map;
+
+  static constexpr int keys_per_thread = 64;
+
+  // a few permanent entries, so scans always have something to visit
+  for (int k = 0; k < 8 * keys_per_thread; k += 7) {
+    map.emplace(-k - 1, -k - 1);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([i, &map] {
+      for (int j = 0; j < MaxIterations / keys_per_thread; ++j) {
+        for (int k = i * keys_per_thread; k < (i + 1) * keys_per_thread; ++k) {
+          [[maybe_unused]] typename Reclaimer::region_guard guard{};
+          EXPECT_TRUE(map.emplace(k, k));
+          int value = -1;
+          EXPECT_TRUE(map.try_get_value(k, value));
+          EXPECT_EQ(k, value);
+        }
+        {
+          [[maybe_unused]] typename Reclaimer::region_guard guard{};
+          int last = std::numeric_limits<int>::min();
+          int found = 0;
+          map.scan(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), [&](const auto& entry) {
+            EXPECT_LT(last, entry.first);
+            EXPECT_EQ(entry.first, entry.second);
+            last = entry.first;
+            if (entry.first >= i * keys_per_thread && entry.first < (i + 1) * keys_per_thread) {
+              ++found;
+            }
+          });
+          EXPECT_EQ(keys_per_thread, found);
+        }
+        for (int k = i * keys_per_thread; k < (i + 1) * keys_per_thread; ++k) {
+          [[maybe_unused]] typename Reclaimer::region_guard guard{};
+          EXPECT_TRUE(map.erase(k));
+          EXPECT_FALSE(map.contains(k));
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int k = 0; k < 8 * keys_per_thread; k += 7) {
+    EXPECT_TRUE(map.contains(-k - 1));
+  }
+}
+} // namespace
@@ -0,0 +1,304 @@
+#include <xenium/channel.hpp>
+#include <xenium/vyukov_bounded_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// a simple single-threaded executor that runs the scheduled tasks on demand
+struct manual_executor {
+  std::deque<std::function<void()>> tasks;
+
+  xenium::channel<int>::executor_type get() {
+    return [this](std::function<void()> f) { tasks.push_back(std::move(f)); };
+  }
+
+  std::size_t run() {
+    std::size_t count = 0;
+    while (!tasks.empty()) {
+      auto f = std::move(tasks.front());
+      tasks.pop_front();
+      f();
+      ++count;
+    }
+    return count;
+  }
+};
+
+TEST(Channel, async_pop_completes_inline_if_element_is_available) {
+  manual_executor executor;
+  xenium::channel<int> ch(4, executor.get());
+  EXPECT_TRUE(ch.try_push(42));
+
+  std::optional<int> result;
+  ch.async_pop([&](std::optional<int> v) { result = v; });
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(42, *result);
+  EXPECT_TRUE(executor.tasks.empty());
+}
+
+TEST(Channel, async_pop_waits_until_element_is_pushed) {
+  manual_executor executor;
+  xenium::channel<int> ch(4, executor.get());
+
+  std::optional<int> result;
+  bool called = false;
+  ch.async_pop([&](std::optional<int> v) {
+    result = v;
+    called = true;
+  });
+  EXPECT_FALSE(called);
+  EXPECT_EQ(0u, executor.run());
+
+  EXPECT_TRUE(ch.try_push(42));
+  EXPECT_FALSE(called);
+  EXPECT_EQ(1u, executor.run());
+  EXPECT_TRUE(called);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(42, *result);
+}
+
+TEST(Channel, async_push_waits_until_there_is_space) {
+  manual_executor executor;
+  xenium::channel<int, xenium::policy::container<xenium::vyukov_bounded_queue<int>>> ch(2, executor.get());
+  EXPECT_TRUE(ch.try_push(1));
+  EXPECT_TRUE(ch.try_push(2));
+
+  std::optional<bool> result;
+  ch.async_push(3, [&](bool v) { result = v; });
+  EXPECT_FALSE(result.has_value());
+
+  int elem = 0;
+  EXPECT_TRUE(ch.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_FALSE(result.has_value());
+  EXPECT_EQ(1u, executor.run());
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(*result);
+
+  EXPECT_TRUE(ch.try_pop(elem));
+  EXPECT_EQ(2, elem);
+  EXPECT_TRUE(ch.try_pop(elem));
+  EXPECT_EQ(3, elem);
+}
+
+TEST(Channel, woken_operations_that_lose_the_race_wait_again) {
+  manual_executor executor;
+  xenium::channel<int> ch(4, executor.get());
+
+  std::vector<int> results;
+  for (int i = 0; i < 3; ++i) {
+    ch.async_pop([&](std::optional<int> v) { results.push_back(*v); });
+  }
+  EXPECT_TRUE(ch.try_push(1));
+  // all three are woken, but only one of them gets the element
+  EXPECT_EQ(3u, executor.run());
+  EXPECT_EQ(std::vector<int>{1}, results);
+
+  EXPECT_TRUE(ch.try_push(2));
+  EXPECT_TRUE(ch.try_push(3));
+  executor.run();
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), results);
+}
+
+TEST(Channel, close_completes_waiting_operations) {
+  manual_executor executor;
+  xenium::channel<int> ch(4, executor.get());
+
+  int pops_completed = 0;
+  for (int i = 0; i < 2; ++i) {
+    ch.async_pop([&](std::optional<int> v) {
+      EXPECT_FALSE(v.has_value());
+      ++pops_completed;
+    });
+  }
+  ch.close();
+  EXPECT_TRUE(ch.is_closed());
+  executor.run();
+  EXPECT_EQ(2, pops_completed);
+
+  EXPECT_FALSE(ch.try_push(1));
+  std::optional<bool> push_result;
+  ch.async_push(1, [&](bool v) { push_result = v; });
+  ASSERT_TRUE(push_result.has_value());
+  EXPECT_FALSE(*push_result);
+}
+
+TEST(Channel, remaining_elements_can_be_popped_after_close) {
+  manual_executor executor;
+  xenium::channel<int> ch(4, executor.get());
+  EXPECT_TRUE(ch.try_push(1));
+  ch.close();
+
+  std::vector<std::optional<int>> results;
+  ch.async_pop([&](std::optional<int> v) { results.push_back(v); });
+  ch.async_pop([&](std::optional<int> v) { results.push_back(v); });
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(1, results[0]);
+  EXPECT_FALSE(results[1].has_value());
+  EXPECT_TRUE(ch.is_drained());
+}
+
+// an executor that runs the scheduled tasks on a set of worker threads
+struct thread_pool_executor {
+  explicit thread_pool_executor(unsigned num_threads) {
+    for (unsigned i = 0; i < num_threads; ++i) {
+      threads.emplace_back([this] {
+        for (;;) {
+          std::function<void()> f;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (tasks.empty()) {
+              return;
+            }
+            f = std::move(tasks.front());
+            tasks.pop_front();
+          }
+          f();
+        }
+      });
+    }
+  }
+
+  ~thread_pool_executor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  xenium::channel<int>::executor_type get() {
+    return [this](std::function<void()> f) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(f));
+      }
+      cv.notify_one();
+    };
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::function<void()>> tasks;
+  bool stop = false;
+  std::vector<std::thread> threads;
+};
+
+struct consumer_loop {
+  xenium::channel<int>& ch;
+  std::atomic<long long>& sum;
+  std::atomic<int>& finished;
+
+  void operator()() {
+    ch.async_pop([this](std::optional<int> v) {
+      if (!v) {
+        finished.fetch_add(1);
+        return;
+      }
+      sum.fetch_add(*v, std::memory_order_relaxed);
+      (*this)();
+    });
+  }
+};
+
+TEST(Channel, parallel_usage) {
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 4;
+#ifdef DEBUG
+  constexpr int num_elements = 500;
+#else
+  constexpr int num_elements = 5000;
+#endif
+
+  std::atomic<long long> sum{0};
+  std::atomic<int> finished{0};
+  thread_pool_executor executor(2);
+  {
+    xenium::channel<int> ch(8, executor.get());
+
+    std::vector<consumer_loop> consumers(num_consumers, consumer_loop{ch, sum, finished});
+    for (auto& c : consumers) {
+      c();
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+      producers.emplace_back([&ch] {
+        for (int i = 1; i <= num_elements; ++i) {
+          std::atomic<bool> done{false};
+          ch.async_push(i, [&done](bool result) {
+            EXPECT_TRUE(result);
+            done.store(true);
+          });
+          while (!done.load()) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (auto& t : producers) {
+      t.join();
+    }
+
+    ch.close();
+    while (finished.load() != num_consumers) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_EQ(static_cast<long long>(num_producers) * num_elements * (num_elements + 1) / 2, sum.load());
+}
+
+#ifdef XENIUM_HAS_COROUTINES
+struct fire_and_forget {
+  struct promise_type {
+    fire_and_forget get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+fire_and_forget consume(xenium::channel<int>& ch, std::vector<int>& results) {
+  while (auto v = co_await ch.pop()) {
+    results.push_back(*v);
+  }
+}
+
+fire_and_forget produce(xenium::channel<int>& ch, int count) {
+  for (int i = 0; i < count; ++i) {
+    EXPECT_TRUE(co_await ch.push(i));
+  }
+  ch.close();
+}
+
+TEST(Channel, coroutines_can_await_push_and_pop) {
+  manual_executor executor;
+  xenium::channel<int> ch(2, executor.get());
+  std::vector<int> results;
+  consume(ch, results);
+  EXPECT_TRUE(results.empty());
+  produce(ch, 10);
+  executor.run();
+
+  std::vector<int> expected;
+  for (int i = 0; i < 10; ++i) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(expected, results);
+}
+#endif
+
+} // namespace
@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <random>
 #include <thread>
 #include <vector>
@@ -83,6 +84,78 @@ TEST(ChaseWorkStealingDeque, push_pop_steal_many) {
   }
 }
 
+TEST(ChaseWorkStealingDeque, stores_small_trivially_copyable_values_inline) {
+  struct task {
+    std::uint64_t id;
+    std::uint32_t a;
+    std::uint32_t b;
+  };
+  constexpr unsigned count = 1000;
+  xenium::chase_work_stealing_deque<task, xenium::policy::store_inline<true>> queue;
+  static_assert(std::is_same_v<task, decltype(queue)::value_type>);
+
+  for (unsigned i = 0; i < count; ++i) {
+    ASSERT_TRUE(queue.try_push(task{i, i + 1, i + 2}));
+  }
+
+  task t{};
+  ASSERT_TRUE(queue.try_steal(t));
+  EXPECT_EQ(0u, t.id);
+  EXPECT_EQ(1u, t.a);
+  EXPECT_EQ(2u, t.b);
+  for (unsigned i = count - 1; i > 0; --i) {
+    ASSERT_TRUE(queue.try_pop(t));
+    EXPECT_EQ(i, t.id);
+    EXPECT_EQ(i + 1, t.a);
+    EXPECT_EQ(i + 2, t.b);
+  }
+  EXPECT_FALSE(queue.try_pop(t));
+  EXPECT_FALSE(queue.try_steal(t));
+}
+
+TEST(ChaseWorkStealingDeque, parallel_usage_with_inline_values) {
+  constexpr unsigned num_threads = 4;
+  constexpr std::uint64_t num_items = 20000;
+  struct item {
+    std::uint64_t value;
+    std::uint64_t check;
+  };
+  xenium::chase_work_stealing_deque<item, xenium::policy::store_inline<true>> queue;
+
+  std::atomic<std::uint64_t> sum{0};
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    thieves.emplace_back([&]() {
+      item v{};
+      while (!done.load()) {
+        if (queue.try_steal(v)) {
+          EXPECT_EQ(~v.value, v.check);
+          sum.fetch_add(v.value);
+        }
+      }
+    });
+  }
+
+  item v{};
+  for (std::uint64_t i = 1; i <= num_items; ++i) {
+    EXPECT_TRUE(queue.try_push(item{i, ~i}));
+    if (i % 3 == 0 && queue.try_pop(v)) {
+      EXPECT_EQ(~v.value, v.check);
+      sum.fetch_add(v.value);
+    }
+  }
+  while (queue.try_pop(v)) {
+    EXPECT_EQ(~v.value, v.check);
+    sum.fetch_add(v.value);
+  }
+  done.store(true);
+  for (auto& t : thieves) {
+    t.join();
+  }
+  EXPECT_EQ(num_items * (num_items + 1) / 2, sum.load());
+}
+
 TEST(ChaseWorkStealingDeque, parallel_usage) {
   constexpr unsigned num_threads = 8;
   constexpr unsigned num_nodes = num_threads * 8;
@@ -0,0 +1,237 @@
+#include <xenium/concurrent_cache.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+#include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
+#include <xenium/reclamation/quiescent_state_based.hpp>
+#include <xenium/reclamation/stamp_it.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Reclaimer>
+struct ConcurrentCache : ::testing::Test {
+  using cache_type = xenium::concurrent_cache<int, int, xenium::policy::reclaimer<Reclaimer>>;
+};
+
+// An accessor for a cache with non-trivial keys holds two guards, and erasing an entry
+// requires up to three, so we need more than the usual three hazard pointers/eras.
+using Reclaimers =
+  ::testing::Types<xenium::reclamation::hazard_pointer<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::static_strategy<5>>>,
+                   xenium::reclamation::hazard_eras<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<5>>>,
+                   xenium::reclamation::quiescent_state_based,
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
+                   xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
+TYPED_TEST_SUITE(ConcurrentCache, Reclaimers);
+
+TYPED_TEST(ConcurrentCache, constructor_throws_if_capacity_is_less_than_num_segments) {
+  using cache_type = typename TestFixture::cache_type;
+  EXPECT_THROW(cache_type(4, 8), std::invalid_argument);
+  EXPECT_THROW(cache_type(4, 0), std::invalid_argument);
+}
+
+TYPED_TEST(ConcurrentCache, try_get_returns_false_for_missing_key) {
+  typename TestFixture::cache_type cache(16, 2);
+  typename TestFixture::cache_type::accessor acc;
+  EXPECT_FALSE(cache.try_get(42, acc));
+  auto stats = cache.stats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TYPED_TEST(ConcurrentCache, try_get_returns_inserted_value) {
+  typename TestFixture::cache_type cache(16, 2);
+  EXPECT_TRUE(cache.emplace(42, 43));
+  EXPECT_FALSE(cache.emplace(42, 44));
+  EXPECT_EQ(1u, cache.size());
+
+  typename TestFixture::cache_type::accessor acc;
+  ASSERT_TRUE(cache.try_get(42, acc));
+  EXPECT_EQ(43, *acc);
+  auto stats = cache.stats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+}
+
+TYPED_TEST(ConcurrentCache, get_or_emplace_lazy_only_calls_factory_on_miss) {
+  typename TestFixture::cache_type cache(16, 2);
+  int calls = 0;
+  auto factory = [&calls] { return ++calls; };
+
+  auto [acc1, inserted1] = cache.get_or_emplace_lazy(42, factory);
+  EXPECT_TRUE(inserted1);
+  EXPECT_EQ(1, *acc1);
+
+  auto [acc2, inserted2] = cache.get_or_emplace_lazy(42, factory);
+  EXPECT_FALSE(inserted2);
+  EXPECT_EQ(1, *acc2);
+  EXPECT_EQ(1, calls);
+
+  auto stats = cache.stats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TYPED_TEST(ConcurrentCache, get_or_emplace_lazy_calls_factory_without_holding_segment_lock) {
+  // with a single segment, the factory would deadlock if it was called while holding the lock
+  typename TestFixture::cache_type cache(16, 1);
+  auto [acc, inserted] = cache.get_or_emplace_lazy(42, [&cache] {
+    EXPECT_TRUE(cache.emplace(1, 2));
+    return 43;
+  });
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(43, *acc);
+  EXPECT_EQ(2u, cache.size());
+}
+
+TYPED_TEST(ConcurrentCache, get_or_emplace_lazy_discards_value_if_key_is_inserted_concurrently) {
+  typename TestFixture::cache_type cache(16, 1);
+  auto [acc, inserted] = cache.get_or_emplace_lazy(42, [&cache] {
+    // simulate another thread that inserts the same key while the factory is running
+    EXPECT_TRUE(cache.emplace(42, 1));
+    return 43;
+  });
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(1, *acc);
+  EXPECT_EQ(1u, cache.size());
+
+  auto stats = cache.stats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+}
+
+TYPED_TEST(ConcurrentCache, erase_removes_entry) {
+  typename TestFixture::cache_type cache(16, 2);
+  EXPECT_FALSE(cache.erase(42));
+  cache.emplace(41, 41);
+  cache.emplace(42, 42);
+  cache.emplace(43, 43);
+  EXPECT_TRUE(cache.erase(42));
+  EXPECT_EQ(2u, cache.size());
+
+  typename TestFixture::cache_type::accessor acc;
+  EXPECT_FALSE(cache.try_get(42, acc));
+  EXPECT_TRUE(cache.try_get(41, acc));
+  EXPECT_TRUE(cache.try_get(43, acc));
+}
+
+TYPED_TEST(ConcurrentCache, size_never_exceeds_capacity) {
+  typename TestFixture::cache_type cache(64, 4);
+  for (int i = 0; i < 1000; ++i) {
+    cache.emplace(i, i);
+    EXPECT_GE(64u, cache.size());
+  }
+  EXPECT_EQ(64u, cache.size());
+  EXPECT_EQ(1000u - 64u, cache.stats().evictions);
+}
+
+TYPED_TEST(ConcurrentCache, referenced_entries_are_not_evicted) {
+  typename TestFixture::cache_type cache(4, 1);
+  for (int i = 0; i < 4; ++i) {
+    cache.emplace(i, i);
+  }
+
+  typename TestFixture::cache_type::accessor acc;
+  for (int i = 4; i < 100; ++i) {
+    // keep key 0 hot
+    ASSERT_TRUE(cache.try_get(0, acc));
+    cache.emplace(i, i);
+  }
+  EXPECT_TRUE(cache.try_get(0, acc));
+  EXPECT_EQ(0, *acc);
+  EXPECT_FALSE(cache.try_get(1, acc));
+}
+
+TYPED_TEST(ConcurrentCache, accessor_remains_valid_after_eviction) {
+  using cache_type = xenium::concurrent_cache<int, std::string, xenium::policy::reclaimer<TypeParam>>;
+  cache_type cache(2, 1);
+  typename cache_type::accessor acc;
+  {
+    [[maybe_unused]] typename TypeParam::region_guard guard{};
+    cache.emplace(1, "foobar");
+    ASSERT_TRUE(cache.try_get(1, acc));
+    for (int i = 2; i < 10; ++i) {
+      cache.emplace(i, std::to_string(i));
+    }
+  }
+  EXPECT_EQ("foobar", *acc);
+  EXPECT_EQ(6u, acc->size());
+}
+
+TYPED_TEST(ConcurrentCache, supports_string_keys) {
+  using cache_type = xenium::concurrent_cache<std::string, std::string, xenium::policy::reclaimer<TypeParam>>;
+  cache_type cache(8, 2);
+  for (int i = 0; i < 100; ++i) {
+    cache.emplace(std::to_string(i), "value" + std::to_string(i));
+  }
+  EXPECT_EQ(8u, cache.size());
+  typename cache_type::accessor acc;
+  EXPECT_TRUE(cache.try_get("99", acc));
+  EXPECT_EQ("value99", *acc);
+  EXPECT_TRUE(cache.erase("99"));
+  EXPECT_FALSE(cache.try_get("99", acc));
+}
+
+#ifdef DEBUG
+constexpr int MaxIterations = 1000;
+#else
+constexpr int MaxIterations = 10000;
+#endif
+
+TYPED_TEST(ConcurrentCache, parallel_usage) {
+  using Reclaimer = TypeParam;
+  using cache_type = typename TestFixture::cache_type;
+  cache_type cache(128, 8);
+
+  static constexpr int key_range = 512;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([i, &cache] {
+      unsigned r = static_cast<unsigned>(i) + 1;
+      for (int j = 0; j < MaxIterations; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        r = r * 1103515245 + 12345;
+        // skew the keys towards the lower end of the range, so there are hits and evictions
+        int key = static_cast<int>((r >> 8) % key_range) % (1 + static_cast<int>((r >> 20) % key_range));
+        if (j % 16 == 0) {
+          cache.erase(key);
+          continue;
+        }
+        auto [acc, inserted] = cache.get_or_emplace_lazy(key, [key] { return key * 2; });
+        EXPECT_EQ(key * 2, *acc);
+        EXPECT_GE(128u, cache.size());
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = cache.stats();
+  constexpr int erase_iterations = (MaxIterations + 15) / 16;
+  EXPECT_EQ(static_cast<std::uint64_t>(8 * (MaxIterations - erase_iterations)), stats.hits + stats.misses);
+  EXPECT_LT(0u, stats.hits);
+  EXPECT_LT(0u, stats.evictions);
+  EXPECT_GE(128u, cache.size());
+}
+} // namespace
@@ -0,0 +1,179 @@
+#include <xenium/concurrent_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+TEST(ConcurrentVector, new_vector_is_empty) {
+  xenium::concurrent_vector<int> vec;
+  EXPECT_TRUE(vec.empty());
+  EXPECT_EQ(0u, vec.size());
+  EXPECT_EQ(nullptr, vec.try_get(0));
+}
+
+TEST(ConcurrentVector, push_back_returns_consecutive_indexes) {
+  xenium::concurrent_vector<int> vec;
+  EXPECT_EQ(0u, vec.push_back(42));
+  EXPECT_EQ(1u, vec.push_back(43));
+  EXPECT_EQ(2u, vec.emplace_back(44));
+  EXPECT_EQ(3u, vec.size());
+  EXPECT_EQ(42, vec[0]);
+  EXPECT_EQ(43, vec[1]);
+  EXPECT_EQ(44, vec.at(2));
+}
+
+TEST(ConcurrentVector, at_throws_for_index_out_of_range) {
+  xenium::concurrent_vector<int> vec;
+  EXPECT_THROW(vec.at(0), std::out_of_range);
+  vec.push_back(42);
+  EXPECT_EQ(42, vec.at(0));
+  EXPECT_THROW(vec.at(1), std::out_of_range);
+}
+
+TEST(ConcurrentVector, elements_spanning_several_buckets_are_not_moved) {
+  xenium::concurrent_vector<std::string, xenium::policy::capacity<4>> vec;
+  std::vector<const std::string*> addresses;
+  for (int i = 0; i < 1000; ++i) {
+    auto idx = vec.push_back(std::to_string(i));
+    EXPECT_EQ(static_cast<std::size_t>(i), idx);
+    addresses.push_back(&vec[idx]);
+  }
+  ASSERT_EQ(1000u, vec.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(std::to_string(i), vec[i]);
+    EXPECT_EQ(addresses[i], &vec[i]);
+    EXPECT_EQ(addresses[i], vec.try_get(i));
+  }
+  EXPECT_EQ(nullptr, vec.try_get(1000));
+}
+
+TEST(ConcurrentVector, elements_are_destroyed_with_the_vector) {
+  auto counter = std::make_shared<int>(0);
+  {
+    xenium::concurrent_vector<std::shared_ptr<int>, xenium::policy::capacity<2>> vec;
+    for (int i = 0; i < 100; ++i) {
+      vec.push_back(counter);
+    }
+    EXPECT_EQ(101, counter.use_count());
+  }
+  EXPECT_EQ(1, counter.use_count());
+}
+
+struct throwing {
+  explicit throwing(bool do_throw) : value(42) {
+    if (do_throw) {
+      throw std::runtime_error("test");
+    }
+  }
+  int value;
+};
+
+TEST(ConcurrentVector, throwing_constructor_skips_index) {
+  xenium::concurrent_vector<throwing> vec;
+  EXPECT_EQ(0u, vec.emplace_back(false));
+  EXPECT_THROW(vec.emplace_back(true), std::runtime_error);
+  EXPECT_EQ(2u, vec.emplace_back(false));
+  EXPECT_EQ(3u, vec.size());
+  EXPECT_NE(nullptr, vec.try_get(0));
+  EXPECT_EQ(nullptr, vec.try_get(1));
+  EXPECT_NE(nullptr, vec.try_get(2));
+  EXPECT_EQ(42, vec[2].value);
+  EXPECT_THROW(vec.at(1), std::out_of_range);
+  EXPECT_EQ(42, vec.at(2).value);
+}
+
+// Fails all allocations while `fail` is set.
+struct failing_array_allocator {
+  static constexpr std::size_t alignment = xenium::default_array_allocator::alignment;
+  static inline bool fail = false;
+
+  static void* allocate(std::size_t size) noexcept {
+    return fail ? nullptr : xenium::default_array_allocator::allocate(size);
+  }
+  static void deallocate(void* p) noexcept { xenium::default_array_allocator::deallocate(p); }
+};
+
+TEST(ConcurrentVector, failed_bucket_allocation_does_not_block_later_pushes) {
+  xenium::concurrent_vector<int, xenium::policy::capacity<2>, xenium::policy::array_allocator<failing_array_allocator>>
+    vec;
+  EXPECT_EQ(0u, vec.push_back(0));
+  EXPECT_EQ(1u, vec.push_back(1));
+
+  // the next index lies in the second bucket, which cannot be allocated
+  failing_array_allocator::fail = true;
+  EXPECT_THROW(vec.push_back(2), std::bad_alloc);
+  failing_array_allocator::fail = false;
+  EXPECT_EQ(2u, vec.size());
+
+  EXPECT_EQ(2u, vec.push_back(2));
+  EXPECT_EQ(3u, vec.push_back(3));
+  EXPECT_EQ(4u, vec.size());
+  EXPECT_EQ(3, vec.at(3));
+}
+
+#ifdef DEBUG
+const int MaxIterations = 2000;
+#else
+const int MaxIterations = 20000;
+#endif
+
+constexpr int num_writers = 4;
+constexpr int num_readers = 4;
+
+TEST(ConcurrentVector, parallel_usage) {
+  xenium::concurrent_vector<std::pair<int, int>, xenium::policy::capacity<8>> vec;
+
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_writers; ++i) {
+    threads.push_back(std::thread([i, &vec, &writers_done] {
+      for (int j = 0; j < MaxIterations; ++j) {
+        auto idx = vec.emplace_back(i, j);
+        EXPECT_EQ(i, vec[idx].first);
+        EXPECT_EQ(j, vec[idx].second);
+      }
+      writers_done.fetch_add(1);
+    }));
+  }
+
+  for (int i = 0; i < num_readers; ++i) {
+    threads.push_back(std::thread([&vec, &writers_done] {
+      std::size_t checked = 0;
+      for (;;) {
+        const bool done = writers_done.load() == num_writers;
+        auto size = vec.size();
+        for (; checked < size; ++checked) {
+          auto& entry = vec[checked];
+          EXPECT_LE(0, entry.first);
+          EXPECT_GT(num_writers, entry.first);
+          EXPECT_GT(MaxIterations, entry.second);
+        }
+        if (done) {
+          break;
+        }
+      }
+      EXPECT_EQ(static_cast<std::size_t>(num_writers * MaxIterations), checked);
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // the elements of each writer must appear in the order they have been pushed
+  std::vector<int> last(num_writers, -1);
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    auto& entry = vec[i];
+    EXPECT_LT(last[entry.first], entry.second);
+    last[entry.first] = entry.second;
+  }
+}
+} // namespace
@@ -0,0 +1,208 @@
+#include <xenium/disruptor_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(DisruptorRing, every_consumer_sees_every_published_element) {
+  xenium::disruptor_ring<int> ring(4);
+  auto& c1 = ring.add_consumer();
+  auto& c2 = ring.add_consumer();
+
+  ring.push(1);
+  ring.push(2);
+
+  int elem;
+  EXPECT_TRUE(c1.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(c1.try_pop(elem));
+  EXPECT_EQ(2, elem);
+  EXPECT_FALSE(c1.try_pop(elem));
+
+  EXPECT_TRUE(c2.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(c2.try_pop(elem));
+  EXPECT_EQ(2, elem);
+  EXPECT_FALSE(c2.try_pop(elem));
+}
+
+TEST(DisruptorRing, try_claim_fails_when_slowest_consumer_is_capacity_behind) {
+  xenium::disruptor_ring<int> ring(2);
+  auto& fast = ring.add_consumer();
+  auto& slow = ring.add_consumer();
+
+  EXPECT_TRUE(ring.try_push(1));
+  EXPECT_TRUE(ring.try_push(2));
+  EXPECT_FALSE(ring.try_push(3));
+
+  int elem;
+  EXPECT_TRUE(fast.try_pop(elem));
+  EXPECT_TRUE(fast.try_pop(elem));
+  EXPECT_FALSE(ring.try_push(3));
+
+  EXPECT_TRUE(slow.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(ring.try_push(3));
+  EXPECT_FALSE(ring.try_push(4));
+}
+
+TEST(DisruptorRing, batch_claim_publish_and_consume) {
+  xenium::disruptor_ring<int> ring(8);
+  auto& c = ring.add_consumer();
+
+  std::uint64_t first;
+  ASSERT_TRUE(ring.try_claim(5, first));
+  EXPECT_EQ(0u, first);
+  for (std::uint64_t i = 0; i < 5; ++i) {
+    ring[first + i] = static_cast<int>(i);
+  }
+  EXPECT_EQ(0u, c.try_consume([](const int&, std::uint64_t) {}));
+  ring.publish(first, 5);
+
+  std::vector<int> seen;
+  EXPECT_EQ(3u, c.try_consume([&](const int& v, std::uint64_t) { seen.push_back(v); }, 3));
+  EXPECT_EQ(3u, c.sequence());
+  EXPECT_EQ(2u, c.try_consume([&](const int& v, std::uint64_t) { seen.push_back(v); }));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), seen);
+
+  // the consumer has processed all elements, so the whole ring is available again
+  std::uint64_t second;
+  ASSERT_TRUE(ring.try_claim(8, second));
+  EXPECT_EQ(5u, second);
+  EXPECT_FALSE(ring.try_claim(1, second));
+}
+
+TEST(DisruptorRing, elements_published_out_of_order_are_seen_in_sequence_order) {
+  xenium::disruptor_ring<int> ring(4);
+  auto& c = ring.add_consumer();
+
+  auto s1 = ring.claim();
+  auto s2 = ring.claim();
+  ring[s2] = 2;
+  ring.publish(s2);
+
+  int elem;
+  EXPECT_FALSE(c.try_pop(elem));
+  ring[s1] = 1;
+  ring.publish(s1);
+  EXPECT_TRUE(c.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(c.try_pop(elem));
+  EXPECT_EQ(2, elem);
+}
+
+TEST(DisruptorRing, dependent_consumer_only_sees_elements_processed_by_its_dependencies) {
+  xenium::disruptor_ring<int> ring(4);
+  auto& a = ring.add_consumer();
+  auto& b = ring.add_consumer();
+  auto& c = ring.add_consumer({a, b});
+
+  ring.push(1);
+  ring.push(2);
+
+  int elem;
+  EXPECT_FALSE(c.try_pop(elem));
+  EXPECT_TRUE(a.try_pop(elem));
+  EXPECT_TRUE(a.try_pop(elem));
+  EXPECT_FALSE(c.try_pop(elem));
+  EXPECT_TRUE(b.try_pop(elem));
+  EXPECT_TRUE(c.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_FALSE(c.try_pop(elem));
+
+  // the producers are now gated by c only
+  EXPECT_TRUE(ring.try_push(3));
+  EXPECT_TRUE(ring.try_push(4));
+  EXPECT_TRUE(ring.try_push(5));
+  EXPECT_FALSE(ring.try_push(6));
+}
+
+TEST(DisruptorRing, without_consumers_producers_never_block) {
+  xenium::disruptor_ring<int, xenium::policy::single_producer<true>> ring(2);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(ring.try_push(i));
+  }
+}
+
+template <class Ring>
+void run_parallel_test(unsigned num_producers) {
+  constexpr unsigned num_consumers = 3;
+#ifdef DEBUG
+  constexpr std::uint64_t num_elements = 1000;
+#else
+  constexpr std::uint64_t num_elements = 20000;
+#endif
+  Ring ring(64);
+  std::vector<typename Ring::consumer*> consumers;
+  auto& first = ring.add_consumer();
+  consumers.push_back(&first);
+  consumers.push_back(&ring.add_consumer());
+  // the last consumer checks that the first one has already seen every element
+  consumers.push_back(&ring.add_consumer({first}));
+
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&ring, p] {
+      std::uint64_t i = 0;
+      while (i < num_elements) {
+        // alternate between single elements and batches
+        std::size_t n = std::min<std::uint64_t>((i % 3) + 1, num_elements - i);
+        auto seq = ring.claim(n);
+        for (std::size_t j = 0; j < n; ++j) {
+          ring[seq + j] = (static_cast<std::uint64_t>(p) << 32) | (i + j);
+        }
+        ring.publish(seq, n);
+        i += n;
+      }
+    });
+  }
+
+  std::vector<std::vector<std::uint64_t>> last_seen(num_consumers);
+  for (unsigned c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&, c] {
+      auto& consumer = *consumers[c];
+      std::vector<std::uint64_t> next(num_producers, 0);
+      std::uint64_t expected_seq = 0;
+      std::uint64_t received = 0;
+      while (received < num_producers * num_elements) {
+        auto n = consumer.try_consume([&](const std::uint64_t& v, std::uint64_t seq) {
+          EXPECT_EQ(expected_seq, seq);
+          ++expected_seq;
+          auto producer = v >> 32;
+          auto value = v & 0xffffffff;
+          // the elements of each producer must be seen in FIFO order
+          EXPECT_EQ(next[producer], value);
+          next[producer] = value + 1;
+        });
+        if (n == 0) {
+          std::this_thread::yield();
+        } else if (c == num_consumers - 1) {
+          EXPECT_LE(consumer.sequence(), consumers[0]->sequence());
+        }
+        received += n;
+      }
+      last_seen[c] = next;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& next : last_seen) {
+    EXPECT_EQ(std::vector<std::uint64_t>(num_producers, num_elements), next);
+  }
+}
+
+TEST(DisruptorRing, parallel_usage_single_producer) {
+  run_parallel_test<xenium::disruptor_ring<std::uint64_t, xenium::policy::single_producer<true>>>(1);
+}
+
+TEST(DisruptorRing, parallel_usage_multiple_producers) {
+  run_parallel_test<xenium::disruptor_ring<std::uint64_t, xenium::policy::backoff<xenium::exponential_backoff<16>>>>(
+    4);
+}
+
+} // namespace
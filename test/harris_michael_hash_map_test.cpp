@@ -2,7 +2,12 @@
 #include <xenium/reclamation/generic_epoch_based.hpp>
 #include <xenium/reclamation/hazard_eras.hpp>
 #include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
 #include <xenium/reclamation/lock_free_ref_count.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
 #include <xenium/reclamation/quiescent_state_based.hpp>
 #include <xenium/reclamation/stamp_it.hpp>
 
@@ -33,6 +38,11 @@ using Reclaimers =
                      xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<3>>>,
                    xenium::reclamation::quiescent_state_based,
                    xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
                    xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
@@ -142,6 +152,31 @@ TYPED_TEST(HarrisMichaelHashMap, erase_existing_element_twice_fails_the_seond_ti
   EXPECT_FALSE(this->map.erase(42));
 }
 
+TYPED_TEST(HarrisMichaelHashMap, string_key_supports_heterogeneous_lookup_with_string_view) {
+  using hash_map = xenium::
+    harris_michael_hash_map<std::string, int, xenium::policy::reclaimer<TypeParam>, xenium::policy::buckets<10>>;
+  hash_map map;
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(map.emplace(std::to_string(i), i));
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    std::string key = std::to_string(i);
+    std::string_view k = key;
+    EXPECT_TRUE(map.contains(k));
+    auto it = map.find(k);
+    ASSERT_NE(map.end(), it);
+    EXPECT_EQ(key, it->first);
+    EXPECT_EQ(i, it->second);
+  }
+
+  EXPECT_FALSE(map.contains(std::string_view("foo")));
+  EXPECT_EQ(map.end(), map.find(std::string_view("foo")));
+  EXPECT_TRUE(map.erase(std::string_view("42")));
+  EXPECT_FALSE(map.erase(std::string_view("42")));
+  EXPECT_FALSE(map.contains(std::string("42")));
+}
+
 TYPED_TEST(HarrisMichaelHashMap, begin_returns_end_iterator_for_empty_map) {
   auto it = this->map.begin();
   ASSERT_EQ(this->map.end(), it);
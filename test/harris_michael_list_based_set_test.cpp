@@ -2,7 +2,12 @@
 #include <xenium/reclamation/generic_epoch_based.hpp>
 #include <xenium/reclamation/hazard_eras.hpp>
 #include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
 #include <xenium/reclamation/lock_free_ref_count.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
 #include <xenium/reclamation/quiescent_state_based.hpp>
 #include <xenium/reclamation/stamp_it.hpp>
 
@@ -24,6 +29,11 @@ using Reclaimers =
                      xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<3>>>,
                    xenium::reclamation::quiescent_state_based,
                    xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
                    xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
@@ -0,0 +1,198 @@
+#include <xenium/backoff.hpp>
+#include <xenium/hoffman_basket_queue.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+#include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#include <xenium/reclamation/lock_free_ref_count.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
+#include <xenium/reclamation/quiescent_state_based.hpp>
+#include <xenium/reclamation/stamp_it.hpp>
+
+#include "helpers.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <typename Reclaimer>
+struct HoffmanBasketQueue : testing::Test {};
+
+using Reclaimers =
+  ::testing::Types<xenium::reclamation::lock_free_ref_count<>,
+                   xenium::reclamation::hazard_pointer<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::static_strategy<2>>>,
+                   xenium::reclamation::hazard_eras<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<2>>>,
+                   xenium::reclamation::quiescent_state_based,
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
+                   xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
+TYPED_TEST_SUITE(HoffmanBasketQueue, Reclaimers);
+
+TYPED_TEST(HoffmanBasketQueue, try_pop_from_empty_queue) {
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<TypeParam>> queue;
+  int elem = 0;
+  ASSERT_FALSE(queue.try_pop(elem));
+}
+
+TYPED_TEST(HoffmanBasketQueue, pop_from_empty_queue) {
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<TypeParam>> queue;
+  auto elem = queue.pop();
+  ASSERT_FALSE(elem.has_value());
+}
+
+TYPED_TEST(HoffmanBasketQueue, push_try_pop_returns_pushed_element) {
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<TypeParam>> queue;
+  queue.push(42);
+  int elem = 0;
+  ASSERT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(42, elem);
+}
+
+TYPED_TEST(HoffmanBasketQueue, push_pop_returns_pushed_element) {
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<TypeParam>> queue;
+  queue.push(42);
+  auto elem = queue.pop();
+  ASSERT_TRUE(elem.has_value());
+  EXPECT_EQ(42, *elem);
+}
+
+TYPED_TEST(HoffmanBasketQueue, push_two_items_pop_them_in_FIFO_order) {
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<TypeParam>> queue;
+  queue.push(42);
+  queue.push(43);
+  auto elem1 = queue.pop();
+  auto elem2 = queue.pop();
+  EXPECT_TRUE(elem1.has_value());
+  EXPECT_TRUE(elem2.has_value());
+  EXPECT_EQ(42, *elem1);
+  EXPECT_EQ(43, *elem2);
+}
+
+TYPED_TEST(HoffmanBasketQueue, supports_move_only_types) {
+  xenium::hoffman_basket_queue<std::unique_ptr<int>, xenium::policy::reclaimer<TypeParam>> queue;
+  queue.push(std::make_unique<int>(42));
+
+  std::unique_ptr<int> elem;
+  ASSERT_TRUE(queue.try_pop(elem));
+  ASSERT_NE(nullptr, elem);
+  EXPECT_EQ(42, *elem);
+}
+
+TYPED_TEST(HoffmanBasketQueue, supports_non_default_constructible_types) {
+  xenium::hoffman_basket_queue<xenium::test::non_default_constructible, xenium::policy::reclaimer<TypeParam>> queue;
+  queue.push(xenium::test::non_default_constructible(42));
+
+  auto elem = queue.pop();
+  ASSERT_TRUE(elem.has_value());
+  EXPECT_EQ(42, elem->value);
+}
+
+TYPED_TEST(HoffmanBasketQueue, correctly_destroys_stored_objects) {
+  int created = 0;
+  int destroyed = 0;
+  struct Counting {
+    Counting(int& created, int& destroyed) : created(created), destroyed(destroyed) { ++created; }
+    Counting(const Counting& r) noexcept : created(r.created), destroyed(r.destroyed) { ++created; }
+    ~Counting() { ++destroyed; }
+    int& created;
+    int& destroyed;
+  };
+  {
+    xenium::hoffman_basket_queue<Counting, xenium::policy::reclaimer<TypeParam>> queue;
+    queue.push({created, destroyed});
+    queue.push({created, destroyed});
+    queue.push({created, destroyed});
+    queue.push({created, destroyed});
+
+    EXPECT_TRUE(queue.pop());
+    EXPECT_TRUE(queue.pop());
+    EXPECT_EQ(2, created - destroyed);
+  }
+  EXPECT_EQ(0, created - destroyed);
+}
+
+TYPED_TEST(HoffmanBasketQueue, parallel_usage) {
+  using Reclaimer = TypeParam;
+  xenium::hoffman_basket_queue<int, xenium::policy::reclaimer<Reclaimer>> queue;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back(std::thread([i, &queue] {
+#ifdef DEBUG
+      const int MaxIterations = 1000;
+#else
+      const int MaxIterations = 10000;
+#endif
+      for (int j = 0; j < MaxIterations; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        queue.push(i);
+        int v;
+        EXPECT_TRUE(queue.try_pop(v));
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TYPED_TEST(HoffmanBasketQueue, parallel_usage_preserves_per_producer_FIFO_order) {
+  using Reclaimer = TypeParam;
+  xenium::hoffman_basket_queue<std::pair<int, int>,
+                               xenium::policy::reclaimer<Reclaimer>,
+                               xenium::policy::backoff<xenium::exponential_backoff<16>>>
+    queue;
+
+  constexpr int Producers = 4;
+#ifdef DEBUG
+  constexpr int MaxIterations = 1000;
+#else
+  constexpr int MaxIterations = 10000;
+#endif
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < Producers; ++i) {
+    threads.push_back(std::thread([i, &queue] {
+      for (int j = 0; j < MaxIterations; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        queue.push({i, j});
+      }
+    }));
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    threads.push_back(std::thread([&queue] {
+      int last_seen[Producers];
+      std::fill(std::begin(last_seen), std::end(last_seen), -1);
+      for (int j = 0; j < MaxIterations; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        if (auto v = queue.pop()) {
+          EXPECT_LT(last_seen[v->first], v->second);
+          last_seen[v->first] = v->second;
+        }
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+} // namespace
@@ -0,0 +1,180 @@
+#include <xenium/idempotent_work_stealing_deque.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct node {
+  std::atomic<int> extracted{0};
+};
+
+template <typename Deque>
+struct IdempotentWorkStealingDeque : testing::Test {
+  using deque = Deque;
+};
+
+using Deques = ::testing::Types<xenium::idempotent_work_stealing_deque<node, xenium::policy::fifo<false>>,
+                                xenium::idempotent_work_stealing_deque<node, xenium::policy::fifo<true>>>;
+TYPED_TEST_SUITE(IdempotentWorkStealingDeque, Deques);
+
+TYPED_TEST(IdempotentWorkStealingDeque, try_pop_and_try_steal_from_empty_deque) {
+  typename TestFixture::deque queue;
+  node* elem = nullptr;
+  EXPECT_FALSE(queue.try_pop(elem));
+  EXPECT_FALSE(queue.try_steal(elem));
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, push_try_pop_returns_pushed_element) {
+  node n;
+  typename TestFixture::deque queue;
+  EXPECT_TRUE(queue.try_push(&n));
+  node* elem = nullptr;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(&n, elem);
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, push_try_steal_returns_pushed_element) {
+  node n;
+  typename TestFixture::deque queue;
+  EXPECT_TRUE(queue.try_push(&n));
+  node* elem = nullptr;
+  EXPECT_TRUE(queue.try_steal(elem));
+  EXPECT_EQ(&n, elem);
+  EXPECT_FALSE(queue.try_steal(elem));
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, items_are_taken_in_configured_order) {
+  node n1;
+  node n2;
+  typename TestFixture::deque queue;
+  EXPECT_TRUE(queue.try_push(&n1));
+  EXPECT_TRUE(queue.try_push(&n2));
+  EXPECT_EQ(2u, queue.size());
+
+  node* elem = nullptr;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(TestFixture::deque::fifo ? &n1 : &n2, elem);
+  EXPECT_TRUE(queue.try_steal(elem));
+  EXPECT_EQ(TestFixture::deque::fifo ? &n2 : &n1, elem);
+  EXPECT_EQ(0u, queue.size());
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, grows_beyond_initial_capacity) {
+  constexpr unsigned count = 1000;
+  std::vector<node> nodes(count);
+  typename TestFixture::deque queue;
+  for (auto& n : nodes) {
+    ASSERT_TRUE(queue.try_push(&n));
+  }
+  EXPECT_EQ(count, queue.size());
+
+  node* elem = nullptr;
+  for (unsigned i = 0; i < count; ++i) {
+    ASSERT_TRUE(i % 2 == 0 ? queue.try_pop(elem) : queue.try_steal(elem));
+    elem->extracted.fetch_add(1);
+  }
+  EXPECT_FALSE(queue.try_pop(elem));
+  for (auto& n : nodes) {
+    EXPECT_EQ(1, n.extracted.load());
+  }
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, grows_correctly_after_indices_have_passed_twice_the_capacity) {
+  constexpr unsigned capacity = 4;
+  using deque =
+    typename TypeParam::template with<xenium::policy::container<xenium::detail::growing_circular_array<node, capacity>>>;
+  deque queue;
+
+  // move the indices far beyond the capacity without growing the array
+  node dummy;
+  node* elem = nullptr;
+  for (unsigned i = 0; i < 5 * capacity; ++i) {
+    ASSERT_TRUE(queue.try_push(&dummy));
+    ASSERT_TRUE(queue.try_pop(elem));
+  }
+
+  // now fill the array beyond its capacity so it has to grow several times
+  constexpr unsigned count = 4 * capacity + 1;
+  std::vector<node> nodes(count);
+  for (auto& n : nodes) {
+    ASSERT_TRUE(queue.try_push(&n));
+  }
+  EXPECT_EQ(count, queue.size());
+
+  for (unsigned i = 0; i < count; ++i) {
+    ASSERT_TRUE(queue.try_pop(elem));
+    ASSERT_NE(nullptr, elem);
+    elem->extracted.fetch_add(1);
+  }
+  EXPECT_FALSE(queue.try_pop(elem));
+  for (auto& n : nodes) {
+    EXPECT_EQ(1, n.extracted.load());
+  }
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, push_fails_if_fixed_size_container_is_full) {
+  using deque = typename TypeParam::template with<
+    xenium::policy::container<xenium::detail::fixed_size_circular_array<node, 4>>>;
+  deque queue;
+  node nodes[5];
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.try_push(&nodes[i]));
+  }
+  EXPECT_FALSE(queue.try_push(&nodes[4]));
+  node* elem = nullptr;
+  ASSERT_TRUE(queue.try_steal(elem));
+  EXPECT_TRUE(queue.try_push(&nodes[4]));
+}
+
+TYPED_TEST(IdempotentWorkStealingDeque, parallel_usage_extracts_every_item_at_least_once) {
+  constexpr unsigned num_thieves = 4;
+#ifdef DEBUG
+  constexpr unsigned count = 2000;
+#else
+  constexpr unsigned count = 20000;
+#endif
+  std::vector<node> nodes(count);
+  typename TestFixture::deque queue;
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (unsigned i = 0; i < num_thieves; ++i) {
+    thieves.emplace_back([&]() {
+      node* elem = nullptr;
+      while (!done.load()) {
+        if (queue.try_steal(elem)) {
+          elem->extracted.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  node* elem = nullptr;
+  for (unsigned i = 0; i < count; ++i) {
+    EXPECT_TRUE(queue.try_push(&nodes[i]));
+    if (i % 3 == 0 && queue.try_pop(elem)) {
+      elem->extracted.fetch_add(1);
+    }
+  }
+  while (queue.try_pop(elem)) {
+    elem->extracted.fetch_add(1);
+  }
+  done.store(true);
+  for (auto& t : thieves) {
+    t.join();
+  }
+
+  for (auto& n : nodes) {
+    EXPECT_GE(n.extracted.load(), 1);
+  }
+}
+
+} // namespace
@@ -0,0 +1,120 @@
+#include <xenium/intrusive_mpsc_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct node : xenium::intrusive_mpsc_queue_hook {
+  explicit node(int v = 0, int p = 0) : value(v), producer(p) {}
+  int value;
+  int producer;
+};
+
+TEST(IntrusiveMpscQueue, pop_on_empty_queue_returns_nullptr) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  EXPECT_EQ(nullptr, queue.pop());
+  node* n;
+  EXPECT_FALSE(queue.try_pop(n));
+}
+
+TEST(IntrusiveMpscQueue, push_pop_returns_pushed_element) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  node n(42);
+  queue.push(&n);
+  EXPECT_EQ(&n, queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+}
+
+TEST(IntrusiveMpscQueue, push_try_pop_returns_pushed_element) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  node n(42);
+  queue.push(&n);
+  node* result = nullptr;
+  EXPECT_TRUE(queue.try_pop(result));
+  EXPECT_EQ(&n, result);
+}
+
+TEST(IntrusiveMpscQueue, push_nullptr_throws_invalid_argument) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  EXPECT_THROW(queue.push(nullptr), std::invalid_argument);
+}
+
+TEST(IntrusiveMpscQueue, push_pop_in_fifo_order) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  std::vector<node> nodes;
+  for (int i = 0; i < 10; ++i) {
+    nodes.emplace_back(i);
+  }
+  for (auto& n : nodes) {
+    queue.push(&n);
+  }
+  for (int i = 0; i < 10; ++i) {
+    node* n = queue.pop();
+    ASSERT_NE(nullptr, n);
+    EXPECT_EQ(i, n->value);
+  }
+  EXPECT_EQ(nullptr, queue.pop());
+}
+
+TEST(IntrusiveMpscQueue, popped_element_can_be_pushed_again) {
+  xenium::intrusive_mpsc_queue<node> queue;
+  node a(1);
+  node b(2);
+  for (int i = 0; i < 3; ++i) {
+    queue.push(&a);
+    queue.push(&b);
+    EXPECT_EQ(&a, queue.pop());
+    queue.push(&a);
+    EXPECT_EQ(&b, queue.pop());
+    EXPECT_EQ(&a, queue.pop());
+    EXPECT_EQ(nullptr, queue.pop());
+  }
+}
+
+TEST(IntrusiveMpscQueue, parallel_usage) {
+  constexpr int num_producers = 4;
+#ifdef DEBUG
+  constexpr int num_elements = 1000;
+#else
+  constexpr int num_elements = 20000;
+#endif
+  xenium::intrusive_mpsc_queue<node> queue;
+  std::vector<std::vector<node>> nodes(num_producers);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    nodes[p].reserve(num_elements);
+    for (int i = 0; i < num_elements; ++i) {
+      nodes[p].emplace_back(i, p);
+    }
+    threads.emplace_back([&queue, &nodes, p] {
+      for (auto& n : nodes[p]) {
+        queue.push(&n);
+      }
+    });
+  }
+
+  std::vector<int> next_value(num_producers, 0);
+  int received = 0;
+  while (received < num_producers * num_elements) {
+    node* n = queue.pop();
+    if (n == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    // elements of the same producer must be received in FIFO order
+    ASSERT_EQ(next_value[n->producer], n->value);
+    ++next_value[n->producer];
+    ++received;
+  }
+  EXPECT_EQ(nullptr, queue.pop());
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace
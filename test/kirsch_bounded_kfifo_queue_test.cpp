@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 #include <thread>
 #include <vector>
 
@@ -118,4 +122,98 @@ TEST(KirschBoundedKFifoQueue, parallel_usage) {
   }
 }
 
+TEST(KirschBoundedKFifoQueue, try_push_fails_after_close) {
+  xenium::kirsch_bounded_kfifo_queue<int*> queue(1, 4);
+  EXPECT_TRUE(queue.try_push(v1));
+  EXPECT_FALSE(queue.is_closed());
+  queue.close();
+  EXPECT_TRUE(queue.is_closed());
+  EXPECT_FALSE(queue.try_push(v2));
+  EXPECT_FALSE(queue.is_drained());
+  int* elem = nullptr;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(v1, elem);
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(KirschBoundedKFifoQueue, empty_queue_is_only_drained_once_it_is_closed) {
+  xenium::kirsch_bounded_kfifo_queue<int*> queue(1, 4);
+  EXPECT_FALSE(queue.is_drained());
+  queue.close();
+  EXPECT_TRUE(queue.is_drained());
+}
+
+TEST(KirschBoundedKFifoQueue, try_pop_batch_pops_up_to_max_elements) {
+  xenium::kirsch_bounded_kfifo_queue<std::unique_ptr<int>> queue(2, 4);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(i)));
+  }
+  std::vector<std::unique_ptr<int>> result;
+  EXPECT_EQ(4u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(2u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(0u, queue.try_pop_batch(std::back_inserter(result), 4));
+  std::vector<int> values;
+  for (auto& v : result) {
+    values.push_back(*v);
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5}), values);
+}
+
+TEST(KirschBoundedKFifoQueue, parallel_usage_with_close_neither_loses_nor_duplicates_elements) {
+  xenium::kirsch_bounded_kfifo_queue<std::unique_ptr<int>> queue(2, 32);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 2;
+#ifdef DEBUG
+  constexpr int close_after = 5000;
+#else
+  constexpr int close_after = 50000;
+#endif
+  std::atomic<int> pushed{0};
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&queue, &pushed, &pushed_sum] {
+      for (int i = 1;; ++i) {
+        if (queue.try_push(std::make_unique<int>(i))) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+          pushed_sum.fetch_add(i, std::memory_order_relaxed);
+        } else if (queue.is_closed()) {
+          break;
+        }
+      }
+    });
+  }
+  for (int c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&queue, &popped_sum] {
+      std::vector<std::unique_ptr<int>> batch(8);
+      long long sum = 0;
+      for (;;) {
+        auto n = queue.try_pop_batch(batch.begin(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+          sum += *batch[i];
+        }
+        if (n == 0 && queue.is_drained()) {
+          break;
+        }
+      }
+      popped_sum.fetch_add(sum, std::memory_order_relaxed);
+    });
+  }
+
+  while (pushed.load(std::memory_order_relaxed) < close_after) {
+    std::this_thread::yield();
+  }
+  queue.close();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
 } // namespace
\ No newline at end of file
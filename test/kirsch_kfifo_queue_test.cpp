@@ -2,6 +2,11 @@
 #include <xenium/reclamation/generic_epoch_based.hpp>
 #include <xenium/reclamation/hazard_eras.hpp>
 #include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
 #include <xenium/reclamation/quiescent_state_based.hpp>
 #include <xenium/reclamation/stamp_it.hpp>
 
@@ -27,7 +32,12 @@ using Reclaimers =
                    xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
-                   xenium::reclamation::stamp_it>;
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>>;
 TYPED_TEST_SUITE(KirschKFifoQueue, Reclaimers);
 
 TYPED_TEST(KirschKFifoQueue, try_pop_returns_false_for_empty_queue) {
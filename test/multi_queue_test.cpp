@@ -0,0 +1,131 @@
+#include <xenium/michael_scott_queue.hpp>
+#include <xenium/multi_queue.hpp>
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/vyukov_bounded_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using reclaimer = xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>;
+using unbounded_queue =
+  xenium::multi_queue<int,
+                      xenium::policy::container<xenium::michael_scott_queue<int, xenium::policy::reclaimer<reclaimer>>>>;
+using bounded_queue = xenium::multi_queue<int, xenium::policy::container<xenium::vyukov_bounded_queue<int>>>;
+
+TEST(MultiQueue, requires_at_least_two_sub_queues) {
+  EXPECT_THROW(unbounded_queue(1), std::invalid_argument);
+}
+
+TEST(MultiQueue, try_pop_from_empty_queue) {
+  unbounded_queue queue(4);
+  EXPECT_EQ(4u, queue.num_queues());
+  int elem = 0;
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(MultiQueue, push_try_pop_returns_pushed_element) {
+  unbounded_queue queue(4);
+  queue.push(42);
+  int elem = 0;
+  ASSERT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(42, elem);
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(MultiQueue, all_pushed_elements_are_popped_exactly_once) {
+  unbounded_queue queue(8);
+  constexpr int count = 1000;
+  for (int i = 0; i < count; ++i) {
+    queue.push(i);
+  }
+
+  std::vector<int> popped;
+  int elem = 0;
+  while (queue.try_pop(elem)) {
+    popped.push_back(elem);
+  }
+  ASSERT_EQ(static_cast<std::size_t>(count), popped.size());
+  std::sort(popped.begin(), popped.end());
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(i, popped[i]);
+  }
+}
+
+TEST(MultiQueue, elements_in_the_same_sub_queue_are_popped_in_fifo_order) {
+  // with a single thread and a stickiness as large as the number of elements,
+  // all elements end up in the same sub-queue.
+  xenium::multi_queue<int,
+                      xenium::policy::container<xenium::vyukov_bounded_queue<int>>,
+                      xenium::policy::stickiness<1000>>
+    queue(2, 128);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.try_push(i));
+  }
+  int elem = 0;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.try_pop(elem));
+    EXPECT_EQ(i, elem);
+  }
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(MultiQueue, try_push_to_bounded_sub_queues_fails_only_if_all_are_full) {
+  bounded_queue queue(4, 2);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(queue.try_push(i));
+  }
+  EXPECT_FALSE(queue.try_push(8));
+
+  int elem = 0;
+  ASSERT_TRUE(queue.try_pop(elem));
+  EXPECT_TRUE(queue.try_push(elem));
+  EXPECT_FALSE(queue.try_push(8));
+}
+
+TEST(MultiQueue, parallel_usage) {
+  constexpr int num_threads = 4;
+#ifdef DEBUG
+  constexpr int count = 1000;
+#else
+  constexpr int count = 10000;
+#endif
+
+  unbounded_queue queue(2 * num_threads);
+  std::atomic<long long> sum{0};
+  std::atomic<int> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      [[maybe_unused]] typename reclaimer::region_guard guard{};
+      for (int i = 0; i < count; ++i) {
+        queue.push(t * count + i);
+        int elem = 0;
+        if (queue.try_pop(elem)) {
+          sum.fetch_add(elem, std::memory_order_relaxed);
+          popped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  int elem = 0;
+  while (queue.try_pop(elem)) {
+    sum.fetch_add(elem, std::memory_order_relaxed);
+    popped.fetch_add(1, std::memory_order_relaxed);
+  }
+  constexpr long long total = static_cast<long long>(num_threads) * count;
+  EXPECT_EQ(total, popped.load());
+  EXPECT_EQ(total * (total - 1) / 2, sum.load());
+}
+
+} // namespace
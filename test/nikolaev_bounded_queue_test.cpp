@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <iterator>
 #include <random>
 #include <thread>
 #include <vector>
@@ -136,16 +138,12 @@ const int MaxIterations = 400000;
 TEST(NikolaevBoundedQueue, parallel_usage) {
   xenium::nikolaev_bounded_queue<int> queue(8);
 
-  constexpr int num_threads = 4;
-  constexpr int thread_mask = num_threads - 1;
+  static constexpr int num_threads = 4;
+  static constexpr int thread_mask = num_threads - 1;
 
   std::vector<std::thread> threads;
   for (int i = 0; i < num_threads; ++i) {
-    threads.emplace_back([i, &queue, num_threads, thread_mask] {
-      // oh my... MSVC complains if these variables are NOT captured; clang complains if they ARE captured.
-      (void)num_threads;
-      (void)thread_mask;
-
+    threads.emplace_back([i, &queue] {
       std::vector<int> last_seen(num_threads);
       int counter = 0;
       for (int j = 0; j < MaxIterations; ++j) {
@@ -222,4 +220,336 @@ TEST(NikolaevBoundedQueue, parallel_usage_mostly_empty) {
   }
 }
 
+using wait_free_queue = xenium::nikolaev_bounded_queue<int, xenium::policy::wait_free<true>>;
+
+TEST(NikolaevBoundedQueue, wait_free_push_pop_in_fifo_order_with_remapped_indexes) {
+  constexpr int capacity = 32;
+  wait_free_queue queue(capacity);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < capacity; ++i) {
+      ASSERT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(capacity));
+
+    for (int i = 0; i < capacity; ++i) {
+      int value;
+      ASSERT_TRUE(queue.try_pop(value));
+      EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(queue.pop());
+  }
+}
+
+TEST(NikolaevBoundedQueue, wait_free_correctly_destroys_stored_objects) {
+  int created = 0;
+  int destroyed = 0;
+  struct Counting {
+    Counting(int& created, int& destroyed) : created(created), destroyed(destroyed) { ++created; }
+    Counting(const Counting& r) noexcept : created(r.created), destroyed(r.destroyed) { ++created; }
+    ~Counting() { ++destroyed; }
+    int& created;
+    int& destroyed;
+  };
+  {
+    xenium::nikolaev_bounded_queue<Counting, xenium::policy::wait_free<true>> queue(4);
+    queue.try_push(Counting{created, destroyed});
+    queue.try_push(Counting{created, destroyed});
+    queue.try_push(Counting{created, destroyed});
+    EXPECT_TRUE(queue.pop());
+    EXPECT_EQ(2, created - destroyed);
+  }
+  EXPECT_EQ(created, destroyed);
+}
+
+TEST(NikolaevBoundedQueue, wait_free_parallel_usage) {
+  wait_free_queue queue(8);
+
+  static constexpr int num_threads = 4;
+  static constexpr int thread_mask = num_threads - 1;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([i, &queue] {
+      std::vector<int> last_seen(num_threads);
+      int counter = 0;
+      for (int j = 0; j < MaxIterations; ++j) {
+        EXPECT_TRUE(queue.try_push((++counter << 8) | i));
+        int elem = 0;
+        ASSERT_TRUE(queue.try_pop(elem));
+        int thread = elem & thread_mask;
+        elem >>= 8;
+        EXPECT_GT(elem, last_seen[thread]);
+        last_seen[thread] = elem;
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(NikolaevBoundedQueue, wait_free_parallel_usage_neither_loses_nor_duplicates_elements) {
+  // a small capacity and more threads than entries causes a lot of contention,
+  // so operations regularly have to fall back to the slow path
+  wait_free_queue queue(2);
+
+  constexpr int num_threads = 8;
+  constexpr int iterations = MaxIterations / 4;
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([i, &queue, &pushed_sum, &popped_sum] {
+      std::mt19937_64 rand;
+      rand.seed(i);
+      long long pushed = 0;
+      long long popped = 0;
+      for (int j = 0; j < iterations; ++j) {
+        if (rand() % 2 == 0) {
+          int value = j * num_threads + i + 1;
+          if (queue.try_push(value)) {
+            pushed += value;
+          }
+        } else {
+          int elem;
+          if (queue.try_pop(elem)) {
+            popped += elem;
+          }
+        }
+      }
+      pushed_sum += pushed;
+      popped_sum += popped;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int elem;
+  while (queue.try_pop(elem)) {
+    popped_sum += elem;
+  }
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
+TEST(NikolaevBoundedQueue, wait_free_parallel_usage_on_slow_path) {
+  // with a patience of one, every operation that fails its first fast path attempt (which
+  // happens regularly with this many threads on such a small queue) has to take the slow path
+  xenium::nikolaev_bounded_queue<int,
+                                 xenium::policy::wait_free<true>,
+                                 xenium::policy::enqueue_patience<1>,
+                                 xenium::policy::dequeue_patience<1>>
+    queue(8);
+
+  static constexpr int num_threads = 8;
+  static constexpr int thread_mask = num_threads - 1;
+  constexpr int iterations = MaxIterations / 4;
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([i, &queue, &pushed_sum, &popped_sum] {
+      std::vector<int> last_seen(num_threads);
+      long long pushed = 0;
+      long long popped = 0;
+      for (int j = 1; j <= iterations; ++j) {
+        int value = (j << 8) | i;
+        EXPECT_TRUE(queue.try_push(value));
+        pushed += value;
+        int elem = 0;
+        ASSERT_TRUE(queue.try_pop(elem));
+        popped += elem;
+        int thread = elem & thread_mask;
+        elem >>= 8;
+        EXPECT_GT(elem, last_seen[thread]);
+        last_seen[thread] = elem;
+      }
+      pushed_sum += pushed;
+      popped_sum += popped;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_FALSE(queue.pop());
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
+TEST(NikolaevBoundedQueue, wait_free_parallel_usage_mostly_empty) {
+  wait_free_queue queue(8);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([i, &queue] {
+      std::mt19937_64 rand;
+      rand.seed(i);
+
+      for (int j = 0; j < MaxIterations; ++j) {
+        if (rand() % 128 < 16) {
+          queue.try_push(i);
+        } else {
+          int elem;
+          if (queue.try_pop(elem)) {
+            EXPECT_TRUE(elem >= 0 && elem <= 4);
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(NikolaevBoundedQueue, try_push_fails_after_close) {
+  xenium::nikolaev_bounded_queue<int> queue(4);
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_FALSE(queue.is_closed());
+  queue.close();
+  EXPECT_TRUE(queue.is_closed());
+  EXPECT_FALSE(queue.try_push(2));
+  EXPECT_FALSE(queue.is_drained());
+  int elem = 0;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(NikolaevBoundedQueue, empty_queue_is_only_drained_once_it_is_closed) {
+  xenium::nikolaev_bounded_queue<int> queue(4);
+  EXPECT_FALSE(queue.is_drained());
+  queue.close();
+  EXPECT_TRUE(queue.is_drained());
+}
+
+TEST(NikolaevBoundedQueue, try_pop_batch_pops_up_to_max_elements_in_fifo_order) {
+  xenium::nikolaev_bounded_queue<int> queue(8);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  std::vector<int> result;
+  EXPECT_EQ(4u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(2u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(0u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5}), result);
+}
+
+TEST(NikolaevBoundedQueue, parallel_usage_with_close_neither_loses_nor_duplicates_elements) {
+  xenium::nikolaev_bounded_queue<int> queue(64);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 2;
+#ifdef DEBUG
+  constexpr int close_after = 5000;
+#else
+  constexpr int close_after = 50000;
+#endif
+  std::atomic<int> pushed{0};
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&queue, &pushed, &pushed_sum] {
+      for (int i = 1;; ++i) {
+        if (queue.try_push(i)) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+          pushed_sum.fetch_add(i, std::memory_order_relaxed);
+        } else if (queue.is_closed()) {
+          break;
+        }
+      }
+    });
+  }
+  for (int c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&queue, &popped_sum] {
+      std::vector<int> batch(8);
+      long long sum = 0;
+      for (;;) {
+        auto n = queue.try_pop_batch(batch.begin(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+          sum += batch[i];
+        }
+        if (n == 0 && queue.is_drained()) {
+          break;
+        }
+      }
+      popped_sum.fetch_add(sum, std::memory_order_relaxed);
+    });
+  }
+
+  while (pushed.load(std::memory_order_relaxed) < close_after) {
+    std::this_thread::yield();
+  }
+  queue.close();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
+TEST(NikolaevBoundedQueue, wait_free_parallel_usage_with_close_neither_loses_nor_duplicates_elements) {
+  xenium::nikolaev_bounded_queue<int, xenium::policy::wait_free<true>> queue(64);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 2;
+#ifdef DEBUG
+  constexpr int close_after = 5000;
+#else
+  constexpr int close_after = 50000;
+#endif
+  std::atomic<int> pushed{0};
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&queue, &pushed, &pushed_sum] {
+      for (int i = 1;; ++i) {
+        if (queue.try_push(i)) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+          pushed_sum.fetch_add(i, std::memory_order_relaxed);
+        } else if (queue.is_closed()) {
+          break;
+        }
+      }
+    });
+  }
+  for (int c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&queue, &popped_sum] {
+      std::vector<int> batch(8);
+      long long sum = 0;
+      for (;;) {
+        auto n = queue.try_pop_batch(batch.begin(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+          sum += batch[i];
+        }
+        if (n == 0 && queue.is_drained()) {
+          break;
+        }
+      }
+      popped_sum.fetch_add(sum, std::memory_order_relaxed);
+    });
+  }
+
+  while (pushed.load(std::memory_order_relaxed) < close_after) {
+    std::this_thread::yield();
+  }
+  queue.close();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
 } // namespace
\ No newline at end of file
@@ -2,12 +2,18 @@
 #include <xenium/reclamation/generic_epoch_based.hpp>
 #include <xenium/reclamation/hazard_eras.hpp>
 #include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
 #include <xenium/reclamation/lock_free_ref_count.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
 #include <xenium/reclamation/quiescent_state_based.hpp>
 #include <xenium/reclamation/stamp_it.hpp>
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <thread>
 #include <vector>
 
@@ -29,7 +35,12 @@ using Reclaimers =
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::quiescent_state_based,
-                   xenium::reclamation::stamp_it>;
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>>;
 TYPED_TEST_SUITE(RamalheteQueue, Reclaimers);
 
 TYPED_TEST(RamalheteQueue, push_try_pop_returns_pushed_element) {
@@ -87,6 +98,30 @@ TYPED_TEST(RamalheteQueue, supports_trivially_copyable_types_smaller_than_a_poin
   }
 }
 
+TYPED_TEST(RamalheteQueue, supports_trivially_copyable_types_of_up_to_16_bytes) {
+  struct descriptor {
+    std::uint64_t id;
+    std::uint32_t a;
+    std::uint16_t b;
+  };
+  // enough entries to span several nodes
+  constexpr std::uint64_t count = 2000;
+  xenium::ramalhete_queue<descriptor, xenium::policy::reclaimer<TypeParam>, xenium::policy::entries_per_node<16>> queue;
+  // zero is a valid value for inline entries
+  queue.push(descriptor{0, 0, 0});
+  for (std::uint64_t i = 1; i < count; ++i) {
+    queue.push(descriptor{i, static_cast<std::uint32_t>(i * 2), static_cast<std::uint16_t>(i % 100)});
+  }
+  for (std::uint64_t i = 0; i < count; ++i) {
+    auto elem = queue.pop();
+    ASSERT_TRUE(elem.has_value());
+    EXPECT_EQ(i, elem->id);
+    EXPECT_EQ(i * 2, elem->a);
+    EXPECT_EQ(i % 100, elem->b);
+  }
+  EXPECT_FALSE(queue.pop().has_value());
+}
+
 TYPED_TEST(RamalheteQueue, deletes_remaining_unique_ptr_entries) {
   unsigned delete_count = 0;
   struct dummy {
@@ -75,6 +75,28 @@ TEST_F(GenericEpochBased, reclaim_releases_ownership_and_the_object_gets_deleted
   EXPECT_EQ(nullptr, foo);
 }
 
+TEST_F(GenericEpochBased, nodes_in_a_retire_batch_are_not_retired_before_the_batch_is_destroyed) {
+  Foo* other = new Foo(&other);
+  {
+    Reclaimer::retire_batch batch;
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    concurrent_ptr<Foo>::guard_ptr gp2(other);
+    gp.reclaim(batch);
+    gp2.reclaim(batch);
+    this->mp = nullptr;
+    EXPECT_EQ(nullptr, gp.get());
+    EXPECT_EQ(nullptr, gp2.get());
+
+    wrap_around_epochs();
+    EXPECT_NE(nullptr, foo);
+    EXPECT_NE(nullptr, other);
+  }
+  EXPECT_NE(nullptr, foo);
+  wrap_around_epochs();
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, other);
+}
+
 struct WithCustomDeleter;
 struct DummyDeleter {
   bool* called;
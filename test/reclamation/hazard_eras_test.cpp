@@ -185,6 +185,32 @@ TYPED_TEST(HazardEras, object_cannot_be_reclaimed_as_long_as_another_guard_prote
   EXPECT_NE(nullptr, this->foo);
 }
 
+TYPED_TEST(HazardEras, nodes_in_a_retire_batch_are_reclaimed_after_the_batch_is_destroyed_unless_protected) {
+  using Foo = typename TestFixture::Foo;
+  using guard_ptr = typename TestFixture::template concurrent_ptr<Foo>::guard_ptr;
+  guard_ptr protector(this->mp);
+  // other is created after the era reserved by protector, so it is not protected
+  this->advance_era();
+  Foo* other = nullptr;
+  other = new Foo(&other);
+  {
+    typename TestFixture::HE::retire_batch batch;
+    guard_ptr gp(this->mp);
+    guard_ptr gp2(other);
+    gp.reclaim(batch);
+    gp2.reclaim(batch);
+    this->mp = nullptr;
+    EXPECT_EQ(nullptr, gp.get());
+    EXPECT_EQ(nullptr, gp2.get());
+    EXPECT_NE(nullptr, other);
+  }
+  EXPECT_EQ(nullptr, other);
+  EXPECT_NE(nullptr, this->foo);
+  protector.reset();
+  this->advance_era();
+  EXPECT_EQ(nullptr, this->foo);
+}
+
 TYPED_TEST(HazardEras, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
   using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
   guard_ptr gp(this->mp);
@@ -43,6 +43,20 @@ struct HazardPointer : ::testing::Test {
   };
   struct WithCustomDeleter : HP::template enable_concurrent_ptr<WithCustomDeleter, 2, DummyDeleter> {};
 
+  // static_strategy<2> has a node threshold of at least 100 (A * K * num_threads + B), so two retired nodes
+  // can only trigger a scan by exceeding the byte threshold
+  using BytesHP = typename HP::template with<
+    xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::static_strategy<2>>,
+    xenium::policy::retired_bytes_threshold<4096>>;
+
+  template <std::size_t Size>
+  struct SizedNode : BytesHP::template enable_concurrent_ptr<SizedNode<Size>> {
+    SizedNode** instance;
+    explicit SizedNode(SizedNode** instance) : instance(instance) {}
+    ~SizedNode() override { *instance = nullptr; }
+    [[nodiscard]] std::size_t allocation_size() const noexcept { return Size; }
+  };
+
   template <typename T>
   using concurrent_ptr = typename HP::template concurrent_ptr<T>;
   template <typename T>
@@ -176,6 +190,43 @@ TYPED_TEST(HazardPointer, object_cannot_be_reclaimed_as_long_as_another_guard_pr
   EXPECT_NE(nullptr, this->foo);
 }
 
+TYPED_TEST(HazardPointer, nodes_in_a_retire_batch_are_reclaimed_after_the_batch_is_destroyed) {
+  using Foo = typename TestFixture::Foo;
+  using guard_ptr = typename TestFixture::template concurrent_ptr<Foo>::guard_ptr;
+  Foo* other = new Foo(&other);
+  {
+    typename TestFixture::HP::retire_batch batch;
+    guard_ptr gp(this->mp);
+    guard_ptr gp2(other);
+    gp.reclaim(batch);
+    gp2.reclaim(batch);
+    this->mp = nullptr;
+    EXPECT_EQ(nullptr, gp.get());
+    EXPECT_EQ(nullptr, gp2.get());
+    EXPECT_NE(nullptr, this->foo);
+    EXPECT_NE(nullptr, other);
+  }
+  EXPECT_EQ(nullptr, this->foo);
+  EXPECT_EQ(nullptr, other);
+}
+
+TYPED_TEST(HazardPointer, scan_is_triggered_once_the_retired_nodes_exceed_the_byte_threshold) {
+  using Small = typename TestFixture::template SizedNode<64>;
+  using Large = typename TestFixture::template SizedNode<4096>;
+  using BytesHP = typename TestFixture::BytesHP;
+
+  Small* small = nullptr;
+  small = new Small(&small);
+  typename BytesHP::template concurrent_ptr<Small>::guard_ptr{small}.reclaim();
+  EXPECT_NE(nullptr, small);
+
+  Large* large = nullptr;
+  large = new Large(&large);
+  typename BytesHP::template concurrent_ptr<Large>::guard_ptr{large}.reclaim();
+  EXPECT_EQ(nullptr, small);
+  EXPECT_EQ(nullptr, large);
+}
+
 TYPED_TEST(HazardPointer, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
   using guard_ptr = typename TestFixture::template concurrent_ptr<typename TestFixture::Foo>::guard_ptr;
   guard_ptr gp(this->mp);
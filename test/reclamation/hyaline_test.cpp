@@ -0,0 +1,202 @@
+#include <xenium/reclamation/hyaline.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+// With a batch size of 1 every retired node is handed over immediately, so it gets reclaimed
+// as soon as the last thread that was active at that time leaves its critical region.
+using Reclaimer = xenium::reclamation::hyaline<>::with<xenium::policy::slots<4>, xenium::policy::batch_size<1>>;
+
+struct Foo : Reclaimer::enable_concurrent_ptr<Foo, 2> {
+  Foo** instance;
+  explicit Foo(Foo** instance) : instance(instance) {}
+  ~Foo() override {
+    if (instance != nullptr) {
+      *instance = nullptr;
+    }
+  }
+};
+
+template <typename T>
+using concurrent_ptr = Reclaimer::concurrent_ptr<T>;
+template <typename T>
+using marked_ptr = typename concurrent_ptr<T>::marked_ptr;
+
+struct Hyaline : testing::Test {
+  Foo* foo = new Foo(&foo);
+  marked_ptr<Foo> mp = marked_ptr<Foo>(foo, 3);
+
+  void TearDown() override {
+    if (mp == nullptr) {
+      assert(foo == nullptr);
+    } else {
+      delete foo;
+    }
+  }
+};
+
+TEST_F(Hyaline, mark_returns_the_same_mark_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.mark(), gp.mark());
+}
+
+TEST_F(Hyaline, get_returns_the_same_pointer_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.get(), gp.get());
+}
+
+TEST_F(Hyaline, reset_releases_ownership_and_sets_pointer_to_null) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reset();
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(Hyaline, reclaim_releases_ownership_and_the_object_gets_deleted_when_the_region_is_left) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(Hyaline, object_is_not_deleted_before_the_region_guard_is_destroyed) {
+  {
+    Reclaimer::region_guard rg{};
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+    this->mp = nullptr;
+    EXPECT_NE(nullptr, foo);
+  }
+  EXPECT_EQ(nullptr, foo);
+}
+
+struct WithCustomDeleter;
+struct DummyDeleter {
+  bool* called;
+  WithCustomDeleter* reference;
+  void operator()(WithCustomDeleter* obj) const;
+};
+struct WithCustomDeleter : Reclaimer::enable_concurrent_ptr<WithCustomDeleter, 2, DummyDeleter> {};
+
+void DummyDeleter::operator()(WithCustomDeleter* obj) const {
+  *called = true;
+  EXPECT_EQ(reference, obj);
+  delete obj;
+}
+
+TEST_F(Hyaline, supports_custom_deleters) {
+  bool called = false;
+  concurrent_ptr<WithCustomDeleter>::guard_ptr gp(new WithCustomDeleter());
+  gp.reclaim(DummyDeleter{&called, gp.get()});
+  EXPECT_TRUE(called);
+}
+
+TEST_F(Hyaline, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+  gp2.reset();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Hyaline, object_cannot_be_reclaimed_as_long_as_another_thread_is_in_a_critical_region) {
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    Reclaimer::region_guard rg{};
+    state.store(1);
+    while (state.load() != 2) {
+    }
+  });
+  while (state.load() != 1) {
+  }
+
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+
+  state.store(2);
+  t.join();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Hyaline, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(gp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(Hyaline, move_constructor_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(std::move(gp));
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Hyaline, copy_assignment_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = gp;
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(Hyaline, move_assignment_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = std::move(gp);
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Hyaline, nodes_are_reclaimed_when_threads_share_slots) {
+  using BatchedReclaimer = xenium::reclamation::hyaline<>::with<xenium::policy::slots<2>, xenium::policy::batch_size<8>>;
+  struct Node : BatchedReclaimer::enable_concurrent_ptr<Node> {
+    explicit Node(std::atomic<int>& counter) : counter(counter) { ++counter; }
+    ~Node() override { --counter; }
+    std::atomic<int>& counter;
+  };
+
+  std::atomic<int> live_nodes{0};
+  BatchedReclaimer::concurrent_ptr<Node> shared;
+  shared.store(new Node(live_nodes));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&shared, &live_nodes] {
+      for (int j = 0; j < 1000; ++j) {
+        typename BatchedReclaimer::concurrent_ptr<Node>::guard_ptr gp;
+        gp.acquire(shared);
+        auto* replacement = new Node(live_nodes);
+        typename BatchedReclaimer::concurrent_ptr<Node>::marked_ptr expected = gp.get();
+        if (shared.compare_exchange_strong(expected, replacement)) {
+          gp.reclaim();
+        } else {
+          delete replacement;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // all terminated threads have handed over their remaining nodes, and since no thread
+  // is active anymore, everything except the current node must have been reclaimed.
+  EXPECT_EQ(1, live_nodes.load());
+  delete shared.load().get();
+}
+} // namespace
@@ -0,0 +1,274 @@
+#include <xenium/reclamation/interval_based.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// With a scan threshold of 1 every reclaim call scans the reservations of all threads,
+// so nodes are reclaimed as soon as they are no longer protected.
+using Reclaimer = xenium::reclamation::interval_based<>::with<xenium::policy::scan_threshold<1>>;
+
+struct Foo : Reclaimer::enable_concurrent_ptr<Foo, 2> {
+  Foo** instance;
+  explicit Foo(Foo** instance) : instance(instance) {}
+  ~Foo() override {
+    if (instance != nullptr) {
+      *instance = nullptr;
+    }
+  }
+};
+
+template <typename T>
+using concurrent_ptr = Reclaimer::concurrent_ptr<T>;
+template <typename T>
+using marked_ptr = typename concurrent_ptr<T>::marked_ptr;
+
+struct IntervalBased : testing::Test {
+  Foo* foo = new Foo(&foo);
+  marked_ptr<Foo> mp = marked_ptr<Foo>(foo, 3);
+
+  void TearDown() override {
+    // There might be some retired nodes remaining from a testcase that need to be reclaimed.
+    // Retiring a dummy object triggers a scan which reclaims all the objects in the retire list.
+    retire_dummy();
+    if (mp == nullptr) {
+      assert(foo == nullptr);
+    } else {
+      delete foo;
+    }
+  }
+
+  // Retiring an object advances the global era and triggers a scan.
+  static void retire_dummy() {
+    concurrent_ptr<Foo>::guard_ptr gp(new Foo(nullptr));
+    gp.reclaim();
+  }
+};
+
+TEST_F(IntervalBased, mark_returns_the_same_mark_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.mark(), gp.mark());
+}
+
+TEST_F(IntervalBased, get_returns_the_same_pointer_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.get(), gp.get());
+}
+
+TEST_F(IntervalBased, acquire_guard_acquires_pointer) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp = xenium::acquire_guard(foo_ptr);
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(IntervalBased, acquire_if_equal_returns_true_and_acquires_pointer_when_values_are_equal) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp;
+  EXPECT_TRUE(gp.acquire_if_equal(foo_ptr, mp));
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(IntervalBased, acquire_if_equal_returns_false_and_resets_guard_when_values_are_not_equal) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp;
+  Foo* other = new Foo(&other);
+  std::unique_ptr<Foo> other_ptr(other);
+  EXPECT_FALSE(gp.acquire_if_equal(foo_ptr, other));
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(IntervalBased, reset_releases_ownership_and_sets_pointer_to_null) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reset();
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(IntervalBased, reclaim_releases_ownership_and_deletes_object_if_no_other_thread_protects_it) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(IntervalBased, object_is_not_deleted_before_the_region_guard_is_destroyed) {
+  {
+    Reclaimer::region_guard rg{};
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    gp.reclaim();
+    this->mp = nullptr;
+    EXPECT_NE(nullptr, foo);
+  }
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(IntervalBased, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+  gp2.reset();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(IntervalBased, nodes_in_a_retire_batch_are_reclaimed_after_the_batch_is_destroyed) {
+  Foo* other = new Foo(&other);
+  {
+    Reclaimer::retire_batch batch;
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    concurrent_ptr<Foo>::guard_ptr gp2(other);
+    gp.reclaim(batch);
+    gp2.reclaim(batch);
+    this->mp = nullptr;
+    EXPECT_EQ(nullptr, gp.get());
+    EXPECT_EQ(nullptr, gp2.get());
+    EXPECT_NE(nullptr, foo);
+    EXPECT_NE(nullptr, other);
+  }
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, other);
+}
+
+TEST_F(IntervalBased, batched_object_cannot_be_reclaimed_while_the_region_guard_is_alive) {
+  {
+    Reclaimer::region_guard rg{};
+    {
+      Reclaimer::retire_batch batch;
+      concurrent_ptr<Foo>::guard_ptr gp(mp);
+      gp.reclaim(batch);
+      this->mp = nullptr;
+    }
+    EXPECT_NE(nullptr, foo);
+  }
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+struct WithCustomDeleter;
+struct DummyDeleter {
+  bool* called;
+  WithCustomDeleter* reference;
+  void operator()(WithCustomDeleter* obj) const;
+};
+struct WithCustomDeleter : Reclaimer::enable_concurrent_ptr<WithCustomDeleter, 2, DummyDeleter> {};
+
+void DummyDeleter::operator()(WithCustomDeleter* obj) const {
+  *called = true;
+  EXPECT_EQ(reference, obj);
+  delete obj;
+}
+
+TEST_F(IntervalBased, supports_custom_deleters) {
+  bool called = false;
+  concurrent_ptr<WithCustomDeleter>::guard_ptr gp(new WithCustomDeleter());
+  gp.reclaim(DummyDeleter{&called, gp.get()});
+  EXPECT_TRUE(called);
+}
+
+TEST_F(IntervalBased, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(gp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(IntervalBased, move_constructor_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(std::move(gp));
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(IntervalBased, copy_assignment_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = gp;
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(IntervalBased, move_assignment_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = std::move(gp);
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(IntervalBased, object_cannot_be_reclaimed_while_its_lifetime_overlaps_the_interval_of_another_thread) {
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    Reclaimer::region_guard rg{};
+    state.store(1);
+    while (state.load() != 2) {
+    }
+  });
+  while (state.load() != 1) {
+  }
+
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+
+  state.store(2);
+  t.join();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(IntervalBased, object_created_after_the_interval_of_another_thread_can_be_reclaimed) {
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    Reclaimer::region_guard rg{};
+    state.store(1);
+    while (state.load() != 2) {
+    }
+  });
+  while (state.load() != 1) {
+  }
+
+  // advance the era so the new object is created after the other thread's reservation
+  retire_dummy();
+  Foo* obj = nullptr;
+  obj = new Foo(&obj);
+  concurrent_ptr<Foo>::guard_ptr gp(obj);
+  gp.reclaim();
+  EXPECT_EQ(nullptr, obj);
+
+  state.store(2);
+  t.join();
+}
+
+TEST_F(IntervalBased, a_single_thread_can_protect_an_unbounded_number_of_objects) {
+  constexpr int number_of_objects = 1000;
+  std::vector<concurrent_ptr<Foo>> ptrs(number_of_objects);
+  for (auto& p : ptrs) {
+    p.store(new Foo(nullptr));
+    retire_dummy();
+  }
+
+  std::vector<concurrent_ptr<Foo>::guard_ptr> guards(number_of_objects);
+  for (int i = 0; i < number_of_objects; ++i) {
+    guards[i].acquire(ptrs[i]);
+    EXPECT_EQ(ptrs[i].load(), guards[i]);
+  }
+
+  for (auto& g : guards) {
+    g.reclaim();
+  }
+}
+} // namespace
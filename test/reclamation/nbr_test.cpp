@@ -0,0 +1,358 @@
+#ifdef __linux__
+
+  #include <xenium/reclamation/nbr.hpp>
+
+  #include <gtest/gtest.h>
+
+  #include <pthread.h>
+
+  #include <atomic>
+  #include <chrono>
+  #include <csignal>
+  #include <thread>
+  #include <vector>
+
+namespace {
+
+// With a scan threshold of 1 every reclaim call pings the other threads and scans their
+// reservations. Nodes are reclaimed as soon as they are no longer protected, unless some
+// other thread has yet to acknowledge its ping; in that case a later scan reclaims them.
+using Reclaimer = xenium::reclamation::nbr<>::with<xenium::policy::scan_threshold<1>>;
+using SecondReclaimer =
+  xenium::reclamation::nbr<>::with<xenium::policy::scan_threshold<1>, xenium::policy::ping_signal<SIGUSR2>>;
+
+struct Foo : Reclaimer::enable_concurrent_ptr<Foo, 2> {
+  Foo** instance;
+  explicit Foo(Foo** instance) : instance(instance) {}
+  ~Foo() override {
+    if (instance != nullptr) {
+      *instance = nullptr;
+    }
+  }
+};
+
+struct Bar : SecondReclaimer::enable_concurrent_ptr<Bar> {
+  Bar** instance;
+  explicit Bar(Bar** instance) : instance(instance) {}
+  ~Bar() override {
+    if (instance != nullptr) {
+      *instance = nullptr;
+    }
+  }
+};
+
+template <typename T>
+using concurrent_ptr = Reclaimer::concurrent_ptr<T>;
+template <typename T>
+using marked_ptr = typename concurrent_ptr<T>::marked_ptr;
+
+struct Nbr : testing::Test {
+  Foo* foo = new Foo(&foo);
+  marked_ptr<Foo> mp = marked_ptr<Foo>(foo, 3);
+
+  void TearDown() override {
+    // There might be some retired nodes remaining from a testcase that need to be reclaimed.
+    // Retiring a dummy object triggers a scan which reclaims all the objects in the retire list.
+    retire_dummy();
+    if (mp == nullptr) {
+      assert(foo == nullptr);
+    } else {
+      delete foo;
+    }
+  }
+
+  static void retire_dummy() {
+    concurrent_ptr<Foo>::guard_ptr gp(new Foo(nullptr));
+    gp.reclaim();
+  }
+
+  // Retires dummy objects until foo has been reclaimed, giving other threads time to acknowledge their pings.
+  void retire_dummies_until_foo_is_reclaimed() {
+    for (int i = 0; i < 1000 && foo != nullptr; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      retire_dummy();
+    }
+  }
+};
+
+TEST_F(Nbr, mark_returns_the_same_mark_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.mark(), gp.mark());
+}
+
+TEST_F(Nbr, get_returns_the_same_pointer_as_the_original_marked_ptr) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  EXPECT_EQ(mp.get(), gp.get());
+}
+
+TEST_F(Nbr, acquire_guard_acquires_pointer) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp = xenium::acquire_guard(foo_ptr);
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(Nbr, acquire_if_equal_returns_true_and_acquires_pointer_when_values_are_equal) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp;
+  EXPECT_TRUE(gp.acquire_if_equal(foo_ptr, mp));
+  EXPECT_EQ(mp, gp);
+}
+
+TEST_F(Nbr, acquire_if_equal_returns_false_and_resets_guard_when_values_are_not_equal) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  concurrent_ptr<Foo>::guard_ptr gp;
+  Foo* other = new Foo(&other);
+  std::unique_ptr<Foo> other_ptr(other);
+  EXPECT_FALSE(gp.acquire_if_equal(foo_ptr, other));
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(Nbr, reset_releases_ownership_and_sets_pointer_to_null) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reset();
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(Nbr, reclaim_releases_ownership_and_deletes_object_if_no_other_thread_protects_it) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, gp.get());
+}
+
+TEST_F(Nbr, region_guard_does_not_protect_objects_that_are_not_guarded) {
+  Reclaimer::region_guard rg{};
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, object_cannot_be_reclaimed_as_long_as_another_guard_protects_it) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+  gp2.reset();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, nodes_in_a_retire_batch_are_reclaimed_after_the_batch_is_destroyed_unless_protected) {
+  Foo* other = new Foo(&other);
+  concurrent_ptr<Foo>::guard_ptr protector(mp);
+  {
+    Reclaimer::retire_batch batch;
+    concurrent_ptr<Foo>::guard_ptr gp(mp);
+    concurrent_ptr<Foo>::guard_ptr gp2(other);
+    gp.reclaim(batch);
+    gp2.reclaim(batch);
+    this->mp = nullptr;
+    EXPECT_EQ(nullptr, gp.get());
+    EXPECT_EQ(nullptr, gp2.get());
+    EXPECT_NE(nullptr, other);
+  }
+  EXPECT_EQ(nullptr, other);
+  EXPECT_NE(nullptr, foo);
+  protector.reset();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+struct WithCustomDeleter;
+struct DummyDeleter {
+  bool* called;
+  WithCustomDeleter* reference;
+  void operator()(WithCustomDeleter* obj) const;
+};
+struct WithCustomDeleter : Reclaimer::enable_concurrent_ptr<WithCustomDeleter, 2, DummyDeleter> {};
+
+void DummyDeleter::operator()(WithCustomDeleter* obj) const {
+  *called = true;
+  EXPECT_EQ(reference, obj);
+  delete obj;
+}
+
+TEST_F(Nbr, supports_custom_deleters) {
+  bool called = false;
+  concurrent_ptr<WithCustomDeleter>::guard_ptr gp(new WithCustomDeleter());
+  gp.reclaim(DummyDeleter{&called, gp.get()});
+  EXPECT_TRUE(called);
+}
+
+TEST_F(Nbr, copy_constructor_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(gp);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(Nbr, move_constructor_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2(std::move(gp));
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, copy_assignment_leads_to_shared_ownership_preventing_the_object_from_beeing_reclaimed) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = gp;
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+}
+
+TEST_F(Nbr, move_assignment_moves_ownership_and_resets_source_object) {
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  concurrent_ptr<Foo>::guard_ptr gp2{};
+  gp2 = std::move(gp);
+  gp2.reclaim();
+  this->mp = nullptr;
+  EXPECT_EQ(nullptr, gp.get()); // NOLINT (use-after-move)
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, object_cannot_be_reclaimed_as_long_as_a_guard_of_another_thread_protects_it) {
+  concurrent_ptr<Foo> foo_ptr(mp);
+  std::atomic<int> state{0};
+  std::thread t([&] {
+    concurrent_ptr<Foo>::guard_ptr gp = xenium::acquire_guard(foo_ptr);
+    state.store(1);
+    while (state.load() != 2) {
+      std::this_thread::yield();
+    }
+  });
+  while (state.load() != 1) {
+    std::this_thread::yield();
+  }
+
+  concurrent_ptr<Foo>::guard_ptr gp = xenium::acquire_guard(foo_ptr);
+  foo_ptr.store(nullptr);
+  gp.reclaim();
+  this->mp = nullptr;
+  EXPECT_NE(nullptr, foo);
+
+  state.store(2);
+  t.join();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, thread_inside_a_critical_region_does_not_prevent_reclamation_of_objects_it_does_not_protect) {
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    Reclaimer::region_guard rg{};
+    state.store(1);
+    while (state.load() != 2) {
+      std::this_thread::yield();
+    }
+  });
+  while (state.load() != 1) {
+    std::this_thread::yield();
+  }
+
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  retire_dummies_until_foo_is_reclaimed();
+  EXPECT_EQ(nullptr, foo);
+
+  state.store(2);
+  t.join();
+}
+
+TEST_F(Nbr, scan_does_not_wait_for_a_thread_that_has_not_acknowledged_its_ping) {
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    {
+      Reclaimer::region_guard rg{};
+      state.store(1);
+      while (state.load() != 2) {
+        std::this_thread::yield();
+      }
+    }
+    pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+  });
+  while (state.load() != 1) {
+    std::this_thread::yield();
+  }
+
+  // The thread cannot acknowledge the ping while it blocks the signal, so foo must
+  // be kept, but neither of the scans may wait for the thread.
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  retire_dummy();
+  EXPECT_NE(nullptr, foo);
+
+  state.store(2);
+  t.join();
+  retire_dummy();
+  EXPECT_EQ(nullptr, foo);
+}
+
+TEST_F(Nbr, instantiations_with_different_ping_signals_can_be_used_in_the_same_thread) {
+  Bar* bar = new Bar(&bar);
+  std::atomic<int> state{0};
+  std::thread t([&state] {
+    Reclaimer::region_guard rg{};
+    SecondReclaimer::region_guard rg2{};
+    state.store(1);
+    while (state.load() != 2) {
+      std::this_thread::yield();
+    }
+  });
+  while (state.load() != 1) {
+    std::this_thread::yield();
+  }
+
+  // The thread is pinged with both signals, and each ping has to be acknowledged
+  // by the handler of the respective signal.
+  SecondReclaimer::concurrent_ptr<Bar>::guard_ptr bar_guard(bar);
+  bar_guard.reclaim();
+  concurrent_ptr<Foo>::guard_ptr gp(mp);
+  gp.reclaim();
+  this->mp = nullptr;
+  for (int i = 0; i < 1000 && (foo != nullptr || bar != nullptr); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    retire_dummy();
+    SecondReclaimer::concurrent_ptr<Bar>::guard_ptr dummy(new Bar(nullptr));
+    dummy.reclaim();
+  }
+  EXPECT_EQ(nullptr, foo);
+  EXPECT_EQ(nullptr, bar);
+
+  state.store(2);
+  t.join();
+}
+
+TEST_F(Nbr, a_single_thread_can_protect_an_unbounded_number_of_objects) {
+  constexpr int number_of_objects = 1000;
+  std::vector<concurrent_ptr<Foo>> ptrs(number_of_objects);
+  for (auto& p : ptrs) {
+    p.store(new Foo(nullptr));
+  }
+
+  std::vector<concurrent_ptr<Foo>::guard_ptr> guards(number_of_objects);
+  for (int i = 0; i < number_of_objects; ++i) {
+    guards[i].acquire(ptrs[i]);
+    EXPECT_EQ(ptrs[i].load(), guards[i]);
+  }
+
+  for (auto& g : guards) {
+    g.reclaim();
+  }
+}
+} // namespace
+
+#endif
@@ -12,7 +12,12 @@
   #include <xenium/reclamation/generic_epoch_based.hpp>
   #include <xenium/reclamation/hazard_eras.hpp>
   #include <xenium/reclamation/hazard_pointer.hpp>
+  #include <xenium/reclamation/hyaline.hpp>
+  #include <xenium/reclamation/interval_based.hpp>
   #include <xenium/reclamation/lock_free_ref_count.hpp>
+  #ifdef __linux__
+    #include <xenium/reclamation/nbr.hpp>
+  #endif
   #include <xenium/reclamation/quiescent_state_based.hpp>
   #include <xenium/reclamation/stamp_it.hpp>
 
@@ -36,7 +41,12 @@ using Reclaimers =
                    xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<1>>,
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<1>>,
                    xenium::reclamation::quiescent_state_based,
-                   xenium::reclamation::stamp_it>;
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+  #ifdef __linux__
+                   xenium::reclamation::nbr<>::with<xenium::policy::scan_threshold<1>>,
+  #endif
+                   xenium::reclamation::interval_based<>>;
 TYPED_TEST_SUITE(Sanitize, Reclaimers);
 
   #ifdef DEBUG
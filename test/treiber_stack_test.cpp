@@ -0,0 +1,174 @@
+#include <xenium/reclamation/generic_epoch_based.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+#include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#include <xenium/reclamation/lock_free_ref_count.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
+#include <xenium/reclamation/quiescent_state_based.hpp>
+#include <xenium/reclamation/stamp_it.hpp>
+#include <xenium/treiber_stack.hpp>
+
+#include "helpers.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Reclaimer>
+struct TreiberStack : testing::Test {};
+
+using Reclaimers =
+  ::testing::Types<xenium::reclamation::lock_free_ref_count<>,
+                   xenium::reclamation::hazard_pointer<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::hp_allocation::static_strategy<2>>>,
+                   xenium::reclamation::hazard_eras<>::with<
+                     xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<2>>>,
+                   xenium::reclamation::quiescent_state_based,
+                   xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
+                   xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
+                   xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
+TYPED_TEST_SUITE(TreiberStack, Reclaimers);
+
+TYPED_TEST(TreiberStack, try_pop_from_empty_stack) {
+  xenium::treiber_stack<int, xenium::policy::reclaimer<TypeParam>> stack;
+  int elem = 0;
+  ASSERT_FALSE(stack.try_pop(elem));
+}
+
+TYPED_TEST(TreiberStack, pop_from_empty_stack) {
+  xenium::treiber_stack<int, xenium::policy::reclaimer<TypeParam>> stack;
+  auto elem = stack.pop();
+  ASSERT_FALSE(elem.has_value());
+}
+
+TYPED_TEST(TreiberStack, push_try_pop_returns_pushed_element) {
+  xenium::treiber_stack<int, xenium::policy::reclaimer<TypeParam>> stack;
+  stack.push(42);
+  int elem = 0;
+  ASSERT_TRUE(stack.try_pop(elem));
+  EXPECT_EQ(42, elem);
+}
+
+TYPED_TEST(TreiberStack, push_two_items_pop_them_in_LIFO_order) {
+  xenium::treiber_stack<int, xenium::policy::reclaimer<TypeParam>> stack;
+  stack.push(42);
+  stack.push(43);
+  auto elem1 = stack.pop();
+  auto elem2 = stack.pop();
+  EXPECT_TRUE(elem1.has_value());
+  EXPECT_TRUE(elem2.has_value());
+  EXPECT_EQ(43, *elem1);
+  EXPECT_EQ(42, *elem2);
+}
+
+TYPED_TEST(TreiberStack, supports_move_only_types) {
+  xenium::treiber_stack<std::unique_ptr<int>, xenium::policy::reclaimer<TypeParam>> stack;
+  stack.push(std::make_unique<int>(42));
+
+  std::unique_ptr<int> elem;
+  ASSERT_TRUE(stack.try_pop(elem));
+  ASSERT_NE(nullptr, elem);
+  EXPECT_EQ(42, *elem);
+}
+
+TYPED_TEST(TreiberStack, supports_non_default_constructible_types) {
+  xenium::treiber_stack<xenium::test::non_default_constructible, xenium::policy::reclaimer<TypeParam>> stack;
+  stack.push(xenium::test::non_default_constructible(42));
+
+  auto elem = stack.pop();
+  ASSERT_TRUE(elem.has_value());
+  EXPECT_EQ(42, elem->value);
+}
+
+TYPED_TEST(TreiberStack, correctly_destroys_stored_objects) {
+  int created = 0;
+  int destroyed = 0;
+  struct Counting {
+    Counting(int& created, int& destroyed) : created(created), destroyed(destroyed) { ++created; }
+    Counting(const Counting& r) noexcept : created(r.created), destroyed(r.destroyed) { ++created; }
+    ~Counting() { ++destroyed; }
+    int& created;
+    int& destroyed;
+  };
+  {
+    xenium::treiber_stack<Counting, xenium::policy::reclaimer<TypeParam>> stack;
+    stack.push({created, destroyed});
+    stack.push({created, destroyed});
+    stack.push({created, destroyed});
+    stack.push({created, destroyed});
+
+    EXPECT_TRUE(stack.pop());
+    EXPECT_TRUE(stack.pop());
+    EXPECT_EQ(2, created - destroyed);
+  }
+  EXPECT_EQ(0, created - destroyed);
+}
+
+template <class Stack>
+void run_parallel_push_pop(Stack& stack) {
+  using Reclaimer = typename Stack::reclaimer;
+  constexpr int num_threads = 8;
+#ifdef DEBUG
+  constexpr int MaxIterations = 1000;
+#else
+  constexpr int MaxIterations = 10000;
+#endif
+  std::atomic<long long> pushed{0};
+  std::atomic<long long> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([i, &stack, &pushed, &popped] {
+      long long push_sum = 0;
+      long long pop_sum = 0;
+      for (int j = 0; j < MaxIterations; ++j) {
+        [[maybe_unused]] typename Reclaimer::region_guard guard{};
+        int v = i * MaxIterations + j + 1;
+        stack.push(v);
+        push_sum += v;
+        if (stack.try_pop(v)) {
+          pop_sum += v;
+        }
+      }
+      pushed += push_sum;
+      popped += pop_sum;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  while (auto v = stack.pop()) {
+    popped += *v;
+  }
+  EXPECT_EQ(pushed.load(), popped.load());
+}
+
+TYPED_TEST(TreiberStack, parallel_usage) {
+  xenium::treiber_stack<int, xenium::policy::reclaimer<TypeParam>> stack;
+  run_parallel_push_pop(stack);
+}
+
+TYPED_TEST(TreiberStack, parallel_usage_with_elimination) {
+  xenium::treiber_stack<int,
+                        xenium::policy::reclaimer<TypeParam>,
+                        xenium::policy::elimination_slots<4>,
+                        xenium::policy::elimination_spins<64>>
+    stack;
+  run_parallel_push_pop(stack);
+}
+} // namespace
@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <iterator>
 #include <thread>
 #include <vector>
 
@@ -184,4 +186,108 @@ TEST(VyukovBoundedQueue, parallel_usage_of_weak_operations) {
   }
 }
 
+TEST(VyukovBoundedQueue, try_push_fails_after_close) {
+  xenium::vyukov_bounded_queue<int> queue(4);
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_FALSE(queue.is_closed());
+  queue.close();
+  EXPECT_TRUE(queue.is_closed());
+  EXPECT_FALSE(queue.try_push(2));
+  EXPECT_FALSE(queue.try_push_weak(2));
+  EXPECT_FALSE(queue.is_drained());
+  int elem = 0;
+  EXPECT_TRUE(queue.try_pop(elem));
+  EXPECT_EQ(1, elem);
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_FALSE(queue.try_pop(elem));
+}
+
+TEST(VyukovBoundedQueue, empty_queue_is_only_drained_once_it_is_closed) {
+  xenium::vyukov_bounded_queue<int> queue(4);
+  EXPECT_FALSE(queue.is_drained());
+  queue.close();
+  EXPECT_TRUE(queue.is_drained());
+}
+
+TEST(VyukovBoundedQueue, try_pop_batch_pops_up_to_max_elements_in_fifo_order) {
+  xenium::vyukov_bounded_queue<int> queue(8);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  std::vector<int> result;
+  EXPECT_EQ(4u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(2u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ(0u, queue.try_pop_batch(std::back_inserter(result), 4));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5}), result);
+}
+
+TEST(VyukovBoundedQueue, try_pop_batch_wraps_around_the_end_of_the_buffer) {
+  xenium::vyukov_bounded_queue<int> queue(4);
+  std::vector<int> result;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_EQ(3u, queue.try_pop_batch(std::back_inserter(result), 10));
+  for (int i = 3; i < 7; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_EQ(4u, queue.try_pop_batch(std::back_inserter(result), 10));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6}), result);
+}
+
+TEST(VyukovBoundedQueue, parallel_usage_with_close_neither_loses_nor_duplicates_elements) {
+  xenium::vyukov_bounded_queue<int> queue(64);
+  constexpr int num_producers = 4;
+  constexpr int num_consumers = 2;
+#ifdef DEBUG
+  constexpr int close_after = 5000;
+#else
+  constexpr int close_after = 50000;
+#endif
+  std::atomic<int> pushed{0};
+  std::atomic<long long> pushed_sum{0};
+  std::atomic<long long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&queue, &pushed, &pushed_sum] {
+      for (int i = 1;; ++i) {
+        if (queue.try_push(i)) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+          pushed_sum.fetch_add(i, std::memory_order_relaxed);
+        } else if (queue.is_closed()) {
+          break;
+        }
+      }
+    });
+  }
+  for (int c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&queue, &popped_sum] {
+      std::vector<int> batch(8);
+      long long sum = 0;
+      for (;;) {
+        auto n = queue.try_pop_batch(batch.begin(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+          sum += batch[i];
+        }
+        if (n == 0 && queue.is_drained()) {
+          break;
+        }
+      }
+      popped_sum.fetch_add(sum, std::memory_order_relaxed);
+    });
+  }
+
+  while (pushed.load(std::memory_order_relaxed) < close_after) {
+    std::this_thread::yield();
+  }
+  queue.close();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(queue.is_drained());
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
 } // namespace
\ No newline at end of file
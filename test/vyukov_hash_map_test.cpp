@@ -1,6 +1,11 @@
 #include <xenium/reclamation/generic_epoch_based.hpp>
 #include <xenium/reclamation/hazard_eras.hpp>
 #include <xenium/reclamation/hazard_pointer.hpp>
+#include <xenium/reclamation/hyaline.hpp>
+#include <xenium/reclamation/interval_based.hpp>
+#ifdef __linux__
+  #include <xenium/reclamation/nbr.hpp>
+#endif
 #include <xenium/reclamation/quiescent_state_based.hpp>
 #include <xenium/reclamation/stamp_it.hpp>
 #include <xenium/vyukov_hash_map.hpp>
@@ -48,6 +53,11 @@ using Reclaimers =
                      xenium::policy::allocation_strategy<xenium::reclamation::he_allocation::static_strategy<3>>>,
                    xenium::reclamation::quiescent_state_based,
                    xenium::reclamation::stamp_it,
+                   xenium::reclamation::hyaline<>,
+#ifdef __linux__
+                   xenium::reclamation::nbr<>,
+#endif
+                   xenium::reclamation::interval_based<>,
                    xenium::reclamation::epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::new_epoch_based<>::with<xenium::policy::scan_frequency<10>>,
                    xenium::reclamation::debra<>::with<xenium::policy::scan_frequency<10>>>;
@@ -155,6 +165,56 @@ TYPED_TEST(VyukovHashMap, map_grows_if_needed) {
   }
 }
 
+TYPED_TEST(VyukovHashMap, shrink_to_fit_keeps_remaining_entries) {
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(this->map.emplace(i, i));
+  }
+  for (int i = 0; i < 10000; ++i) {
+    if (i % 100 != 0) {
+      EXPECT_TRUE(this->map.erase(i));
+    }
+  }
+  EXPECT_TRUE(this->map.shrink_to_fit());
+  for (int i = 0; i < 10000; ++i) {
+    typename VyukovHashMap<TypeParam>::hash_map::accessor acc;
+    ASSERT_EQ(i % 100 == 0, this->map.try_get_value(i, acc)) << i;
+    if (i % 100 == 0) {
+      EXPECT_EQ(i, *acc);
+    }
+  }
+  EXPECT_FALSE(this->map.shrink_to_fit());
+  EXPECT_TRUE(this->map.emplace(1, 1));
+}
+
+TYPED_TEST(VyukovHashMap, shrink_to_fit_does_not_shrink_below_initial_capacity) {
+  typename VyukovHashMap<TypeParam>::hash_map map(1024);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(map.emplace(i, i));
+  }
+  EXPECT_FALSE(map.shrink_to_fit());
+}
+
+TYPED_TEST(VyukovHashMap, map_shrinks_automatically_if_load_factor_drops_below_threshold) {
+  using hash_map = xenium::vyukov_hash_map<int,
+                                           std::string,
+                                           xenium::policy::reclaimer<TypeParam>,
+                                           xenium::policy::shrink_threshold<25>>;
+  hash_map map(8);
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(map.emplace(i, std::to_string(i)));
+  }
+  for (int i = 0; i < 9990; ++i) {
+    EXPECT_TRUE(map.erase(i));
+  }
+  // the map has already been shrunk during erase, so there is nothing left to shrink
+  EXPECT_FALSE(map.shrink_to_fit());
+  for (int i = 9990; i < 10000; ++i) {
+    typename hash_map::accessor acc;
+    ASSERT_TRUE(map.try_get_value(i, acc)) << i;
+    EXPECT_EQ(std::to_string(i), *acc);
+  }
+}
+
 TYPED_TEST(VyukovHashMap, with_managed_pointer_value) {
   struct node : TypeParam::template enable_concurrent_ptr<node> {
     explicit node(int v) : v(v) {}
@@ -261,6 +321,32 @@ TYPED_TEST(VyukovHashMap, with_string_key) {
   EXPECT_EQ(43, *acc);
 }
 
+TYPED_TEST(VyukovHashMap, string_key_supports_heterogeneous_lookup_with_string_view) {
+  using hash_map = xenium::vyukov_hash_map<std::string, int, xenium::policy::reclaimer<TypeParam>>;
+  hash_map map(8);
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(map.emplace(std::to_string(i), i));
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    std::string key = std::to_string(i);
+    std::string_view k = key;
+    EXPECT_TRUE(map.contains(k));
+    typename hash_map::accessor acc;
+    ASSERT_TRUE(map.try_get_value(k, acc));
+    EXPECT_EQ(i, *acc);
+    auto it = map.find(k);
+    ASSERT_NE(map.end(), it);
+    EXPECT_EQ(key, it->first);
+  }
+
+  EXPECT_FALSE(map.contains(std::string_view("foo")));
+  EXPECT_EQ(map.end(), map.find(std::string_view("foo")));
+  EXPECT_TRUE(map.erase(std::string_view("42")));
+  EXPECT_FALSE(map.erase(std::string_view("42")));
+  EXPECT_FALSE(map.contains(std::string("42")));
+}
+
 TYPED_TEST(VyukovHashMap, with_string_key_and_managed_ptr_value) {
   struct node : TypeParam::template enable_concurrent_ptr<node> {
     explicit node(int v) : v(v) {}
@@ -344,6 +430,40 @@ TYPED_TEST(VyukovHashMap, correctly_handles_hash_collisions_of_nontrivial_keys)
   EXPECT_EQ(42, *acc);
 }
 
+TYPED_TEST(VyukovHashMap, correctly_handles_long_extension_chains) {
+  // all keys end up in the same bucket, so most of them are stored in extension items
+  struct bad_hash {
+    bad_hash() = default;
+    std::size_t operator()(int v) { return static_cast<std::size_t>((v % 7) << 10); }
+  };
+  using hash_map =
+    xenium::vyukov_hash_map<int, int, xenium::policy::reclaimer<TypeParam>, xenium::policy::hash<bad_hash>>;
+  hash_map map(8);
+
+  for (int i = 0; i < 60; i += 2) {
+    EXPECT_TRUE(map.emplace(i, i));
+  }
+  for (int i = 0; i < 60; ++i) {
+    typename hash_map::accessor acc;
+    EXPECT_EQ(i % 2 == 0, map.try_get_value(i, acc)) << i;
+    EXPECT_EQ(i % 2 == 0, map.find(i) != map.end()) << i;
+  }
+  for (int i = 0; i < 60; i += 4) {
+    EXPECT_TRUE(map.erase(i));
+    EXPECT_FALSE(map.erase(i + 1));
+  }
+  for (int i = 0; i < 60; ++i) {
+    typename hash_map::accessor acc;
+    EXPECT_EQ(i % 4 == 2, map.try_get_value(i, acc)) << i;
+  }
+  auto it = map.find(58);
+  ASSERT_NE(map.end(), it);
+  map.erase(it);
+  it.reset();
+  typename hash_map::accessor acc;
+  EXPECT_FALSE(map.try_get_value(58, acc));
+}
+
 TYPED_TEST(VyukovHashMap, begin_returns_end_iterator_for_empty_map) {
   auto it = this->map.begin();
   ASSERT_EQ(this->map.end(), it);
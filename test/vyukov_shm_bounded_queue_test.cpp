@@ -0,0 +1,163 @@
+#include <xenium/vyukov_shm_bounded_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+
+struct message {
+  std::uint32_t producer;
+  std::uint32_t seq;
+  double payload;
+};
+
+using queue_t = xenium::vyukov_shm_bounded_queue<message>;
+
+struct region {
+  explicit region(std::size_t size) :
+      size(size),
+      memory(::operator new(size, std::align_val_t{queue_t::alignment})) {}
+  ~region() { ::operator delete(memory, std::align_val_t{queue_t::alignment}); }
+  std::size_t size;
+  void* memory;
+};
+
+TEST(VyukovShmBoundedQueue, push_try_pop_via_attached_handle_returns_pushed_element) {
+  region r(queue_t::required_size(4));
+  auto producer = queue_t::create(r.memory, r.size, 4);
+  auto consumer = queue_t::attach(r.memory, r.size);
+  EXPECT_EQ(4u, consumer.capacity());
+
+  EXPECT_TRUE(producer.try_push(message{1, 2, 3.5}));
+  message m{};
+  EXPECT_TRUE(consumer.try_pop(m));
+  EXPECT_EQ(1u, m.producer);
+  EXPECT_EQ(2u, m.seq);
+  EXPECT_EQ(3.5, m.payload);
+  EXPECT_FALSE(consumer.try_pop(m));
+}
+
+TEST(VyukovShmBoundedQueue, try_push_returns_false_when_queue_is_full) {
+  region r(queue_t::required_size(2));
+  auto queue = queue_t::create(r.memory, r.size, 2);
+  EXPECT_TRUE(queue.try_push(message{}));
+  EXPECT_TRUE(queue.try_push(message{}));
+  EXPECT_FALSE(queue.try_push(message{}));
+}
+
+TEST(VyukovShmBoundedQueue, create_rejects_invalid_arguments) {
+  region r(queue_t::required_size(4));
+  EXPECT_THROW(queue_t::create(r.memory, r.size, 3), std::invalid_argument);
+  EXPECT_THROW(queue_t::create(r.memory, r.size, 8), std::invalid_argument);
+  EXPECT_THROW(queue_t::create(static_cast<char*>(r.memory) + 8, r.size - 8, 2), std::invalid_argument);
+}
+
+TEST(VyukovShmBoundedQueue, attach_rejects_uninitialized_or_incompatible_regions) {
+  region r(queue_t::required_size(4));
+  std::memset(r.memory, 0, r.size);
+  EXPECT_THROW(queue_t::attach(r.memory, r.size), std::invalid_argument);
+
+  queue_t::create(r.memory, r.size, 4);
+  EXPECT_NO_THROW(queue_t::attach(r.memory, r.size));
+  EXPECT_THROW(queue_t::attach(r.memory, queue_t::required_size(2)), std::invalid_argument);
+  EXPECT_THROW(xenium::vyukov_shm_bounded_queue<std::uint64_t>::attach(r.memory, r.size), std::invalid_argument);
+}
+
+TEST(VyukovShmBoundedQueue, create_reinitializes_a_previously_used_region) {
+  region r(queue_t::required_size(4));
+  auto queue = queue_t::create(r.memory, r.size, 4);
+  EXPECT_TRUE(queue.try_push(message{}));
+  queue = queue_t::create(r.memory, r.size, 4);
+  message m{};
+  EXPECT_FALSE(queue_t::attach(r.memory, r.size).try_pop(m));
+}
+
+TEST(VyukovShmBoundedQueue, parallel_usage) {
+  constexpr std::uint32_t num_producers = 2;
+#ifdef DEBUG
+  constexpr std::uint32_t num_elements = 2000;
+#else
+  constexpr std::uint32_t num_elements = 20000;
+#endif
+  region r(queue_t::required_size(64));
+  queue_t::create(r.memory, r.size, 64);
+
+  std::vector<std::thread> threads;
+  for (std::uint32_t p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&r, p] {
+      auto queue = queue_t::attach(r.memory, r.size);
+      for (std::uint32_t i = 0; i < num_elements;) {
+        if (queue.try_push(message{p, i, 0.0})) {
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  auto queue = queue_t::attach(r.memory, r.size);
+  std::vector<std::uint32_t> next(num_producers, 0);
+  for (std::uint32_t received = 0; received < num_producers * num_elements;) {
+    message m{};
+    if (queue.try_pop(m)) {
+      ASSERT_EQ(next[m.producer], m.seq);
+      ++next[m.producer];
+      ++received;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+#if defined(__linux__)
+TEST(VyukovShmBoundedQueue, exchanges_elements_between_processes) {
+  constexpr std::uint32_t num_elements = 10000;
+  const auto size = queue_t::required_size(64);
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, memory);
+  queue_t::create(memory, size, 64);
+
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    auto queue = queue_t::attach(memory, size);
+    for (std::uint32_t i = 0; i < num_elements;) {
+      if (queue.try_push(message{0, i, 0.0})) {
+        ++i;
+      }
+    }
+    _exit(0);
+  }
+
+  auto queue = queue_t::attach(memory, size);
+  for (std::uint32_t i = 0; i < num_elements;) {
+    message m{};
+    if (queue.try_pop(m)) {
+      ASSERT_EQ(i, m.seq);
+      ++i;
+    }
+  }
+  int status = 0;
+  EXPECT_EQ(pid, waitpid(pid, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  munmap(memory, size);
+}
+#endif
+
+} // namespace
@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_ARRAY_ALLOCATOR_HPP
+#define XENIUM_ARRAY_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace xenium {
+
+/**
+ * @brief The default allocator for large internal arrays like the bucket array of
+ * `vyukov_hash_map` or the ring buffer of `vyukov_bounded_queue`.
+ *
+ * Simply uses the regular heap via `operator new`.
+ *
+ * An array allocator has to provide the following static member functions:
+ *  * `void* allocate(std::size_t size) noexcept`<br>
+ *    Returns a pointer to `size` bytes of zero-initialized memory that is aligned to
+ *    at least a cacheline (i.e., 64 bytes), or `nullptr` if the allocation failed.
+ *  * `void deallocate(void* p) noexcept`<br>
+ *    Releases memory that was previously returned by `allocate`.
+ *
+ * Array allocators can be configured via `xenium::policy::array_allocator`.
+ */
+struct default_array_allocator {
+  static constexpr std::size_t alignment = 64;
+
+  static void* allocate(std::size_t size) noexcept {
+    void* mem = ::operator new(size, std::align_val_t{alignment}, std::nothrow);
+    if (mem != nullptr) {
+      std::memset(mem, 0, size);
+    }
+    return mem;
+  }
+
+  static void deallocate(void* p) noexcept { ::operator delete(p, std::align_val_t{alignment}); }
+};
+
+/**
+ * @brief An allocator for very large internal arrays that is backed by huge pages.
+ *
+ * With large arrays that are accessed randomly (like the bucket array of a large
+ * `vyukov_hash_map`) almost every access results in a TLB miss when the array is
+ * backed by regular 4K pages. This allocator maps such arrays directly via `mmap`
+ * and either requests explicit huge pages (`MAP_HUGETLB`) or advises the kernel
+ * to use transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+ *
+ * Allocations smaller than `huge_page_size` are forwarded to `default_array_allocator`.
+ * On platforms other than Linux all allocations are forwarded to `default_array_allocator`.
+ *
+ * @tparam UseHugeTLB if true, the allocator first tries to map explicit huge pages via
+ *   `MAP_HUGETLB`; if that fails (e.g., because no huge pages are reserved), it falls back
+ *   to transparent huge pages. Defaults to false.
+ * @tparam NumaInterleave if true, the pages are interleaved across all NUMA nodes the
+ *   calling thread is allowed to allocate from (via `mbind(MPOL_INTERLEAVE)`). Otherwise
+ *   pages end up on whichever node touches them first. Defaults to false.
+ * @tparam InitThreads the number of threads used to pre-fault the pages of a new allocation.
+ *   If this is zero, pages are faulted in lazily on first access. Defaults to zero.
+ */
+template <bool UseHugeTLB = false, bool NumaInterleave = false, unsigned InitThreads = 0>
+struct huge_page_array_allocator {
+  static constexpr std::size_t alignment = default_array_allocator::alignment;
+  static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+  static void* allocate(std::size_t size) noexcept;
+  static void deallocate(void* p) noexcept;
+
+private:
+  // Every allocation is preceded by a header, so deallocate can determine how the
+  // memory has to be released. We use a whole cacheline to preserve the alignment.
+  struct alignas(alignment) header {
+    void* mapping;
+    std::size_t mapping_size;
+  };
+  static_assert(sizeof(header) == alignment);
+
+#if defined(__linux__)
+  static void* map(std::size_t size) noexcept;
+  static void interleave(void* addr, std::size_t size) noexcept;
+  static void prefault(void* addr, std::size_t size) noexcept;
+#endif
+};
+
+template <bool UseHugeTLB, bool NumaInterleave, unsigned InitThreads>
+void* huge_page_array_allocator<UseHugeTLB, NumaInterleave, InitThreads>::allocate(std::size_t size) noexcept {
+  const std::size_t total_size = size + sizeof(header);
+#if defined(__linux__)
+  if (size >= huge_page_size) {
+    const std::size_t mapping_size = (total_size + huge_page_size - 1) & ~(huge_page_size - 1);
+    void* mapping = map(mapping_size);
+    if (mapping == nullptr) {
+      return nullptr;
+    }
+    if constexpr (NumaInterleave) {
+      interleave(mapping, mapping_size);
+    }
+    if constexpr (InitThreads > 0) {
+      prefault(mapping, mapping_size);
+    }
+    // anonymous mappings are zero-initialized
+    auto* h = new (mapping) header{mapping, mapping_size};
+    return h + 1;
+  }
+#endif
+  void* mem = default_array_allocator::allocate(total_size);
+  if (mem == nullptr) {
+    return nullptr;
+  }
+  auto* h = new (mem) header{nullptr, 0};
+  return h + 1;
+}
+
+template <bool UseHugeTLB, bool NumaInterleave, unsigned InitThreads>
+void huge_page_array_allocator<UseHugeTLB, NumaInterleave, InitThreads>::deallocate(void* p) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+  auto* h = static_cast<header*>(p) - 1;
+#if defined(__linux__)
+  if (h->mapping != nullptr) {
+    ::munmap(h->mapping, h->mapping_size);
+    return;
+  }
+#endif
+  default_array_allocator::deallocate(h);
+}
+
+#if defined(__linux__)
+template <bool UseHugeTLB, bool NumaInterleave, unsigned InitThreads>
+void* huge_page_array_allocator<UseHugeTLB, NumaInterleave, InitThreads>::map(std::size_t size) noexcept {
+  #if defined(MAP_HUGETLB)
+  if constexpr (UseHugeTLB) {
+    void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+      return mem;
+    }
+  }
+  #endif
+
+  // Transparent huge pages can only be used for huge page aligned regions, so we
+  // map an additional huge page and trim the unaligned parts afterwards.
+  void* mem = ::mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  auto addr = reinterpret_cast<std::uintptr_t>(mem);
+  auto aligned_addr = (addr + huge_page_size - 1) & ~(huge_page_size - 1);
+  if (aligned_addr != addr) {
+    ::munmap(mem, aligned_addr - addr);
+  }
+  const auto tail = (addr + size + huge_page_size) - (aligned_addr + size);
+  if (tail != 0) {
+    ::munmap(reinterpret_cast<void*>(aligned_addr + size), tail);
+  }
+
+  mem = reinterpret_cast<void*>(aligned_addr);
+  #if defined(MADV_HUGEPAGE)
+  // this is only a hint, so we can safely ignore any errors
+  ::madvise(mem, size, MADV_HUGEPAGE);
+  #endif
+  return mem;
+}
+
+template <bool UseHugeTLB, bool NumaInterleave, unsigned InitThreads>
+void huge_page_array_allocator<UseHugeTLB, NumaInterleave, InitThreads>::interleave(
+  [[maybe_unused]] void* addr,
+  [[maybe_unused]] std::size_t size) noexcept {
+  // We use the raw syscalls to avoid a dependency on libnuma.
+  // Interleaving is only an optimization, so we simply ignore any errors.
+  #if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+  constexpr int mpol_interleave = 3;
+  constexpr unsigned long mpol_f_mems_allowed = 1 << 2;
+  constexpr unsigned long max_nodes = 1024;
+  unsigned long nodes[max_nodes / (8 * sizeof(unsigned long))] = {};
+  if (::syscall(SYS_get_mempolicy, nullptr, nodes, max_nodes, nullptr, mpol_f_mems_allowed) == 0) {
+    ::syscall(SYS_mbind, addr, size, mpol_interleave, nodes, max_nodes, 0);
+  }
+  #endif
+}
+
+template <bool UseHugeTLB, bool NumaInterleave, unsigned InitThreads>
+void huge_page_array_allocator<UseHugeTLB, NumaInterleave, InitThreads>::prefault(void* addr,
+                                                                                  std::size_t size) noexcept {
+  // Touch one byte per page; with a NUMA interleave policy the pages are placed
+  // according to that policy, otherwise on the node of the touching thread.
+  constexpr std::size_t page_size = 4096;
+  auto touch = [addr](std::size_t begin, std::size_t end) {
+    auto* p = static_cast<volatile char*>(addr);
+    for (std::size_t i = begin; i < end; i += page_size) {
+      p[i] = 0;
+    }
+  };
+
+  const std::size_t num_chunks = std::min<std::size_t>(InitThreads, size / huge_page_size);
+  if (num_chunks <= 1) {
+    touch(0, size);
+    return;
+  }
+
+  const std::size_t chunk_size = size / num_chunks;
+  std::vector<std::thread> threads;
+  try {
+    threads.reserve(num_chunks - 1);
+    for (std::size_t i = 1; i < num_chunks; ++i) {
+      threads.emplace_back(touch, i * chunk_size, i + 1 == num_chunks ? size : (i + 1) * chunk_size);
+    }
+  } catch (...) {
+    // if we cannot create more threads, we simply touch the remaining pages ourselves
+    touch((threads.size() + 1) * chunk_size, size);
+  }
+  touch(0, chunk_size);
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+#endif
+
+} // namespace xenium
+
+#endif
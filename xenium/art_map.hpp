@@ -0,0 +1,1071 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_ART_MAP_HPP
+#define XENIUM_ART_MAP_HPP
+
+#include <xenium/backoff.hpp>
+#include <xenium/detail/olc_version.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace xenium {
+
+namespace detail {
+  /**
+   * @brief Defines how keys of type `Key` are mapped to the byte strings that are stored in an `art_map`.
+   *
+   * The encoding must be order preserving (comparing the encoded byte strings lexicographically
+   * yields the same order as comparing the keys) and prefix free (no encoded key is a prefix of
+   * another encoded key).
+   */
+  template <class Key, class = void>
+  struct art_key_traits;
+
+  // Integers are stored in big-endian byte order; for signed integers the sign bit is flipped,
+  // so that negative numbers are ordered before positive ones.
+  template <class Key>
+  struct art_key_traits<Key, std::enable_if_t<std::is_integral_v<Key>>> {
+    static void encode(Key key, std::string& result) {
+      using unsigned_key = std::make_unsigned_t<Key>;
+      auto value = static_cast<unsigned_key>(key);
+      if constexpr (std::is_signed_v<Key>) {
+        value ^= static_cast<unsigned_key>(static_cast<unsigned_key>(1) << (sizeof(Key) * 8 - 1));
+      }
+      result.resize(sizeof(Key));
+      for (std::size_t i = sizeof(Key); i > 0; --i) {
+        result[i - 1] = static_cast<char>(value & 0xff);
+        value = static_cast<unsigned_key>(value >> 8);
+      }
+    }
+  };
+
+  // Strings are terminated with the two bytes 0x00 0x00; to keep the encoding prefix free, every
+  // 0x00 byte inside the string is escaped as 0x00 0xff.
+  template <>
+  struct art_key_traits<std::string> {
+    static void encode(const std::string& key, std::string& result) {
+      encode_prefix(key, result);
+      result.push_back('\0');
+      result.push_back('\0');
+    }
+
+    // Encodes the given string without the terminator, so the result is a prefix of the
+    // encodings of all strings that start with `prefix`.
+    static void encode_prefix(const std::string& prefix, std::string& result) {
+      result.clear();
+      result.reserve(prefix.size() + 2);
+      for (char c : prefix) {
+        result.push_back(c);
+        if (c == '\0') {
+          result.push_back('\xff');
+        }
+      }
+    }
+  };
+} // namespace detail
+
+/**
+ * @brief A concurrent ordered map based on the adaptive radix tree (ART) proposed by Leis et al.
+ * \[[LKN13](index.html#ref-leis-2013)\], synchronized via optimistic lock coupling
+ * \[[LSH+16](index.html#ref-leis-2016)\].
+ *
+ * Keys are mapped to byte strings (see `detail::art_key_traits`); all integral types as well as
+ * `std::string` are supported out of the box. Inner nodes adapt their size to the number of
+ * children (4, 16, 48 or 256) and store the common prefix of all keys in their subtree (path
+ * compression). Values are stored in leaf nodes together with the full key, so a lookup only
+ * compares the complete key once it reaches a leaf.
+ *
+ * Every inner node has a version counter that is used like the sequence counter of a `seqlock`:
+ * writers lock a node by setting the lock bit and increment the version when they release it.
+ * Readers never write to shared memory - they remember a node's version, read its content and
+ * validate afterwards that the version has not changed; otherwise they restart the operation.
+ * An update operation locks at most two nodes (the node it modifies and its parent) and only
+ * tries to lock them, so there are no deadlocks. Leaves and node prefixes are never modified
+ * after a node has been published; nodes are instead replaced by modified copies (e.g., when a
+ * node has to grow or shrink). Replaced nodes are marked as obsolete and retired via the
+ * reclaimer.
+ *
+ * Since writers lock nodes, the map is not lock-free, but lookups and scans never block
+ * writers. A range scan does not take a snapshot; it visits all entries in ascending key order,
+ * but an entry that is inserted or removed concurrently may or may not be visited.
+ *
+ * `lock_free_ref_count` is not supported, because a reader may try to acquire a guard for a
+ * node that has already been removed.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for internal nodes. (**required**)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy that is used when an operation has to restart.
+ *    (*optional*; defaults to `xenium::no_backoff`)
+ *
+ * @tparam Key the key type; must be supported by `detail::art_key_traits`.
+ * @tparam Value the mapped type; values are returned as copies and must therefore be copyable.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class Key, class Value, class... Policies>
+class art_map {
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<const Key, Value>;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+  using key_traits = detail::art_key_traits<Key>;
+
+  template <class... NewPolicies>
+  using with = art_map<Key, Value, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+
+  art_map();
+  ~art_map();
+
+  art_map(const art_map&) = delete;
+  art_map(art_map&&) = delete;
+
+  art_map& operator=(const art_map&) = delete;
+  art_map& operator=(art_map&&) = delete;
+
+  /**
+   * @brief Inserts a new element into the map if the map doesn't already contain an
+   * element with the same key.
+   *
+   * The value is constructed in-place with the given `args`.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key
+   * @param args arguments to forward to the constructor of the value
+   * @return `true` if the element was inserted, otherwise `false`
+   */
+  template <class... Args>
+  bool emplace(const Key& key, Args&&... args);
+
+  /**
+   * @brief Removes the element with the given key from the map, if one exists.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key
+   * @return `true` if an element was removed, otherwise `false`
+   */
+  bool erase(const Key& key);
+
+  /**
+   * @brief Checks whether the map contains an element with the given key.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param key
+   * @return `true` if the map contains such an element, otherwise `false`
+   */
+  [[nodiscard]] bool contains(const Key& key);
+
+  /**
+   * @brief Looks up the element with the given key and copies its value to `result`.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param key
+   * @param result the value of the element if one was found
+   * @return `true` if an element was found, otherwise `false`
+   */
+  [[nodiscard]] bool try_get_value(const Key& key, Value& result);
+
+  /**
+   * @brief Visits all elements with a key in the range `[first, last)` in ascending key order.
+   *
+   * `func` is called with a `const value_type&`. If it returns a value that converts to `false`,
+   * the scan stops. The element reference must not be used after `func` returns.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param first inclusive lower bound
+   * @param last exclusive upper bound
+   * @param func
+   * @return the number of visited elements
+   */
+  template <class Func>
+  std::size_t scan(const Key& first, const Key& last, Func&& func);
+
+  /**
+   * @brief Visits all elements whose key starts with the given prefix in ascending key order.
+   *
+   * Only available for string keys. The requirements for `func` are the same as for `scan`.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param prefix
+   * @param func
+   * @return the number of visited elements
+   */
+  template <class Func, class K = Key, std::enable_if_t<std::is_same_v<K, std::string>, int> = 0>
+  std::size_t scan_prefix(const std::string& prefix, Func&& func);
+
+private:
+  enum class node_type : std::uint8_t { leaf, node4, node16, node48, node256 };
+  enum class op_result { restart, success, failure };
+
+  struct node : reclaimer::template enable_concurrent_ptr<node> {
+    explicit node(node_type type) : type(type) {}
+    const node_type type;
+  };
+
+  using concurrent_ptr = typename reclaimer::template concurrent_ptr<node, 0>;
+  using marked_ptr = typename concurrent_ptr::marked_ptr;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+
+  struct leaf : node {
+    template <class... Args>
+    leaf(std::string&& bytes, const Key& key, Args&&... args) :
+        node(node_type::leaf),
+        bytes(std::move(bytes)),
+        value(std::piecewise_construct,
+              std::forward_as_tuple(key),
+              std::forward_as_tuple(std::forward<Args>(args)...)) {}
+    const std::string bytes;
+    value_type value;
+  };
+
+  struct inner_node : node {
+    inner_node(node_type type, std::string&& prefix) : node(type), prefix(std::move(prefix)) {}
+    detail::olc_version version;
+    std::atomic<std::uint16_t> count{0};
+    // the prefix is never changed after the node has been published, so it can be read without validation.
+    const std::string prefix;
+  };
+
+  template <unsigned N, node_type Type>
+  struct sorted_node : inner_node {
+    explicit sorted_node(std::string&& prefix) : inner_node(Type, std::move(prefix)) {
+      for (auto& k : keys) {
+        k.store(0, std::memory_order_relaxed);
+      }
+    }
+    static constexpr unsigned capacity = N;
+    std::atomic<std::uint8_t> keys[N];
+    concurrent_ptr children[N];
+  };
+
+  using node4 = sorted_node<4, node_type::node4>;
+  using node16 = sorted_node<16, node_type::node16>;
+
+  struct node48 : inner_node {
+    explicit node48(std::string&& prefix) : inner_node(node_type::node48, std::move(prefix)) {
+      for (auto& i : index) {
+        i.store(0, std::memory_order_relaxed);
+      }
+    }
+    static constexpr unsigned capacity = 48;
+    // index of the child slot + 1; zero means no child
+    std::atomic<std::uint8_t> index[256];
+    concurrent_ptr children[48];
+  };
+
+  struct node256 : inner_node {
+    explicit node256(std::string&& prefix) : inner_node(node_type::node256, std::move(prefix)) {}
+    concurrent_ptr children[256];
+  };
+
+  static std::uint8_t byte_at(const std::string& s, std::size_t pos) { return static_cast<std::uint8_t>(s[pos]); }
+
+  static inner_node* make_node(node_type type, std::string&& prefix);
+  static concurrent_ptr* find_child(inner_node& n, std::uint8_t byte);
+  static concurrent_ptr* next_child(inner_node& n, unsigned min_byte, std::uint8_t& byte);
+  static bool is_full(const inner_node& n);
+  static void add_child(inner_node& n, std::uint8_t byte, node* child);
+  static void remove_child(inner_node& n, std::uint8_t byte);
+  static inner_node* copy_node(inner_node& n, node_type type, std::string&& prefix, int skip_byte = -1);
+  static void destroy(node* n);
+
+  static std::size_t prefix_mismatch(const inner_node& n, const std::string& key, std::size_t depth);
+
+  op_result do_insert(leaf* new_leaf);
+  op_result do_erase(const std::string& key);
+  op_result do_find(const std::string& key, guard_ptr& result);
+  op_result do_find_next(inner_node& n,
+                         std::uint64_t version,
+                         std::size_t depth,
+                         const std::string& from,
+                         bool inclusive,
+                         bool greater,
+                         guard_ptr& result);
+
+  bool find(const std::string& key, guard_ptr& result);
+  bool find_next(const std::string& from, bool inclusive, guard_ptr& result);
+  template <class Func, class Predicate>
+  std::size_t do_scan(const std::string& from, Predicate&& in_range, Func&& func);
+
+  // The root is never replaced, so it does not have to be protected by guards.
+  node256* _root;
+};
+
+template <class Key, class Value, class... Policies>
+art_map<Key, Value, Policies...>::art_map() : _root(new node256(std::string())) {}
+
+template <class Key, class Value, class... Policies>
+art_map<Key, Value, Policies...>::~art_map() {
+  destroy(_root);
+}
+
+template <class Key, class Value, class... Policies>
+void art_map<Key, Value, Policies...>::destroy(node* n) {
+  if (n->type != node_type::leaf) {
+    auto& inner = static_cast<inner_node&>(*n);
+    std::uint8_t byte;
+    for (unsigned b = 0; b < 256; b = byte + 1u) {
+      auto* slot = next_child(inner, b, byte);
+      if (slot == nullptr) {
+        break;
+      }
+      // (1) - this acquire-load synchronizes-with the release-stores (2, 3, 4, 5)
+      auto child = slot->load(std::memory_order_acquire);
+      if (child) {
+        destroy(child.get());
+      }
+    }
+  }
+  delete n;
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::make_node(node_type type, std::string&& prefix) -> inner_node* {
+  switch (type) {
+    case node_type::node4:
+      return new node4(std::move(prefix));
+    case node_type::node16:
+      return new node16(std::move(prefix));
+    case node_type::node48:
+      return new node48(std::move(prefix));
+    default:
+      assert(type == node_type::node256);
+      return new node256(std::move(prefix));
+  }
+}
+
+// The following functions read the node's content optimistically, i.e., the result is only
+// meaningful if the node's version is validated afterwards (or the node is locked).
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::find_child(inner_node& n, std::uint8_t byte) -> concurrent_ptr* {
+  auto find_sorted = [byte](auto& sn) -> concurrent_ptr* {
+    unsigned cnt = std::min<unsigned>(sn.count.load(std::memory_order_relaxed), sn.capacity);
+    for (unsigned i = 0; i < cnt; ++i) {
+      if (sn.keys[i].load(std::memory_order_relaxed) == byte) {
+        return &sn.children[i];
+      }
+    }
+    return nullptr;
+  };
+
+  switch (n.type) {
+    case node_type::node4:
+      return find_sorted(static_cast<node4&>(n));
+    case node_type::node16:
+      return find_sorted(static_cast<node16&>(n));
+    case node_type::node48: {
+      auto& n48 = static_cast<node48&>(n);
+      unsigned idx = n48.index[byte].load(std::memory_order_relaxed);
+      return (idx == 0 || idx > node48::capacity) ? nullptr : &n48.children[idx - 1];
+    }
+    default:
+      assert(n.type == node_type::node256);
+      return &static_cast<node256&>(n).children[byte];
+  }
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::next_child(inner_node& n, unsigned min_byte, std::uint8_t& byte)
+  -> concurrent_ptr* {
+  auto next_sorted = [min_byte, &byte](auto& sn) -> concurrent_ptr* {
+    unsigned cnt = std::min<unsigned>(sn.count.load(std::memory_order_relaxed), sn.capacity);
+    for (unsigned i = 0; i < cnt; ++i) {
+      auto k = sn.keys[i].load(std::memory_order_relaxed);
+      if (k >= min_byte) {
+        byte = k;
+        return &sn.children[i];
+      }
+    }
+    return nullptr;
+  };
+
+  switch (n.type) {
+    case node_type::node4:
+      return next_sorted(static_cast<node4&>(n));
+    case node_type::node16:
+      return next_sorted(static_cast<node16&>(n));
+    case node_type::node48: {
+      auto& n48 = static_cast<node48&>(n);
+      for (unsigned b = min_byte; b < 256; ++b) {
+        unsigned idx = n48.index[b].load(std::memory_order_relaxed);
+        if (idx != 0 && idx <= node48::capacity) {
+          byte = static_cast<std::uint8_t>(b);
+          return &n48.children[idx - 1];
+        }
+      }
+      return nullptr;
+    }
+    default: {
+      assert(n.type == node_type::node256);
+      auto& n256 = static_cast<node256&>(n);
+      for (unsigned b = min_byte; b < 256; ++b) {
+        if (n256.children[b].load(std::memory_order_relaxed)) {
+          byte = static_cast<std::uint8_t>(b);
+          return &n256.children[b];
+        }
+      }
+      return nullptr;
+    }
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::is_full(const inner_node& n) {
+  auto cnt = n.count.load(std::memory_order_relaxed);
+  switch (n.type) {
+    case node_type::node4:
+      return cnt >= node4::capacity;
+    case node_type::node16:
+      return cnt >= node16::capacity;
+    case node_type::node48:
+      return cnt >= node48::capacity;
+    default:
+      return false;
+  }
+}
+
+// add_child and remove_child must only be called if the node is locked or not yet published.
+// Children are always stored with release semantics, since readers acquire them via a guard
+// without synchronizing with the lock.
+template <class Key, class Value, class... Policies>
+void art_map<Key, Value, Policies...>::add_child(inner_node& n, std::uint8_t byte, node* child) {
+  auto cnt = n.count.load(std::memory_order_relaxed);
+  auto add_sorted = [byte, child, cnt](auto& sn) {
+    assert(cnt < sn.capacity);
+    unsigned pos = cnt;
+    for (; pos > 0 && sn.keys[pos - 1].load(std::memory_order_relaxed) > byte; --pos) {
+      sn.keys[pos].store(sn.keys[pos - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      // (2) - this release-store synchronizes-with the acquire-loads (1, 6)
+      sn.children[pos].store(sn.children[pos - 1].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    sn.keys[pos].store(byte, std::memory_order_relaxed);
+    // (3) - this release-store synchronizes-with the acquire-loads (1, 6)
+    sn.children[pos].store(marked_ptr(child), std::memory_order_release);
+  };
+
+  switch (n.type) {
+    case node_type::node4:
+      add_sorted(static_cast<node4&>(n));
+      break;
+    case node_type::node16:
+      add_sorted(static_cast<node16&>(n));
+      break;
+    case node_type::node48: {
+      auto& n48 = static_cast<node48&>(n);
+      unsigned slot = 0;
+      while (n48.children[slot].load(std::memory_order_relaxed)) {
+        ++slot;
+        assert(slot < node48::capacity);
+      }
+      // (4) - this release-store synchronizes-with the acquire-loads (1, 6)
+      n48.children[slot].store(marked_ptr(child), std::memory_order_release);
+      n48.index[byte].store(static_cast<std::uint8_t>(slot + 1), std::memory_order_relaxed);
+      break;
+    }
+    default:
+      assert(n.type == node_type::node256);
+      // (4) - this release-store synchronizes-with the acquire-loads (1, 6)
+      static_cast<node256&>(n).children[byte].store(marked_ptr(child), std::memory_order_release);
+      break;
+  }
+  n.count.store(static_cast<std::uint16_t>(cnt + 1), std::memory_order_relaxed);
+}
+
+template <class Key, class Value, class... Policies>
+void art_map<Key, Value, Policies...>::remove_child(inner_node& n, std::uint8_t byte) {
+  auto cnt = n.count.load(std::memory_order_relaxed);
+  auto remove_sorted = [byte, cnt](auto& sn) {
+    unsigned pos = 0;
+    while (sn.keys[pos].load(std::memory_order_relaxed) != byte) {
+      ++pos;
+      assert(pos < cnt);
+    }
+    for (; pos + 1 < cnt; ++pos) {
+      sn.keys[pos].store(sn.keys[pos + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      // (2) - this release-store synchronizes-with the acquire-loads (1, 6)
+      sn.children[pos].store(sn.children[pos + 1].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    sn.children[pos].store(marked_ptr(), std::memory_order_relaxed);
+  };
+
+  switch (n.type) {
+    case node_type::node4:
+      remove_sorted(static_cast<node4&>(n));
+      break;
+    case node_type::node16:
+      remove_sorted(static_cast<node16&>(n));
+      break;
+    case node_type::node48: {
+      auto& n48 = static_cast<node48&>(n);
+      unsigned idx = n48.index[byte].load(std::memory_order_relaxed);
+      assert(idx != 0);
+      n48.index[byte].store(0, std::memory_order_relaxed);
+      n48.children[idx - 1].store(marked_ptr(), std::memory_order_relaxed);
+      break;
+    }
+    default:
+      assert(n.type == node_type::node256);
+      static_cast<node256&>(n).children[byte].store(marked_ptr(), std::memory_order_relaxed);
+      break;
+  }
+  n.count.store(static_cast<std::uint16_t>(cnt - 1), std::memory_order_relaxed);
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::copy_node(inner_node& n, node_type type, std::string&& prefix, int skip_byte)
+  -> inner_node* {
+  auto* result = make_node(type, std::move(prefix));
+  std::uint8_t byte;
+  for (unsigned b = 0; b < 256; b = byte + 1u) {
+    auto* slot = next_child(n, b, byte);
+    if (slot == nullptr) {
+      break;
+    }
+    auto child = slot->load(std::memory_order_relaxed);
+    if (child && byte != skip_byte) {
+      add_child(*result, byte, child.get());
+    }
+  }
+  return result;
+}
+
+template <class Key, class Value, class... Policies>
+std::size_t
+  art_map<Key, Value, Policies...>::prefix_mismatch(const inner_node& n, const std::string& key, std::size_t depth) {
+  const auto& prefix = n.prefix;
+  std::size_t i = 0;
+  for (; i < prefix.size() && depth + i < key.size(); ++i) {
+    if (prefix[i] != key[depth + i]) {
+      break;
+    }
+  }
+  return i;
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::do_insert(leaf* new_leaf) -> op_result {
+  const std::string& key = new_leaf->bytes;
+  guard_ptr parent_guard;
+  guard_ptr node_guard;
+  guard_ptr next_guard;
+  inner_node* parent = nullptr;
+  std::uint64_t parent_version = 0;
+  std::uint8_t parent_byte = 0;
+
+  inner_node* n = _root;
+  std::uint64_t version;
+  if (!n->version.read_lock(version)) {
+    return op_result::restart;
+  }
+
+  std::size_t depth = 0;
+  for (;;) {
+    auto mismatch = prefix_mismatch(*n, key, depth);
+    if (mismatch < n->prefix.size()) {
+      // The key diverges inside the node's prefix, so we replace the node with a new node4 that
+      // contains the common part of the prefix and has the new leaf and a copy of the node
+      // (with the remaining prefix) as children. The root has no prefix, so parent is not null.
+      assert(parent != nullptr);
+      assert(depth + mismatch < key.size());
+      if (!parent->version.try_upgrade(parent_version)) {
+        return op_result::restart;
+      }
+      if (!n->version.try_upgrade(version)) {
+        parent->version.unlock();
+        return op_result::restart;
+      }
+      auto* copy = copy_node(*n, n->type, n->prefix.substr(mismatch + 1));
+      auto* new_node = make_node(node_type::node4, n->prefix.substr(0, mismatch));
+      add_child(*new_node, byte_at(n->prefix, mismatch), copy);
+      add_child(*new_node, byte_at(key, depth + mismatch), new_leaf);
+      // (5) - this release-store synchronizes-with the acquire-loads (1, 6)
+      find_child(*parent, parent_byte)->store(marked_ptr(new_node), std::memory_order_release);
+      n->version.unlock_obsolete();
+      parent->version.unlock();
+      node_guard.reclaim();
+      return op_result::success;
+    }
+
+    depth += n->prefix.size();
+    assert(depth < key.size());
+    auto byte = byte_at(key, depth);
+    auto* slot = find_child(*n, byte);
+    if (slot != nullptr) {
+      // (6) - this acquire-load synchronizes-with the release-stores (2, 3, 4, 5)
+      next_guard.acquire(*slot, std::memory_order_acquire);
+    } else {
+      next_guard.reset();
+    }
+    if (!n->version.validate(version)) {
+      return op_result::restart;
+    }
+
+    if (!next_guard) {
+      if (is_full(*n)) {
+        // Replace the node with a bigger copy that includes the new leaf. The root is a
+        // node256 and therefore never full, so parent is not null.
+        assert(parent != nullptr);
+        if (!parent->version.try_upgrade(parent_version)) {
+          return op_result::restart;
+        }
+        if (!n->version.try_upgrade(version)) {
+          parent->version.unlock();
+          return op_result::restart;
+        }
+        auto bigger_type = static_cast<node_type>(static_cast<std::uint8_t>(n->type) + 1);
+        auto* bigger = copy_node(*n, bigger_type, std::string(n->prefix));
+        add_child(*bigger, byte, new_leaf);
+        // (5) - this release-store synchronizes-with the acquire-loads (1, 6)
+        find_child(*parent, parent_byte)->store(marked_ptr(bigger), std::memory_order_release);
+        n->version.unlock_obsolete();
+        parent->version.unlock();
+        node_guard.reclaim();
+        return op_result::success;
+      }
+
+      if (!n->version.try_upgrade(version)) {
+        return op_result::restart;
+      }
+      add_child(*n, byte, new_leaf);
+      n->version.unlock();
+      return op_result::success;
+    }
+
+    if (next_guard->type == node_type::leaf) {
+      auto* existing = static_cast<leaf*>(next_guard.get());
+      if (existing->bytes == key) {
+        return op_result::failure;
+      }
+
+      // Replace the existing leaf with a new node4 that contains both leafs. Since the
+      // encoded keys are prefix free, they must differ at some position.
+      if (!n->version.try_upgrade(version)) {
+        return op_result::restart;
+      }
+      const std::string& other = existing->bytes;
+      auto start = depth + 1;
+      auto end = start;
+      while (end < key.size() && end < other.size() && key[end] == other[end]) {
+        ++end;
+      }
+      assert(end < key.size() && end < other.size());
+      auto* new_node = make_node(node_type::node4, key.substr(start, end - start));
+      add_child(*new_node, byte_at(other, end), existing);
+      add_child(*new_node, byte_at(key, end), new_leaf);
+      // (5) - this release-store synchronizes-with the acquire-loads (1, 6)
+      slot->store(marked_ptr(new_node), std::memory_order_release);
+      n->version.unlock();
+      return op_result::success;
+    }
+
+    parent_guard = std::move(node_guard);
+    parent = n;
+    parent_version = version;
+    parent_byte = byte;
+    node_guard = std::move(next_guard);
+    n = static_cast<inner_node*>(node_guard.get());
+    if (!n->version.read_lock(version)) {
+      return op_result::restart;
+    }
+    ++depth;
+  }
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::do_erase(const std::string& key) -> op_result {
+  guard_ptr parent_guard;
+  guard_ptr node_guard;
+  guard_ptr next_guard;
+  inner_node* parent = nullptr;
+  std::uint64_t parent_version = 0;
+  std::uint8_t parent_byte = 0;
+
+  inner_node* n = _root;
+  std::uint64_t version;
+  if (!n->version.read_lock(version)) {
+    return op_result::restart;
+  }
+
+  std::size_t depth = 0;
+  for (;;) {
+    if (prefix_mismatch(*n, key, depth) < n->prefix.size()) {
+      return n->version.validate(version) ? op_result::failure : op_result::restart;
+    }
+
+    depth += n->prefix.size();
+    assert(depth < key.size());
+    auto byte = byte_at(key, depth);
+    auto* slot = find_child(*n, byte);
+    if (slot != nullptr) {
+      // (6) - this acquire-load synchronizes-with the release-stores (2, 3, 4, 5)
+      next_guard.acquire(*slot, std::memory_order_acquire);
+    } else {
+      next_guard.reset();
+    }
+    if (!n->version.validate(version)) {
+      return op_result::restart;
+    }
+    if (!next_guard) {
+      return op_result::failure;
+    }
+
+    if (next_guard->type == node_type::leaf) {
+      if (static_cast<leaf*>(next_guard.get())->bytes != key) {
+        return op_result::failure;
+      }
+
+      auto cnt = n->count.load(std::memory_order_relaxed);
+      bool replace = false;
+      if (parent != nullptr) {
+        switch (n->type) {
+          case node_type::node4:
+            replace = cnt <= 2;
+            break;
+          case node_type::node16:
+            replace = cnt <= 4;
+            break;
+          case node_type::node48:
+            replace = cnt <= 13;
+            break;
+          default:
+            replace = cnt <= 38;
+            break;
+        }
+      }
+
+      if (!replace) {
+        if (!n->version.try_upgrade(version)) {
+          return op_result::restart;
+        }
+        remove_child(*n, byte);
+        n->version.unlock();
+        next_guard.reclaim();
+        return op_result::success;
+      }
+
+      if (!parent->version.try_upgrade(parent_version)) {
+        return op_result::restart;
+      }
+      if (!n->version.try_upgrade(version)) {
+        parent->version.unlock();
+        return op_result::restart;
+      }
+      // we hold the lock, so the count we have read before is still valid.
+      if (n->type == node_type::node4) {
+        // A node4 that would be left with a single leaf is replaced by that leaf. If the
+        // remaining child is an inner node we would have to merge the prefixes, so in that
+        // case we keep the node4.
+        marked_ptr other{};
+        if (cnt == 2) {
+          auto& n4 = static_cast<node4&>(*n);
+          other = n4.children[n4.keys[0].load(std::memory_order_relaxed) == byte ? 1 : 0].load(
+            std::memory_order_relaxed);
+        }
+        if (cnt == 1) {
+          remove_child(*parent, parent_byte);
+        } else if (other->type == node_type::leaf) {
+          // (5) - this release-store synchronizes-with the acquire-loads (1, 6)
+          find_child(*parent, parent_byte)->store(other, std::memory_order_release);
+        } else {
+          remove_child(*n, byte);
+          n->version.unlock();
+          parent->version.unlock();
+          next_guard.reclaim();
+          return op_result::success;
+        }
+      } else {
+        auto smaller_type = static_cast<node_type>(static_cast<std::uint8_t>(n->type) - 1);
+        auto* smaller = copy_node(*n, smaller_type, std::string(n->prefix), byte);
+        // (5) - this release-store synchronizes-with the acquire-loads (1, 6)
+        find_child(*parent, parent_byte)->store(marked_ptr(smaller), std::memory_order_release);
+      }
+      n->version.unlock_obsolete();
+      parent->version.unlock();
+      node_guard.reclaim();
+      next_guard.reclaim();
+      return op_result::success;
+    }
+
+    parent_guard = std::move(node_guard);
+    parent = n;
+    parent_version = version;
+    parent_byte = byte;
+    node_guard = std::move(next_guard);
+    n = static_cast<inner_node*>(node_guard.get());
+    if (!n->version.read_lock(version)) {
+      return op_result::restart;
+    }
+    ++depth;
+  }
+}
+
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::do_find(const std::string& key, guard_ptr& result) -> op_result {
+  guard_ptr node_guard;
+  inner_node* n = _root;
+  std::uint64_t version;
+  if (!n->version.read_lock(version)) {
+    return op_result::restart;
+  }
+
+  std::size_t depth = 0;
+  for (;;) {
+    if (prefix_mismatch(*n, key, depth) < n->prefix.size()) {
+      return n->version.validate(version) ? op_result::failure : op_result::restart;
+    }
+
+    depth += n->prefix.size();
+    assert(depth < key.size());
+    auto* slot = find_child(*n, byte_at(key, depth));
+    if (slot != nullptr) {
+      // (6) - this acquire-load synchronizes-with the release-stores (2, 3, 4, 5)
+      result.acquire(*slot, std::memory_order_acquire);
+    } else {
+      result.reset();
+    }
+    if (!n->version.validate(version)) {
+      return op_result::restart;
+    }
+    if (!result) {
+      return op_result::failure;
+    }
+    if (result->type == node_type::leaf) {
+      return static_cast<leaf*>(result.get())->bytes == key ? op_result::success : op_result::failure;
+    }
+
+    node_guard = std::move(result);
+    n = static_cast<inner_node*>(node_guard.get());
+    if (!n->version.read_lock(version)) {
+      return op_result::restart;
+    }
+    ++depth;
+  }
+}
+
+// Searches the subtree of `n` for the leaf with the smallest key that is greater than (or equal to,
+// if `inclusive` is true) `from`. `greater` is true if the path to `n` is already greater than
+// the corresponding part of `from`, in which case we simply look for the leftmost leaf.
+template <class Key, class Value, class... Policies>
+auto art_map<Key, Value, Policies...>::do_find_next(inner_node& n,
+                                                    std::uint64_t version,
+                                                    std::size_t depth,
+                                                    const std::string& from,
+                                                    bool inclusive,
+                                                    bool greater,
+                                                    guard_ptr& result) -> op_result {
+  const auto& prefix = n.prefix;
+  for (std::size_t i = 0; !greater && i < prefix.size(); ++i) {
+    if (depth + i >= from.size() || byte_at(prefix, i) > byte_at(from, depth + i)) {
+      greater = true;
+    } else if (byte_at(prefix, i) < byte_at(from, depth + i)) {
+      // all keys in this subtree are smaller
+      return n.version.validate(version) ? op_result::failure : op_result::restart;
+    }
+  }
+  depth += prefix.size();
+
+  unsigned start = 0;
+  if (!greater) {
+    if (depth >= from.size()) {
+      greater = true;
+    } else {
+      start = byte_at(from, depth);
+    }
+  }
+
+  guard_ptr child_guard;
+  std::uint8_t byte;
+  for (unsigned b = start; b < 256; b = byte + 1u) {
+    auto* slot = next_child(n, b, byte);
+    if (slot != nullptr) {
+      // (6) - this acquire-load synchronizes-with the release-stores (2, 3, 4, 5)
+      child_guard.acquire(*slot, std::memory_order_acquire);
+    }
+    if (!n.version.validate(version)) {
+      return op_result::restart;
+    }
+    if (slot == nullptr) {
+      break;
+    }
+    if (!child_guard) {
+      continue;
+    }
+
+    bool child_greater = greater || byte > start;
+    if (child_guard->type == node_type::leaf) {
+      const auto& bytes = static_cast<leaf*>(child_guard.get())->bytes;
+      if (child_greater || bytes > from || (inclusive && bytes == from)) {
+        result = std::move(child_guard);
+        return op_result::success;
+      }
+      continue;
+    }
+
+    auto& child = static_cast<inner_node&>(*child_guard);
+    std::uint64_t child_version;
+    if (!child.version.read_lock(child_version)) {
+      return op_result::restart;
+    }
+    auto r = do_find_next(child, child_version, depth + 1, from, inclusive, child_greater, result);
+    if (r != op_result::failure) {
+      return r;
+    }
+  }
+  return op_result::failure;
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::find(const std::string& key, guard_ptr& result) {
+  backoff backoff;
+  for (;;) {
+    auto r = do_find(key, result);
+    if (r != op_result::restart) {
+      return r == op_result::success;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::find_next(const std::string& from, bool inclusive, guard_ptr& result) {
+  backoff backoff;
+  for (;;) {
+    std::uint64_t version;
+    if (_root->version.read_lock(version)) {
+      auto r = do_find_next(*_root, version, 0, from, inclusive, false, result);
+      if (r != op_result::restart) {
+        return r == op_result::success;
+      }
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+template <class Func, class Predicate>
+std::size_t art_map<Key, Value, Policies...>::do_scan(const std::string& from, Predicate&& in_range, Func&& func) {
+  // Every step searches the successor of the previously visited key starting from the root.
+  // This way a concurrent modification only restarts the current step, not the whole scan.
+  std::size_t visited = 0;
+  std::string key = from;
+  bool inclusive = true;
+  guard_ptr current;
+  while (find_next(key, inclusive, current)) {
+    auto* l = static_cast<leaf*>(current.get());
+    if (!in_range(l->bytes)) {
+      break;
+    }
+    ++visited;
+    if constexpr (std::is_void_v<std::invoke_result_t<Func, const value_type&>>) {
+      func(std::as_const(l->value));
+    } else {
+      if (!func(std::as_const(l->value))) {
+        break;
+      }
+    }
+    key = l->bytes;
+    inclusive = false;
+  }
+  return visited;
+}
+
+template <class Key, class Value, class... Policies>
+template <class... Args>
+bool art_map<Key, Value, Policies...>::emplace(const Key& key, Args&&... args) {
+  std::string bytes;
+  key_traits::encode(key, bytes);
+  auto* new_leaf = new leaf(std::move(bytes), key, std::forward<Args>(args)...);
+  backoff backoff;
+  for (;;) {
+    auto r = do_insert(new_leaf);
+    if (r == op_result::success) {
+      return true;
+    }
+    if (r == op_result::failure) {
+      delete new_leaf;
+      return false;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::erase(const Key& key) {
+  std::string bytes;
+  key_traits::encode(key, bytes);
+  backoff backoff;
+  for (;;) {
+    auto r = do_erase(bytes);
+    if (r != op_result::restart) {
+      return r == op_result::success;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::contains(const Key& key) {
+  std::string bytes;
+  key_traits::encode(key, bytes);
+  guard_ptr result;
+  return find(bytes, result);
+}
+
+template <class Key, class Value, class... Policies>
+bool art_map<Key, Value, Policies...>::try_get_value(const Key& key, Value& result) {
+  std::string bytes;
+  key_traits::encode(key, bytes);
+  guard_ptr guard;
+  if (!find(bytes, guard)) {
+    return false;
+  }
+  result = static_cast<leaf*>(guard.get())->value.second;
+  return true;
+}
+
+template <class Key, class Value, class... Policies>
+template <class Func>
+std::size_t art_map<Key, Value, Policies...>::scan(const Key& first, const Key& last, Func&& func) {
+  std::string from;
+  std::string to;
+  key_traits::encode(first, from);
+  key_traits::encode(last, to);
+  return do_scan(
+    from, [&to](const std::string& bytes) { return bytes < to; }, std::forward<Func>(func));
+}
+
+template <class Key, class Value, class... Policies>
+template <class Func, class K, std::enable_if_t<std::is_same_v<K, std::string>, int>>
+std::size_t art_map<Key, Value, Policies...>::scan_prefix(const std::string& prefix, Func&& func) {
+  std::string from;
+  key_traits::encode_prefix(prefix, from);
+  return do_scan(
+    from,
+    [&from](const std::string& bytes) { return bytes.compare(0, from.size(), from) == 0; },
+    std::forward<Func>(func));
+}
+} // namespace xenium
+
+#endif
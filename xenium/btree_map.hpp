@@ -0,0 +1,759 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_BTREE_MAP_HPP
+#define XENIUM_BTREE_MAP_HPP
+
+#include <xenium/backoff.hpp>
+#include <xenium/detail/olc_version.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure the size of the nodes of a `btree_map` in bytes.
+   * @tparam Value
+   */
+  template <std::size_t Value>
+  struct node_size;
+} // namespace policy
+
+/**
+ * @brief A concurrent ordered map based on a B+-tree that is synchronized via optimistic lock
+ * coupling \[[LSH+16](index.html#ref-leis-2016)\].
+ *
+ * All entries are stored in the leaf nodes in sorted order; inner nodes only contain separator
+ * keys. Since every node holds a number of entries in contiguous arrays, lookups touch only a
+ * few cache lines, and range scans copy whole leaves instead of following a pointer per entry.
+ *
+ * Every node has a version counter that is used like the sequence counter of a `seqlock`:
+ * readers never write to shared memory, but validate that the version of a node has not changed
+ * after they have read its content; otherwise they restart the operation. Writers lock the
+ * node they modify (and when splitting a node also its parent). Full inner nodes are split
+ * eagerly on the way down, so a split never has to propagate upwards. A leaf that becomes
+ * empty is removed from its parent and retired via the reclaimer, unless it is the first child
+ * of its parent; inner nodes are never merged.
+ *
+ * Every leaf has a link to its right sibling (as in a B-link tree), which is updated while
+ * the leaf is locked. A range scan follows these links with the same optimistic lock coupling
+ * as a lookup - it reads the sibling's version before it validates the current leaf - and only
+ * descends from the root again if a validation fails.
+ *
+ * Keys and values are read optimistically and are therefore stored as atomics, so both must
+ * be trivially copyable. Ideally they are fixed-width types whose atomics are lock-free (e.g.,
+ * integers or pointers). Keys are compared with `operator<`.
+ *
+ * Since writers lock nodes, the map is not lock-free, but lookups and scans never block
+ * writers. A range scan does not take a snapshot; each leaf is read consistently, but entries
+ * that are inserted or removed concurrently may or may not be visited.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for internal nodes. (**required**)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy that is used when an operation has to restart.
+ *    (*optional*; defaults to `xenium::no_backoff`)
+ *  * `xenium::policy::node_size`<br>
+ *    Defines the (approximate) size of the nodes in bytes, which determines the number of
+ *    entries per node. (*optional*; defaults to 256, i.e., four cache lines)
+ *
+ * @tparam Key the key type; must be trivially copyable.
+ * @tparam Value the mapped type; must be trivially copyable.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class Key, class Value, class... Policies>
+class btree_map {
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+  static constexpr std::size_t node_size =
+    parameter::value_param_t<std::size_t, policy::node_size, 256, Policies...>::value;
+
+  template <class... NewPolicies>
+  using with = btree_map<Key, Value, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+  static_assert(std::is_trivially_copyable_v<Key>, "Key must be trivially copyable");
+  static_assert(std::is_trivially_copyable_v<Value>, "Value must be trivially copyable");
+
+  btree_map();
+  ~btree_map();
+
+  btree_map(const btree_map&) = delete;
+  btree_map(btree_map&&) = delete;
+
+  btree_map& operator=(const btree_map&) = delete;
+  btree_map& operator=(btree_map&&) = delete;
+
+  /**
+   * @brief Inserts a new element into the map if the map doesn't already contain an
+   * element with the same key.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key
+   * @param value
+   * @return `true` if the element was inserted, otherwise `false`
+   */
+  bool emplace(const Key& key, const Value& value);
+
+  /**
+   * @brief Removes the element with the given key from the map, if one exists.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key
+   * @return `true` if an element was removed, otherwise `false`
+   */
+  bool erase(const Key& key);
+
+  /**
+   * @brief Checks whether the map contains an element with the given key.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param key
+   * @return `true` if the map contains such an element, otherwise `false`
+   */
+  [[nodiscard]] bool contains(const Key& key) {
+    Value value{};
+    return try_get_value(key, value);
+  }
+
+  /**
+   * @brief Looks up the element with the given key and copies its value to `result`.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param key
+   * @param result the value of the element if one was found
+   * @return `true` if an element was found, otherwise `false`
+   */
+  [[nodiscard]] bool try_get_value(const Key& key, Value& result);
+
+  /**
+   * @brief Visits all elements with a key in the range `[first, last)` in ascending key order.
+   *
+   * `func` is called with a `const value_type&`. If it returns a value that converts to `false`,
+   * the scan stops. The entries of a leaf are copied to a local buffer before they are passed
+   * to `func`, so `func` does not delay concurrent writers. However, the scan keeps the current
+   * leaf protected while `func` runs, so that it can continue with the leaf's right sibling;
+   * depending on the reclaimer, a long running `func` can therefore delay reclamation.
+   *
+   * Progress guarantees: blocking (only waits for locked nodes to be released)
+   *
+   * @param first inclusive lower bound
+   * @param last exclusive upper bound
+   * @param func
+   * @return the number of visited elements
+   */
+  template <class Func>
+  std::size_t scan(const Key& first, const Key& last, Func&& func);
+
+private:
+  enum class op_result { restart, success, failure };
+
+  struct node : reclaimer::template enable_concurrent_ptr<node> {
+    explicit node(bool is_leaf) : is_leaf(is_leaf) {}
+    const bool is_leaf;
+    detail::olc_version version;
+    std::atomic<std::uint16_t> count{0};
+  };
+
+  using concurrent_ptr = typename reclaimer::template concurrent_ptr<node, 0>;
+  using marked_ptr = typename concurrent_ptr::marked_ptr;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+
+  static constexpr std::size_t node_payload = node_size > sizeof(node) ? node_size - sizeof(node) : 0;
+  static constexpr std::size_t leaf_capacity = (node_payload - std::min(node_payload, sizeof(concurrent_ptr))) /
+                                               (sizeof(std::atomic<Key>) + sizeof(std::atomic<Value>));
+  static constexpr std::size_t inner_capacity = (node_payload - std::min(node_payload, sizeof(concurrent_ptr))) /
+                                                (sizeof(std::atomic<Key>) + sizeof(concurrent_ptr));
+  static_assert(leaf_capacity >= 4 && inner_capacity >= 4, "node_size is too small");
+
+  // Keys and values beyond `count` are never read, so they do not have to be initialized.
+  // `next` is the right sibling, or null for the rightmost leaf and for removed leaves.
+  struct leaf_node : node {
+    leaf_node() : node(true) {}
+    concurrent_ptr next;
+    std::atomic<Key> keys[leaf_capacity];
+    std::atomic<Value> values[leaf_capacity];
+  };
+
+  // Child i contains all keys `k` with `keys[i - 1] < k <= keys[i]`.
+  struct inner_node : node {
+    inner_node() : node(false) {}
+    std::atomic<Key> keys[inner_capacity];
+    concurrent_ptr children[inner_capacity + 1];
+  };
+
+  // The search functions read the keys optimistically, so the result is only meaningful if
+  // the node's version is validated afterwards. The loops are branch free, which lets the
+  // compiler use conditional moves (and is faster than a binary search for small nodes).
+  template <std::size_t Capacity>
+  static unsigned load_count(const node& n) {
+    return std::min<unsigned>(n.count.load(std::memory_order_relaxed), Capacity);
+  }
+  static unsigned lower_bound(const std::atomic<Key>* keys, unsigned count, const Key& key) {
+    unsigned pos = 0;
+    for (unsigned i = 0; i < count; ++i) {
+      pos += keys[i].load(std::memory_order_relaxed) < key ? 1 : 0;
+    }
+    return pos;
+  }
+  static unsigned upper_bound(const std::atomic<Key>* keys, unsigned count, const Key& key) {
+    unsigned pos = 0;
+    for (unsigned i = 0; i < count; ++i) {
+      pos += key < keys[i].load(std::memory_order_relaxed) ? 0 : 1;
+    }
+    return pos;
+  }
+
+  static void destroy(node* n);
+  leaf_node* split_leaf(leaf_node& leaf, Key& separator);
+  inner_node* split_inner(inner_node& inner, Key& separator);
+  void insert_child(inner_node* parent, node* left, const Key& separator, node* right);
+  static void remove_child(inner_node& parent, unsigned idx);
+
+  bool acquire_root(guard_ptr& guard, std::uint64_t& version);
+  op_result do_insert(const Key& key, const Value& value);
+  op_result do_erase(const Key& key);
+  op_result do_find(const Key& key, Value& result);
+  op_result do_read_leaf(
+    const Key& from, bool inclusive, guard_ptr& leaf_guard, std::uint64_t& version, value_type* buffer, unsigned& size);
+  op_result do_read_next_leaf(guard_ptr& leaf_guard, std::uint64_t& version, value_type* buffer, unsigned& size);
+
+  concurrent_ptr _root;
+};
+
+template <class Key, class Value, class... Policies>
+btree_map<Key, Value, Policies...>::btree_map() {
+  _root.store(marked_ptr(new leaf_node()), std::memory_order_relaxed);
+}
+
+template <class Key, class Value, class... Policies>
+btree_map<Key, Value, Policies...>::~btree_map() {
+  // (1) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+  destroy(_root.load(std::memory_order_acquire).get());
+}
+
+template <class Key, class Value, class... Policies>
+void btree_map<Key, Value, Policies...>::destroy(node* n) {
+  if (!n->is_leaf) {
+    auto& inner = static_cast<inner_node&>(*n);
+    auto cnt = load_count<inner_capacity>(inner);
+    for (unsigned i = 0; i <= cnt; ++i) {
+      // (2) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+      destroy(inner.children[i].load(std::memory_order_acquire).get());
+    }
+  }
+  delete n;
+}
+
+// Moves the upper half of the leaf's entries to a new leaf. The leaf must be locked.
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::split_leaf(leaf_node& leaf, Key& separator) -> leaf_node* {
+  auto cnt = load_count<leaf_capacity>(leaf);
+  auto mid = cnt / 2;
+  auto* right = new leaf_node();
+  for (unsigned i = mid; i < cnt; ++i) {
+    right->keys[i - mid].store(leaf.keys[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    right->values[i - mid].store(leaf.values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  right->count.store(static_cast<std::uint16_t>(cnt - mid), std::memory_order_relaxed);
+  right->next.store(leaf.next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  leaf.count.store(static_cast<std::uint16_t>(mid), std::memory_order_relaxed);
+  // (8) - this release-store synchronizes-with the acquire-load (9)
+  leaf.next.store(marked_ptr(right), std::memory_order_release);
+  separator = leaf.keys[mid - 1].load(std::memory_order_relaxed);
+  return right;
+}
+
+// Moves the upper half of the inner node's children to a new inner node; the middle key is
+// moved up to the parent. The inner node must be locked.
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::split_inner(inner_node& inner, Key& separator) -> inner_node* {
+  auto cnt = load_count<inner_capacity>(inner);
+  auto mid = cnt / 2;
+  auto* right = new inner_node();
+  for (unsigned i = mid + 1; i < cnt; ++i) {
+    right->keys[i - mid - 1].store(inner.keys[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  for (unsigned i = mid + 1; i <= cnt; ++i) {
+    right->children[i - mid - 1].store(inner.children[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  right->count.store(static_cast<std::uint16_t>(cnt - mid - 1), std::memory_order_relaxed);
+  inner.count.store(static_cast<std::uint16_t>(mid), std::memory_order_relaxed);
+  separator = inner.keys[mid].load(std::memory_order_relaxed);
+  return right;
+}
+
+// Adds the new right sibling of `left` to the parent, or creates a new root if `left` is the
+// root. The parent (or the root) must be locked.
+template <class Key, class Value, class... Policies>
+void btree_map<Key, Value, Policies...>::insert_child(inner_node* parent,
+                                                      node* left,
+                                                      const Key& separator,
+                                                      node* right) {
+  if (parent == nullptr) {
+    auto* root = new inner_node();
+    root->keys[0].store(separator, std::memory_order_relaxed);
+    root->children[0].store(marked_ptr(left), std::memory_order_relaxed);
+    root->children[1].store(marked_ptr(right), std::memory_order_relaxed);
+    root->count.store(1, std::memory_order_relaxed);
+    // (3) - this release-store synchronizes-with the acquire-loads (1, 2, 6, 7)
+    _root.store(marked_ptr(root), std::memory_order_release);
+    return;
+  }
+
+  auto cnt = load_count<inner_capacity>(*parent);
+  assert(cnt < inner_capacity);
+  auto pos = lower_bound(parent->keys, cnt, separator);
+  for (unsigned i = cnt; i > pos; --i) {
+    parent->keys[i].store(parent->keys[i - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    // (4) - this release-store synchronizes-with the acquire-loads (1, 2, 6, 7)
+    parent->children[i + 1].store(parent->children[i].load(std::memory_order_relaxed), std::memory_order_release);
+  }
+  parent->keys[pos].store(separator, std::memory_order_relaxed);
+  // (5) - this release-store synchronizes-with the acquire-loads (1, 2, 6, 7)
+  parent->children[pos + 1].store(marked_ptr(right), std::memory_order_release);
+  parent->count.store(static_cast<std::uint16_t>(cnt + 1), std::memory_order_relaxed);
+}
+
+// Removes the child at index `idx` together with its lower separator, so its key range is taken
+// over by its left sibling. The parent must be locked and `idx` must be greater than zero.
+template <class Key, class Value, class... Policies>
+void btree_map<Key, Value, Policies...>::remove_child(inner_node& parent, unsigned idx) {
+  auto cnt = load_count<inner_capacity>(parent);
+  assert(idx > 0 && idx <= cnt);
+  for (unsigned i = idx - 1; i + 1 < cnt; ++i) {
+    parent.keys[i].store(parent.keys[i + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  for (unsigned i = idx; i < cnt; ++i) {
+    // (4) - this release-store synchronizes-with the acquire-loads (1, 2, 6, 7)
+    parent.children[i].store(parent.children[i + 1].load(std::memory_order_relaxed), std::memory_order_release);
+  }
+  parent.count.store(static_cast<std::uint16_t>(cnt - 1), std::memory_order_relaxed);
+}
+
+template <class Key, class Value, class... Policies>
+bool btree_map<Key, Value, Policies...>::acquire_root(guard_ptr& guard, std::uint64_t& version) {
+  // (6) - this acquire-load synchronizes-with the release-store (3)
+  guard.acquire(_root, std::memory_order_acquire);
+  if (!guard->version.read_lock(version)) {
+    return false;
+  }
+  // The root is only replaced while the old root is locked, so if the root has not changed
+  // yet, it cannot change until the version of the old root changes.
+  return _root.load(std::memory_order_relaxed).get() == guard.get();
+}
+
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::do_insert(const Key& key, const Value& value) -> op_result {
+  guard_ptr parent_guard;
+  guard_ptr node_guard;
+  guard_ptr child_guard;
+  inner_node* parent = nullptr;
+  std::uint64_t parent_version = 0;
+  std::uint64_t version;
+  if (!acquire_root(node_guard, version)) {
+    return op_result::restart;
+  }
+
+  while (!node_guard->is_leaf) {
+    auto& inner = static_cast<inner_node&>(*node_guard);
+    auto cnt = load_count<inner_capacity>(inner);
+    if (cnt == inner_capacity) {
+      // Split full inner nodes eagerly, so that there is always room for a new separator in
+      // the parent of the leaf. We restart afterwards to keep things simple.
+      if (parent != nullptr && !parent->version.try_upgrade(parent_version)) {
+        return op_result::restart;
+      }
+      if (!inner.version.try_upgrade(version)) {
+        if (parent != nullptr) {
+          parent->version.unlock();
+        }
+        return op_result::restart;
+      }
+      Key separator{};
+      auto* right = split_inner(inner, separator);
+      insert_child(parent, &inner, separator, right);
+      inner.version.unlock();
+      if (parent != nullptr) {
+        parent->version.unlock();
+      }
+      return op_result::restart;
+    }
+
+    auto idx = lower_bound(inner.keys, cnt, key);
+    // (7) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+    child_guard.acquire(inner.children[idx], std::memory_order_acquire);
+    // The parent has to be validated _after_ reading the child's version, since otherwise
+    // the child could have been split in between, so it might no longer cover our key.
+    std::uint64_t child_version;
+    if (!child_guard->version.read_lock(child_version) || !inner.version.validate(version)) {
+      return op_result::restart;
+    }
+
+    parent_guard = std::move(node_guard);
+    parent = &inner;
+    parent_version = version;
+    node_guard = std::move(child_guard);
+    version = child_version;
+  }
+
+  auto& leaf = static_cast<leaf_node&>(*node_guard);
+  auto cnt = load_count<leaf_capacity>(leaf);
+  auto pos = lower_bound(leaf.keys, cnt, key);
+  bool exists = pos < cnt && !(key < leaf.keys[pos].load(std::memory_order_relaxed));
+  if (!leaf.version.validate(version)) {
+    return op_result::restart;
+  }
+  if (exists) {
+    return op_result::failure;
+  }
+
+  if (cnt == leaf_capacity) {
+    if (parent != nullptr && !parent->version.try_upgrade(parent_version)) {
+      return op_result::restart;
+    }
+    if (!leaf.version.try_upgrade(version)) {
+      if (parent != nullptr) {
+        parent->version.unlock();
+      }
+      return op_result::restart;
+    }
+    Key separator{};
+    auto* right = split_leaf(leaf, separator);
+    insert_child(parent, &leaf, separator, right);
+    leaf.version.unlock();
+    if (parent != nullptr) {
+      parent->version.unlock();
+    }
+    return op_result::restart;
+  }
+
+  if (!leaf.version.try_upgrade(version)) {
+    return op_result::restart;
+  }
+  for (unsigned i = cnt; i > pos; --i) {
+    leaf.keys[i].store(leaf.keys[i - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    leaf.values[i].store(leaf.values[i - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  leaf.keys[pos].store(key, std::memory_order_relaxed);
+  leaf.values[pos].store(value, std::memory_order_relaxed);
+  leaf.count.store(static_cast<std::uint16_t>(cnt + 1), std::memory_order_relaxed);
+  leaf.version.unlock();
+  return op_result::success;
+}
+
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::do_erase(const Key& key) -> op_result {
+  guard_ptr parent_guard;
+  guard_ptr node_guard;
+  guard_ptr child_guard;
+  inner_node* parent = nullptr;
+  std::uint64_t parent_version = 0;
+  unsigned parent_idx = 0;
+  std::uint64_t version;
+  if (!acquire_root(node_guard, version)) {
+    return op_result::restart;
+  }
+
+  while (!node_guard->is_leaf) {
+    auto& inner = static_cast<inner_node&>(*node_guard);
+    auto idx = lower_bound(inner.keys, load_count<inner_capacity>(inner), key);
+    // (7) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+    child_guard.acquire(inner.children[idx], std::memory_order_acquire);
+    // The parent has to be validated _after_ reading the child's version, since otherwise
+    // the child could have been split in between, so it might no longer cover our key.
+    std::uint64_t child_version;
+    if (!child_guard->version.read_lock(child_version) || !inner.version.validate(version)) {
+      return op_result::restart;
+    }
+
+    parent_guard = std::move(node_guard);
+    parent = &inner;
+    parent_version = version;
+    parent_idx = idx;
+    node_guard = std::move(child_guard);
+    version = child_version;
+  }
+
+  auto& leaf = static_cast<leaf_node&>(*node_guard);
+  auto cnt = load_count<leaf_capacity>(leaf);
+  auto pos = lower_bound(leaf.keys, cnt, key);
+  bool exists = pos < cnt && !(key < leaf.keys[pos].load(std::memory_order_relaxed));
+  // The first child of a parent is never removed, since its left sibling (whose link would have
+  // to be updated) belongs to a different parent.
+  bool remove_leaf = cnt == 1 && parent != nullptr && parent_idx > 0;
+  if (!leaf.version.validate(version)) {
+    return op_result::restart;
+  }
+  if (!exists) {
+    return op_result::failure;
+  }
+
+  if (remove_leaf) {
+    // The leaf would become empty, so we remove it from its parent instead. The left sibling
+    // has to be locked as well, since its link has to be redirected to the leaf's successor.
+    if (!parent->version.try_upgrade(parent_version)) {
+      return op_result::restart;
+    }
+    // (7) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+    child_guard.acquire(parent->children[parent_idx - 1], std::memory_order_acquire);
+    auto& left = static_cast<leaf_node&>(*child_guard);
+    std::uint64_t left_version;
+    if (!left.version.read_lock(left_version) || !left.version.try_upgrade(left_version)) {
+      parent->version.unlock();
+      return op_result::restart;
+    }
+    if (!leaf.version.try_upgrade(version)) {
+      left.version.unlock();
+      parent->version.unlock();
+      return op_result::restart;
+    }
+    // (8) - this release-store synchronizes-with the acquire-load (9)
+    left.next.store(leaf.next.load(std::memory_order_relaxed), std::memory_order_release);
+    // Clearing the link ensures that a scan cannot acquire the successor via the removed leaf
+    // after the successor has been removed and retired as well.
+    leaf.next.store(nullptr, std::memory_order_relaxed);
+    remove_child(*parent, parent_idx);
+    leaf.version.unlock_obsolete();
+    left.version.unlock();
+    parent->version.unlock();
+    node_guard.reclaim();
+    return op_result::success;
+  }
+
+  if (!leaf.version.try_upgrade(version)) {
+    return op_result::restart;
+  }
+  for (unsigned i = pos; i + 1 < cnt; ++i) {
+    leaf.keys[i].store(leaf.keys[i + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    leaf.values[i].store(leaf.values[i + 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  leaf.count.store(static_cast<std::uint16_t>(cnt - 1), std::memory_order_relaxed);
+  leaf.version.unlock();
+  return op_result::success;
+}
+
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::do_find(const Key& key, Value& result) -> op_result {
+  guard_ptr node_guard;
+  guard_ptr child_guard;
+  std::uint64_t version;
+  if (!acquire_root(node_guard, version)) {
+    return op_result::restart;
+  }
+
+  while (!node_guard->is_leaf) {
+    auto& inner = static_cast<inner_node&>(*node_guard);
+    auto idx = lower_bound(inner.keys, load_count<inner_capacity>(inner), key);
+    // (7) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+    child_guard.acquire(inner.children[idx], std::memory_order_acquire);
+    // The parent has to be validated _after_ reading the child's version, since otherwise
+    // the child could have been split in between, so it might no longer cover our key.
+    std::uint64_t child_version;
+    if (!child_guard->version.read_lock(child_version) || !inner.version.validate(version)) {
+      return op_result::restart;
+    }
+    node_guard = std::move(child_guard);
+    version = child_version;
+  }
+
+  auto& leaf = static_cast<leaf_node&>(*node_guard);
+  auto cnt = load_count<leaf_capacity>(leaf);
+  auto pos = lower_bound(leaf.keys, cnt, key);
+  bool exists = pos < cnt && !(key < leaf.keys[pos].load(std::memory_order_relaxed));
+  Value value{};
+  if (exists) {
+    value = leaf.values[pos].load(std::memory_order_relaxed);
+  }
+  if (!leaf.version.validate(version)) {
+    return op_result::restart;
+  }
+  if (!exists) {
+    return op_result::failure;
+  }
+  result = value;
+  return op_result::success;
+}
+
+// Descends to the leaf that contains `from` (or its successor, if `inclusive` is false) and
+// copies all of its entries that are greater than (or equal to) `from` to `buffer`. On success
+// `leaf_guard` holds the leaf and `version` is the leaf's validated version.
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::do_read_leaf(const Key& from,
+                                                      bool inclusive,
+                                                      guard_ptr& leaf_guard,
+                                                      std::uint64_t& version,
+                                                      value_type* buffer,
+                                                      unsigned& size) -> op_result {
+  guard_ptr child_guard;
+  if (!acquire_root(leaf_guard, version)) {
+    return op_result::restart;
+  }
+
+  while (!leaf_guard->is_leaf) {
+    auto& inner = static_cast<inner_node&>(*leaf_guard);
+    auto cnt = load_count<inner_capacity>(inner);
+    auto idx = inclusive ? lower_bound(inner.keys, cnt, from) : upper_bound(inner.keys, cnt, from);
+    // (7) - this acquire-load synchronizes-with the release-stores (3, 4, 5)
+    child_guard.acquire(inner.children[idx], std::memory_order_acquire);
+    // The parent has to be validated _after_ reading the child's version, since otherwise
+    // the child could have been split in between, so it might no longer cover our key.
+    std::uint64_t child_version;
+    if (!child_guard->version.read_lock(child_version) || !inner.version.validate(version)) {
+      return op_result::restart;
+    }
+    leaf_guard = std::move(child_guard);
+    version = child_version;
+  }
+
+  auto& leaf = static_cast<leaf_node&>(*leaf_guard);
+  auto cnt = load_count<leaf_capacity>(leaf);
+  auto start = inclusive ? lower_bound(leaf.keys, cnt, from) : upper_bound(leaf.keys, cnt, from);
+  for (unsigned i = start; i < cnt; ++i) {
+    buffer[i - start].first = leaf.keys[i].load(std::memory_order_relaxed);
+    buffer[i - start].second = leaf.values[i].load(std::memory_order_relaxed);
+  }
+  if (!leaf.version.validate(version)) {
+    return op_result::restart;
+  }
+  size = cnt - start;
+  return op_result::success;
+}
+
+// Moves from the leaf in `leaf_guard` (whose content has been read at the given `version`) to
+// its right sibling and copies all of the sibling's entries to `buffer`. Fails if the leaf is
+// the rightmost leaf.
+template <class Key, class Value, class... Policies>
+auto btree_map<Key, Value, Policies...>::do_read_next_leaf(guard_ptr& leaf_guard,
+                                                           std::uint64_t& version,
+                                                           value_type* buffer,
+                                                           unsigned& size) -> op_result {
+  auto& leaf = static_cast<leaf_node&>(*leaf_guard);
+  guard_ptr next_guard;
+  // (9) - this acquire-load synchronizes-with the release-stores (8)
+  next_guard.acquire(leaf.next, std::memory_order_acquire);
+  if (next_guard == nullptr) {
+    return leaf.version.validate(version) ? op_result::failure : op_result::restart;
+  }
+  // As when descending, the leaf has to be validated _after_ reading the sibling's version,
+  // since otherwise the sibling could have been split or removed in between.
+  std::uint64_t next_version;
+  if (!next_guard->version.read_lock(next_version) || !leaf.version.validate(version)) {
+    return op_result::restart;
+  }
+
+  auto& next = static_cast<leaf_node&>(*next_guard);
+  auto cnt = load_count<leaf_capacity>(next);
+  for (unsigned i = 0; i < cnt; ++i) {
+    buffer[i].first = next.keys[i].load(std::memory_order_relaxed);
+    buffer[i].second = next.values[i].load(std::memory_order_relaxed);
+  }
+  if (!next.version.validate(next_version)) {
+    return op_result::restart;
+  }
+  leaf_guard = std::move(next_guard);
+  version = next_version;
+  size = cnt;
+  return op_result::success;
+}
+
+template <class Key, class Value, class... Policies>
+bool btree_map<Key, Value, Policies...>::emplace(const Key& key, const Value& value) {
+  backoff backoff;
+  for (;;) {
+    auto r = do_insert(key, value);
+    if (r != op_result::restart) {
+      return r == op_result::success;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool btree_map<Key, Value, Policies...>::erase(const Key& key) {
+  backoff backoff;
+  for (;;) {
+    auto r = do_erase(key);
+    if (r != op_result::restart) {
+      return r == op_result::success;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool btree_map<Key, Value, Policies...>::try_get_value(const Key& key, Value& result) {
+  backoff backoff;
+  for (;;) {
+    auto r = do_find(key, result);
+    if (r != op_result::restart) {
+      return r == op_result::success;
+    }
+    backoff();
+  }
+}
+
+template <class Key, class Value, class... Policies>
+template <class Func>
+std::size_t btree_map<Key, Value, Policies...>::scan(const Key& first, const Key& last, Func&& func) {
+  std::size_t visited = 0;
+  value_type buffer[leaf_capacity];
+  guard_ptr leaf_guard;
+  std::uint64_t version = 0;
+  // the position to continue from if we have to descend from the root again
+  Key from = first;
+  bool inclusive = true;
+  for (;;) {
+    unsigned size = 0;
+    auto r = leaf_guard == nullptr ? op_result::restart : do_read_next_leaf(leaf_guard, version, buffer, size);
+    if (r == op_result::failure) {
+      return visited;
+    }
+    if (r == op_result::restart) {
+      backoff backoff;
+      while (do_read_leaf(from, inclusive, leaf_guard, version, buffer, size) == op_result::restart) {
+        backoff();
+      }
+    }
+
+    for (unsigned i = 0; i < size; ++i) {
+      if (!(buffer[i].first < last)) {
+        return visited;
+      }
+      ++visited;
+      if constexpr (std::is_void_v<std::invoke_result_t<Func, const value_type&>>) {
+        func(std::as_const(buffer[i]));
+      } else {
+        if (!func(std::as_const(buffer[i]))) {
+          return visited;
+        }
+      }
+    }
+    if (size > 0) {
+      from = buffer[size - 1].first;
+      inclusive = false;
+    }
+  }
+}
+} // namespace xenium
+
+#endif
@@ -0,0 +1,482 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_CHANNEL_HPP
+#define XENIUM_CHANNEL_HPP
+
+#include <xenium/nikolaev_bounded_queue.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+  #if __has_include(<coroutine>)
+    #include <coroutine>
+    #define XENIUM_HAS_COROUTINES
+  #endif
+#endif
+
+namespace xenium {
+/**
+ * @brief A bounded multi-producer/multi-consumer channel on top of a bounded queue that
+ * allows producers and consumers to wait asynchronously instead of spinning.
+ *
+ * Operations that cannot complete immediately (i.e., a pop on an empty channel or a push
+ * on a full one) register a waiter in one of two lock-free lists - one for waiting consumers,
+ * one for waiting producers. Every successful push (pop) notifies all waiting consumers
+ * (producers) by handing their continuations to the user-supplied executor; resumed
+ * operations simply retry, and register again if they lose the race. Waiting operations
+ * therefore occupy no thread and do not spin.
+ *
+ * The executor is a callable that accepts a `std::function<void()>` and eventually runs it;
+ * it must not run the function inline. Continuations of operations that can complete
+ * immediately are _not_ passed to the executor.
+ *
+ * If the compiler supports C++20 coroutines, `pop()` and `push(value)` return awaitables,
+ * i.e., a coroutine can simply `co_await ch.pop()` or `co_await ch.push(v)`. Independent of
+ * that, `async_pop` and `async_push` provide the same functionality via callbacks.
+ *
+ * A channel can be closed via `close`; afterwards all push operations fail, and pop operations
+ * return `std::nullopt` once all remaining elements have been consumed.
+ *
+ * All operations must have completed before the channel is destroyed.
+ *
+ * Supported policies:
+ *  * `xenium::policy::container`<br>
+ *    Defines the underlying queue. The queue must provide `try_push` overloads that leave
+ *    their argument untouched if they fail, a `pop` operation that returns an `std::optional`,
+ *    as well as `close`, `is_closed` and `is_drained`.
+ *    (*optional*; defaults to `xenium::nikolaev_bounded_queue<T>`)
+ *
+ * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class channel {
+public:
+  using value_type = T;
+  using queue = parameter::type_param_t<policy::container, nikolaev_bounded_queue<T>, Policies...>;
+  using executor_type = std::function<void(std::function<void()>)>;
+
+  template <class... NewPolicies>
+  using with = channel<T, NewPolicies..., Policies...>;
+
+  static_assert(std::is_same_v<typename queue::value_type, T>, "the queue's value_type must be T");
+
+  /**
+   * @brief Constructs a new channel.
+   * @param capacity the capacity of the underlying queue.
+   * @param executor the executor that runs the continuations of waiting operations.
+   */
+  channel(std::size_t capacity, executor_type executor);
+  ~channel();
+
+  channel(const channel&) = delete;
+  channel(channel&&) = delete;
+
+  channel& operator=(const channel&) = delete;
+  channel& operator=(channel&&) = delete;
+
+  /**
+   * @brief Tries to push a new element to the channel.
+   *
+   * The element is only moved from if the operation is successful.
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(T&& value);
+
+  /**
+   * @brief Tries to push a copy of the given element to the channel.
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(const T& value);
+
+  /**
+   * @brief Tries to pop an element from the channel.
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T& result);
+
+  /**
+   * @brief Pops an element from the channel and passes it to `callback`.
+   *
+   * `callback` is invoked with an `std::optional<T>`; it is empty if the channel has been
+   * closed and drained. If an element is available immediately, `callback` is invoked
+   * inline, otherwise it is run by the executor once an element becomes available.
+   *
+   * @param callback
+   */
+  template <class Callback>
+  void async_pop(Callback&& callback);
+
+  /**
+   * @brief Pushes `value` to the channel and passes the result to `callback`.
+   *
+   * `callback` is invoked with `true` if the element has been pushed, or `false` if the
+   * channel has been closed. If the element can be pushed immediately, `callback` is invoked
+   * inline, otherwise it is run by the executor once there is space in the channel.
+   *
+   * @param value
+   * @param callback
+   */
+  template <class Callback>
+  void async_push(T value, Callback&& callback);
+
+  /**
+   * @brief Closes the channel and notifies all waiting operations.
+   *
+   * All subsequent push operations fail; pop operations return the remaining elements.
+   */
+  void close();
+
+  /**
+   * @brief Returns `true` if the channel has been closed.
+   */
+  [[nodiscard]] bool is_closed() const noexcept { return _queue.is_closed(); }
+
+  /**
+   * @brief Returns `true` if the channel has been closed and all elements have been popped.
+   */
+  [[nodiscard]] bool is_drained() const noexcept { return _queue.is_drained(); }
+
+#ifdef XENIUM_HAS_COROUTINES
+  class pop_awaiter;
+  class push_awaiter;
+
+  /**
+   * @brief Returns an awaitable that pops an element from the channel.
+   *
+   * The result of the `co_await` expression is an `std::optional<T>` that is empty if the
+   * channel has been closed and drained.
+   */
+  [[nodiscard]] pop_awaiter pop() noexcept { return pop_awaiter(*this); }
+
+  /**
+   * @brief Returns an awaitable that pushes `value` to the channel.
+   *
+   * The result of the `co_await` expression is `false` if the channel has been closed.
+   */
+  [[nodiscard]] push_awaiter push(T value) { return push_awaiter(*this, std::move(value)); }
+#endif
+
+private:
+  struct operation {
+    using func_t = void (*)(operation&);
+    operation(channel& ch, func_t resume, func_t complete) : ch(ch), resume(resume), complete(complete) {}
+    channel& ch;
+    // called by the task that is passed to the executor
+    func_t resume;
+    // called once the operation has its result
+    func_t complete;
+    bool has_result = false;
+  };
+
+  struct pop_operation : operation {
+    pop_operation(channel& ch, typename operation::func_t complete) :
+        operation(ch, &channel::resume_operation<pop_operation>, complete) {}
+    std::optional<T> result;
+  };
+
+  struct push_operation : operation {
+    push_operation(channel& ch, T&& value, typename operation::func_t complete) :
+        operation(ch, &channel::resume_operation<push_operation>, complete),
+        value(std::move(value)) {}
+    T value;
+    bool result = false;
+  };
+
+  // A waiter is shared between the list (i.e., the notifying thread) and the operation that
+  // registered it; both release their reference once they are done with it. The operation is
+  // only resumed via the executor after both, the operation and the notifier, have decremented
+  // `pending`, so the operation's state is never accessed concurrently.
+  struct waiter {
+    explicit waiter(operation* op) : op(op) {}
+    std::atomic<unsigned> refs{2};
+    std::atomic<unsigned> pending{2};
+    std::atomic<unsigned> state{waiting};
+    waiter* next = nullptr;
+    operation* op;
+  };
+
+  static constexpr unsigned waiting = 0;
+  static constexpr unsigned notified = 1;
+  static constexpr unsigned cancelled = 2;
+
+  bool try_complete(pop_operation& op);
+  bool try_complete(push_operation& op);
+  std::atomic<waiter*>& waiters_for(pop_operation&) noexcept { return _pop_waiters; }
+  std::atomic<waiter*>& waiters_for(push_operation&) noexcept { return _push_waiters; }
+
+  template <class Op>
+  bool start(Op& op);
+  template <class Op>
+  static void resume_operation(operation& op);
+
+  void schedule(operation* op);
+  void notify_all(std::atomic<waiter*>& list);
+  static void release(waiter* w) noexcept;
+
+  queue _queue;
+  executor_type _executor;
+  alignas(64) std::atomic<waiter*> _pop_waiters{nullptr};
+  alignas(64) std::atomic<waiter*> _push_waiters{nullptr};
+};
+
+template <class T, class... Policies>
+channel<T, Policies...>::channel(std::size_t capacity, executor_type executor) :
+    _queue(capacity),
+    _executor(std::move(executor)) {}
+
+template <class T, class... Policies>
+channel<T, Policies...>::~channel() {
+  // only cancelled waiters can be left in the lists
+  for (auto list : {&_pop_waiters, &_push_waiters}) {
+    auto w = list->load(std::memory_order_acquire);
+    while (w != nullptr) {
+      auto next = w->next;
+      assert(w->state.load(std::memory_order_relaxed) == cancelled);
+      release(w);
+      w = next;
+    }
+  }
+}
+
+template <class T, class... Policies>
+bool channel<T, Policies...>::try_push(T&& value) {
+  if (!_queue.try_push(std::move(value))) {
+    return false;
+  }
+  notify_all(_pop_waiters);
+  return true;
+}
+
+template <class T, class... Policies>
+bool channel<T, Policies...>::try_push(const T& value) {
+  if (!_queue.try_push(value)) {
+    return false;
+  }
+  notify_all(_pop_waiters);
+  return true;
+}
+
+template <class T, class... Policies>
+bool channel<T, Policies...>::try_pop(T& result) {
+  if (!_queue.try_pop(result)) {
+    return false;
+  }
+  notify_all(_push_waiters);
+  return true;
+}
+
+template <class T, class... Policies>
+void channel<T, Policies...>::close() {
+  _queue.close();
+  notify_all(_pop_waiters);
+  notify_all(_push_waiters);
+}
+
+template <class T, class... Policies>
+template <class Callback>
+void channel<T, Policies...>::async_pop(Callback&& callback) {
+  struct callback_operation : pop_operation {
+    callback_operation(channel& ch, Callback&& cb) :
+        pop_operation(ch, &callback_operation::complete_and_delete),
+        callback(std::forward<Callback>(cb)) {}
+    static void complete_and_delete(operation& op) {
+      auto self = static_cast<callback_operation*>(&op);
+      self->callback(std::move(self->result));
+      delete self;
+    }
+    std::decay_t<Callback> callback;
+  };
+
+  auto op = new callback_operation(*this, std::forward<Callback>(callback));
+  if (try_complete(*op) || start(*op)) {
+    callback_operation::complete_and_delete(*op);
+  }
+}
+
+template <class T, class... Policies>
+template <class Callback>
+void channel<T, Policies...>::async_push(T value, Callback&& callback) {
+  struct callback_operation : push_operation {
+    callback_operation(channel& ch, T&& value, Callback&& cb) :
+        push_operation(ch, std::move(value), &callback_operation::complete_and_delete),
+        callback(std::forward<Callback>(cb)) {}
+    static void complete_and_delete(operation& op) {
+      auto self = static_cast<callback_operation*>(&op);
+      self->callback(self->result);
+      delete self;
+    }
+    std::decay_t<Callback> callback;
+  };
+
+  auto op = new callback_operation(*this, std::move(value), std::forward<Callback>(callback));
+  if (try_complete(*op) || start(*op)) {
+    callback_operation::complete_and_delete(*op);
+  }
+}
+
+template <class T, class... Policies>
+bool channel<T, Policies...>::try_complete(pop_operation& op) {
+  op.result = _queue.pop();
+  if (op.result.has_value()) {
+    notify_all(_push_waiters);
+    return true;
+  }
+  return _queue.is_drained();
+}
+
+template <class T, class... Policies>
+bool channel<T, Policies...>::try_complete(push_operation& op) {
+  if (_queue.try_push(std::move(op.value))) {
+    op.result = true;
+    notify_all(_pop_waiters);
+    return true;
+  }
+  if (_queue.is_closed()) {
+    op.result = false;
+    return true;
+  }
+  return false;
+}
+
+template <class T, class... Policies>
+template <class Op>
+bool channel<T, Policies...>::start(Op& op) {
+  auto& list = waiters_for(op);
+  for (;;) {
+    auto w = new waiter(&op);
+    w->next = list.load(std::memory_order_relaxed);
+    // (1) - this acq_rel-CAS synchronizes-with the acq_rel-exchange (2). Both operations are
+    // RMW operations on the same list, so either the other thread's exchange takes our waiter,
+    // or our CAS reads from that exchange and we are guaranteed to see the other thread's
+    // element (or space) in the subsequent retry.
+    while (!list.compare_exchange_weak(w->next, w, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+
+    bool done = try_complete(op);
+    if (done) {
+      unsigned expected = waiting;
+      if (w->state.compare_exchange_strong(expected, cancelled, std::memory_order_relaxed)) {
+        release(w);
+        return true;
+      }
+      // some thread has already notified this waiter - since it will only schedule the
+      // operation once we have decremented `pending`, we can safely store our result.
+    }
+    op.has_result = done;
+    // (3) - this acq_rel-fetch_sub synchronizes-with the acq_rel-fetch_sub (4)
+    bool was_notified = w->pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    release(w);
+    if (!was_notified) {
+      // the notifying thread will schedule the operation
+      return false;
+    }
+    if (done) {
+      return true;
+    }
+    // we have been notified, but some other thread was faster - register again
+  }
+}
+
+template <class T, class... Policies>
+template <class Op>
+void channel<T, Policies...>::resume_operation(operation& base) {
+  auto& op = static_cast<Op&>(base);
+  if (op.has_result || op.ch.start(op)) {
+    op.complete(op);
+  }
+}
+
+template <class T, class... Policies>
+void channel<T, Policies...>::schedule(operation* op) {
+  _executor([op]() { op->resume(*op); });
+}
+
+template <class T, class... Policies>
+void channel<T, Policies...>::notify_all(std::atomic<waiter*>& list) {
+  // (2) - this acq_rel-exchange synchronizes-with the acq_rel-CAS (1)
+  auto w = list.exchange(nullptr, std::memory_order_acq_rel);
+  while (w != nullptr) {
+    auto next = w->next;
+    unsigned expected = waiting;
+    if (w->state.compare_exchange_strong(expected, notified, std::memory_order_relaxed)) {
+      // (4) - this acq_rel-fetch_sub synchronizes-with the acq_rel-fetch_sub (3)
+      if (w->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(w->op);
+      }
+    }
+    release(w);
+    w = next;
+  }
+}
+
+template <class T, class... Policies>
+void channel<T, Policies...>::release(waiter* w) noexcept {
+  if (w->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete w;
+  }
+}
+
+#ifdef XENIUM_HAS_COROUTINES
+/**
+ * @brief The awaitable returned by `channel::pop`.
+ */
+template <class T, class... Policies>
+class channel<T, Policies...>::pop_awaiter : private channel<T, Policies...>::pop_operation {
+public:
+  explicit pop_awaiter(channel& ch) noexcept : pop_operation(ch, &pop_awaiter::resume_coroutine) {}
+
+  bool await_ready() { return this->ch.try_complete(*this); }
+  bool await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    // after start has returned false, this awaiter may already be gone
+    return !this->ch.start(static_cast<pop_operation&>(*this));
+  }
+  std::optional<T> await_resume() { return std::move(this->result); }
+
+private:
+  static void resume_coroutine(operation& op) { static_cast<pop_awaiter&>(op)._handle.resume(); }
+  std::coroutine_handle<> _handle;
+};
+
+/**
+ * @brief The awaitable returned by `channel::push`.
+ */
+template <class T, class... Policies>
+class channel<T, Policies...>::push_awaiter : private channel<T, Policies...>::push_operation {
+public:
+  push_awaiter(channel& ch, T&& value) : push_operation(ch, std::move(value), &push_awaiter::resume_coroutine) {}
+
+  bool await_ready() { return this->ch.try_complete(*this); }
+  bool await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    // after start has returned false, this awaiter may already be gone
+    return !this->ch.start(static_cast<push_operation&>(*this));
+  }
+  bool await_resume() noexcept { return this->result; }
+
+private:
+  static void resume_coroutine(operation& op) { static_cast<push_awaiter&>(op)._handle.resume(); }
+  std::coroutine_handle<> _handle;
+};
+#endif
+} // namespace xenium
+
+#endif
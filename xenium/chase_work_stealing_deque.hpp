@@ -6,6 +6,7 @@
 #ifndef XENIUM_CHASE_WORK_STEALING_DEQUE_HPP
 #define XENIUM_CHASE_WORK_STEALING_DEQUE_HPP
 
+#include <xenium/detail/atomic_inline_value.hpp>
 #include <xenium/detail/fixed_size_circular_array.hpp>
 #include <xenium/detail/growing_circular_array.hpp>
 #include <xenium/parameter.hpp>
@@ -13,8 +14,24 @@
 
 #include <atomic>
 #include <cassert>
+#include <type_traits>
 
 namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure whether `chase_work_stealing_deque` stores values of
+   * type `T` directly instead of pointers to `T`.
+   *
+   * This is only supported for trivially copyable types of at most 16 bytes
+   * (e.g., small task descriptors), which can then be pushed without any heap allocation.
+   *
+   * @tparam Value
+   */
+  template <bool Value>
+  struct store_inline;
+} // namespace policy
+
 /**
  * @brief A lock-free work stealing deque.
  *
@@ -31,16 +48,27 @@ namespace xenium {
  *    * `xenium::detail::fixed_size_circular_array`
  *    * `xenium::detail::growing_circular_array`
  *
+ *    If `store_inline` is set, the element type of the container must be `xenium::detail::inline_value<T>`.
+ *  * `xenium::policy::store_inline`<br>
+ *    If true, values of type `T` are stored directly in the deque and `value_type` is `T`;
+ *    otherwise the deque stores pointers and `value_type` is `T*`. `T` must be a trivially
+ *    copyable type of at most 16 bytes. (*optional*; defaults to false)
+ *
  * @tparam T
  * @tparam Policies
  */
 template <class T, class... Policies>
 struct chase_work_stealing_deque {
-  using value_type = T*;
+  static constexpr bool store_inline = parameter::value_param_t<bool, policy::store_inline, false, Policies...>::value;
+  using element_type = std::conditional_t<store_inline, detail::inline_value<T>, T>;
+  using value_type = typename detail::circular_array_slot<element_type>::value_type;
   static constexpr std::size_t capacity =
     parameter::value_param_t<std::size_t, policy::capacity, 128, Policies...>::value;
   using container =
-    parameter::type_param_t<policy::container, detail::growing_circular_array<T, capacity>, Policies...>;
+    parameter::type_param_t<policy::container, detail::growing_circular_array<element_type, capacity>, Policies...>;
+
+  static_assert(std::is_same_v<typename container::value_type, value_type>,
+                "container must store values of type value_type");
 
   chase_work_stealing_deque();
 
@@ -106,7 +134,7 @@ bool chase_work_stealing_deque<T, Policies...>::try_pop(value_type& result) {
   // (2) - this seq-cst-store enforces a total order with the seq-cst-load (4)
   _bottom.store(b, std::memory_order_seq_cst);
 
-  auto* item = _items.get(b, std::memory_order_relaxed);
+  auto item = _items.get(b, std::memory_order_relaxed);
   // (3) - this seq-cst-load enforces a total order with the seq-cst-CAS (5)
   t = _top.load(std::memory_order_seq_cst);
   if (b > t) {
@@ -141,7 +169,9 @@ bool chase_work_stealing_deque<T, Policies...>::try_steal(value_type& result) {
     return false;
   }
 
-  auto* item = _items.get(t, std::memory_order_relaxed);
+  // If T is stored inline, we might read a torn value here in case the owner concurrently
+  // overwrites this slot; but in that case the CAS on _top fails and we discard the value.
+  auto item = _items.get(t, std::memory_order_relaxed);
   // (5) - this seq-cst-CAS enforces a total order with the seq-cst-load (3)
   if (_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
     result = item;
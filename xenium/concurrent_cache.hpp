@@ -0,0 +1,523 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_CONCURRENT_CACHE_HPP
+#define XENIUM_CONCURRENT_CACHE_HPP
+
+#include <xenium/backoff.hpp>
+#include <xenium/hash.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/vyukov_hash_map.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+/**
+ * @brief A concurrent cache with a fixed capacity that evicts entries using the CLOCK
+ * algorithm.
+ *
+ * The entries are stored in a `vyukov_hash_map`, so lookups are lock-free. Every entry
+ * has a _reference bit_ that is set when the entry is found by `try_get` (the bit is only
+ * written if it is not already set, so frequently used entries are not written to on every
+ * hit). Eviction follows the CLOCK algorithm, which approximates LRU: a "clock hand"
+ * iterates over the entries, clears all reference bits that are set and evicts the first
+ * entry whose reference bit was not set.
+ *
+ * To avoid a global lock, the cache is split into `num_segments` independent segments,
+ * each with its own lock, clock hand and share of the capacity. An entry is assigned to a
+ * segment based on its key's hash. Lookups never acquire any lock; inserts and erases only
+ * lock the key's segment. Since eviction only considers the entries of one segment, the
+ * eviction order is only an approximation of the global CLOCK order.
+ *
+ * The values can only be accessed via `accessor` instances. Entries can be evicted or
+ * erased while some other thread holds an `accessor` to them; the lifetime of the entries
+ * is managed via the specified reclamation scheme. Note that an `accessor` holds one guard
+ * (two if `Key` is not trivial), and inserts and erases internally need up to three more,
+ * so reclaimers with a fixed number of guards per thread (e.g., `hazard_pointer` with a
+ * `static_strategy`) must be configured accordingly.
+ *
+ * The cache keeps track of the number of hits, misses and evictions (see `stats`). The
+ * counters are distributed over several cache lines to avoid contention.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for the entries. (**required**)
+ *  * `xenium::policy::hash`<br>
+ *    Defines the hash function. (*optional*; defaults to `xenium::hash<Key>`)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy for the segment locks. (*optional*; defaults to `xenium::no_backoff`)
+ *
+ * @tparam Key the key type; must be supported by `vyukov_hash_map`.
+ * @tparam Value the value type.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class Key, class Value, class... Policies>
+class concurrent_cache {
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  using hash = parameter::type_param_t<policy::hash, xenium::hash<Key>, Policies...>;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+
+  template <class... NewPolicies>
+  using with = concurrent_cache<Key, Value, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+
+  /**
+   * @brief The hit, miss and eviction counters of a cache.
+   */
+  struct statistics {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+  };
+
+  class accessor;
+
+  /**
+   * @brief Constructs a new cache that can hold up to `capacity` entries.
+   *
+   * The capacity is distributed evenly over the segments.
+   *
+   * @param capacity the maximum number of entries; must be at least `num_segments`.
+   * @param num_segments the number of segments; must be greater than zero.
+   */
+  explicit concurrent_cache(std::size_t capacity, std::size_t num_segments = 16);
+  ~concurrent_cache();
+
+  concurrent_cache(const concurrent_cache&) = delete;
+  concurrent_cache(concurrent_cache&&) = delete;
+
+  concurrent_cache& operator=(const concurrent_cache&) = delete;
+  concurrent_cache& operator=(concurrent_cache&&) = delete;
+
+  /**
+   * @brief Provides an accessor to the value associated with the specified key,
+   * if such an entry exists in the cache, and marks the entry as recently used.
+   *
+   * Updates the hit/miss counters.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the entry to search for
+   * @param result reference to an accessor to be set if a matching entry is found
+   * @return `true` if an entry was found, otherwise `false`
+   */
+  bool try_get(const key_type& key, accessor& result);
+
+  /**
+   * @brief Inserts a new entry into the cache if the cache doesn't already contain an
+   * entry with an equivalent key. If the key's segment is full, another entry is evicted.
+   *
+   * The value is only constructed if no entry with the key exists in the cache. It is
+   * constructed without holding any lock, so if several threads concurrently insert the same
+   * key, all but one of the constructed values are discarded.
+   * This operation does not update the hit/miss counters.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key the key of entry to be inserted.
+   * @param args arguments to forward to the constructor of the value
+   * @return `true` if an entry was inserted, otherwise `false`
+   */
+  template <class... Args>
+  bool emplace(key_type key, Args&&... args) {
+    return do_get_or_emplace(std::move(key), [&] { return Value(std::forward<Args>(args)...); }, false).second;
+  }
+
+  /**
+   * @brief Looks up the entry with the given key and inserts a new one if it is not found.
+   * If the key's segment is full, another entry is evicted.
+   *
+   * The value is only constructed if no entry with the key exists in the cache. It is
+   * constructed without holding any lock, so if several threads concurrently insert the same
+   * key, all but one of the constructed values are discarded. A hit is counted if an existing
+   * entry is returned, a miss if a new entry is inserted.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key the key of entry to be looked up or inserted.
+   * @param args arguments to forward to the constructor of the value
+   * @return a pair consisting of an accessor to the inserted entry, or the already-existing
+   * entry if no insertion happened, and a bool denoting whether the insertion took place.
+   */
+  template <class... Args>
+  std::pair<accessor, bool> get_or_emplace(key_type key, Args&&... args) {
+    return do_get_or_emplace(std::move(key), [&] { return Value(std::forward<Args>(args)...); }, true);
+  }
+
+  /**
+   * @brief Looks up the entry with the given key and inserts a new one if it is not found.
+   * The value for the new entry is created by calling `factory`.
+   *
+   * This is the typical way to use the cache: `factory` performs the expensive computation
+   * that shall be cached. `factory` is called without holding any lock, so a slow factory does
+   * not block other operations on the same segment. The flip side is that if several threads miss
+   * on the same key concurrently, each of them calls `factory` and all but one of the created
+   * values are discarded. A hit is counted if an existing entry is returned, a miss if a new
+   * entry is inserted.
+   *
+   * Progress guarantees: blocking
+   *
+   * @tparam Factory
+   * @param key the key of entry to be looked up or inserted.
+   * @param factory a functor that is used to create the `Value` instance.
+   * @return a pair consisting of an accessor to the inserted entry, or the already-existing
+   * entry if no insertion happened, and a bool denoting whether the insertion took place.
+   */
+  template <class Factory>
+  std::pair<accessor, bool> get_or_emplace_lazy(key_type key, Factory&& factory) {
+    return do_get_or_emplace(std::move(key), std::forward<Factory>(factory), true);
+  }
+
+  /**
+   * @brief Removes the entry with the key equivalent to key (if one exists).
+   *
+   * No accessors are invalidated.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key key of the entry to remove
+   * @return `true` if an entry was removed, otherwise `false`
+   */
+  bool erase(const key_type& key);
+
+  /**
+   * @brief Returns the number of entries in the cache.
+   *
+   * The result is only an approximation if other threads modify the cache concurrently.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] std::size_t size() const noexcept;
+
+  /**
+   * @brief Returns the maximum number of entries in the cache.
+   */
+  [[nodiscard]] std::size_t capacity() const noexcept { return _capacity; }
+
+  /**
+   * @brief Returns the number of segments.
+   */
+  [[nodiscard]] std::size_t num_segments() const noexcept { return _num_segments; }
+
+  /**
+   * @brief Returns the current hit, miss and eviction counters.
+   *
+   * The counters are read one after another, so the result is only an approximation if
+   * other threads use the cache concurrently.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] statistics stats() const noexcept;
+
+private:
+  struct entry : reclaimer::template enable_concurrent_ptr<entry> {
+    template <class Factory>
+    entry(const Key& key, Factory& factory) : key(key), value(factory()) {}
+
+    const Key key;
+    Value value;
+    std::atomic<bool> referenced{false};
+    // the position of this entry in its segment's clock; protected by the segment lock.
+    std::size_t slot = 0;
+  };
+
+  using hash_map =
+    vyukov_hash_map<Key, managed_ptr<entry, reclaimer>, policy::reclaimer<reclaimer>, policy::hash<hash>>;
+
+  struct alignas(64) segment {
+    void lock() {
+      backoff backoff;
+      for (;;) {
+        while (locked.load(std::memory_order_relaxed)) {
+          backoff();
+        }
+        if (!locked.exchange(true, std::memory_order_acquire)) {
+          return;
+        }
+      }
+    }
+    void unlock() { locked.store(false, std::memory_order_release); }
+
+    std::atomic<bool> locked{false};
+    std::atomic<std::size_t> size{0};
+    std::size_t capacity = 0;
+    std::size_t hand = 0;
+    std::unique_ptr<entry*[]> clock;
+  };
+
+  struct segment_lock {
+    explicit segment_lock(segment& s) : s(s) { s.lock(); }
+    ~segment_lock() { s.unlock(); }
+    segment_lock(const segment_lock&) = delete;
+    segment_lock& operator=(const segment_lock&) = delete;
+    segment& s;
+  };
+
+  struct alignas(64) counters {
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+  };
+
+  static constexpr std::size_t num_counters = 16;
+
+  // Threads are assigned to the counters in a round robin fashion. The assignment is shared
+  // by all instances, which is fine since the counters are only used for statistics.
+  static counters& local_counters(counters* c) noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t idx = next.fetch_add(1, std::memory_order_relaxed) % num_counters;
+    return c[idx];
+  }
+
+  segment& get_segment(const Key& key) noexcept {
+    // The hash map uses the low bits of the hash to calculate the bucket index, and
+    // hash functions like std::hash<int> are often the identity, so we mix the hash
+    // (Fibonacci hashing) and use the high bits to select the segment.
+    auto h = static_cast<std::uint64_t>(hash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return _segments[static_cast<std::size_t>(h >> 32) % _num_segments];
+  }
+
+  template <class Factory>
+  std::pair<accessor, bool> do_get_or_emplace(Key&& key, Factory&& factory, bool count);
+  void record_hit(accessor& acc);
+  std::size_t evict(segment& s);
+  static void remove_slot(segment& s, std::size_t slot) noexcept;
+
+  hash_map _map;
+  std::size_t _capacity;
+  std::size_t _num_segments;
+  std::unique_ptr<segment[]> _segments;
+  std::unique_ptr<counters[]> _counters;
+};
+
+/**
+ * @brief Provides safe read access to the value of a cache entry.
+ *
+ * The entry remains valid as long as the accessor exists, even if the entry is evicted
+ * or erased in the meantime.
+ */
+template <class Key, class Value, class... Policies>
+class concurrent_cache<Key, Value, Policies...>::accessor {
+public:
+  accessor() = default;
+  const Value* operator->() const noexcept { return &get()->value; }
+  const Value& operator*() const noexcept { return get()->value; }
+  void reset() { _acc.reset(); }
+
+private:
+  entry* get() const noexcept { return _acc.operator->(); }
+  typename hash_map::accessor _acc;
+  friend class concurrent_cache;
+};
+
+template <class Key, class Value, class... Policies>
+concurrent_cache<Key, Value, Policies...>::concurrent_cache(std::size_t capacity, std::size_t num_segments) :
+    _map(capacity),
+    _capacity(capacity),
+    _num_segments(num_segments) {
+  if (num_segments == 0) {
+    throw std::invalid_argument("concurrent_cache requires at least one segment");
+  }
+  if (capacity < num_segments) {
+    throw std::invalid_argument("the capacity of concurrent_cache must be at least num_segments");
+  }
+  _segments = std::make_unique<segment[]>(num_segments);
+  _counters = std::make_unique<counters[]>(num_counters);
+  for (std::size_t i = 0; i < num_segments; ++i) {
+    auto& s = _segments[i];
+    s.capacity = capacity / num_segments + (i < capacity % num_segments ? 1 : 0);
+    s.clock = std::make_unique<entry*[]>(s.capacity);
+  }
+}
+
+template <class Key, class Value, class... Policies>
+concurrent_cache<Key, Value, Policies...>::~concurrent_cache() {
+  // The map does not reclaim managed_ptr values in its destructor, so we have to erase
+  // all remaining entries explicitly.
+  for (std::size_t i = 0; i < _num_segments; ++i) {
+    auto& s = _segments[i];
+    auto size = s.size.load(std::memory_order_relaxed);
+    for (std::size_t j = 0; j < size; ++j) {
+      _map.erase(s.clock[j]->key);
+    }
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool concurrent_cache<Key, Value, Policies...>::try_get(const key_type& key, accessor& result) {
+  if (!_map.try_get_value(key, result._acc)) {
+    local_counters(_counters.get()).misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  record_hit(result);
+  return true;
+}
+
+template <class Key, class Value, class... Policies>
+void concurrent_cache<Key, Value, Policies...>::record_hit(accessor& acc) {
+  local_counters(_counters.get()).hits.fetch_add(1, std::memory_order_relaxed);
+  auto& referenced = acc.get()->referenced;
+  if (!referenced.load(std::memory_order_relaxed)) {
+    referenced.store(true, std::memory_order_relaxed);
+  }
+}
+
+template <class Key, class Value, class... Policies>
+template <class Factory>
+auto concurrent_cache<Key, Value, Policies...>::do_get_or_emplace(Key&& key, Factory&& factory, bool count)
+  -> std::pair<accessor, bool> {
+  std::pair<accessor, bool> result;
+  if (_map.try_get_value(key, result.first._acc)) {
+    if (count) {
+      record_hit(result.first);
+    }
+    return result;
+  }
+
+  // The factory can be arbitrarily expensive, so we create the entry before we acquire the
+  // segment lock; otherwise all other misses on this segment would have to wait for it.
+  std::unique_ptr<entry> e(new entry(key, factory));
+
+  // All updates of the entries of a segment are performed while holding the segment lock,
+  // so the map and the segment's clock are always consistent for the lock owner.
+  auto& s = get_segment(key);
+  segment_lock lock(s);
+  if (_map.try_get_value(key, result.first._acc)) {
+    // some other thread was faster - we discard our entry
+    if (count) {
+      record_hit(result.first);
+    }
+    return result;
+  }
+  if (count) {
+    local_counters(_counters.get()).misses.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // We evict before we insert the new entry so we do not hold an accessor while erasing
+  // the victim; this reduces the number of guards (e.g., hazard pointers) we need at a time.
+  std::size_t slot = s.size.load(std::memory_order_relaxed);
+  if (slot == s.capacity) {
+    slot = evict(s);
+  } else {
+    s.size.store(slot + 1, std::memory_order_relaxed);
+  }
+
+  try {
+    auto [acc, inserted] = _map.get_or_emplace(std::move(key), e.get());
+    assert(inserted);
+    (void)inserted;
+    result.first._acc = std::move(acc);
+  } catch (...) {
+    remove_slot(s, slot);
+    throw;
+  }
+  result.second = true;
+  e->slot = slot;
+  s.clock[slot] = e.release();
+  return result;
+}
+
+template <class Key, class Value, class... Policies>
+void concurrent_cache<Key, Value, Policies...>::remove_slot(segment& s, std::size_t slot) noexcept {
+  // Move the last entry into the freed slot; this way the slots [0, size) are always occupied.
+  auto last = s.size.load(std::memory_order_relaxed) - 1;
+  auto* moved = s.clock[last];
+  s.clock[last] = nullptr;
+  s.clock[slot] = moved;
+  if (moved != nullptr) {
+    moved->slot = slot;
+  }
+  s.size.store(last, std::memory_order_relaxed);
+}
+
+template <class Key, class Value, class... Policies>
+std::size_t concurrent_cache<Key, Value, Policies...>::evict(segment& s) {
+  assert(s.size.load(std::memory_order_relaxed) == s.capacity);
+  // Advance the hand until we find an entry that has not been referenced since the hand
+  // passed it the last time. This terminates after at most one full round, since all
+  // reference bits that we pass are cleared.
+  for (;;) {
+    entry* e = s.clock[s.hand];
+    if (!e->referenced.load(std::memory_order_relaxed)) {
+      break;
+    }
+    e->referenced.store(false, std::memory_order_relaxed);
+    s.hand = (s.hand + 1) % s.capacity;
+  }
+
+  // The new entry takes the victim's slot, so the hand has to move past it.
+  auto slot = s.hand;
+  s.hand = (s.hand + 1) % s.capacity;
+
+  // erase reclaims the victim, so we must not access it afterwards.
+  [[maybe_unused]] bool erased = _map.erase(s.clock[slot]->key);
+  assert(erased);
+  s.clock[slot] = nullptr;
+  local_counters(_counters.get()).evictions.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+template <class Key, class Value, class... Policies>
+bool concurrent_cache<Key, Value, Policies...>::erase(const key_type& key) {
+  auto& s = get_segment(key);
+  segment_lock lock(s);
+  std::size_t slot;
+  {
+    typename hash_map::accessor acc;
+    if (!_map.try_get_value(key, acc)) {
+      return false;
+    }
+    slot = acc->slot;
+  }
+  // We hold the segment lock, so nobody else can remove the entry in the meantime.
+  remove_slot(s, slot);
+
+  [[maybe_unused]] bool erased = _map.erase(key);
+  assert(erased);
+  return true;
+}
+
+template <class Key, class Value, class... Policies>
+std::size_t concurrent_cache<Key, Value, Policies...>::size() const noexcept {
+  std::size_t result = 0;
+  for (std::size_t i = 0; i < _num_segments; ++i) {
+    result += _segments[i].size.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+template <class Key, class Value, class... Policies>
+auto concurrent_cache<Key, Value, Policies...>::stats() const noexcept -> statistics {
+  statistics result;
+  for (std::size_t i = 0; i < num_counters; ++i) {
+    auto& c = _counters[i];
+    result.hits += c.hits.load(std::memory_order_relaxed);
+    result.misses += c.misses.load(std::memory_order_relaxed);
+    result.evictions += c.evictions.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,344 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_CONCURRENT_VECTOR_HPP
+#define XENIUM_CONCURRENT_VECTOR_HPP
+
+#include <xenium/array_allocator.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/utils.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace xenium {
+/**
+ * @brief An append-only vector that supports concurrent `push_back` operations and
+ * wait-free indexed reads.
+ *
+ * The elements are stored in a sequence of buckets, similar to the vector proposed by
+ * Dechev et al. \[[DPS06](index.html#ref-dechev-2006)\]. The first bucket has space for
+ * `capacity` elements, and every following bucket is twice as large as its predecessor.
+ * Buckets are allocated lazily and are never reallocated, so elements never move once they
+ * have been constructed and references to them remain valid for the lifetime of the vector.
+ * Elements cannot be removed.
+ *
+ * `push_back`/`emplace_back` are lock-free (provided the allocator is); they make sure the
+ * bucket for the next index exists, reserve that index via a CAS, construct the element in
+ * place and return the index. Since several elements can be under construction at the same
+ * time, `size()` reports the length of the longest prefix of _completed_ slots, i.e., all
+ * elements with index < `size()` can be accessed unless their construction failed (see below).
+ * An element is available to the thread that pushed it as soon as `push_back` returns; other
+ * threads can use `try_get` to access elements beyond `size()`.
+ *
+ * If the constructor of an element throws, the reserved index is skipped and the exception is
+ * propagated to the caller. The slot is marked as _invalid_, but still counts towards `size()`;
+ * `try_get` always returns `nullptr` for it and `at` throws `std::out_of_range`. If the
+ * allocation of a bucket fails, no index is reserved.
+ *
+ * Supported policies:
+ *  * `xenium::policy::capacity`<br>
+ *    Defines the size of the first bucket; must be a power of two. (*optional*; defaults to 32)
+ *  * `xenium::policy::array_allocator`<br>
+ *    Defines the allocator that is used for the buckets.
+ *    (*optional*; defaults to `xenium::default_array_allocator`)
+ *
+ * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class concurrent_vector {
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  static constexpr std::size_t capacity =
+    parameter::value_param_t<std::size_t, policy::capacity, 32, Policies...>::value;
+  using array_allocator = parameter::type_param_t<policy::array_allocator, default_array_allocator, Policies...>;
+
+  template <class... NewPolicies>
+  using with = concurrent_vector<T, NewPolicies..., Policies...>;
+
+  static_assert(capacity > 0 && utils::is_power_of_two(capacity), "capacity must be a power of two");
+  static_assert(alignof(T) <= array_allocator::alignment, "T must not be over-aligned.");
+
+  concurrent_vector() = default;
+  ~concurrent_vector();
+
+  concurrent_vector(const concurrent_vector&) = delete;
+  concurrent_vector(concurrent_vector&&) = delete;
+
+  concurrent_vector& operator=(const concurrent_vector&) = delete;
+  concurrent_vector& operator=(concurrent_vector&&) = delete;
+
+  /**
+   * @brief Appends a copy of `value` and returns its index.
+   *
+   * Progress guarantees: lock-free (if the allocator is lock-free)
+   */
+  std::size_t push_back(const T& value) { return emplace_back(value); }
+
+  /**
+   * @brief Appends `value` and returns its index.
+   *
+   * Progress guarantees: lock-free (if the allocator is lock-free)
+   */
+  std::size_t push_back(T&& value) { return emplace_back(std::move(value)); }
+
+  /**
+   * @brief Constructs a new element in place at the end of the vector and returns its index.
+   *
+   * Progress guarantees: lock-free (if the allocator is lock-free)
+   *
+   * @throws std::bad_alloc if the bucket for the new element cannot be allocated; in this case
+   *   no index is reserved. Any exception thrown by the constructor of `T` is propagated, but
+   *   the reserved index is lost, i.e., it becomes an invalid slot.
+   */
+  template <class... Args>
+  std::size_t emplace_back(Args&&... args);
+
+  /**
+   * @brief Returns the length of the prefix of slots that are no longer under construction.
+   *
+   * Every slot with an index less than the returned value either holds a published element or
+   * is invalid because the constructor of its element threw. Use `at` or `try_get` if the vector
+   * can contain invalid slots.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    // (1) - this acquire-load synchronizes-with the seq-cst-CAS (9)
+    return _size.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  /**
+   * @brief Returns the element with the given index.
+   *
+   * The element must be published, i.e., `idx` must be less than a value previously returned
+   * by `size()` or the calling thread must have pushed the element itself, and the slot must not
+   * be invalid (i.e., the constructor of the element must not have thrown).
+   *
+   * Progress guarantees: wait-free
+   */
+  T& operator[](std::size_t idx) noexcept {
+    auto& s = get_slot(idx);
+    assert(s.state.load(std::memory_order_relaxed) == slot::published);
+    return *s.value();
+  }
+
+  const T& operator[](std::size_t idx) const noexcept {
+    return const_cast<concurrent_vector&>(*this)[idx]; // NOLINT
+  }
+
+  /**
+   * @brief Returns the element with the given index.
+   *
+   * Progress guarantees: wait-free
+   *
+   * @throws std::out_of_range if `idx` is not less than `size()` or the slot is invalid
+   *   because the constructor of the element threw.
+   */
+  T& at(std::size_t idx) {
+    if (idx >= size()) {
+      throw std::out_of_range("concurrent_vector::at");
+    }
+    auto& s = get_slot(idx);
+    // the acquire-load in size() already synchronizes-with the store of the final slot state
+    if (s.state.load(std::memory_order_relaxed) != slot::published) {
+      throw std::out_of_range("concurrent_vector::at: element construction failed");
+    }
+    return *s.value();
+  }
+
+  const T& at(std::size_t idx) const { return const_cast<concurrent_vector&>(*this).at(idx); } // NOLINT
+
+  /**
+   * @brief Returns a pointer to the element with the given index, or `nullptr` if the element
+   * does not exist or has not been published yet.
+   *
+   * Progress guarantees: wait-free
+   */
+  T* try_get(std::size_t idx) noexcept;
+
+  const T* try_get(std::size_t idx) const noexcept {
+    return const_cast<concurrent_vector&>(*this).try_get(idx); // NOLINT
+  }
+
+private:
+  struct slot {
+    static constexpr std::uint8_t pending = 0;
+    static constexpr std::uint8_t published = 1;
+    static constexpr std::uint8_t invalid = 2;
+
+    std::atomic<std::uint8_t> state;
+    alignas(T) std::byte storage[sizeof(T)];
+
+    T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  static constexpr unsigned first_bucket_bits = utils::find_last_bit_set(capacity) - 1;
+  static constexpr std::size_t num_buckets = std::numeric_limits<std::size_t>::digits - first_bucket_bits;
+
+  static std::size_t bucket_size(std::size_t bucket) noexcept { return capacity << bucket; }
+
+  // Maps an index to its bucket and the offset inside this bucket. The first bucket covers the
+  // indexes [0, capacity), bucket b covers [capacity * (2^b - 1), capacity * (2^(b+1) - 1)).
+  static std::pair<std::size_t, std::size_t> locate(std::size_t idx) noexcept {
+    const std::size_t pos = idx + capacity;
+    const unsigned high_bit = utils::find_last_bit_set(pos) - 1;
+    return {high_bit - first_bucket_bits, pos ^ (static_cast<std::size_t>(1) << high_bit)};
+  }
+
+  slot& get_slot(std::size_t idx) noexcept {
+    auto [bucket, offset] = locate(idx);
+    // The element is published, so the allocation of its bucket happens-before this load.
+    return _buckets[bucket].load(std::memory_order_relaxed)[offset];
+  }
+
+  slot* get_or_allocate_bucket(std::size_t bucket);
+  void advance_size() noexcept;
+
+  std::atomic<std::size_t> _reserved{0};
+  std::atomic<std::size_t> _size{0};
+  std::atomic<slot*> _buckets[num_buckets] = {};
+};
+
+template <class T, class... Policies>
+concurrent_vector<T, Policies...>::~concurrent_vector() {
+  auto remaining = _reserved.load(std::memory_order_relaxed);
+  for (std::size_t b = 0; b < num_buckets; ++b) {
+    auto* bucket = _buckets[b].load(std::memory_order_relaxed);
+    if (bucket == nullptr) {
+      continue;
+    }
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      const auto count = std::min(remaining, bucket_size(b));
+      for (std::size_t i = 0; i < count; ++i) {
+        if (bucket[i].state.load(std::memory_order_relaxed) == slot::published) {
+          bucket[i].value()->~T();
+        }
+      }
+    }
+    remaining -= std::min(remaining, bucket_size(b));
+    array_allocator::deallocate(bucket);
+  }
+}
+
+template <class T, class... Policies>
+template <class... Args>
+std::size_t concurrent_vector<T, Policies...>::emplace_back(Args&&... args) {
+  // The bucket has to exist before we reserve an index; otherwise an allocation failure would
+  // leave behind a reserved slot that stays pending forever and blocks advance_size. We therefore
+  // cannot use a fetch-add, but have to reserve the index via a CAS once the bucket exists.
+  auto idx = _reserved.load(std::memory_order_relaxed);
+  slot* bucket_ptr;
+  std::size_t offset;
+  do {
+    auto [bucket, off] = locate(idx);
+    bucket_ptr = get_or_allocate_bucket(bucket);
+    offset = off;
+  } while (!_reserved.compare_exchange_weak(idx, idx + 1, std::memory_order_relaxed));
+  slot& s = bucket_ptr[offset];
+
+  try {
+    ::new (static_cast<void*>(s.storage)) T(std::forward<Args>(args)...);
+  } catch (...) {
+    // (2) - this seq-cst-store enforces a total order with the seq-cst-load (8)
+    s.state.store(slot::invalid, std::memory_order_seq_cst);
+    advance_size();
+    throw;
+  }
+
+  // (3) - this seq-cst-store synchronizes-with the seq-cst-load (8) and the acquire-load (11)
+  s.state.store(slot::published, std::memory_order_seq_cst);
+  advance_size();
+  return idx;
+}
+
+template <class T, class... Policies>
+auto concurrent_vector<T, Policies...>::get_or_allocate_bucket(std::size_t bucket) -> slot* {
+  assert(bucket < num_buckets);
+  // (4) - this acquire-load synchronizes-with the seq-cst-CAS (5)
+  auto* result = _buckets[bucket].load(std::memory_order_acquire);
+  if (result != nullptr) {
+    return result;
+  }
+
+  const auto count = bucket_size(bucket);
+  void* mem = array_allocator::allocate(count * sizeof(slot));
+  if (mem == nullptr) {
+    throw std::bad_alloc();
+  }
+  auto* new_bucket = static_cast<slot*>(mem);
+  // the allocator returns zero-initialized memory, i.e., all slots are already pending
+  std::uninitialized_default_construct_n(new_bucket, count);
+
+  // (5) - this seq-cst-CAS synchronizes-with the acquire-loads (4, 10), the seq-cst-load (7)
+  //       and the seq-cst-CAS (5)
+  if (_buckets[bucket].compare_exchange_strong(result, new_bucket, std::memory_order_seq_cst)) {
+    return new_bucket;
+  }
+  // some other thread was faster
+  array_allocator::deallocate(new_bucket);
+  return result;
+}
+
+template <class T, class... Policies>
+void concurrent_vector<T, Policies...>::advance_size() noexcept {
+  // Every pushing thread tries to move _size over all slots that are no longer pending and stops
+  // at the first slot that is still pending - the thread that has reserved that slot continues
+  // from there once it is done. We have to use seq-cst order for the operations on _size, the
+  // bucket pointers and the slot states to ensure that a thread that publishes its slot and a
+  // thread that advances _size up to that slot cannot both miss the other one's update, which
+  // would leave _size stuck in front of a published slot.
+  // (6) - this seq-cst-load enforces a total order with the seq-cst-CAS (9) and the seq-cst-stores (2, 3)
+  auto size = _size.load(std::memory_order_seq_cst);
+  for (;;) {
+    auto [bucket, offset] = locate(size);
+    // (7) - this seq-cst-load synchronizes-with the seq-cst-CAS (5)
+    auto* b = _buckets[bucket].load(std::memory_order_seq_cst);
+    // (8) - this seq-cst-load synchronizes-with the seq-cst-store (3)
+    if (b == nullptr || b[offset].state.load(std::memory_order_seq_cst) == slot::pending) {
+      return;
+    }
+    // (9) - this seq-cst-CAS synchronizes-with the acquire-load (1)
+    if (_size.compare_exchange_weak(size, size + 1, std::memory_order_seq_cst)) {
+      ++size;
+    }
+  }
+}
+
+template <class T, class... Policies>
+T* concurrent_vector<T, Policies...>::try_get(std::size_t idx) noexcept {
+  if (idx >= _reserved.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  auto [bucket, offset] = locate(idx);
+  // (10) - this acquire-load synchronizes-with the seq-cst-CAS (5)
+  auto* b = _buckets[bucket].load(std::memory_order_acquire);
+  if (b == nullptr) {
+    return nullptr;
+  }
+  // (11) - this acquire-load synchronizes-with the seq-cst-store (3)
+  if (b[offset].state.load(std::memory_order_acquire) != slot::published) {
+    return nullptr;
+  }
+  return b[offset].value();
+}
+} // namespace xenium
+
+#endif
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_DETAIL_ATOMIC_INLINE_VALUE_HPP
+#define XENIUM_DETAIL_ATOMIC_INLINE_VALUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace xenium::detail {
+
+/**
+ * The maximum size of trivially copyable values that are stored inline (i.e.,
+ * without an additional heap allocation) in data structures that support this.
+ */
+static constexpr std::size_t max_inline_value_size = 16;
+
+template <class T>
+inline constexpr bool is_inline_value_v =
+  std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && sizeof(T) <= max_inline_value_size;
+
+/**
+ * Tag type to request that `T` is stored by value instead of storing a `T*`.
+ * Can be used as element type for `fixed_size_circular_array` and `growing_circular_array`.
+ */
+template <class T>
+struct inline_value {
+  static_assert(is_inline_value_v<T>, "T must be a trivially copyable type of at most 16 bytes");
+};
+
+/**
+ * A slot that holds a trivially copyable value of at most `max_inline_value_size` bytes.
+ *
+ * If `std::atomic<T>` is always lock-free, the value is stored in a `std::atomic<T>`. This is
+ * usually the case for values of up to 8 bytes, but usually *not* for 16 byte values: GCC
+ * reports 16 byte atomics as not always lock-free (and dispatches them to libatomic) even
+ * with `-mcx16`, so with GCC such values always use the fallback; Clang only uses
+ * `cmpxchg16b` if `-mcx16` is given. The fallback splits the value into pointer sized words
+ * that are loaded/stored individually, so a `load` that runs concurrently with a `store` can
+ * observe a torn value. This is sufficient for algorithms like the Chase-Lev deque which only
+ * use a loaded value if a subsequent CAS confirms that the slot has not been overwritten in
+ * the meantime.
+ */
+template <class T, bool = std::atomic<T>::is_always_lock_free>
+struct atomic_inline_value {
+  static_assert(is_inline_value_v<T>, "T must be a trivially copyable type of at most 16 bytes");
+
+  T load(std::memory_order order) const noexcept {
+    std::uintptr_t buffer[num_words];
+    for (std::size_t i = 0; i < num_words; ++i) {
+      buffer[i] = words[i].load(order);
+    }
+    T result;
+    // need to cast to void* to avoid gcc error about "copying an object of non-trivial type"
+    std::memcpy(static_cast<void*>(&result), buffer, sizeof(T));
+    return result;
+  }
+
+  void store(const T& value, std::memory_order order) noexcept {
+    std::uintptr_t buffer[num_words] = {};
+    std::memcpy(buffer, static_cast<const void*>(&value), sizeof(T));
+    for (std::size_t i = 0; i < num_words; ++i) {
+      words[i].store(buffer[i], order);
+    }
+  }
+
+private:
+  static constexpr std::size_t num_words = (sizeof(T) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t);
+  std::atomic<std::uintptr_t> words[num_words];
+};
+
+template <class T>
+struct atomic_inline_value<T, true> {
+  static_assert(is_inline_value_v<T>, "T must be a trivially copyable type of at most 16 bytes");
+
+  T load(std::memory_order order) const noexcept { return value.load(order); }
+  void store(const T& v, std::memory_order order) noexcept { value.store(v, order); }
+
+private:
+  std::atomic<T> value;
+};
+
+/**
+ * Maps the element type of a circular array to the type of the values that are
+ * stored and the type of the atomic slot used to store them.
+ * By default a `T*` is stored; `inline_value<T>` stores `T` directly.
+ */
+template <class T>
+struct circular_array_slot {
+  using value_type = T*;
+  using type = std::atomic<T*>;
+};
+
+template <class T>
+struct circular_array_slot<inline_value<T>> {
+  using value_type = T;
+  using type = atomic_inline_value<T>;
+};
+} // namespace xenium::detail
+
+#endif
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_DETAIL_DOUBLE_WIDTH_CAS_HPP
+#define XENIUM_DETAIL_DOUBLE_WIDTH_CAS_HPP
+
+#include <xenium/detail/port.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+namespace xenium::detail {
+
+/**
+ * Two adjacent 64-bit words that can be updated together with a single (sequentially
+ * consistent) double-width CAS. Each word can also be loaded individually; a pair of such
+ * loads is not atomic, so callers must validate the observed values with a subsequent CAS.
+ *
+ * On x86-64 this uses `cmpxchg16b`, which is available on all but the very first generation
+ * of 64-bit CPUs. In TSan builds the compiler builtin is used instead, so that TSan can see
+ * the operation; on other platforms this may require linking against libatomic.
+ */
+struct alignas(16) double_width_word {
+  std::atomic<std::uint64_t> lo;
+  std::atomic<std::uint64_t> hi;
+
+  void store(std::uint64_t new_lo, std::uint64_t new_hi, std::memory_order order) noexcept {
+    lo.store(new_lo, order);
+    hi.store(new_hi, order);
+  }
+
+  bool compare_exchange(std::uint64_t& expected_lo,
+                        std::uint64_t& expected_hi,
+                        std::uint64_t desired_lo,
+                        std::uint64_t desired_hi) noexcept {
+#if defined(XENIUM_ARCH_X86) && (defined(__GNUC__) || defined(__clang__)) && !defined(XENIUM_TSAN)
+    bool result;
+    __asm__ __volatile__("lock cmpxchg16b %1\n\t"
+                         "sete %0"
+                         : "=q"(result), "+m"(*this), "+a"(expected_lo), "+d"(expected_hi)
+                         : "b"(desired_lo), "c"(desired_hi)
+                         : "cc", "memory");
+    return result;
+#elif defined(_MSC_VER) && defined(XENIUM_ARCH_X86)
+    long long expected[2] = {static_cast<long long>(expected_lo), static_cast<long long>(expected_hi)};
+    bool result = _InterlockedCompareExchange128(reinterpret_cast<volatile long long*>(this),
+                                                 static_cast<long long>(desired_hi),
+                                                 static_cast<long long>(desired_lo),
+                                                 expected) != 0;
+    expected_lo = static_cast<std::uint64_t>(expected[0]);
+    expected_hi = static_cast<std::uint64_t>(expected[1]);
+    return result;
+#else
+    struct alignas(16) raw {
+      std::uint64_t lo;
+      std::uint64_t hi;
+    };
+    raw expected{expected_lo, expected_hi};
+    raw desired{desired_lo, desired_hi};
+    bool result = __atomic_compare_exchange(
+      reinterpret_cast<raw*>(this), &expected, &desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    expected_lo = expected.lo;
+    expected_hi = expected.hi;
+    return result;
+#endif
+  }
+
+  /**
+   * Atomically adds `inc` to the low word, leaving the high word untouched.
+   *
+   * TSan emulates 128-bit atomics with an internal lock, so in TSan builds a plain `fetch_add`
+   * on the low word would not be atomic with respect to a concurrent `compare_exchange`; in
+   * this case the operation is therefore emulated with a double-width CAS loop.
+   */
+  std::uint64_t fetch_add_lo(std::uint64_t inc, std::memory_order order) noexcept {
+#if defined(XENIUM_TSAN)
+    (void)order;
+    auto expected_lo = lo.load(std::memory_order_relaxed);
+    auto expected_hi = hi.load(std::memory_order_relaxed);
+    while (!compare_exchange(expected_lo, expected_hi, expected_lo + inc, expected_hi)) {
+    }
+    return expected_lo;
+#else
+    return lo.fetch_add(inc, order);
+#endif
+  }
+};
+
+static_assert(sizeof(double_width_word) == 16, "double_width_word must be exactly 16 bytes");
+} // namespace xenium::detail
+
+#endif
@@ -6,6 +6,8 @@
 #ifndef XENIUM_FIXED_SIZE_CIRCULAR_ARRAY_HPP
 #define XENIUM_FIXED_SIZE_CIRCULAR_ARRAY_HPP
 
+#include <xenium/detail/atomic_inline_value.hpp>
+
 #include <atomic>
 #include <cstdint>
 #include <stdexcept>
@@ -13,11 +15,13 @@
 namespace xenium::detail {
 template <class T, std::size_t Capacity>
 struct fixed_size_circular_array {
+  using value_type = typename circular_array_slot<T>::value_type;
+
   [[nodiscard]] std::size_t capacity() const { return Capacity; }
 
-  T* get(std::size_t idx, std::memory_order order) { return _items[idx & mask].load(order); }
+  value_type get(std::size_t idx, std::memory_order order) { return _items[idx & mask].load(order); }
 
-  void put(std::size_t idx, T* value, std::memory_order order) { _items[idx & mask].store(value, order); }
+  void put(std::size_t idx, value_type value, std::memory_order order) { _items[idx & mask].store(value, order); }
 
   [[nodiscard]] constexpr bool can_grow() const { return false; }
 
@@ -27,7 +31,7 @@ private:
   static constexpr std::size_t mask = Capacity - 1;
   static_assert((Capacity & mask) == 0, "capacity has to be a power of two");
 
-  std::atomic<T*> _items[Capacity];
+  typename circular_array_slot<T>::type _items[Capacity];
 };
 } // namespace xenium::detail
 #endif
@@ -6,15 +6,24 @@
 #ifndef XENIUM_GROWING_CIRCULAR_ARRAY_HPP
 #define XENIUM_GROWING_CIRCULAR_ARRAY_HPP
 
+#include <xenium/array_allocator.hpp>
+#include <xenium/detail/atomic_inline_value.hpp>
 #include <xenium/utils.hpp>
 
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <memory>
+#include <new>
 
 namespace xenium::detail {
-template <class T, std::size_t MinCapacity = 64, std::size_t MaxCapacity = static_cast<std::size_t>(1) << 31>
+template <class T,
+          std::size_t MinCapacity = 64,
+          std::size_t MaxCapacity = static_cast<std::size_t>(1) << 31,
+          class Allocator = default_array_allocator>
 struct growing_circular_array {
+  using value_type = typename circular_array_slot<T>::value_type;
+
   static constexpr std::size_t min_capacity = MinCapacity;
   static constexpr std::size_t max_capacity = MaxCapacity;
   static constexpr std::size_t num_buckets = utils::find_last_bit_set(max_capacity);
@@ -28,13 +37,13 @@ struct growing_circular_array {
 
   [[nodiscard]] std::size_t capacity() const { return _capacity.load(std::memory_order_relaxed); }
 
-  T* get(std::size_t idx, std::memory_order order) {
+  value_type get(std::size_t idx, std::memory_order order) {
     // (1) - this acquire-load synchronizes-with the release-store (2)
     auto capacitiy = _capacity.load(std::memory_order_acquire);
     return get_entry(idx, capacitiy).load(order);
   }
 
-  void put(std::size_t idx, T* value, std::memory_order order) {
+  void put(std::size_t idx, value_type value, std::memory_order order) {
     auto capacitiy = _capacity.load(std::memory_order_relaxed);
     get_entry(idx, capacitiy).store(value, order);
   }
@@ -44,7 +53,7 @@ struct growing_circular_array {
   void grow(std::size_t bottom, std::size_t top);
 
 private:
-  using entry = std::atomic<T*>;
+  using entry = typename circular_array_slot<T>::type;
 
   entry& get_entry(std::size_t idx, std::size_t capacity) {
     idx = idx & (capacity - 1);
@@ -57,17 +66,28 @@ private:
 
   static constexpr std::size_t initial_buckets = utils::find_last_bit_set(MinCapacity);
 
+  static entry* allocate_entries(std::size_t count) {
+    void* mem = Allocator::allocate(count * sizeof(entry));
+    if (mem == nullptr) {
+      throw std::bad_alloc();
+    }
+    auto* entries = static_cast<entry*>(mem);
+    // the allocator returns zero-initialized memory, i.e., all entries are already null
+    std::uninitialized_default_construct_n(entries, count);
+    return entries;
+  }
+
   std::size_t _buckets;
   std::atomic<std::size_t> _capacity;
   entry* _data[num_buckets];
 };
 
-template <class T, std::size_t MinCapacity, std::size_t Buckets>
-growing_circular_array<T, MinCapacity, Buckets>::growing_circular_array() :
+template <class T, std::size_t MinCapacity, std::size_t Buckets, class Allocator>
+growing_circular_array<T, MinCapacity, Buckets, Allocator>::growing_circular_array() :
     _buckets(initial_buckets),
     _capacity(MinCapacity),
     _data() {
-  auto* ptr = new entry[MinCapacity];
+  auto* ptr = allocate_entries(MinCapacity);
   _data[0] = ptr++;
   for (std::size_t i = 1; i < _buckets; ++i) {
     _data[i] = ptr;
@@ -75,23 +95,24 @@ growing_circular_array<T, MinCapacity, Buckets>::growing_circular_array() :
   }
 }
 
-template <class T, std::size_t MinCapacity, std::size_t Buckets>
-growing_circular_array<T, MinCapacity, Buckets>::~growing_circular_array() {
-  delete[](_data[0]);
-  for (std::size_t i = initial_buckets; i < num_buckets; ++i) {
-    delete[](_data[i]);
+template <class T, std::size_t MinCapacity, std::size_t Buckets, class Allocator>
+growing_circular_array<T, MinCapacity, Buckets, Allocator>::~growing_circular_array() {
+  // entries are trivially destructible, so we can simply release the memory
+  Allocator::deallocate(_data[0]);
+  for (std::size_t i = initial_buckets; i < _buckets; ++i) {
+    Allocator::deallocate(_data[i]);
   }
 }
 
-template <class T, std::size_t MinCapacity, std::size_t Buckets>
-void growing_circular_array<T, MinCapacity, Buckets>::grow(std::size_t bottom, std::size_t top) {
+template <class T, std::size_t MinCapacity, std::size_t Buckets, class Allocator>
+void growing_circular_array<T, MinCapacity, Buckets, Allocator>::grow(std::size_t bottom, std::size_t top) {
   assert(can_grow());
 
   auto capacity = this->capacity();
   auto mod_mask = capacity - 1;
   assert((capacity & mod_mask) == 0);
 
-  _data[_buckets] = new entry[capacity];
+  _data[_buckets] = allocate_entries(capacity);
   _buckets++;
   auto new_capacity = capacity * 2;
   auto new_mod_mask = new_capacity - 1;
@@ -105,11 +126,11 @@ void growing_circular_array<T, MinCapacity, Buckets>::grow(std::size_t bottom, s
 
   for (std::size_t i = start; i < bottom; i++) {
     auto oldI = i & mod_mask;
-    auto newI = i % new_mod_mask;
+    auto newI = i & new_mod_mask;
     if (oldI != newI) {
       auto oldBit = utils::find_last_bit_set(oldI);
       auto newBit = utils::find_last_bit_set(newI);
-      auto* v = _data[oldBit][oldI ^ ((1 << (oldBit)) >> 1)].load(std::memory_order_relaxed);
+      auto v = _data[oldBit][oldI ^ ((1 << (oldBit)) >> 1)].load(std::memory_order_relaxed);
       _data[newBit][newI ^ ((1 << (newBit)) >> 1)].store(v, std::memory_order_relaxed);
     } else {
       // Make sure we don't iterate through useless indices
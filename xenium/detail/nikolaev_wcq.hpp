@@ -0,0 +1,756 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_DETAIL_NIKOLAEV_WCQ_HPP
+#define XENIUM_DETAIL_NIKOLAEV_WCQ_HPP
+
+#include "xenium/detail/double_width_cas.hpp"
+#include "xenium/utils.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium::detail {
+
+/**
+ * Assigns small process-wide ids to threads. An id is acquired when a thread calls
+ * `current()` for the first time and is released again when the thread terminates.
+ * If all ids are in use, `current()` returns `max_ids`.
+ *
+ * Ids are reused, so a thread may acquire an id that was previously held by a terminated
+ * thread. Releasing an id synchronizes with its next acquisition, so the new owner can
+ * safely take over any non-atomic state associated with the id.
+ */
+class wcq_thread_id {
+public:
+  static constexpr std::size_t max_ids = 4096;
+
+  static std::size_t current() { return holder.id; }
+
+private:
+  static constexpr std::size_t bits_per_word = 64;
+  static constexpr std::size_t words = max_ids / bits_per_word;
+
+  struct id_holder {
+    id_holder() : id(acquire()) {}
+    ~id_holder() { release(id); }
+    std::size_t id;
+  };
+
+  static std::size_t acquire() {
+    for (std::size_t i = 0; i < words; ++i) {
+      auto bits = used[i].load(std::memory_order_relaxed);
+      while (bits != ~std::uint64_t(0)) {
+        std::size_t bit = 0;
+        while (bits & (std::uint64_t(1) << bit)) {
+          ++bit;
+        }
+        if (used[i].compare_exchange_weak(
+              bits, bits | (std::uint64_t(1) << bit), std::memory_order_acquire, std::memory_order_relaxed)) {
+          return i * bits_per_word + bit;
+        }
+      }
+    }
+    return max_ids;
+  }
+
+  static void release(std::size_t id) {
+    if (id < max_ids) {
+      used[id / bits_per_word].fetch_and(~(std::uint64_t(1) << (id % bits_per_word)), std::memory_order_release);
+    }
+  }
+
+  inline static std::atomic<std::uint64_t> used[words];
+  inline static thread_local id_holder holder;
+};
+
+/**
+ * A wait-free variant of `nikolaev_scq`, based on Nikolaev's and Ravindran's wCQ
+ * \[[NR22](index.html#ref-nikolaev-2022)\].
+ *
+ * Operations first run the SCQ algorithm (the _fast path_) for a bounded number of attempts.
+ * If this does not succeed, the operation publishes a request in its thread's record and
+ * switches to the _slow path_. Every thread periodically inspects the record of some other
+ * thread and helps to complete a pending request, so a starving operation is eventually
+ * helped by all threads and completes in a bounded number of steps.
+ *
+ * All helpers of a request must agree on the positions used by this request. Positions are
+ * therefore obtained with a cooperative fetch-and-add (`slow_faa`) that increments the global
+ * head/tail exactly once per step. The global counters are pairs of counter and _phase2_ word;
+ * the latter identifies the request an increment belongs to until its thread record has been
+ * updated. As in wCQ, a slow-path enqueue inserts its entry in two steps - first a tentative
+ * entry that references the thread record (via the entry's second word), which is committed
+ * once the request has been finalized at this position. A dequeue that encounters such a
+ * tentative entry resolves it first, i.e., it either finalizes the request (and commits the
+ * entry), or it revokes the entry if the request has already moved on.
+ *
+ * Threads that have no thread record (because the number of threads exceeds `max_threads`)
+ * never give up on the fast path, so for them operations are only lock-free.
+ *
+ * `enqueue_patience` and `dequeue_patience` define the number of fast path attempts before
+ * an operation switches to the slow path; both must be at least one.
+ */
+struct nikolaev_wcq {
+  struct empty_tag {};
+  struct full_tag {};
+
+  nikolaev_wcq(std::size_t capacity,
+               std::size_t remap_shift,
+               std::size_t max_threads,
+               unsigned enqueue_patience,
+               unsigned dequeue_patience,
+               empty_tag);
+  nikolaev_wcq(std::size_t capacity,
+               std::size_t remap_shift,
+               std::size_t max_threads,
+               unsigned enqueue_patience,
+               unsigned dequeue_patience,
+               full_tag);
+
+  template <bool Nonempty, bool Finalizable>
+  bool enqueue(std::uint64_t value, std::size_t capacity, std::size_t remap_shift);
+  template <bool Nonempty, std::size_t PopRetries>
+  bool dequeue(std::uint64_t& value, std::size_t capacity, std::size_t remap_shift);
+
+  static constexpr std::size_t calc_remap_shift(std::size_t capacity) {
+    assert(utils::is_power_of_two(capacity));
+    return utils::find_last_bit_set(capacity / indexes_per_cacheline);
+  }
+
+private:
+  using index_t = std::uint64_t;
+  using indexdiff_t = std::int64_t;
+  using value_t = std::uint64_t;
+
+  static constexpr std::size_t cacheline_size = 64;
+  static constexpr std::size_t indexes_per_cacheline = cacheline_size / sizeof(double_width_word);
+
+  // number of operations after which a thread checks the record of another thread
+  static constexpr unsigned help_delay = 8;
+
+  // flags for the positions stored in thread records
+  static constexpr index_t fin_bit = index_t(1) << 63;
+  static constexpr index_t pending_bit = index_t(1) << 62;
+  static constexpr index_t empty_bit = index_t(1) << 61;
+
+  // the phase2 word consists of the owning thread's id (+1) and the (truncated) position
+  static constexpr unsigned phase2_tid_shift = 48;
+  static constexpr index_t phase2_position_mask = (index_t(1) << phase2_tid_shift) - 1;
+
+  static constexpr index_t index_inc = 2;
+
+  struct entry {
+    index_t value;
+    std::uint64_t note; // non-zero only for tentative entries; id of the owning thread + 1
+  };
+
+  struct alignas(64) thread_record {
+    std::atomic<index_t> local_tail{fin_bit};
+    std::atomic<index_t> init_tail{0};
+    std::atomic<index_t> local_head{fin_bit};
+    std::atomic<index_t> init_head{0};
+    std::atomic<value_t> enqueue_value{0};
+    // The following members are only accessed by the thread that currently holds the record's
+    // id. They are not reset when the id is handed to a new thread (see wcq_thread_id); the new
+    // owner simply continues the previous owner's round-robin over the other records.
+    unsigned next_check = help_delay;
+    std::size_t next_tid = 0;
+  };
+
+  static inline indexdiff_t diff(index_t a, index_t b) { return static_cast<indexdiff_t>(a - b); }
+
+  static inline index_t remap_index(index_t idx, std::size_t remap_shift, std::size_t n) {
+    assert(remap_shift == 0 || (1 << remap_shift) * indexes_per_cacheline == n);
+    idx >>= 1;
+    return ((idx & (n - 1)) >> remap_shift) | ((idx * indexes_per_cacheline) & (n - 1));
+  }
+
+  static inline index_t make_phase2(std::size_t tid, index_t pos) {
+    return (static_cast<index_t>(tid + 1) << phase2_tid_shift) | ((pos >> 1) & phase2_position_mask);
+  }
+
+  entry load_entry(index_t idx) const;
+  bool cas_entry(index_t idx, entry& expected, index_t value, std::uint64_t note);
+
+  thread_record* my_record();
+
+  bool try_enqueue(index_t tail, value_t value, std::size_t capacity, std::size_t remap_shift);
+  enum class dequeue_result { success, empty, retry };
+  template <std::size_t PopRetries>
+  dequeue_result try_dequeue(index_t head, value_t& value, std::size_t capacity, std::size_t remap_shift);
+
+  void enqueue_slow(std::size_t tid, index_t tail, value_t value, std::size_t capacity, std::size_t remap_shift);
+  bool dequeue_slow(std::size_t tid, index_t head, value_t& value, std::size_t capacity, std::size_t remap_shift);
+  bool try_enqueue_slow(std::size_t tid, index_t tail, std::size_t capacity, std::size_t remap_shift);
+  bool try_dequeue_slow(std::size_t tid, index_t head, std::size_t capacity, std::size_t remap_shift);
+  bool slow_faa(double_width_word& global, std::size_t tid, index_t& pos, bool is_head);
+  void help_phase2(double_width_word& global, std::uint64_t phase2, bool is_head);
+  void resolve_tentative(index_t idx, entry tentative, index_t tail, std::size_t capacity);
+
+  void help_threads(thread_record& rec, std::size_t capacity, std::size_t remap_shift);
+  void help_enqueue(std::size_t tid, std::size_t capacity, std::size_t remap_shift);
+  void help_dequeue(std::size_t tid, std::size_t capacity, std::size_t remap_shift);
+
+  void catchup(std::uint64_t tail, std::uint64_t head);
+
+  // index values are structured as follows
+  // 0..log2(capacity)+1 bits   - value [0..capacity-1, nil (=2*capacity-1)]
+  // 1 bit                      - is_safe flag
+  // log2(capacity) + 2..n bits - cycle
+
+  // The low words of _head/_tail are the counters, the high words are the phase2 words.
+  double_width_word _head;
+  alignas(64) std::atomic<std::int64_t> _threshold;
+  alignas(64) double_width_word _tail;
+  alignas(64) std::unique_ptr<double_width_word[]> _data;
+  const std::size_t _max_threads;
+  const unsigned _enqueue_patience;
+  const unsigned _dequeue_patience;
+  std::unique_ptr<thread_record[]> _records;
+};
+
+inline nikolaev_wcq::nikolaev_wcq(std::size_t capacity,
+                                  std::size_t remap_shift,
+                                  std::size_t max_threads,
+                                  unsigned enqueue_patience,
+                                  unsigned dequeue_patience,
+                                  empty_tag) :
+    _threshold(-1),
+    _data(new double_width_word[capacity * 2]),
+    _max_threads(max_threads),
+    _enqueue_patience(enqueue_patience),
+    _dequeue_patience(dequeue_patience),
+    _records(new thread_record[max_threads]) {
+  const auto n = capacity * 2;
+  _head.store(0, 0, std::memory_order_relaxed);
+  _tail.store(0, 0, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < n; ++i) {
+    _data[remap_index(i << 1, remap_shift, n)].store(static_cast<index_t>(-1), 0, std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < max_threads; ++i) {
+    _records[i].next_tid = (i + 1) % max_threads;
+  }
+}
+
+inline nikolaev_wcq::nikolaev_wcq(std::size_t capacity,
+                                  std::size_t remap_shift,
+                                  std::size_t max_threads,
+                                  unsigned enqueue_patience,
+                                  unsigned dequeue_patience,
+                                  full_tag) :
+    _threshold(static_cast<std::int64_t>(capacity) * 3 - 1),
+    _data(new double_width_word[capacity * 2]),
+    _max_threads(max_threads),
+    _enqueue_patience(enqueue_patience),
+    _dequeue_patience(dequeue_patience),
+    _records(new thread_record[max_threads]) {
+  const auto n = capacity * 2;
+  _head.store(0, 0, std::memory_order_relaxed);
+  _tail.store(capacity * index_inc, 0, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < capacity; ++i) {
+    _data[remap_index(i << 1, remap_shift, n)].store(n + i, 0, std::memory_order_relaxed);
+  }
+  for (std::size_t i = capacity; i < n; ++i) {
+    _data[remap_index(i << 1, remap_shift, n)].store(static_cast<index_t>(-1), 0, std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < max_threads; ++i) {
+    _records[i].next_tid = (i + 1) % max_threads;
+  }
+}
+
+// The fast path uses the same memory orders as nikolaev_scq (the double-width CAS is always
+// sequentially consistent). All operations on thread records and phase2 words are sequentially
+// consistent. Tentative entries are committed by whichever thread resolves them, so the value
+// written by the enqueuing thread is published via its thread record: the enqueuing thread
+// stores the request's initial position after its value, and all later updates of the position
+// are RMW operations that continue this release sequence.
+
+inline auto nikolaev_wcq::load_entry(index_t idx) const -> entry {
+  // (1) - this acquire-load synchronizes-with the CAS (2)
+  auto value = _data[idx].lo.load(std::memory_order_acquire);
+  auto note = _data[idx].hi.load(std::memory_order_acquire);
+  return {value, note};
+}
+
+inline bool nikolaev_wcq::cas_entry(index_t idx, entry& expected, index_t value, std::uint64_t note) {
+  // (2) - this CAS synchronizes-with the acquire-load (1)
+  return _data[idx].compare_exchange(expected.value, expected.note, value, note);
+}
+
+inline auto nikolaev_wcq::my_record() -> thread_record* {
+  const auto tid = wcq_thread_id::current();
+  return tid < _max_threads ? &_records[tid] : nullptr;
+}
+
+template <bool Nonempty, bool Finalizable>
+inline bool nikolaev_wcq::enqueue(std::uint64_t value, std::size_t capacity, std::size_t remap_shift) {
+  static_assert(!Nonempty && !Finalizable, "nikolaev_wcq supports neither nonempty nor finalizable queues");
+  assert(value < capacity);
+
+  auto* rec = my_record();
+  if (rec != nullptr) {
+    help_threads(*rec, capacity, remap_shift);
+  }
+
+  for (unsigned attempt = 1;; ++attempt) {
+    auto tail = _tail.fetch_add_lo(index_inc, std::memory_order_relaxed);
+    if (try_enqueue(tail, value, capacity, remap_shift)) {
+      return true;
+    }
+    if (rec != nullptr && attempt == _enqueue_patience) {
+      enqueue_slow(static_cast<std::size_t>(rec - _records.get()), tail, value, capacity, remap_shift);
+      return true;
+    }
+  }
+}
+
+inline bool nikolaev_wcq::try_enqueue(index_t tail, value_t value, std::size_t capacity, std::size_t remap_shift) {
+  const std::size_t n = capacity * 2;
+  const std::size_t is_safe_and_value_mask = 2 * n - 1;
+  const auto tail_cycle = tail | is_safe_and_value_mask;
+  const auto tidx = remap_index(tail, remap_shift, n);
+  auto e = load_entry(tidx);
+  for (;;) {
+    const auto entry_cycle = e.value | is_safe_and_value_mask;
+    if (diff(entry_cycle, tail_cycle) >= 0 ||
+        (e.value != entry_cycle &&
+         (e.value != (entry_cycle ^ n) || diff(_head.lo.load(std::memory_order_relaxed), tail) > 0))) {
+      return false;
+    }
+
+    if (cas_entry(tidx, e, (tail_cycle ^ is_safe_and_value_mask) | value, 0)) {
+      const auto threshold = static_cast<std::int64_t>(n + capacity - 1);
+      if (_threshold.load(std::memory_order_relaxed) != threshold) {
+        _threshold.store(threshold, std::memory_order_relaxed);
+      }
+      return true;
+    }
+  }
+}
+
+template <bool Nonempty, std::size_t PopRetries>
+inline bool nikolaev_wcq::dequeue(std::uint64_t& value, std::size_t capacity, std::size_t remap_shift) {
+  static_assert(!Nonempty, "nikolaev_wcq does not support nonempty queues");
+  if (_threshold.load(std::memory_order_relaxed) < 0) {
+    return false;
+  }
+
+  auto* rec = my_record();
+  if (rec != nullptr) {
+    help_threads(*rec, capacity, remap_shift);
+  }
+
+  for (unsigned attempt = 1;; ++attempt) {
+    auto head = _head.fetch_add_lo(index_inc, std::memory_order_relaxed);
+    switch (try_dequeue<PopRetries>(head, value, capacity, remap_shift)) {
+      case dequeue_result::success:
+        return true;
+      case dequeue_result::empty:
+        return false;
+      case dequeue_result::retry:
+        break;
+    }
+    if (rec != nullptr && attempt == _dequeue_patience) {
+      return dequeue_slow(static_cast<std::size_t>(rec - _records.get()), head, value, capacity, remap_shift);
+    }
+  }
+}
+
+template <std::size_t PopRetries>
+inline auto nikolaev_wcq::try_dequeue(index_t head, value_t& value, std::size_t capacity, std::size_t remap_shift)
+  -> dequeue_result {
+  const std::size_t n = capacity * 2;
+  const std::size_t value_mask = n - 1;
+  const std::size_t is_safe_and_value_mask = 2 * n - 1;
+  const auto head_cycle = head | is_safe_and_value_mask;
+  const auto hidx = remap_index(head, remap_shift, n);
+  std::size_t attempt = 0;
+
+  auto e = load_entry(hidx);
+  for (;;) {
+    const auto entry_cycle = e.value | is_safe_and_value_mask;
+    if (entry_cycle == head_cycle) {
+      if ((e.value | n) == entry_cycle) {
+        break; // a revoked slow-path enqueue - there is nothing to dequeue at this position
+      }
+      if (e.note != 0) {
+        resolve_tentative(hidx, e, head, capacity);
+        e = load_entry(hidx);
+        continue;
+      }
+      if (cas_entry(hidx, e, e.value | value_mask, 0)) {
+        value = e.value & value_mask;
+        assert(value < capacity);
+        return dequeue_result::success;
+      }
+      continue;
+    }
+
+    if (diff(entry_cycle, head_cycle) > 0) {
+      break;
+    }
+
+    index_t entry_new;
+    if ((e.value | n) != entry_cycle) {
+      entry_new = e.value & ~n;
+      if (e.value == entry_new) {
+        break;
+      }
+    } else {
+      auto tail = _tail.lo.load(std::memory_order_relaxed);
+      if (diff(tail, head + index_inc) > 0 && ++attempt <= PopRetries) {
+        e = load_entry(hidx);
+        continue;
+      }
+      entry_new = head_cycle;
+    }
+
+    if (cas_entry(hidx, e, entry_new, e.note)) {
+      break;
+    }
+  }
+
+  auto tail = _tail.lo.load(std::memory_order_relaxed);
+  if (diff(tail, head + index_inc) <= 0) {
+    catchup(tail, head + index_inc);
+    _threshold.fetch_sub(1, std::memory_order_relaxed);
+    return dequeue_result::empty;
+  }
+
+  if (_threshold.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+    return dequeue_result::empty;
+  }
+  return dequeue_result::retry;
+}
+
+inline void nikolaev_wcq::enqueue_slow(std::size_t tid,
+                                       index_t tail,
+                                       value_t value,
+                                       std::size_t capacity,
+                                       std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  rec.enqueue_value.store(value, std::memory_order_relaxed);
+  rec.init_tail.store(tail, std::memory_order_relaxed);
+  // publish the request
+  rec.local_tail.store(tail);
+
+  index_t pos = tail;
+  while (slow_faa(_tail, tid, pos, false)) {
+    if (try_enqueue_slow(tid, pos, capacity, remap_shift)) {
+      break;
+    }
+  }
+
+  // The request has been finalized, but the entry might still be tentative, and we
+  // must not return before it has been committed (the value in our record would change).
+  const auto final_pos = rec.local_tail.load() & ~fin_bit;
+  assert((rec.local_tail.load() & fin_bit) != 0);
+  const std::size_t n = capacity * 2;
+  const std::size_t is_safe_and_value_mask = 2 * n - 1;
+  const auto idx = remap_index(final_pos, remap_shift, n);
+  for (;;) {
+    auto e = load_entry(idx);
+    if ((e.value | is_safe_and_value_mask) != (final_pos | is_safe_and_value_mask) || e.note != tid + 1) {
+      break;
+    }
+    resolve_tentative(idx, e, final_pos, capacity);
+  }
+}
+
+inline bool nikolaev_wcq::dequeue_slow(std::size_t tid,
+                                       index_t head,
+                                       value_t& value,
+                                       std::size_t capacity,
+                                       std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  rec.init_head.store(head, std::memory_order_relaxed);
+  // publish the request
+  rec.local_head.store(head);
+
+  index_t pos = head;
+  while (slow_faa(_head, tid, pos, true)) {
+    if (try_dequeue_slow(tid, pos, capacity, remap_shift)) {
+      break;
+    }
+  }
+
+  const auto result = rec.local_head.load();
+  assert((result & fin_bit) != 0);
+  if ((result & empty_bit) != 0) {
+    return false;
+  }
+
+  // The request has been finalized at a position that holds a committed entry. Nobody
+  // but us consumes an entry at this position, so the value is still there.
+  const auto final_pos = result & ~fin_bit;
+  const std::size_t n = capacity * 2;
+  const std::size_t value_mask = n - 1;
+  const auto idx = remap_index(final_pos, remap_shift, n);
+  auto e = load_entry(idx);
+  for (;;) {
+    assert((e.value | (2 * n - 1)) == (final_pos | (2 * n - 1)) && e.note == 0);
+    if (cas_entry(idx, e, e.value | value_mask, 0)) {
+      value = e.value & value_mask;
+      assert(value < capacity);
+      return true;
+    }
+  }
+}
+
+inline bool nikolaev_wcq::try_enqueue_slow(std::size_t tid,
+                                           index_t tail,
+                                           std::size_t capacity,
+                                           std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  const std::size_t n = capacity * 2;
+  const std::size_t is_safe_and_value_mask = 2 * n - 1;
+  const auto tail_cycle = tail | is_safe_and_value_mask;
+  const auto tidx = remap_index(tail, remap_shift, n);
+  for (;;) {
+    auto e = load_entry(tidx);
+    // The entry must be loaded before the position - the request is finalized before a
+    // tentative entry is committed (and consumed), so we cannot miss a finalization.
+    const auto pos = rec.local_tail.load();
+    if (pos != tail) {
+      return (pos & fin_bit) != 0;
+    }
+
+    const auto entry_cycle = e.value | is_safe_and_value_mask;
+    if (entry_cycle == tail_cycle) {
+      if ((e.value | n) != entry_cycle && e.note != 0) {
+        resolve_tentative(tidx, e, tail, capacity);
+        continue;
+      }
+      return false; // a dequeue operation has already passed this position
+    }
+
+    if (diff(entry_cycle, tail_cycle) > 0 ||
+        (e.value != entry_cycle &&
+         (e.value != (entry_cycle ^ n) || diff(_head.lo.load(std::memory_order_relaxed), tail) > 0))) {
+      return false;
+    }
+
+    entry tentative{tail_cycle ^ is_safe_and_value_mask, tid + 1};
+    if (cas_entry(tidx, e, tentative.value, tentative.note)) {
+      const auto threshold = static_cast<std::int64_t>(n + capacity - 1);
+      if (_threshold.load(std::memory_order_relaxed) != threshold) {
+        _threshold.store(threshold, std::memory_order_relaxed);
+      }
+      resolve_tentative(tidx, tentative, tail, capacity);
+    }
+  }
+}
+
+inline bool nikolaev_wcq::try_dequeue_slow(std::size_t tid,
+                                           index_t head,
+                                           std::size_t capacity,
+                                           std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  const std::size_t n = capacity * 2;
+  const std::size_t is_safe_and_value_mask = 2 * n - 1;
+  const auto head_cycle = head | is_safe_and_value_mask;
+  const auto hidx = remap_index(head, remap_shift, n);
+  for (;;) {
+    auto e = load_entry(hidx);
+    auto pos = rec.local_head.load();
+    if (pos != head) {
+      return (pos & fin_bit) != 0;
+    }
+
+    const auto entry_cycle = e.value | is_safe_and_value_mask;
+    if (entry_cycle == head_cycle) {
+      if ((e.value | n) == entry_cycle) {
+        break; // there is nothing to dequeue at this position
+      }
+      if (e.note != 0) {
+        resolve_tentative(hidx, e, head, capacity);
+        continue;
+      }
+      // This entry belongs to our position, so nobody else can consume it. We only
+      // finalize the request here - the value is taken by the owner of the request.
+      rec.local_head.compare_exchange_strong(pos, head | fin_bit);
+      continue;
+    }
+
+    if (diff(entry_cycle, head_cycle) > 0) {
+      break;
+    }
+
+    index_t entry_new;
+    if ((e.value | n) != entry_cycle) {
+      entry_new = e.value & ~n;
+      if (e.value == entry_new) {
+        break;
+      }
+    } else {
+      entry_new = head_cycle;
+    }
+
+    if (cas_entry(hidx, e, entry_new, e.note)) {
+      break;
+    }
+  }
+
+  // There is no value at this position - check whether the queue is empty. The threshold is
+  // decremented in slow_faa when the position is acquired.
+  auto tail = _tail.lo.load(std::memory_order_relaxed);
+  if (diff(tail, head + index_inc) <= 0) {
+    catchup(tail, head + index_inc);
+  } else if (_threshold.load(std::memory_order_relaxed) >= 0) {
+    return false;
+  }
+
+  auto expected = head;
+  if (rec.local_head.compare_exchange_strong(expected, head | fin_bit | empty_bit)) {
+    return true;
+  }
+  return (expected & fin_bit) != 0;
+}
+
+inline bool nikolaev_wcq::slow_faa(double_width_word& global, std::size_t tid, index_t& pos, bool is_head) {
+  auto& local = is_head ? _records[tid].local_head : _records[tid].local_tail;
+  for (;;) {
+    auto l = local.load();
+    if ((l & fin_bit) != 0) {
+      return false;
+    }
+    if ((l & pending_bit) == 0 && l != pos) {
+      // the request has already been advanced to a new position
+      pos = l;
+      return true;
+    }
+
+    auto cnt = global.lo.load();
+    auto phase2 = global.hi.load();
+    if (phase2 != 0) {
+      help_phase2(global, phase2, is_head);
+      continue;
+    }
+
+    // Claim the current counter value for this request; if another helper has already
+    // claimed an outdated value, we replace it.
+    const auto claimed = cnt | pending_bit;
+    if (l != claimed && !local.compare_exchange_strong(l, claimed)) {
+      continue;
+    }
+
+    // The increment is associated with the request via the phase2 word until the pending
+    // flag in the thread record has been cleared. Since the global counter is monotonic, at
+    // most one helper can succeed with this CAS for a given counter value.
+    const auto new_phase2 = make_phase2(tid, cnt);
+    if (global.compare_exchange(cnt, phase2, cnt + index_inc, new_phase2)) {
+      if (is_head) {
+        _threshold.fetch_sub(1, std::memory_order_relaxed);
+      }
+      help_phase2(global, new_phase2, is_head);
+    }
+  }
+}
+
+inline void nikolaev_wcq::help_phase2(double_width_word& global, std::uint64_t phase2, bool is_head) {
+  const auto tid = static_cast<std::size_t>(phase2 >> phase2_tid_shift) - 1;
+  auto& local = is_head ? _records[tid].local_head : _records[tid].local_tail;
+  auto l = local.load();
+  if ((l & pending_bit) != 0 && (((l & ~pending_bit) >> 1) & phase2_position_mask) == (phase2 & phase2_position_mask)) {
+    local.compare_exchange_strong(l, l & ~pending_bit);
+  }
+
+  auto cnt = global.lo.load();
+  auto expected = phase2;
+  while (!global.compare_exchange(cnt, expected, cnt, 0) && expected == phase2) {
+  }
+}
+
+inline void nikolaev_wcq::resolve_tentative(index_t idx, entry tentative, index_t tail, std::size_t capacity) {
+  const std::size_t is_safe_and_value_mask = 4 * capacity - 1;
+  auto& rec = _records[tentative.note - 1];
+  auto pos = rec.local_tail.load();
+  if (pos == tail) {
+    rec.local_tail.compare_exchange_strong(pos, tail | fin_bit);
+    pos = rec.local_tail.load();
+  }
+
+  if (pos == (tail | fin_bit)) {
+    // The request has been finalized at this position, so the owner cannot have returned
+    // (and reused its record) yet, because it waits until the entry has been committed.
+    cas_entry(idx, tentative, tentative.value | rec.enqueue_value.load(), 0);
+  } else {
+    // The request has moved on, so this entry is revoked.
+    cas_entry(idx, tentative, tentative.value | is_safe_and_value_mask, 0);
+  }
+}
+
+inline void nikolaev_wcq::help_threads(thread_record& rec, std::size_t capacity, std::size_t remap_shift) {
+  if (--rec.next_check != 0) {
+    return;
+  }
+  rec.next_check = help_delay;
+  const auto tid = rec.next_tid;
+  rec.next_tid = (tid + 1) % _max_threads;
+  help_enqueue(tid, capacity, remap_shift);
+  help_dequeue(tid, capacity, remap_shift);
+}
+
+inline void nikolaev_wcq::help_enqueue(std::size_t tid, std::size_t capacity, std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  auto pos = rec.local_tail.load();
+  if ((pos & fin_bit) != 0) {
+    return;
+  }
+  // The initial position has already been tried by the owner in its fast path; but if the
+  // request has been advanced to a new position, we have to try this one before moving on.
+  if ((pos & pending_bit) == 0 && pos != rec.init_tail.load()) {
+    if (try_enqueue_slow(tid, pos, capacity, remap_shift)) {
+      return;
+    }
+  }
+  while (slow_faa(_tail, tid, pos, false)) {
+    if (try_enqueue_slow(tid, pos, capacity, remap_shift)) {
+      return;
+    }
+  }
+}
+
+inline void nikolaev_wcq::help_dequeue(std::size_t tid, std::size_t capacity, std::size_t remap_shift) {
+  auto& rec = _records[tid];
+  auto pos = rec.local_head.load();
+  if ((pos & fin_bit) != 0) {
+    return;
+  }
+  if ((pos & pending_bit) == 0 && pos != rec.init_head.load()) {
+    if (try_dequeue_slow(tid, pos, capacity, remap_shift)) {
+      return;
+    }
+  }
+  while (slow_faa(_head, tid, pos, true)) {
+    if (try_dequeue_slow(tid, pos, capacity, remap_shift)) {
+      return;
+    }
+  }
+}
+
+inline void nikolaev_wcq::catchup(std::uint64_t tail, std::uint64_t head) {
+  auto phase2 = _tail.hi.load(std::memory_order_relaxed);
+  while (!_tail.compare_exchange(tail, phase2, head, phase2)) {
+    head = _head.lo.load(std::memory_order_relaxed);
+    if (diff(tail, head) >= 0) {
+      break;
+    }
+  }
+}
+} // namespace xenium::detail
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
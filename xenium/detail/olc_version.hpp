@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_DETAIL_OLC_VERSION_HPP
+#define XENIUM_DETAIL_OLC_VERSION_HPP
+
+#include <xenium/detail/port.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace xenium::detail {
+
+/**
+ * @brief The version word of a node that is synchronized via optimistic lock coupling.
+ *
+ * The version consists of an obsolete bit, a lock bit and a counter in the remaining bits.
+ * It is used like the sequence counter of a `seqlock`: readers remember the version, read
+ * the node's content (which must consist of atomics that are read with relaxed order) and
+ * validate afterwards that the version has not changed. Writers lock the node by upgrading
+ * a previously read version, so writers never wait for each other - if the upgrade fails,
+ * the operation has to restart. Unlocking increments the counter; an obsolete node (i.e., a
+ * node that has been removed from the data structure) remains obsolete forever.
+ */
+class olc_version {
+public:
+  /**
+   * @brief Reads the current version; fails if the node is currently locked or obsolete.
+   */
+  bool read_lock(std::uint64_t& version) const noexcept {
+    // (1) - this acquire-load synchronizes-with the release-FAAs (5, 6)
+    version = _version.load(std::memory_order_acquire);
+    return (version & (locked_bit | obsolete_bit)) == 0;
+  }
+
+  /**
+   * @brief Checks whether the version is still the same, i.e., whether the data that has been
+   * read since the call to `read_lock` is consistent.
+   */
+  [[nodiscard]] bool validate(std::uint64_t version) const noexcept {
+    // (2) - this acquire-fence synchronizes-with the release-fence (4)
+    XENIUM_THREAD_FENCE(std::memory_order_acquire);
+    return _version.load(std::memory_order_relaxed) == version;
+  }
+
+  /**
+   * @brief Tries to lock the node; fails if the version has changed since it has been read.
+   */
+  bool try_upgrade(std::uint64_t version) noexcept {
+    // (3) - this acquire-CAS synchronizes-with the release-FAAs (5, 6)
+    if (!_version.compare_exchange_strong(
+          version, version + locked_bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return false;
+    }
+    // (4) - this release-fence synchronizes-with the acquire-fence (2)
+    XENIUM_THREAD_FENCE(std::memory_order_release);
+    return true;
+  }
+
+  void unlock() noexcept {
+    // Adding the lock bit clears it and increments the counter.
+    // (5) - this release-FAA synchronizes-with the acquire-load (1) and the acquire-CAS (3)
+    _version.fetch_add(locked_bit, std::memory_order_release);
+  }
+
+  void unlock_obsolete() noexcept {
+    // (6) - this release-FAA synchronizes-with the acquire-load (1) and the acquire-CAS (3)
+    _version.fetch_add(locked_bit | obsolete_bit, std::memory_order_release);
+  }
+
+private:
+  static constexpr std::uint64_t obsolete_bit = 1;
+  static constexpr std::uint64_t locked_bit = 2;
+
+  std::atomic<std::uint64_t> _version{0};
+};
+} // namespace xenium::detail
+
+#endif
@@ -6,6 +6,8 @@
 #ifndef XENIUM_POINTER_QUEUE_TRAITS_HPP
 #define XENIUM_POINTER_QUEUE_TRAITS_HPP
 
+#include <xenium/detail/atomic_inline_value.hpp>
+
 #include <cstring>
 #include <memory>
 #include <optional>
@@ -67,6 +69,22 @@ struct pointer_queue_traits<std::unique_ptr<T>, Policies...> {
   static void delete_value(raw_type v) { std::unique_ptr<T> dummy{v}; }
 };
 
+// Traits for trivially copyable types that do not fit into a pointer, but are small
+// enough to be stored inline in the queue's entries.
+template <class T, class... Policies>
+struct inline_queue_traits {
+  static_assert(is_inline_value_v<T>);
+  using value_type = T;
+  using raw_type = T;
+  static raw_type get_raw(value_type& val) { return val; }
+  static void release(value_type&) {}
+  static std::optional<value_type> get(raw_type val) { return val; }
+  static void delete_value(raw_type) {}
+};
+
+template <class T>
+inline constexpr bool use_inline_queue_traits_v = is_inline_value_v<T> && sizeof(T) >= sizeof(void*);
+
 template <class T, class... Policies>
 using pointer_queue_traits_t = std::conditional_t<std::is_trivially_copyable<T>::value && sizeof(T) < sizeof(void*),
                                                   trivially_copyable_pointer_queue_traits<T, Policies...>,
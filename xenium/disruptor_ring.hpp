@@ -0,0 +1,487 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_DISRUPTOR_RING_HPP
+#define XENIUM_DISRUPTOR_RING_HPP
+
+#include <xenium/array_allocator.hpp>
+#include <xenium/backoff.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/utils.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure whether a `disruptor_ring` is only used by a single producer.
+   *
+   * A single producer can claim sequences without any atomic read-modify-write operation.
+   * @tparam Value
+   */
+  template <bool Value>
+  struct single_producer;
+} // namespace policy
+
+/**
+ * @brief A bounded broadcast ring buffer in the style of the LMAX Disruptor.
+ *
+ * In contrast to a queue, every published element is delivered to _every_ consumer. Each
+ * consumer keeps its own sequence cursor, and an element's slot is only reused once all
+ * consumers have moved past it. Producers therefore gate on the slowest consumer; the minimum
+ * of the consumer cursors is cached, so producers only have to inspect all consumer cursors
+ * when the cached value indicates that the ring may be full.
+ *
+ * The ring uses the same cell layout as `vyukov_bounded_queue`: every cell consists of a
+ * sequence number and the element. A producer publishes the element for sequence `s` by
+ * storing `s + 1` into the cell's sequence number, so producers can publish out of order and
+ * consumers can detect the end of the contiguously published range without any shared
+ * "published" cursor.
+ *
+ * Producers work in two steps: `claim` (or `try_claim`) reserves a range of sequences, the
+ * elements are then written via `operator[]`, and finally the whole range is made visible to
+ * the consumers with a single call to `publish`. `push` and `try_push` combine these steps for
+ * single elements.
+ *
+ * Consumers are created via `add_consumer`. A consumer can depend on other consumers, in which
+ * case it only sees elements that all its dependencies have already processed; this allows to
+ * build processing pipelines and diamonds like in the Disruptor. Consumers must be added before
+ * the producers start, i.e., `add_consumer` must not be called concurrently with any other
+ * operation. If no consumer is added, producers never block, but elements are overwritten
+ * without anyone seeing them.
+ *
+ * The ring stores default constructed instances of `T` in all cells; elements are written by
+ * assignment and are never destroyed before the ring itself is destroyed.
+ *
+ * Supported policies:
+ *  * `xenium::policy::single_producer`<br>
+ *    If true, only a single thread may claim/publish elements, which allows claiming without
+ *    atomic read-modify-write operations. (*optional*; defaults to false)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy used while a producer waits for the consumers in `claim`/`push`.
+ *    (*optional*; defaults to `xenium::no_backoff`)
+ *  * `xenium::policy::array_allocator`<br>
+ *    Defines the allocator for the internal ring buffer.
+ *    (*optional*; defaults to `xenium::default_array_allocator`)
+ *
+ * @tparam T type of the stored elements; must be default constructible.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class disruptor_ring {
+public:
+  static_assert(std::is_default_constructible_v<T>, "T must be default constructible.");
+
+  using value_type = T;
+  static constexpr bool single_producer =
+    parameter::value_param_t<bool, policy::single_producer, false, Policies...>::value;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+  using array_allocator = parameter::type_param_t<policy::array_allocator, default_array_allocator, Policies...>;
+
+  template <class... NewPolicies>
+  using with = disruptor_ring<T, NewPolicies..., Policies...>;
+
+  class consumer;
+
+  /**
+   * @brief Constructs a new instance with the specified capacity.
+   * @param capacity max number of published elements that have not yet been processed by all
+   * consumers; must be a power of two greater one.
+   */
+  explicit disruptor_ring(std::size_t capacity);
+  ~disruptor_ring();
+
+  disruptor_ring(const disruptor_ring&) = delete;
+  disruptor_ring(disruptor_ring&&) = delete;
+
+  disruptor_ring& operator=(const disruptor_ring&) = delete;
+  disruptor_ring& operator=(disruptor_ring&&) = delete;
+
+  /**
+   * @brief Adds a new consumer that only sees elements that have been processed by all
+   * the given dependencies.
+   *
+   * The new consumer starts at the current claim position, i.e., it does not see any element
+   * that has been claimed before it was added. The returned reference remains valid for the
+   * lifetime of the ring.
+   *
+   * This operation must not be called concurrently with any other operation on the ring.
+   *
+   * @param dependencies consumers of this ring that have to process an element before the new
+   * consumer can see it
+   * @return the new consumer
+   */
+  consumer& add_consumer(std::initializer_list<std::reference_wrapper<const consumer>> dependencies = {});
+
+  /**
+   * @brief Tries to claim `n` consecutive sequences.
+   *
+   * Fails if there is not enough space, i.e., if claiming would overwrite elements that have
+   * not yet been processed by all consumers. The claimed elements have to be published via
+   * `publish` in any case, otherwise the consumers will stall.
+   *
+   * Progress guarantees: lock-free (wait-free with `policy::single_producer`)
+   *
+   * @param n the number of sequences to claim; must not exceed the capacity.
+   * @param first the first claimed sequence if the operation was successful
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_claim(std::size_t n, std::uint64_t& first);
+
+  /**
+   * @brief Claims `n` consecutive sequences, waiting for the consumers if necessary.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param n the number of sequences to claim; must not exceed the capacity.
+   * @return the first claimed sequence
+   */
+  std::uint64_t claim(std::size_t n = 1);
+
+  /**
+   * @brief Returns the element for the given sequence.
+   *
+   * Producers may only write elements for sequences they have claimed but not yet published.
+   * @param seq
+   * @return the element
+   */
+  T& operator[](std::uint64_t seq) noexcept { return _cells[seq & _index_mask].value; }
+
+  /**
+   * @brief Publishes the elements of the `n` sequences starting with `first`.
+   *
+   * All these sequences must have been claimed by the calling thread.
+   *
+   * Progress guarantees: wait-free
+   *
+   * @param first
+   * @param n
+   */
+  void publish(std::uint64_t first, std::size_t n = 1) noexcept;
+
+  /**
+   * @brief Tries to claim a single sequence, assigns it the given value and publishes it.
+   *
+   * Progress guarantees: see `try_claim`
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  template <class U>
+  bool try_push(U&& value);
+
+  /**
+   * @brief Claims a single sequence, assigns it the given value and publishes it.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param value
+   */
+  template <class U>
+  void push(U&& value);
+
+  /**
+   * @brief Returns the capacity of the ring.
+   */
+  [[nodiscard]] std::size_t capacity() const noexcept { return _index_mask + 1; }
+
+private:
+  struct cell {
+    std::atomic<std::uint64_t> sequence;
+    T value;
+  };
+
+  static_assert(alignof(cell) <= array_allocator::alignment, "T must not be over-aligned.");
+
+  std::uint64_t min_gating_sequence(std::uint64_t limit) const noexcept;
+  bool has_space(std::uint64_t end, std::uint64_t& gate) noexcept;
+
+  cell* _cells;
+  const std::size_t _index_mask;
+  // the consumers that no other consumer depends on - all other consumers are always ahead of them
+  std::vector<const consumer*> _gating;
+  std::vector<std::unique_ptr<consumer>> _consumers;
+  alignas(64) std::atomic<std::uint64_t> _claim{0};
+  // the (cached) minimum of the gating consumers' cursors
+  alignas(64) std::atomic<std::uint64_t> _gate{0};
+};
+
+/**
+ * @brief A consumer of a `disruptor_ring`, created via `disruptor_ring::add_consumer`.
+ *
+ * Every consumer sees all published elements in sequence order. A consumer may only be used by
+ * a single thread at a time.
+ */
+template <class T, class... Policies>
+class disruptor_ring<T, Policies...>::consumer {
+public:
+  consumer(const consumer&) = delete;
+  consumer(consumer&&) = delete;
+
+  consumer& operator=(const consumer&) = delete;
+  consumer& operator=(consumer&&) = delete;
+
+  /**
+   * @brief Processes up to `max` available elements in sequence order.
+   *
+   * `func` is called with a const reference to the element and its sequence for each element.
+   * The consumer's cursor is only advanced once after the whole batch has been processed, so
+   * producers and dependent consumers see the batch as a whole.
+   *
+   * Progress guarantees: wait-free
+   *
+   * @param func callable with signature `void(const T&, std::uint64_t)`
+   * @param max the maximum number of elements to process
+   * @return the number of processed elements
+   */
+  template <class Func>
+  std::size_t try_consume(Func&& func, std::size_t max = std::numeric_limits<std::size_t>::max());
+
+  /**
+   * @brief Tries to copy the next element to `result`.
+   *
+   * Progress guarantees: wait-free
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T& result);
+
+  /**
+   * @brief Returns the sequence of the next element this consumer will process.
+   */
+  [[nodiscard]] std::uint64_t sequence() const noexcept { return _cursor.load(std::memory_order_relaxed); }
+
+private:
+  friend class disruptor_ring;
+
+  consumer(disruptor_ring& ring, std::vector<const consumer*>&& dependencies, std::uint64_t start) :
+      _ring(ring),
+      _dependencies(std::move(dependencies)),
+      _cached_limit(start),
+      _cursor(start) {}
+
+  std::uint64_t dependency_limit(std::uint64_t seq) noexcept;
+
+  disruptor_ring& _ring;
+  const std::vector<const consumer*> _dependencies;
+  // the (cached) minimum of the dependencies' cursors
+  std::uint64_t _cached_limit;
+  alignas(64) std::atomic<std::uint64_t> _cursor;
+};
+
+template <class T, class... Policies>
+disruptor_ring<T, Policies...>::disruptor_ring(std::size_t capacity) :
+    _cells(static_cast<cell*>(array_allocator::allocate(capacity * sizeof(cell)))),
+    _index_mask(capacity - 1) {
+  assert(capacity >= 2 && utils::is_power_of_two(capacity));
+  if (_cells == nullptr) {
+    throw std::bad_alloc();
+  }
+  std::size_t i = 0;
+  try {
+    for (; i < capacity; ++i) {
+      // the sequence of cell i is zero, so sequence i is not yet published
+      new (&_cells[i]) cell{};
+    }
+  } catch (...) {
+    while (i > 0) {
+      _cells[--i].~cell();
+    }
+    array_allocator::deallocate(_cells);
+    throw;
+  }
+}
+
+template <class T, class... Policies>
+disruptor_ring<T, Policies...>::~disruptor_ring() {
+  for (std::size_t i = 0; i <= _index_mask; ++i) {
+    _cells[i].~cell();
+  }
+  array_allocator::deallocate(_cells);
+}
+
+template <class T, class... Policies>
+auto disruptor_ring<T, Policies...>::add_consumer(
+  std::initializer_list<std::reference_wrapper<const consumer>> dependencies) -> consumer& {
+  std::vector<const consumer*> deps;
+  deps.reserve(dependencies.size());
+  for (const consumer& dep : dependencies) {
+    assert(&dep._ring == this);
+    deps.push_back(&dep);
+    // the new consumer is always behind its dependencies, so they no longer have to gate the producers
+    _gating.erase(std::remove(_gating.begin(), _gating.end(), &dep), _gating.end());
+  }
+
+  auto start = _claim.load(std::memory_order_relaxed);
+  _consumers.push_back(std::unique_ptr<consumer>(new consumer(*this, std::move(deps), start)));
+  auto& result = *_consumers.back();
+  _gating.push_back(&result);
+  if (_gating.size() == 1) {
+    _gate.store(start, std::memory_order_relaxed);
+  }
+  return result;
+}
+
+template <class T, class... Policies>
+std::uint64_t disruptor_ring<T, Policies...>::min_gating_sequence(std::uint64_t limit) const noexcept {
+  for (auto c : _gating) {
+    // (1) - this acquire-load synchronizes-with the release-store (7)
+    limit = std::min(limit, c->_cursor.load(std::memory_order_acquire));
+  }
+  return limit;
+}
+
+template <class T, class... Policies>
+bool disruptor_ring<T, Policies...>::has_space(std::uint64_t end, std::uint64_t& gate) noexcept {
+  if (end - gate <= capacity()) {
+    return true;
+  }
+  // The cached gate is too old - recompute it from the consumers' cursors. Without any
+  // consumers the ring never fills up.
+  auto new_gate = min_gating_sequence(end - capacity());
+  if (new_gate == gate) {
+    return false;
+  }
+  gate = new_gate;
+  // Several producers may update the cache concurrently, so make sure it never moves backwards.
+  auto cached = _gate.load(std::memory_order_relaxed);
+  while (cached < new_gate) {
+    // (2) - this release-CAS synchronizes-with the acquire-load (3)
+    if (_gate.compare_exchange_weak(cached, new_gate, std::memory_order_release, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  return end - gate <= capacity();
+}
+
+template <class T, class... Policies>
+bool disruptor_ring<T, Policies...>::try_claim(std::size_t n, std::uint64_t& first) {
+  assert(n > 0 && n <= capacity());
+  // (3) - this acquire-load synchronizes-with the release-CAS (2)
+  auto gate = _gate.load(std::memory_order_acquire);
+  auto pos = _claim.load(std::memory_order_relaxed);
+  for (;;) {
+    if (!has_space(pos + n, gate)) {
+      return false;
+    }
+    if constexpr (single_producer) {
+      _claim.store(pos + n, std::memory_order_relaxed);
+      break;
+    } else {
+      if (_claim.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+  }
+  first = pos;
+  return true;
+}
+
+template <class T, class... Policies>
+std::uint64_t disruptor_ring<T, Policies...>::claim(std::size_t n) {
+  backoff backoff;
+  std::uint64_t first;
+  while (!try_claim(n, first)) {
+    backoff();
+  }
+  return first;
+}
+
+template <class T, class... Policies>
+void disruptor_ring<T, Policies...>::publish(std::uint64_t first, std::size_t n) noexcept {
+  for (auto seq = first; seq != first + n; ++seq) {
+    // (4) - this release-store synchronizes-with the acquire-load (6)
+    _cells[seq & _index_mask].sequence.store(seq + 1, std::memory_order_release);
+  }
+}
+
+template <class T, class... Policies>
+template <class U>
+bool disruptor_ring<T, Policies...>::try_push(U&& value) {
+  std::uint64_t seq;
+  if (!try_claim(1, seq)) {
+    return false;
+  }
+  (*this)[seq] = std::forward<U>(value);
+  publish(seq);
+  return true;
+}
+
+template <class T, class... Policies>
+template <class U>
+void disruptor_ring<T, Policies...>::push(U&& value) {
+  auto seq = claim();
+  (*this)[seq] = std::forward<U>(value);
+  publish(seq);
+}
+
+template <class T, class... Policies>
+std::uint64_t disruptor_ring<T, Policies...>::consumer::dependency_limit(std::uint64_t seq) noexcept {
+  if (_dependencies.empty()) {
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  if (seq < _cached_limit) {
+    return _cached_limit;
+  }
+  auto limit = std::numeric_limits<std::uint64_t>::max();
+  for (auto dep : _dependencies) {
+    // (5) - this acquire-load synchronizes-with the release-store (7)
+    limit = std::min(limit, dep->_cursor.load(std::memory_order_acquire));
+  }
+  _cached_limit = limit;
+  return limit;
+}
+
+template <class T, class... Policies>
+template <class Func>
+std::size_t disruptor_ring<T, Policies...>::consumer::try_consume(Func&& func, std::size_t max) {
+  const auto start = _cursor.load(std::memory_order_relaxed);
+  const auto limit = dependency_limit(start);
+  auto seq = start;
+  while (seq != limit && seq - start < max) {
+    auto& c = _ring._cells[seq & _ring._index_mask];
+    // (6) - this acquire-load synchronizes-with the release-store (4)
+    if (c.sequence.load(std::memory_order_acquire) != seq + 1) {
+      break;
+    }
+    func(static_cast<const T&>(c.value), seq);
+    ++seq;
+  }
+  if (seq != start) {
+    // (7) - this release-store synchronizes-with the acquire-loads (1, 5)
+    _cursor.store(seq, std::memory_order_release);
+  }
+  return static_cast<std::size_t>(seq - start);
+}
+
+template <class T, class... Policies>
+bool disruptor_ring<T, Policies...>::consumer::try_pop(T& result) {
+  return try_consume([&result](const T& v, std::uint64_t) { result = v; }, 1) == 1;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
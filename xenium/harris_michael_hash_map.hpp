@@ -50,6 +50,15 @@ namespace policy {
   struct memoize_hash;
 } // namespace policy
 
+namespace detail {
+  template <class Key, class K, class = void>
+  struct is_ordered_with : std::false_type {};
+
+  template <class Key, class K>
+  struct is_ordered_with<Key, K, std::void_t<decltype(std::declval<const Key&>() >= std::declval<const K&>())>> :
+      std::true_type {};
+} // namespace detail
+
 /**
  * @brief A generic lock-free hash-map.
  *
@@ -67,7 +76,11 @@ namespace policy {
  *  * `xenium::policy::reclaimer`<br>
  *    Defines the reclamation scheme to be used for internal nodes. (**required**)
  *  * `xenium::policy::hash`<br>
- *    Defines the hash function. (*optional*; defaults to `xenium::hash<Key>`)
+ *    Defines the hash function. (*optional*; defaults to `xenium::hash<Key>`)<br>
+ *    If the hash function defines the member type `is_transparent`, `find`, `contains`
+ *    and `erase` also accept keys of any type `K` that supports `==` and `>=` with `Key`
+ *    (e.g., `std::string_view` for `std::string` keys). `hash(k)` must return the same
+ *    value for all equivalent keys, regardless of their type.
  *  * `xenium::policy::map_to_bucket`<br>
  *    Defines the function that is used to map the calculated hash to a bucket.
  *    (*optional*; defaults to `xenium::utils::modulo<std::size_t>`)
@@ -101,6 +114,13 @@ public:
 
   static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
 
+private:
+  template <class K>
+  using enable_if_transparent = std::enable_if_t<
+    detail::is_transparent_key<hash, Key, K>::value && detail::is_ordered_with<Key, K>::value,
+    int>;
+
+public:
   class iterator;
   class accessor;
 
@@ -195,7 +215,23 @@ public:
    * @param key key of the element to remove
    * @return `true` if an element was removed, otherwise `false`
    */
-  bool erase(const Key& key);
+  bool erase(const Key& key) { return do_erase(key); }
+
+  /**
+   * @brief Removes the element with the key equivalent to key (if one exists).
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   * It allows to remove elements without constructing an instance of `Key`.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to remove
+   * @return `true` if an element was removed, otherwise `false`
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  bool erase(const K& key) {
+    return do_erase(key);
+  }
 
   /**
    * @brief Removes the specified element from the container.
@@ -218,7 +254,23 @@ public:
    * @return iterator to an element with key equivalent to key if such element is found,
    * otherwise past-the-end iterator
    */
-  iterator find(const Key& key);
+  iterator find(const Key& key) { return do_find(key); }
+
+  /**
+   * @brief Finds an element with key equivalent to key.
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to search for
+   * @return iterator to an element with key equivalent to key if such element is found,
+   * otherwise past-the-end iterator
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  iterator find(const K& key) {
+    return do_find(key);
+  }
 
   /**
    * @brief Checks if there is an element with key equivalent to key in the container.
@@ -228,7 +280,22 @@ public:
    * @param key key of the element to search for
    * @return `true` if there is such an element, otherwise `false`
    */
-  bool contains(const Key& key);
+  bool contains(const Key& key) { return do_contains(key); }
+
+  /**
+   * @brief Checks if there is an element with key equivalent to key in the container.
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to search for
+   * @return `true` if there is such an element, otherwise `false`
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  bool contains(const K& key) {
+    return do_contains(key);
+  }
 
   /**
    * @brief
@@ -272,7 +339,10 @@ private:
     template <class... Args>
     explicit data_without_hash(construct_without_hash, Args&&... args) : value(std::forward<Args>(args)...) {}
     [[nodiscard]] hash_t get_hash() const { return hash{}(value.first); }
-    [[nodiscard]] bool greater_or_equal(hash_t /*h*/, const Key& key) const { return value.first >= key; }
+    template <class K>
+    [[nodiscard]] bool greater_or_equal(hash_t /*h*/, const K& key) const {
+      return value.first >= key;
+    }
   };
 
   struct data_with_hash {
@@ -285,7 +355,10 @@ private:
       hash = harris_michael_hash_map::hash{}(value.first);
     }
     [[nodiscard]] hash_t get_hash() const { return hash; }
-    [[nodiscard]] bool greater_or_equal(hash_t h, const Key& key) const { return hash >= h && value.first >= key; }
+    template <class K>
+    [[nodiscard]] bool greater_or_equal(hash_t h, const K& key) const {
+      return hash >= h && value.first >= key;
+    }
   };
 
   using data_t = std::conditional_t<memoize_hash, data_with_hash, data_without_hash>;
@@ -304,7 +377,15 @@ private:
     guard_ptr save{};
   };
 
-  bool find(hash_t hash, const Key& key, std::size_t bucket, find_info& info, backoff& backoff);
+  template <class K>
+  bool find(hash_t hash, const K& key, std::size_t bucket, find_info& info, backoff& backoff);
+
+  template <class K>
+  bool do_contains(const K& key);
+  template <class K>
+  iterator do_find(const K& key);
+  template <class K>
+  bool do_erase(const K& key);
 
   concurrent_ptr buckets[num_buckets];
 };
@@ -453,8 +534,9 @@ harris_michael_hash_map<Key, Value, Policies...>::~harris_michael_hash_map() {
 }
 
 template <class Key, class Value, class... Policies>
+template <class K>
 bool harris_michael_hash_map<Key, Value, Policies...>::find(hash_t hash,
-                                                            const Key& key,
+                                                            const K& key,
                                                             std::size_t bucket,
                                                             find_info& info,
                                                             backoff& backoff) {
@@ -518,7 +600,8 @@ retry:
 }
 
 template <class Key, class Value, class... Policies>
-bool harris_michael_hash_map<Key, Value, Policies...>::contains(const Key& key) {
+template <class K>
+bool harris_michael_hash_map<Key, Value, Policies...>::do_contains(const K& key) {
   auto h = hash{}(key);
   auto bucket = map_to_bucket{}(h, num_buckets);
   find_info info{&buckets[bucket]};
@@ -527,7 +610,8 @@ bool harris_michael_hash_map<Key, Value, Policies...>::contains(const Key& key)
 }
 
 template <class Key, class Value, class... Policies>
-auto harris_michael_hash_map<Key, Value, Policies...>::find(const Key& key) -> iterator {
+template <class K>
+auto harris_michael_hash_map<Key, Value, Policies...>::do_find(const K& key) -> iterator {
   auto h = hash{}(key);
   auto bucket = map_to_bucket{}(h, num_buckets);
   find_info info{&buckets[bucket]};
@@ -636,7 +720,8 @@ auto harris_michael_hash_map<Key, Value, Policies...>::emplace_or_get(Args&&...
 }
 
 template <class Key, class Value, class... Policies>
-bool harris_michael_hash_map<Key, Value, Policies...>::erase(const Key& key) {
+template <class K>
+bool harris_michael_hash_map<Key, Value, Policies...>::do_erase(const K& key) {
   auto h = hash{}(key);
   auto bucket = map_to_bucket{}(h, num_buckets);
   backoff backoff;
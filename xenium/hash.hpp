@@ -10,6 +10,9 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace xenium {
 
@@ -51,6 +54,37 @@ struct hash<Key*> {
     return hash >> shift;
   }
 };
+
+/**
+ * @brief Specialized hash functor for `std::string` that supports heterogeneous lookup.
+ *
+ * The standard guarantees that `std::hash<std::string>` and `std::hash<std::string_view>`
+ * produce the same hash value for equal character sequences. This functor can therefore
+ * also be used to calculate the hash of a `std::string_view` or a C string, without
+ * having to create a temporary `std::string` instance.
+ */
+template <>
+struct hash<std::string> {
+  using is_transparent = void;
+  hash_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+};
+
+namespace detail {
+  /**
+   * Heterogeneous lookup with a key of type `K` in a map with `Key` type is only
+   * supported if `Hash` is transparent and `Key` and `K` are equality comparable.
+   */
+  template <class Hash, class Key, class K, class = void>
+  struct is_transparent_key : std::false_type {};
+
+  template <class Hash, class Key, class K>
+  struct is_transparent_key<Hash,
+                            Key,
+                            K,
+                            std::void_t<typename Hash::is_transparent,
+                                        decltype(std::declval<const Key&>() == std::declval<const K&>())>> :
+      std::bool_constant<!std::is_same_v<Key, K>> {};
+} // namespace detail
 } // namespace xenium
 
 #endif
@@ -0,0 +1,300 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_HOFFMAN_BASKET_QUEUE_HPP
+#define XENIUM_HOFFMAN_BASKET_QUEUE_HPP
+
+#include <xenium/acquire_guard.hpp>
+#include <xenium/backoff.hpp>
+#include <xenium/marked_ptr.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <optional>
+#include <type_traits>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+/**
+ * @brief An unbounded generic lock-free multi-producer/multi-consumer FIFO queue that
+ * reduces the contention on the queue's tail.
+ *
+ * This is an implementation of the basket queue proposed by Hoffman, Shalev and Shavit
+ * \[[HSS07](index.html#ref-hoffman-2007)\].
+ *
+ * Like the `michael_scott_queue`, this queue is a linked list of nodes, but push operations
+ * that fail to append their node to the current tail do not simply retry. The nodes of all
+ * push operations that failed the same CAS form a _basket_ - since these operations were
+ * concurrent, their nodes can be inserted in any order. So instead of competing for the
+ * (new) tail, these operations insert their nodes directly behind the old tail node.
+ *
+ * In order to prevent nodes from being inserted in front of a node that has already been
+ * dequeued, pop operations first mark the link to the node they are about to dequeue. In
+ * contrast to the original proposal, nodes are unlinked from the head immediately (i.e., the
+ * head is not updated lazily), and the tags to prevent the ABA problem are replaced by the
+ * configured reclaimer's `guard_ptr`.
+ *
+ * It is fully generic and can handle any type `T` that is nothrow move constructible.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for internal nodes. (**required**)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy. (*optional*; defaults to `xenium::no_backoff`)
+ *
+ * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class hoffman_basket_queue {
+public:
+  static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible.");
+
+  using value_type = T;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+
+  template <class... NewPolicies>
+  using with = hoffman_basket_queue<T, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+
+  hoffman_basket_queue();
+  ~hoffman_basket_queue();
+
+  hoffman_basket_queue(const hoffman_basket_queue&) = delete;
+  hoffman_basket_queue(hoffman_basket_queue&&) = delete;
+
+  hoffman_basket_queue& operator=(const hoffman_basket_queue&) = delete;
+  hoffman_basket_queue& operator=(hoffman_basket_queue&&) = delete;
+
+  /**
+   * @brief Pushes the given value to the queue.
+   *
+   * This operation always allocates a new node.
+   * Progress guarantees: lock-free (always performs a memory allocation)
+   *
+   * @param value
+   */
+  void push(T value);
+
+  /**
+   * @brief Tries to pop an object from the queue. If the operation is
+   * successful, the object will be moved to `result`.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T& result);
+
+  /**
+   * @brief Tries to pop an object from the queue.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @return the popped value if the operation was successful, otherwise `std::nullopt`
+   */
+  [[nodiscard]] std::optional<T> pop();
+
+private:
+  struct node;
+
+  // the mark bit in a node's next pointer signals that the successor has been dequeued
+  using concurrent_ptr = typename reclaimer::template concurrent_ptr<node, 1>;
+  using marked_ptr = typename concurrent_ptr::marked_ptr;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+
+  struct node : reclaimer::template enable_concurrent_ptr<node, 1> {
+    node() = default;
+    explicit node(T&& v) { new (&_data) T(std::move(v)); }
+
+    T& value() { return reinterpret_cast<T&>(_data); }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _data;
+    concurrent_ptr _next;
+  };
+
+  guard_ptr pop_node();
+
+  alignas(64) concurrent_ptr _head;
+  alignas(64) concurrent_ptr _tail;
+};
+
+template <class T, class... Policies>
+hoffman_basket_queue<T, Policies...>::hoffman_basket_queue() {
+  auto n = new node();
+  _head.store(n, std::memory_order_relaxed);
+  _tail.store(n, std::memory_order_relaxed);
+}
+
+template <class T, class... Policies>
+hoffman_basket_queue<T, Policies...>::~hoffman_basket_queue() {
+  // (1) - this acquire-load synchronizes-with the release-CAS (12, 14)
+  auto n = _head.load(std::memory_order_acquire);
+  // the head node is the dummy node which has no payload
+  bool has_value = false;
+  while (n) {
+    // (2) - this acquire-load synchronizes-with the release-CAS (6, 8)
+    auto next = n->_next.load(std::memory_order_acquire);
+    if (has_value) {
+      reinterpret_cast<T&>(n->_data).~T();
+    }
+    delete n.get();
+    // if the link is marked, the successor's value has already been dequeued
+    has_value = next.mark() == 0;
+    n = next.get();
+  }
+}
+
+template <class T, class... Policies>
+void hoffman_basket_queue<T, Policies...>::push(T value) {
+  node* n = new node(std::move(value));
+
+  backoff backoff;
+
+  guard_ptr t;
+  for (;;) {
+    // (3) - this acquire-load synchronizes-with the release-CAS (5, 7, 11)
+    t.acquire(_tail, std::memory_order_acquire);
+
+    // (4) - this acquire-load synchronizes-with the release-CAS (6, 8)
+    auto next = t->_next.load(std::memory_order_acquire);
+    if (_tail.load(std::memory_order_relaxed).get() != t.get()) {
+      continue;
+    }
+
+    if (next.get() != nullptr) {
+      // The tail is lagging behind -> help to update it.
+      marked_ptr expected(t.get());
+      // (5) - this release-CAS synchronizes-with the acquire-load (3)
+      _tail.compare_exchange_weak(
+        expected, marked_ptr(next.get()), std::memory_order_release, std::memory_order_relaxed);
+      continue;
+    }
+
+    // Attempt to link in the new element.
+    n->_next.store(nullptr, std::memory_order_relaxed);
+    // (6) - this release-CAS synchronizes-with the acquire-load (2, 4, 10) and the acquire-CAS (13)
+    if (t->_next.compare_exchange_strong(next, n, std::memory_order_release, std::memory_order_acquire)) {
+      marked_ptr expected(t.get());
+      // (7) - this release-CAS synchronizes-with the acquire-load (3)
+      _tail.compare_exchange_strong(expected, n, std::memory_order_release, std::memory_order_relaxed);
+      return;
+    }
+
+    // Some other push operations have won the race for the same tail node. They were all
+    // concurrent with us, so instead of competing for the new tail, we insert our node
+    // directly behind t, i.e., in the basket of nodes appended after t. This is only
+    // possible as long as the first node in this basket has not been dequeued yet.
+    while (next.mark() == 0) {
+      backoff();
+      n->_next.store(next, std::memory_order_relaxed);
+      // (8) - this release-CAS synchronizes-with the acquire-load (2, 4, 10) and the acquire-CAS (13)
+      if (t->_next.compare_exchange_weak(next, n, std::memory_order_release, std::memory_order_acquire)) {
+        return;
+      }
+    }
+  }
+}
+
+template <class T, class... Policies>
+bool hoffman_basket_queue<T, Policies...>::try_pop(T& result) {
+  auto n = pop_node();
+  if (n) {
+    auto& data = n->value();
+    result = std::move(data);
+    data.~T();
+    return true;
+  }
+  return false;
+}
+
+template <class T, class... Policies>
+std::optional<T> hoffman_basket_queue<T, Policies...>::pop() {
+  auto n = pop_node();
+  if (n) {
+    auto& data = n->value();
+    std::optional<T> result(std::move(data));
+    data.~T();
+    return result;
+  }
+  return std::nullopt;
+}
+
+template <class T, class... Policies>
+auto hoffman_basket_queue<T, Policies...>::pop_node() -> guard_ptr {
+  backoff backoff;
+
+  guard_ptr h;
+  guard_ptr next;
+  for (;;) {
+    // (9) - this acquire-load synchronizes-with the release-CAS (12, 14)
+    h.acquire(_head, std::memory_order_acquire);
+
+    // (10) - this acquire-load synchronizes-with the release-CAS (6, 8)
+    next.acquire(h->_next, std::memory_order_acquire);
+    if (_head.load(std::memory_order_relaxed).get() != h.get()) {
+      continue;
+    }
+
+    auto expected_next = marked_ptr(next.get(), next.mark());
+    if (expected_next.mark() != 0) {
+      // The successor has already been dequeued by some other thread, but the head
+      // has not been updated yet -> help to update it.
+      marked_ptr expected(h.get());
+      // (12) - this release-CAS synchronizes-with the acquire-load (1, 9)
+      if (_head.compare_exchange_strong(
+            expected, marked_ptr(next.get()), std::memory_order_release, std::memory_order_relaxed)) {
+        h.reclaim();
+      }
+      continue;
+    }
+
+    // If the head (dummy) node is the only one, the queue is empty.
+    if (next.get() == nullptr) {
+      return guard_ptr{};
+    }
+
+    // Make sure the tail does not fall behind the head.
+    marked_ptr t = _tail.load(std::memory_order_relaxed);
+    if (t.get() == h.get()) {
+      // (11) - this release-CAS synchronizes-with the acquire-load (3)
+      _tail.compare_exchange_weak(t, marked_ptr(next.get()), std::memory_order_release, std::memory_order_relaxed);
+      continue;
+    }
+
+    // Mark the link to our successor, thereby claiming its value. This also prevents
+    // any push operation from inserting a node in front of it.
+    // (13) - this acquire-CAS synchronizes-with the release-CAS (6, 8)
+    if (h->_next.compare_exchange_strong(expected_next,
+                                         marked_ptr(next.get(), 1),
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+      // The dequeued node becomes the new dummy node.
+      marked_ptr expected(h.get());
+      // (14) - this release-CAS synchronizes-with the acquire-load (1, 9)
+      if (_head.compare_exchange_strong(
+            expected, marked_ptr(next.get()), std::memory_order_release, std::memory_order_relaxed)) {
+        h.reclaim();
+      }
+      return next;
+    }
+
+    backoff();
+  }
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
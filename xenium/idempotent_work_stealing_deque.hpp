@@ -0,0 +1,248 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_IDEMPOTENT_WORK_STEALING_DEQUE_HPP
+#define XENIUM_IDEMPOTENT_WORK_STEALING_DEQUE_HPP
+
+#include <xenium/detail/fixed_size_circular_array.hpp>
+#include <xenium/detail/growing_circular_array.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure whether `idempotent_work_stealing_deque` operates in FIFO
+   * order (idempotent FIFO) or in LIFO order (idempotent LIFO).
+   * @tparam Value
+   */
+  template <bool Value>
+  struct fifo;
+} // namespace policy
+
+/**
+ * @brief A lock-free work stealing deque with _idempotent_ semantics, i.e., every item is
+ * extracted _at least_ once, but may occasionally be extracted more than once.
+ *
+ * This is an implementation of the idempotent work stealing algorithms proposed by Michael,
+ * Vechev and Saraswat \[[MVS09](index.html#ref-michael-2009)\]. Compared to
+ * `chase_work_stealing_deque`, the owner operations `try_push` and `try_pop` do not need any
+ * seq-cst operations or CAS, even when competing with thieves for the last item. The price is
+ * that an item may be obtained by more than one thread if the owner races with thieves. This
+ * makes it suitable for task systems where executing a task twice is harmless (e.g., because
+ * tasks are idempotent, or because a task checks whether it has already been executed).
+ *
+ * Depending on the `fifo` policy, the owner as well as the thieves take either the oldest
+ * item (idempotent FIFO), or the most recently pushed item (idempotent LIFO).
+ *
+ * Like `chase_work_stealing_deque` the deque stores pointers to `T`, i.e., `value_type` is `T*`.
+ *
+ * Supported policies:
+ *  * `xenium::policy::fifo`<br>
+ *    If true, items are taken in FIFO order (idempotent FIFO); otherwise in LIFO order
+ *    (idempotent LIFO). (*optional*; defaults to false)
+ *  * `xenium::policy::capacity`<br>
+ *    Defines the (minimum) capacity of the deque. (*optional*; defaults to 128)
+ *  * `xenium::policy::container`<br>
+ *    Defines the internal container type to store the entries.
+ *    (*optional*; defaults to `xenium::detail::growing_circular_array`)<br>
+ *    Possible containers are:
+ *    * `xenium::detail::fixed_size_circular_array`
+ *    * `xenium::detail::growing_circular_array`
+ *
+ * @tparam T
+ * @tparam Policies
+ */
+template <class T, class... Policies>
+struct idempotent_work_stealing_deque {
+  using value_type = T*;
+  static constexpr bool fifo = parameter::value_param_t<bool, policy::fifo, false, Policies...>::value;
+  static constexpr std::size_t capacity =
+    parameter::value_param_t<std::size_t, policy::capacity, 128, Policies...>::value;
+  using container = parameter::type_param_t<policy::container, detail::growing_circular_array<T, capacity>, Policies...>;
+
+  template <class... NewPolicies>
+  using with = idempotent_work_stealing_deque<T, NewPolicies..., Policies...>;
+
+  static_assert(std::is_same_v<typename container::value_type, value_type>,
+                "container must store values of type value_type");
+
+  idempotent_work_stealing_deque() = default;
+
+  idempotent_work_stealing_deque(const idempotent_work_stealing_deque&) = delete;
+  idempotent_work_stealing_deque(idempotent_work_stealing_deque&&) = delete;
+
+  idempotent_work_stealing_deque& operator=(const idempotent_work_stealing_deque&) = delete;
+  idempotent_work_stealing_deque& operator=(idempotent_work_stealing_deque&&) = delete;
+
+  /**
+   * @brief Pushes a new item; must only be called by the owner.
+   *
+   * Fails if the deque is full and the container cannot grow.
+   *
+   * Progress guarantees: wait-free (unless the container has to grow)
+   *
+   * @param item
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(value_type item);
+
+  /**
+   * @brief Tries to take an item; must only be called by the owner.
+   *
+   * Depending on the `fifo` policy this takes the oldest or the most recently pushed item.
+   * The item may also be obtained by a concurrent `try_steal` operation.
+   *
+   * Progress guarantees: wait-free
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(value_type& result);
+
+  /**
+   * @brief Tries to steal an item; can be called by any thread.
+   *
+   * Depending on the `fifo` policy this takes the oldest or the most recently pushed item.
+   * The item may also be obtained by a concurrent `try_pop` operation of the owner.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_steal(value_type& result);
+
+  std::size_t size() {
+    if constexpr (fifo) {
+      auto h = _head.load(std::memory_order_relaxed);
+      return _tail.load(std::memory_order_relaxed) - h;
+    } else {
+      return anchor_tail(_anchor.load(std::memory_order_relaxed));
+    }
+  }
+
+private:
+  // The LIFO variant packs the tail and a tag into a single word. The tag is incremented by
+  // every push, so a thief's CAS fails if the owner has taken and pushed items in between.
+  static constexpr unsigned tag_bits = 32;
+  static constexpr std::uint64_t tail_mask = (static_cast<std::uint64_t>(1) << tag_bits) - 1;
+  static std::size_t anchor_tail(std::uint64_t anchor) { return static_cast<std::size_t>(anchor & tail_mask); }
+  static std::uint64_t anchor_tag(std::uint64_t anchor) { return anchor >> tag_bits; }
+  static std::uint64_t make_anchor(std::size_t tail, std::uint64_t tag) {
+    return (tag << tag_bits) | static_cast<std::uint64_t>(tail);
+  }
+
+  container _items;
+  // only used by the FIFO variant
+  std::atomic<std::size_t> _head{0};
+  std::atomic<std::size_t> _tail{0};
+  // only used by the LIFO variant
+  std::atomic<std::uint64_t> _anchor{0};
+};
+
+template <class T, class... Policies>
+bool idempotent_work_stealing_deque<T, Policies...>::try_push(value_type item) {
+  if constexpr (fifo) {
+    auto t = _tail.load(std::memory_order_relaxed);
+    // (1) - this acquire-load synchronizes-with the release-CAS (5)
+    auto h = _head.load(std::memory_order_acquire);
+    if (t - h >= _items.capacity()) {
+      if (!_items.can_grow()) {
+        return false;
+      }
+      _items.grow(t, h);
+    }
+    _items.put(t, item, std::memory_order_relaxed);
+    // (2) - this release-store synchronizes-with the acquire-load (4)
+    _tail.store(t + 1, std::memory_order_release);
+  } else {
+    // (6) - this acquire-load synchronizes-with the release-CAS (10)
+    auto a = _anchor.load(std::memory_order_acquire);
+    auto t = anchor_tail(a);
+    if (t >= _items.capacity()) {
+      if (!_items.can_grow() || t == tail_mask) {
+        return false;
+      }
+      _items.grow(t, 0);
+    }
+    _items.put(t, item, std::memory_order_relaxed);
+    // (7) - this release-store synchronizes-with the acquire-load (9)
+    _anchor.store(make_anchor(t + 1, anchor_tag(a) + 1), std::memory_order_release);
+  }
+  return true;
+}
+
+template <class T, class... Policies>
+bool idempotent_work_stealing_deque<T, Policies...>::try_pop(value_type& result) {
+  if constexpr (fifo) {
+    auto t = _tail.load(std::memory_order_relaxed);
+    // (3) - this acquire-load synchronizes-with the release-CAS (5)
+    auto h = _head.load(std::memory_order_acquire);
+    if (h == t) {
+      return false;
+    }
+    result = _items.get(h, std::memory_order_relaxed);
+    // A plain store instead of a CAS - if a thief has concurrently taken the same item,
+    // we simply both return it.
+    _head.store(h + 1, std::memory_order_relaxed);
+  } else {
+    // (8) - this acquire-load synchronizes-with the release-CAS (10)
+    auto a = _anchor.load(std::memory_order_acquire);
+    auto t = anchor_tail(a);
+    if (t == 0) {
+      return false;
+    }
+    result = _items.get(t - 1, std::memory_order_relaxed);
+    // The tag remains unchanged, so a thief that has read the anchor before this store can
+    // only succeed as long as we do not push a new item.
+    _anchor.store(make_anchor(t - 1, anchor_tag(a)), std::memory_order_relaxed);
+  }
+  return true;
+}
+
+template <class T, class... Policies>
+bool idempotent_work_stealing_deque<T, Policies...>::try_steal(value_type& result) {
+  if constexpr (fifo) {
+    auto h = _head.load(std::memory_order_relaxed);
+    // (4) - this acquire-load synchronizes-with the release-store (2)
+    auto t = _tail.load(std::memory_order_acquire);
+    if (static_cast<std::intptr_t>(t - h) <= 0) {
+      return false;
+    }
+    auto item = _items.get(h, std::memory_order_relaxed);
+    // (5) - this release-CAS synchronizes-with the acquire-loads (1) and (3)
+    if (!_head.compare_exchange_strong(h, h + 1, std::memory_order_release, std::memory_order_relaxed)) {
+      return false;
+    }
+    result = item;
+  } else {
+    // (9) - this acquire-load synchronizes-with the release-store (7)
+    auto a = _anchor.load(std::memory_order_acquire);
+    auto t = anchor_tail(a);
+    if (t == 0) {
+      return false;
+    }
+    auto item = _items.get(t - 1, std::memory_order_relaxed);
+    // (10) - this release-CAS synchronizes-with the acquire-loads (6) and (8)
+    if (!_anchor.compare_exchange_strong(a,
+                                         make_anchor(t - 1, anchor_tag(a)),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+      return false;
+    }
+    result = item;
+  }
+  return true;
+}
+} // namespace xenium
+
+#endif
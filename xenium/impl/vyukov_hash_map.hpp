@@ -12,9 +12,9 @@
 #include <xenium/parameter.hpp>
 #include <xenium/policy.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
-#include <cstring>
 
 #ifdef _MSC_VER
   #pragma warning(push)
@@ -108,6 +108,10 @@ struct vyukov_hash_map<Key, Value, Policies...>::bucket {
 
 template <class Key, class Value, class... Policies>
 struct vyukov_hash_map<Key, Value, Policies...>::extension_item {
+  // The memoized hash of the key. The extension items of a bucket are kept sorted by
+  // this value, which allows us to stop the search as soon as we encounter an item
+  // with a larger hash.
+  std::atomic<hash_t> hash;
   typename traits::storage_key_type key;
   typename traits::storage_value_type value;
   std::atomic<extension_item*> next;
@@ -149,7 +153,7 @@ struct alignas(64) vyukov_hash_map<Key, Value, Policies...>::block : reclaimer::
   [[nodiscard]] std::uint32_t index(const key_type& key) const { return static_cast<std::uint32_t>(key & mask); }
   bucket* buckets() { return reinterpret_cast<bucket*>(this + 1); }
 
-  void operator delete(void* p) { ::operator delete(p, cacheline_size); } // NOLINT (new-delete-overloads)
+  void operator delete(void* p) { array_allocator::deallocate(p); } // NOLINT (new-delete-overloads)
 };
 
 template <class Key, class Value, class... Policies>
@@ -176,12 +180,15 @@ private:
 };
 
 template <class Key, class Value, class... Policies>
-vyukov_hash_map<Key, Value, Policies...>::vyukov_hash_map(std::size_t initial_capacity) : resize_lock(0) {
-  auto b = allocate_block(static_cast<std::uint32_t>(utils::next_power_of_two(initial_capacity)));
+vyukov_hash_map<Key, Value, Policies...>::vyukov_hash_map(std::size_t initial_capacity) :
+    resize_lock(0),
+    min_bucket_count(static_cast<std::uint32_t>(utils::next_power_of_two(initial_capacity))) {
+  auto b = allocate_block(min_bucket_count);
   if (b == nullptr) {
     throw std::bad_alloc();
   }
   data_block.store(b, std::memory_order_relaxed);
+  current_bucket_count.store(min_bucket_count, std::memory_order_relaxed);
 }
 
 template <class Key, class Value, class... Policies>
@@ -258,20 +265,30 @@ retry:
     traits::template store_item<AcquireAccessor>(
       bucket.key[item_count], bucket.value[item_count], h, std::move(key), factory(), std::memory_order_relaxed, acc);
     callback(std::move(acc), bucket.value[item_count]);
+    // the size has to be updated while we hold the lock, see update_size
+    update_size(1);
     // release the bucket lock and increment the item count
     // (3) - this release-store synchronizes-with the acquire-CAS (7, 30, 34, 37) and the acquire-load (23)
     unlocker.unlock(state.inc_item_count(), std::memory_order_release);
     return true;
   }
 
-  // TODO - keep extension items sorted
-  for (extension_item* extension = bucket.head.load(std::memory_order_relaxed); extension != nullptr;
-       extension = extension->next.load(std::memory_order_relaxed)) {
-    if (traits::template compare_key<AcquireAccessor>(extension->key, extension->value, key, h, acc)) {
+  // extension items are sorted by their hash, so we can stop as soon as we
+  // encounter an item with a larger hash; this is also where we have to insert.
+  auto extension_prev = &bucket.head;
+  for (extension_item* extension = extension_prev->load(std::memory_order_relaxed); extension != nullptr;
+       extension = extension_prev->load(std::memory_order_relaxed)) {
+    const hash_t extension_hash = extension->hash.load(std::memory_order_relaxed);
+    if (extension_hash > h) {
+      break;
+    }
+    if (extension_hash == h &&
+        traits::template compare_key<AcquireAccessor>(extension->key, extension->value, key, h, acc)) {
       callback(std::move(acc), extension->value);
       unlocker.unlock(state, std::memory_order_relaxed);
       return false;
     }
+    extension_prev = &extension->next;
   }
 
   extension_item* extension = allocate_extension_item(b.get(), h);
@@ -288,10 +305,11 @@ retry:
     throw;
   }
   callback(std::move(acc), extension->value);
-  auto old_head = bucket.head.load(std::memory_order_relaxed);
-  extension->next.store(old_head, std::memory_order_relaxed);
-  // (4) - this release-store synchronizes-with the acquire-load (25)
-  bucket.head.store(extension, std::memory_order_release);
+  extension->hash.store(h, std::memory_order_relaxed);
+  extension->next.store(extension_prev->load(std::memory_order_relaxed), std::memory_order_relaxed);
+  // (4) - this release-store synchronizes-with the acquire-loads (25, 27)
+  extension_prev->store(extension, std::memory_order_release);
+  update_size(1);
   // release the bucket lock
   // (5) - this release-store synchronizes-with the acquire-CAS (7, 30, 34, 37) and the acquire-load (23)
   unlocker.unlock(state, std::memory_order_release);
@@ -300,22 +318,31 @@ retry:
 }
 
 template <class Key, class Value, class... Policies>
-bool vyukov_hash_map<Key, Value, Policies...>::erase(const key_type& key) {
+template <class K>
+bool vyukov_hash_map<Key, Value, Policies...>::do_erase(const K& key) {
   accessor acc;
-  bool result = do_extract(key, acc);
+  if (!do_extract(key, acc)) {
+    // nothing to reclaim - the accessor is empty
+    return false;
+  }
   traits::reclaim(acc);
-  return result;
+  try_auto_shrink();
+  return true;
 }
 
 template <class Key, class Value, class... Policies>
 bool vyukov_hash_map<Key, Value, Policies...>::extract(const key_type& key, accessor& acc) {
   bool result = do_extract(key, acc);
   traits::reclaim_internal(acc);
+  if (result) {
+    try_auto_shrink();
+  }
   return result;
 }
 
 template <class Key, class Value, class... Policies>
-bool vyukov_hash_map<Key, Value, Policies...>::do_extract(const key_type& key, accessor& result) {
+template <class K>
+bool vyukov_hash_map<Key, Value, Policies...>::do_extract(const K& key, accessor& result) {
   const hash_t h = hash{}(key);
   backoff backoff;
   guarded_block b;
@@ -337,7 +364,7 @@ restart:
   }
 
   auto locked_state = state.locked();
-  // (7) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38)
+  // (7) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38, 42)
   if (!bucket.state.compare_exchange_strong(
         state, locked_state, std::memory_order_acquire, std::memory_order_relaxed)) {
     backoff();
@@ -350,6 +377,8 @@ restart:
 
   for (std::uint32_t i = 0; i != item_count; ++i) {
     if (traits::template compare_key<true>(bucket.key[i], bucket.value[i], key, h, result)) {
+      // the size has to be updated while we hold the lock, see update_size
+      update_size(-1);
       extension_item* extension = bucket.head.load(std::memory_order_relaxed);
       if (extension) {
         // signal which item we are deleting
@@ -399,9 +428,14 @@ restart:
   auto extension_prev = &bucket.head;
   extension_item* extension = extension_prev->load(std::memory_order_relaxed);
   while (extension) {
-    if (traits::template compare_key<true>(extension->key, extension->value, key, h, result)) {
+    const hash_t extension_hash = extension->hash.load(std::memory_order_relaxed);
+    if (extension_hash > h) {
+      break;
+    }
+    if (extension_hash == h && traits::template compare_key<true>(extension->key, extension->value, key, h, result)) {
       extension_item* extension_next = extension->next.load(std::memory_order_relaxed);
       extension_prev->store(extension_next, std::memory_order_relaxed);
+      update_size(-1);
 
       // release the bucket lock and increase the version
       // (14) - this release-store synchronizes-with the acquire-CAS (7, 30, 34, 37) and the acquire-load (23)
@@ -424,6 +458,8 @@ restart:
 
 template <class Key, class Value, class... Policies>
 void vyukov_hash_map<Key, Value, Policies...>::erase(iterator& pos) {
+  // we hold the lock on the current bucket, so we cannot shrink here
+  update_size(-1);
   if (pos.extension) {
     // the item we are currently looking at is an extension item
     auto next = pos.extension->next.load(std::memory_order_relaxed);
@@ -503,7 +539,8 @@ void vyukov_hash_map<Key, Value, Policies...>::erase(iterator& pos) {
 }
 
 template <class Key, class Value, class... Policies>
-bool vyukov_hash_map<Key, Value, Policies...>::try_get_value(const key_type& key, accessor& result) const {
+template <class K>
+bool vyukov_hash_map<Key, Value, Policies...>::do_try_get_value(const K& key, accessor& result) const {
   const hash_t h = hash{}(key);
 
   // (22) - this acquire-load synchronizes-with the release-store (31)
@@ -562,7 +599,16 @@ retry:
   // (25) - this acquire-load synchronizes-with the release-store (4, 10, 18)
   extension_item* extension = bucket.head.load(std::memory_order_acquire);
   while (extension) {
-    if (traits::compare_trivial_key(extension->key, key, h)) {
+    // Extension items are sorted by their hash, so once we see a larger hash we can stop
+    // the search. Since extension items can be reused by other buckets, the hash we read
+    // might belong to some other key, but in that case the version check after the loop
+    // will detect the concurrent deletion and we retry.
+    const hash_t extension_hash = extension->hash.load(std::memory_order_relaxed);
+    if (extension_hash > h) {
+      break;
+    }
+
+    if (extension_hash == h && traits::compare_trivial_key(extension->key, key, h)) {
       // TODO - this acquire does not synchronize with anything ATM.
       // However, this is probably required when introducing an update-method that
       // allows to store a new value.
@@ -576,15 +622,13 @@ retry:
         goto retry;
       }
 
-      if (!traits::compare_nontrivial_key(acc, key)) {
-        continue;
+      if (traits::compare_nontrivial_key(acc, key)) {
+        result = std::move(acc);
+        return true;
       }
-
-      result = std::move(acc);
-      return true;
     }
 
-    // (27) - this acquire-load synchronizes-with the release-store (35)
+    // (27) - this acquire-load synchronizes-with the release-stores (4, 35)
     extension = extension->next.load(std::memory_order_acquire);
     auto state2 = bucket.state.load(std::memory_order_relaxed);
     if (state.version() != state2.version()) {
@@ -620,7 +664,7 @@ void vyukov_hash_map<Key, Value, Policies...>::grow(bucket& bucket, bucket_state
   if (already_resizing != 0) {
     backoff backoff;
     // another thread is already resizing -> wait for it to finish
-    // (28) - this acquire-load synchronizes-with the release-store (32)
+    // (28) - this acquire-load synchronizes-with the release-store (32, 40)
     while (resize_lock.load(std::memory_order_acquire) != 0) {
       backoff();
     }
@@ -635,7 +679,7 @@ template <class Key, class Value, class... Policies>
 void vyukov_hash_map<Key, Value, Policies...>::do_grow() {
   // Note: since we hold the resize lock, nobody can replace the current block
   // (29) - this acquire-load synchronizes-with the release-store (31)
-  auto old_block = data_block.load(std::memory_order_acquire);
+  block* old_block = data_block.load(std::memory_order_acquire).get();
   const auto bucket_count = old_block->bucket_count;
   block* new_block = allocate_block(bucket_count * 2);
   if (new_block == nullptr) {
@@ -643,10 +687,109 @@ void vyukov_hash_map<Key, Value, Policies...>::do_grow() {
     throw std::bad_alloc();
   }
 
-  // lock all buckets
+  lock_all_buckets(old_block);
+  // every bucket of the old block is split into two buckets in the new block,
+  // so we can never run out of extension items.
+  [[maybe_unused]] const bool migrated = migrate_entries(old_block, new_block);
+  assert(migrated);
+  replace_block(old_block, new_block);
+}
+
+template <class Key, class Value, class... Policies>
+bool vyukov_hash_map<Key, Value, Policies...>::shrink_to_fit() {
+  backoff backoff;
+  // (39) - this acquire-exchange synchronizes-with the release-store (32, 40)
+  while (resize_lock.exchange(1, std::memory_order_acquire) != 0) {
+    backoff();
+  }
+  return do_shrink(min_bucket_count);
+}
+
+template <class Key, class Value, class... Policies>
+void vyukov_hash_map<Key, Value, Policies...>::try_auto_shrink() {
+  if constexpr (shrink_threshold != 0) {
+    const std::size_t bucket_count = current_bucket_count.load(std::memory_order_relaxed);
+    if (bucket_count <= min_bucket_count) {
+      return;
+    }
+    // size * 100 < bucket_count * shrink_threshold, without risking an overflow of size * 100
+    const std::size_t size = approximate_size.load(std::memory_order_relaxed);
+    if (size >= (bucket_count * shrink_threshold + 99) / 100 ||
+        size >= shrink_retry_size.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    // if some other thread is already resizing the map we simply leave it to them.
+    // (41) - this acquire-exchange synchronizes-with the release-store (32, 40)
+    if (resize_lock.exchange(1, std::memory_order_acquire) != 0) {
+      return;
+    }
+    do_shrink(min_bucket_count);
+  }
+}
+
+// Must be called while holding the lock of the modified bucket. do_shrink counts the entries
+// while holding all bucket locks, so this ensures that every update is either included in
+// the counted size or applied after the counted size has been stored.
+template <class Key, class Value, class... Policies>
+void vyukov_hash_map<Key, Value, Policies...>::update_size([[maybe_unused]] std::ptrdiff_t delta) {
+  if constexpr (shrink_threshold != 0) {
+    approximate_size.fetch_add(static_cast<std::size_t>(delta), std::memory_order_relaxed);
+  }
+}
+
+template <class Key, class Value, class... Policies>
+bool vyukov_hash_map<Key, Value, Policies...>::do_shrink(std::uint32_t min_bucket_count) {
+  // Note: since we hold the resize lock, nobody can replace the current block
+  block* old_block = data_block.load(std::memory_order_acquire).get();
+  lock_all_buckets(old_block);
+
+  // now that all buckets are locked we can determine the exact number of entries
+  std::size_t size = 0;
   auto old_buckets = old_block->buckets();
-  for (std::uint32_t i = 0; i != bucket_count; ++i) {
-    auto& bucket = old_buckets[i];
+  for (std::uint32_t i = 0; i != old_block->bucket_count; ++i) {
+    size += old_buckets[i].state.load(std::memory_order_relaxed).item_count();
+    for (auto extension = old_buckets[i].head.load(std::memory_order_relaxed); extension != nullptr;
+         extension = extension->next.load(std::memory_order_relaxed)) {
+      ++size;
+    }
+  }
+  if constexpr (shrink_threshold != 0) {
+    approximate_size.store(size, std::memory_order_relaxed);
+  }
+
+  // Depending on the hash distribution the entries might not fit into the smallest
+  // possible block, so we keep doubling the size until they do.
+  auto bucket_count =
+    std::max(min_bucket_count, static_cast<std::uint32_t>(utils::next_power_of_two(std::max<std::size_t>(size, 1))));
+  for (; bucket_count < old_block->bucket_count; bucket_count *= 2) {
+    block* new_block = allocate_block(bucket_count);
+    if (new_block == nullptr) {
+      break;
+    }
+    if (migrate_entries(old_block, new_block)) {
+      replace_block(old_block, new_block);
+      return true;
+    }
+    delete new_block;
+  }
+
+  if constexpr (shrink_threshold != 0) {
+    // Avoid recounting all entries on every erase; we only try again once the map has
+    // shrunk to half its current size, or the bucket array has been replaced.
+    shrink_retry_size.store(size / 2, std::memory_order_relaxed);
+  }
+  unlock_all_buckets(old_block);
+  // (40) - this release-store synchronizes-with the acquire-load (28) and the acquire-exchange (39, 41)
+  resize_lock.store(0, std::memory_order_release);
+  return false;
+}
+
+template <class Key, class Value, class... Policies>
+void vyukov_hash_map<Key, Value, Policies...>::lock_all_buckets(block* b) {
+  auto buckets = b->buckets();
+  for (std::uint32_t i = 0; i != b->bucket_count; ++i) {
+    auto& bucket = buckets[i];
     backoff backoff;
     for (;;) {
       auto st = bucket.state.load(std::memory_order_relaxed);
@@ -654,7 +797,7 @@ void vyukov_hash_map<Key, Value, Policies...>::do_grow() {
         continue;
       }
 
-      // (30) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38)
+      // (30) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38, 42)
       if (bucket.state.compare_exchange_strong(st, st.locked(), std::memory_order_acquire, std::memory_order_relaxed)) {
         break; // we've got the lock
       }
@@ -662,52 +805,89 @@ void vyukov_hash_map<Key, Value, Policies...>::do_grow() {
       backoff();
     }
   }
+}
+
+template <class Key, class Value, class... Policies>
+void vyukov_hash_map<Key, Value, Policies...>::unlock_all_buckets(block* b) {
+  auto buckets = b->buckets();
+  for (std::uint32_t i = 0; i != b->bucket_count; ++i) {
+    auto& bucket = buckets[i];
+    auto st = bucket.state.load(std::memory_order_relaxed);
+    // (42) - this release-store synchronizes-with the acquire-CAS (7, 30, 34, 37)
+    bucket.state.store(st.clear_lock(), std::memory_order_release);
+  }
+}
 
+template <class Key, class Value, class... Policies>
+bool vyukov_hash_map<Key, Value, Policies...>::migrate_entries(block* old_block, block* new_block) {
+  auto old_buckets = old_block->buckets();
   auto new_buckets = new_block->buckets();
-  for (std::uint32_t bucket_idx = 0; bucket_idx != bucket_count; ++bucket_idx) {
-    auto& old_bucket = old_buckets[bucket_idx];
-    const std::uint32_t item_count = old_bucket.state.load(std::memory_order_relaxed).item_count();
-    for (std::uint32_t i = 0; i != item_count; ++i) {
-      auto k = old_bucket.key[i].load(std::memory_order_relaxed);
-      hash_t h = traits::template rehash<hash>(k);
-      auto& new_bucket = new_buckets[h & new_block->mask];
-      auto new_bucket_state = new_bucket.state.load(std::memory_order_relaxed);
-      auto new_bucket_count = new_bucket_state.item_count();
-      auto v = old_bucket.value[i].load(std::memory_order_relaxed);
+  auto move_entry = [new_block, new_buckets](auto k, auto v) {
+    hash_t h = traits::template rehash<hash>(k);
+    auto& new_bucket = new_buckets[h & new_block->mask];
+    auto new_bucket_state = new_bucket.state.load(std::memory_order_relaxed);
+    auto new_bucket_count = new_bucket_state.item_count();
+    if (new_bucket_count < bucket_item_count) {
       new_bucket.key[new_bucket_count].store(k, std::memory_order_relaxed);
       new_bucket.value[new_bucket_count].store(v, std::memory_order_relaxed);
       new_bucket.state.store(new_bucket_state.inc_item_count(), std::memory_order_relaxed);
+      return true;
+    }
+
+    extension_item* new_extension = allocate_extension_item(new_block, h);
+    if (new_extension == nullptr) {
+      return false;
+    }
+    new_extension->hash.store(h, std::memory_order_relaxed);
+    new_extension->key.store(k, std::memory_order_relaxed);
+    new_extension->value.store(v, std::memory_order_relaxed);
+    // keep the extension items sorted by their hash
+    auto prev = &new_bucket.head;
+    for (auto next = prev->load(std::memory_order_relaxed);
+         next != nullptr && next->hash.load(std::memory_order_relaxed) <= h;
+         next = prev->load(std::memory_order_relaxed)) {
+      prev = &next->next;
+    }
+    new_extension->next.store(prev->load(std::memory_order_relaxed), std::memory_order_relaxed);
+    prev->store(new_extension, std::memory_order_relaxed);
+    return true;
+  };
+
+  // relaxed ordering is fine since we own the locks of all buckets
+  for (std::uint32_t bucket_idx = 0; bucket_idx != old_block->bucket_count; ++bucket_idx) {
+    auto& old_bucket = old_buckets[bucket_idx];
+    const std::uint32_t item_count = old_bucket.state.load(std::memory_order_relaxed).item_count();
+    for (std::uint32_t i = 0; i != item_count; ++i) {
+      if (!move_entry(old_bucket.key[i].load(std::memory_order_relaxed),
+                      old_bucket.value[i].load(std::memory_order_relaxed))) {
+        return false;
+      }
     }
 
-    // relaxed ordering is fine since we own the bucket lock
     for (extension_item* extension = old_bucket.head; extension != nullptr;
          extension = extension->next.load(std::memory_order_relaxed)) {
-      auto k = extension->key.load(std::memory_order_relaxed);
-      hash_t h = traits::template rehash<hash>(k);
-      auto& new_bucket = new_buckets[h & new_block->mask];
-      auto new_bucket_state = new_bucket.state.load(std::memory_order_relaxed);
-      auto new_bucket_count = new_bucket_state.item_count();
-      auto v = extension->value.load(std::memory_order_relaxed);
-      if (new_bucket_count < bucket_item_count) {
-        new_bucket.key[new_bucket_count].store(k, std::memory_order_relaxed);
-        new_bucket.value[new_bucket_count].store(v, std::memory_order_relaxed);
-        new_bucket.state.store(new_bucket_state.inc_item_count(), std::memory_order_relaxed);
-      } else {
-        extension_item* new_extension = allocate_extension_item(new_block, h);
-        assert(new_extension);
-        new_extension->key.store(k, std::memory_order_relaxed);
-        new_extension->value.store(v, std::memory_order_relaxed);
-        new_extension->next.store(new_bucket.head, std::memory_order_relaxed);
-        new_bucket.head = new_extension;
+      if (!move_entry(extension->key.load(std::memory_order_relaxed),
+                      extension->value.load(std::memory_order_relaxed))) {
+        return false;
       }
     }
   }
+  return true;
+}
+
+template <class Key, class Value, class... Policies>
+void vyukov_hash_map<Key, Value, Policies...>::replace_block(block* old_block, block* new_block) {
+  current_bucket_count.store(new_block->bucket_count, std::memory_order_relaxed);
+  if constexpr (shrink_threshold != 0) {
+    shrink_retry_size.store(std::numeric_limits<std::size_t>::max(), std::memory_order_relaxed);
+  }
   // (31) - this release-store synchronizes-with (6, 22, 29, 33)
   data_block.store(new_block, std::memory_order_release);
-  // (32) - this release-store synchronizes-with the acquire-load (28)
+  // (32) - this release-store synchronizes-with the acquire-load (28) and the acquire-exchange (39, 41)
   resize_lock.store(0, std::memory_order_release);
 
-  // reclaim the old data block
+  // reclaim the old data block; the buckets in the old block remain locked
+  // so that all threads that try to lock them are forced to reload data_block.
   guarded_block g(old_block);
   g.reclaim();
 }
@@ -718,12 +898,12 @@ auto vyukov_hash_map<Key, Value, Policies...>::allocate_block(std::uint32_t buck
   std::size_t size = sizeof(block) + sizeof(bucket) * bucket_count +
                      sizeof(extension_bucket) * (static_cast<size_t>(extension_bucket_count) + 1);
 
-  void* mem = ::operator new(size, cacheline_size, std::nothrow);
+  // the allocator returns zero-initialized memory
+  void* mem = array_allocator::allocate(size);
   if (mem == nullptr) {
     return nullptr;
   }
 
-  std::memset(mem, 0, size);
   auto* b = new (mem) block;
   b->mask = bucket_count - 1;
   b->bucket_count = bucket_count;
@@ -749,7 +929,8 @@ auto vyukov_hash_map<Key, Value, Policies...>::allocate_block(std::uint32_t buck
 }
 
 template <class Key, class Value, class... Policies>
-auto vyukov_hash_map<Key, Value, Policies...>::find(const key_type& key) -> iterator {
+template <class K>
+auto vyukov_hash_map<Key, Value, Policies...>::do_find(const K& key) -> iterator {
   const auto h = hash{}(key);
   iterator result;
 
@@ -765,13 +946,20 @@ auto vyukov_hash_map<Key, Value, Policies...>::find(const key_type& key) -> iter
     }
   }
 
-  auto extension = bucket.head.load(std::memory_order_relaxed);
+  auto prev = &bucket.head;
+  auto extension = prev->load(std::memory_order_relaxed);
   while (extension) {
-    if (traits::template compare_key<false>(extension->key, extension->value, key, h, acc)) {
+    const hash_t extension_hash = extension->hash.load(std::memory_order_relaxed);
+    if (extension_hash > h) {
+      break;
+    }
+    if (extension_hash == h && traits::template compare_key<false>(extension->key, extension->value, key, h, acc)) {
       result.extension = extension;
+      result.prev = prev;
       return result;
     }
-    extension = extension->next.load(std::memory_order_relaxed);
+    prev = &extension->next;
+    extension = prev->load(std::memory_order_relaxed);
   }
 
   return end();
@@ -801,7 +989,7 @@ auto vyukov_hash_map<Key, Value, Policies...>::lock_bucket(hash_t hash, guarded_
       continue;
     }
 
-    // (34) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38)
+    // (34) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38, 42)
     if (bucket.state.compare_exchange_strong(st, st.locked(), std::memory_order_acquire, std::memory_order_relaxed)) {
       state = st;
       return bucket;
@@ -980,7 +1168,7 @@ void vyukov_hash_map<Key, Value, Policies...>::iterator::move_to_next_bucket() {
       continue;
     }
 
-    // (37) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38)
+    // (37) - this acquire-CAS synchronizes-with the release-store (3, 5, 11, 13, 14, 36, 38, 42)
     if (current_bucket->state.compare_exchange_strong(
           st, st.locked(), std::memory_order_acquire, std::memory_order_relaxed)) {
       current_bucket_state = st;
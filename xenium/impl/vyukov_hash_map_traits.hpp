@@ -21,13 +21,13 @@ namespace bits {
 
   template <class Key>
   struct vyukov_hash_map_trivial_key : vyukov_hash_map_common<Key> {
-    template <class Cell>
-    static bool compare_trivial_key(Cell& key_cell, const Key& key, hash_t /*hash*/) {
+    template <class Cell, class K>
+    static bool compare_trivial_key(Cell& key_cell, const K& key, hash_t /*hash*/) {
       return key_cell.load(std::memory_order_relaxed) == key;
     }
 
-    template <class Accessor>
-    static bool compare_nontrivial_key(const Accessor&, const Key&) {
+    template <class Accessor, class K>
+    static bool compare_nontrivial_key(const Accessor&, const K&) {
       return true;
     }
 
@@ -39,13 +39,13 @@ namespace bits {
 
   template <class Key>
   struct vyukov_hash_map_nontrivial_key : vyukov_hash_map_common<Key> {
-    template <class Cell>
-    static bool compare_trivial_key(Cell& key_cell, const Key& /*key*/, hash_t hash) {
+    template <class Cell, class K>
+    static bool compare_trivial_key(Cell& key_cell, const K& /*key*/, hash_t hash) {
       return key_cell.load(std::memory_order_relaxed) == hash;
     }
 
-    template <class Accessor>
-    static bool compare_nontrivial_key(const Accessor& acc, const Key& key) {
+    template <class Accessor, class K>
+    static bool compare_nontrivial_key(const Accessor& acc, const K& key) {
       return acc.key() == key;
     }
 
@@ -98,10 +98,10 @@ struct vyukov_hash_map_traits<Key, managed_ptr<Value, VReclaimer>, ValueReclaime
     }
   }
 
-  template <bool AcquireAccessor>
+  template <bool AcquireAccessor, class K>
   static bool compare_key(storage_key_type& key_cell,
                           storage_value_type& value_cell,
-                          const Key& key,
+                          const K& key,
                           hash_t /*hash*/,
                           accessor& acc) {
     if (key_cell.load(std::memory_order_relaxed) != key) {
@@ -180,10 +180,10 @@ struct vyukov_hash_map_traits<Key, managed_ptr<Value, VReclaimer>, ValueReclaime
     value_cell.store(n, order);
   }
 
-  template <bool AcquireAccessor>
+  template <bool AcquireAccessor, class K>
   static bool compare_key(storage_key_type& key_cell,
                           storage_value_type& value_cell,
-                          const Key& key,
+                          const K& key,
                           hash_t hash,
                           accessor& acc) {
     if (key_cell.load(std::memory_order_relaxed) != hash) {
@@ -259,10 +259,10 @@ struct vyukov_hash_map_traits<Key, Value, ValueReclaimer, Reclaimer, true, true>
     }
   }
 
-  template <bool AcquireAccessor>
+  template <bool AcquireAccessor, class K>
   static bool compare_key(storage_key_type& key_cell,
                           storage_value_type& value_cell,
-                          const Key& key,
+                          const K& key,
                           hash_t /*hash*/,
                           accessor& acc) {
     if (key_cell.load(std::memory_order_relaxed) != key) {
@@ -313,10 +313,10 @@ struct vyukov_hash_map_traits<Key, Value, ValueReclaimer, Reclaimer, true, false
 
   static accessor acquire(storage_value_type& v, std::memory_order order) { return accessor(v, order); }
 
-  template <bool AcquireAccessor>
+  template <bool AcquireAccessor, class K>
   static bool compare_key(storage_key_type& key_cell,
                           storage_value_type& value_cell,
-                          const Key& key,
+                          const K& key,
                           hash_t /*hash*/,
                           accessor& acc) {
     if (key_cell.load(std::memory_order_relaxed) != key) {
@@ -409,10 +409,10 @@ struct vyukov_hash_map_traits<Key, Value, ValueReclaimer, Reclaimer, false, Triv
     value_cell.store(n, order);
   }
 
-  template <bool AcquireAccessor>
+  template <bool AcquireAccessor, class K>
   static bool compare_key(storage_key_type& key_cell,
                           storage_value_type& value_cell,
-                          const Key& key,
+                          const K& key,
                           hash_t hash,
                           accessor& acc) {
     if (key_cell.load(std::memory_order_relaxed) != hash) {
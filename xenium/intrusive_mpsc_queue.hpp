@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_INTRUSIVE_MPSC_QUEUE_HPP
+#define XENIUM_INTRUSIVE_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+
+/**
+ * @brief Base class for objects that can be stored in an `intrusive_mpsc_queue`.
+ *
+ * An object can only be stored in one queue at a time.
+ */
+class intrusive_mpsc_queue_hook {
+public:
+  intrusive_mpsc_queue_hook() noexcept = default;
+  // the link is not part of the object's value, so copies start out unlinked
+  intrusive_mpsc_queue_hook(const intrusive_mpsc_queue_hook&) noexcept {}
+  intrusive_mpsc_queue_hook& operator=(const intrusive_mpsc_queue_hook&) noexcept { return *this; }
+
+private:
+  std::atomic<intrusive_mpsc_queue_hook*> _next{nullptr};
+
+  template <class T>
+  friend class intrusive_mpsc_queue;
+};
+
+/**
+ * @brief An unbounded intrusive multi-producer/single-consumer FIFO queue.
+ *
+ * This is an implementation of the intrusive MPSC queue proposed by Vyukov
+ * \[[Vyu10b](index.html#ref-vyukov-2010b)\].
+ *
+ * The queue does not allocate any memory - the link to the next element is stored in the
+ * pushed objects themselves, so `T` has to be derived from `intrusive_mpsc_queue_hook`.
+ * The queue never takes ownership of the pushed objects. Since there is only a single consumer
+ * and the queue never accesses an object after it has been popped, the consumer can free it
+ * right away, i.e., no reclamation scheme is required.
+ *
+ * A push operation consists of a single atomic exchange and is therefore wait-free. A pop
+ * operation usually requires no atomic read-modify-write operation at all. However, a producer
+ * that has been preempted between the exchange and linking its object to its predecessor
+ * blocks the consumer from popping any subsequently pushed objects until it resumes; during
+ * this time pop operations return `nullptr`, even though the queue is not empty.
+ *
+ * Only a single thread may call `try_pop`/`pop` at the same time.
+ *
+ * @tparam T type of the stored objects; must be derived from `intrusive_mpsc_queue_hook`.
+ */
+template <class T>
+class intrusive_mpsc_queue {
+public:
+  using value_type = T*;
+
+  intrusive_mpsc_queue() = default;
+  ~intrusive_mpsc_queue() = default;
+
+  intrusive_mpsc_queue(const intrusive_mpsc_queue&) = delete;
+  intrusive_mpsc_queue(intrusive_mpsc_queue&&) = delete;
+
+  intrusive_mpsc_queue& operator=(const intrusive_mpsc_queue&) = delete;
+  intrusive_mpsc_queue& operator=(intrusive_mpsc_queue&&) = delete;
+
+  /**
+   * @brief Pushes the given object to the queue.
+   *
+   * The object must not be stored in any other `intrusive_mpsc_queue` at the same time.
+   *
+   * Progress guarantees: wait-free
+   *
+   * Throws an `std::invalid_argument` exception if `value` is `nullptr`.
+   *
+   * @param value
+   */
+  void push(T* value);
+
+  /**
+   * @brief Tries to pop an object from the queue.
+   *
+   * May only be called by the consumer thread.
+   *
+   * Progress guarantees: wait-free (but see the class description)
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T*& result);
+
+  /**
+   * @brief Tries to pop an object from the queue.
+   *
+   * May only be called by the consumer thread.
+   *
+   * Progress guarantees: wait-free (but see the class description)
+   *
+   * @return the popped object if the operation was successful, otherwise `nullptr`
+   */
+  [[nodiscard]] T* pop();
+
+private:
+  using hook = intrusive_mpsc_queue_hook;
+
+  void push_hook(hook* n);
+
+  // producers swap themselves into _head; the consumer owns _tail
+  alignas(64) std::atomic<hook*> _head{&_stub};
+  alignas(64) hook* _tail = &_stub;
+  hook _stub;
+};
+
+template <class T>
+void intrusive_mpsc_queue<T>::push(T* value) {
+  static_assert(std::is_base_of_v<intrusive_mpsc_queue_hook, T>, "T must be derived from intrusive_mpsc_queue_hook");
+  if (value == nullptr) {
+    throw std::invalid_argument("value can not be nullptr");
+  }
+  push_hook(value);
+}
+
+template <class T>
+void intrusive_mpsc_queue<T>::push_hook(hook* n) {
+  n->_next.store(nullptr, std::memory_order_relaxed);
+  // (1) - this acq_rel-exchange synchronizes-with the acquire-load (5)
+  hook* prev = _head.exchange(n, std::memory_order_acq_rel);
+  // Between the exchange and the following store the new object is not yet reachable
+  // from the consumer's side - this is the window in which a pop operation can fail
+  // even though the queue is not empty.
+  // (2) - this release-store synchronizes-with the acquire-loads (3, 4, 6)
+  prev->_next.store(n, std::memory_order_release);
+}
+
+template <class T>
+bool intrusive_mpsc_queue<T>::try_pop(T*& result) {
+  result = pop();
+  return result != nullptr;
+}
+
+template <class T>
+T* intrusive_mpsc_queue<T>::pop() {
+  static_assert(std::is_base_of_v<intrusive_mpsc_queue_hook, T>, "T must be derived from intrusive_mpsc_queue_hook");
+  hook* tail = _tail;
+  // (3) - this acquire-load synchronizes-with the release-store (2)
+  hook* next = tail->_next.load(std::memory_order_acquire);
+  if (tail == &_stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    // skip the stub
+    _tail = next;
+    tail = next;
+    // (4) - this acquire-load synchronizes-with the release-store (2)
+    next = next->_next.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    _tail = next;
+    return static_cast<T*>(tail);
+  }
+
+  // tail is the last object we can see. If it is not the head, some producer has
+  // already swapped in its object but has not yet linked it.
+  // (5) - this acquire-load synchronizes-with the acq_rel-exchange (1)
+  if (_head.load(std::memory_order_acquire) != tail) {
+    return nullptr;
+  }
+
+  // tail is the last object in the queue - in order to pop it we have to make sure that
+  // it has a successor, so we push the stub.
+  push_hook(&_stub);
+  // (6) - this acquire-load synchronizes-with the release-store (2)
+  next = tail->_next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    _tail = next;
+    return static_cast<T*>(tail);
+  }
+  return nullptr;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
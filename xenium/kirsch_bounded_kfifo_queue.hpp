@@ -36,6 +36,12 @@ namespace xenium {
  * smaller than a pointer (i.e., `T` must be a raw pointer, a `std::unique_ptr` or a trivially copyable
  * type like std::uint32_t).
  *
+ * The queue can be closed via `close`, after which all push operations fail. Consumers can
+ * use `is_drained` to distinguish a queue that is only empty for now from one that is closed
+ * and will therefore remain empty forever. Since a pushed element becomes visible to consumers
+ * as soon as it is stored in its entry, push operations register themselves in a shared counter
+ * that also holds the closed flag, so `is_drained` can tell when no push is in flight anymore.
+ *
  * Supported policies:
  *  * `xenium::policy::padding_bytes`<br>
  *    Defines the number of padding bytes for each entry. (*optional*; defaults to `sizeof(T*)`)
@@ -92,6 +98,48 @@ public:
    */
   [[nodiscard]] std::optional<value_type> pop();
 
+  /**
+   * @brief Tries to pop up to `max` elements from the queue.
+   *
+   * The popped elements are assigned to `out`. Since the elements of a segment can be popped
+   * in any order, there is no contiguous range that could be claimed at once, so this simply
+   * performs up to `max` pop operations and stops at the first one that fails.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param out output iterator that receives the popped elements
+   * @param max the maximum number of elements to pop
+   * @return the number of popped elements
+   */
+  template <class OutputIt>
+  std::size_t try_pop_batch(OutputIt out, std::size_t max);
+
+  /**
+   * @brief Closes the queue, i.e., all subsequent push operations fail.
+   *
+   * Elements that have been pushed before the queue has been closed can still be popped.
+   *
+   * Progress guarantees: wait-free
+   */
+  void close() noexcept { _push_state.fetch_or(closed_flag, std::memory_order_relaxed); }
+
+  /**
+   * @brief Returns `true` if the queue has been closed.
+   */
+  [[nodiscard]] bool is_closed() const noexcept {
+    return (_push_state.load(std::memory_order_relaxed) & closed_flag) != 0;
+  }
+
+  /**
+   * @brief Returns `true` if the queue has been closed and all elements have been popped.
+   *
+   * Once this returns `true` no other element will ever be available in this queue.
+   * This has to inspect all entries, so it should only be called after a pop operation has failed.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] bool is_drained() const noexcept;
+
 private:
   using marked_value = xenium::marked_ptr<std::remove_pointer_t<raw_value_type>, 16>;
 
@@ -136,6 +184,7 @@ private:
   [[nodiscard]] bool not_in_valid_region(uint64_t tail_old, uint64_t tail_current, uint64_t head_current) const;
   [[nodiscard]] bool in_valid_region(uint64_t tail_old, uint64_t tail_current, uint64_t head_current) const;
   bool committed(const marked_idx& tail_old, marked_value new_value, uint64_t index);
+  bool do_try_push(value_type& value);
 
   template <class SuccessFunc, class EmptyFunc>
   auto do_pop(SuccessFunc successFunc, EmptyFunc emptyFunc);
@@ -147,6 +196,10 @@ private:
   std::atomic<marked_idx> _head;
   std::atomic<marked_idx> _tail;
   std::unique_ptr<entry[]> _queue;
+  // the LSB signals that the queue has been closed, the remaining bits count the pending push operations
+  std::atomic<uint64_t> _push_state{0};
+  static constexpr uint64_t closed_flag = 1;
+  static constexpr uint64_t push_inc = 2;
 };
 
 template <class T, class... Policies>
@@ -170,6 +223,18 @@ bool kirsch_bounded_kfifo_queue<T, Policies...>::try_push(value_type value) {
     throw std::invalid_argument("value can not be nullptr");
   }
 
+  if (_push_state.fetch_add(push_inc, std::memory_order_relaxed) & closed_flag) {
+    _push_state.fetch_sub(push_inc, std::memory_order_relaxed);
+    return false;
+  }
+  bool result = do_try_push(value);
+  // (5) - this release-fetch_sub synchronizes-with the acquire-load (6)
+  _push_state.fetch_sub(push_inc, std::memory_order_release);
+  return result;
+}
+
+template <class T, class... Policies>
+bool kirsch_bounded_kfifo_queue<T, Policies...>::do_try_push(value_type& value) {
   raw_value_type raw_value = traits::get_raw(value);
   for (;;) {
     marked_idx tail_old = _tail.load(std::memory_order_relaxed);
@@ -263,6 +328,40 @@ auto kirsch_bounded_kfifo_queue<T, Policies...>::do_pop(SuccessFunc successFunc,
   }
 }
 
+template <class T, class... Policies>
+template <class OutputIt>
+std::size_t kirsch_bounded_kfifo_queue<T, Policies...>::try_pop_batch(OutputIt out, std::size_t max) {
+  std::size_t n = 0;
+  while (n < max && do_pop(
+                      [&out](auto& v) {
+                        value_type value{};
+                        traits::store(value, v.get());
+                        *out = std::move(value);
+                        ++out;
+                        return true;
+                      },
+                      []() { return false; })) {
+    ++n;
+  }
+  return n;
+}
+
+template <class T, class... Policies>
+bool kirsch_bounded_kfifo_queue<T, Policies...>::is_drained() const noexcept {
+  // (6) - this acquire-load synchronizes-with the release-fetch_sub (5)
+  if (_push_state.load(std::memory_order_acquire) != closed_flag) {
+    return false;
+  }
+  // The queue is closed and no push operation is in flight, so entries can only be
+  // cleared by pop operations from now on.
+  for (uint64_t i = 0; i < _queue_size; ++i) {
+    if (_queue[i].value.load(std::memory_order_relaxed).get() != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <class T, class... Policies>
 template <bool Empty>
 bool kirsch_bounded_kfifo_queue<T, Policies...>::find_index(uint64_t start_index,
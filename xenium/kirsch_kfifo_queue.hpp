@@ -140,6 +140,10 @@ private:
 
     entry* items() noexcept { return reinterpret_cast<entry*>(this + 1); }
 
+    // The entries are stored directly after the segment (see alloc_segment), so the segment
+    // occupies more memory than sizeof(segment); used by byte based retire thresholds.
+    [[nodiscard]] std::size_t allocation_size() const noexcept { return sizeof(segment) + k * sizeof(entry); }
+
     std::atomic<bool> deleted{false};
     const uint64_t k;
     concurrent_ptr next{};
@@ -0,0 +1,383 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_LCRQ_QUEUE_HPP
+#define XENIUM_LCRQ_QUEUE_HPP
+
+#include <xenium/acquire_guard.hpp>
+#include <xenium/marked_ptr.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/utils.hpp>
+
+#include <xenium/detail/double_width_cas.hpp>
+#include <xenium/detail/pointer_queue_traits.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+/**
+ * @brief An unbounded lock-free multi-producer/multi-consumer FIFO queue.
+ *
+ * This is an implementation of the `LCRQ` proposed by Morrison and Afek
+ * \[[MA13](index.html#ref-morrison-2013)\].
+ *
+ * The queue is a linked list of concurrent ring queues (CRQs). Push and pop operations
+ * acquire an index in the current ring via fetch-and-add, so in contrast to CAS based
+ * queues they do not have to retry under contention. Each ring entry holds an index and
+ * a value which are updated together using a double-width CAS (`cmpxchg16b` on x86-64).
+ * If a push operation cannot place its value (because the ring is full or the operation
+ * repeatedly fails due to concurrent pop operations), it _closes_ the ring and appends a
+ * new one.
+ *
+ * Like the `ramalhete_queue`, it can only handle pointers or trivially copyable types that
+ * are smaller than a pointer (i.e., `T` must be a raw pointer, a `std::unique_ptr` or a
+ * trivially copyable type like std::uint32_t). Trivially copyable types are packed into
+ * the entry's value and must therefore not be zero.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for internal nodes. (**required**)
+ *  * `xenium::policy::entries_per_node`<br>
+ *    Defines the number of entries in each ring. This must be a power of two.
+ *    (*optional*; defaults to 1024)
+ *
+ * @tparam T
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class lcrq_queue {
+private:
+  using traits = detail::pointer_queue_traits_t<T, Policies...>;
+  using raw_value_type = typename traits::raw_type;
+
+public:
+  using value_type = T;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  static constexpr unsigned entries_per_node =
+    parameter::value_param_t<unsigned, policy::entries_per_node, 1024, Policies...>::value;
+
+  static_assert(utils::is_power_of_two(entries_per_node), "entries_per_node must be a power of two");
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+
+  template <class... NewPolicies>
+  using with = lcrq_queue<T, NewPolicies..., Policies...>;
+
+  lcrq_queue();
+  ~lcrq_queue();
+
+  lcrq_queue(const lcrq_queue&) = delete;
+  lcrq_queue(lcrq_queue&&) = delete;
+
+  lcrq_queue& operator=(const lcrq_queue&) = delete;
+  lcrq_queue& operator=(lcrq_queue&&) = delete;
+
+  /**
+   * @brief Pushes the given value to the queue.
+   *
+   * This operation might have to allocate a new node.
+   * Progress guarantees: lock-free (may perform a memory allocation)
+   * @param value
+   */
+  void push(value_type value);
+
+  /**
+   * @brief Tries to pop an object from the queue.
+   *
+   * Progress guarantees: lock-free
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(value_type& result);
+
+  /**
+   * @brief Tries to pop an element from the queue.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @return the popped value if the operation was successful, otherwise `std::nullopt`
+   */
+  [[nodiscard]] std::optional<value_type> pop();
+
+private:
+  struct node;
+
+  using concurrent_ptr = typename reclaimer::template concurrent_ptr<node, 0>;
+  using marked_ptr = typename concurrent_ptr::marked_ptr;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+
+  static constexpr std::uint64_t empty_value = 0;
+  // The most significant bit of an entry's index is the "safe" bit, the most significant
+  // bit of a ring's tail is the "closed" bit.
+  static constexpr std::uint64_t flag_bit = std::uint64_t(1) << 63;
+  static constexpr std::uint64_t index_mask = flag_bit - 1;
+  // The number of failed attempts after which a push operation closes the ring because
+  // it is starving (i.e., its entries are repeatedly invalidated by pop operations).
+  static constexpr unsigned max_push_attempts = 16;
+
+  static std::uint64_t to_entry_value(raw_value_type v) { return reinterpret_cast<std::uintptr_t>(v); }
+  static raw_value_type from_entry_value(std::uint64_t v) {
+    return reinterpret_cast<raw_value_type>(static_cast<std::uintptr_t>(v));
+  }
+
+  // Each entry is padded to a full cache line to avoid false sharing between
+  // operations with consecutive indexes.
+  struct alignas(64) entry {
+    // lo: safe bit + index; hi: value
+    detail::double_width_word data;
+  };
+
+  struct node : reclaimer::template enable_concurrent_ptr<node> {
+    explicit node(raw_value_type item);
+    ~node() override;
+
+    bool try_push(std::uint64_t value);
+    std::uint64_t try_pop();
+
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) concurrent_ptr next;
+    entry entries[entries_per_node];
+
+  private:
+    void fix_state();
+  };
+
+  alignas(64) concurrent_ptr _head;
+  alignas(64) concurrent_ptr _tail;
+};
+
+// All operations on a ring's head, tail and entries are sequentially consistent - the
+// correctness argument of the CRQ relies on a total order of these operations.
+
+template <class T, class... Policies>
+lcrq_queue<T, Policies...>::node::node(raw_value_type item) : head{0}, tail{0}, next{nullptr} {
+  for (std::uint64_t i = 0; i < entries_per_node; ++i) {
+    entries[i].data.store(flag_bit | i, empty_value, std::memory_order_relaxed);
+  }
+  if (item != nullptr) {
+    // Start with the first entry pre-filled
+    entries[0].data.store(flag_bit, to_entry_value(item), std::memory_order_relaxed);
+    tail.store(1, std::memory_order_relaxed);
+  }
+}
+
+template <class T, class... Policies>
+lcrq_queue<T, Policies...>::node::~node() {
+  for (auto& e : entries) {
+    auto v = e.data.hi.load(std::memory_order_relaxed);
+    if (v != empty_value) {
+      traits::delete_value(from_entry_value(v));
+    }
+  }
+}
+
+template <class T, class... Policies>
+bool lcrq_queue<T, Policies...>::node::try_push(std::uint64_t value) {
+  for (unsigned attempt = 1;; ++attempt) {
+    const auto t = tail.fetch_add(1);
+    if (t & flag_bit) {
+      return false; // the ring is closed
+    }
+
+    auto& data = entries[t & (entries_per_node - 1)].data;
+    auto idx = data.lo.load();
+    auto val = data.hi.load();
+    if (val == empty_value && (idx & index_mask) <= t) {
+      // If the entry is marked as unsafe, a pop operation may have already passed it,
+      // so we can only use it if no pop operation has reached our index yet.
+      if (((idx & flag_bit) != 0 || head.load() <= t) && data.compare_exchange(idx, val, flag_bit | t, value)) {
+        return true;
+      }
+    }
+
+    const auto h = head.load();
+    if ((t >= h && t - h >= entries_per_node) || attempt >= max_push_attempts) {
+      tail.fetch_or(flag_bit);
+      return false;
+    }
+  }
+}
+
+template <class T, class... Policies>
+std::uint64_t lcrq_queue<T, Policies...>::node::try_pop() {
+  for (;;) {
+    const auto h = head.fetch_add(1);
+    auto& data = entries[h & (entries_per_node - 1)].data;
+    for (;;) {
+      auto idx = data.lo.load();
+      auto val = data.hi.load();
+      const auto safe = idx & flag_bit;
+      const auto i = idx & index_mask;
+      if (i > h) {
+        break; // this entry has already been passed by a later round
+      }
+
+      if (val != empty_value) {
+        if (i == h) {
+          // This is our value - take it and prepare the entry for the next round.
+          if (data.compare_exchange(idx, val, safe | (h + entries_per_node), empty_value)) {
+            return val;
+          }
+        } else if (data.compare_exchange(idx, val, i, val)) {
+          // The value belongs to an earlier round whose pop operation is still pending.
+          // We mark the entry as unsafe to prevent a push operation of our round from
+          // storing a value that nobody would ever pop.
+          break;
+        }
+      } else if (data.compare_exchange(idx, val, safe | (h + entries_per_node), empty_value)) {
+        // The entry is empty - advance it to the next round so that a (slow) push
+        // operation of our round can no longer use it.
+        break;
+      }
+    }
+
+    // We failed to pop a value; check whether the ring is empty.
+    const auto t = tail.load() & index_mask;
+    if (t <= h + 1) {
+      fix_state();
+      return empty_value;
+    }
+  }
+}
+
+template <class T, class... Policies>
+void lcrq_queue<T, Policies...>::node::fix_state() {
+  // Pop operations increment head even if the ring is empty, so head may overtake tail.
+  // In this case we move tail forward so that subsequent push operations use valid entries.
+  for (;;) {
+    auto t = tail.load();
+    const auto h = head.load();
+    if (tail.load() != t) {
+      continue;
+    }
+    if (h <= t) {
+      return; // nothing to do (this also covers closed rings)
+    }
+    if (tail.compare_exchange_strong(t, h)) {
+      return;
+    }
+  }
+}
+
+template <class T, class... Policies>
+lcrq_queue<T, Policies...>::lcrq_queue() {
+  auto n = new node(nullptr);
+  _head.store(n, std::memory_order_relaxed);
+  _tail.store(n, std::memory_order_relaxed);
+}
+
+template <class T, class... Policies>
+lcrq_queue<T, Policies...>::~lcrq_queue() {
+  // (1) - this acquire-load synchronizes-with the release-CAS (10)
+  auto n = _head.load(std::memory_order_acquire);
+  while (n) {
+    // (2) - this acquire-load synchronizes-with the release-CAS (6)
+    auto next = n->next.load(std::memory_order_acquire);
+    delete n.get();
+    n = next;
+  }
+}
+
+template <class T, class... Policies>
+void lcrq_queue<T, Policies...>::push(value_type value) {
+  raw_value_type raw_val = traits::get_raw(value);
+  if (raw_val == nullptr) {
+    throw std::invalid_argument("value can not be nullptr");
+  }
+
+  guard_ptr t;
+  for (;;) {
+    // (3) - this acquire-load synchronizes-with the release-CAS (5, 7)
+    t.acquire(_tail, std::memory_order_acquire);
+
+    // (4) - this acquire-load synchronizes-with the release-CAS (6)
+    auto next = t->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      // some other thread already added a new node -> help to update the tail
+      marked_ptr expected = t;
+      // (5) - this release-CAS synchronizes-with the acquire-load (3)
+      _tail.compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed);
+      continue;
+    }
+
+    if (t->try_push(to_entry_value(raw_val))) {
+      traits::release(value);
+      return;
+    }
+
+    // The ring has been closed -> append a new one that contains our value.
+    node* new_node = new node(raw_val);
+    marked_ptr expected = nullptr;
+    // (6) - this release-CAS synchronizes-with the acquire-load (2, 4, 8)
+    if (t->next.compare_exchange_strong(expected, new_node, std::memory_order_release, std::memory_order_relaxed)) {
+      traits::release(value);
+      expected = t;
+      // (7) - this release-CAS synchronizes-with the acquire-load (3)
+      _tail.compare_exchange_strong(expected, new_node, std::memory_order_release, std::memory_order_relaxed);
+      return;
+    }
+    // some other thread already added a new node; prevent the pre-stored value from being deleted
+    new_node->entries[0].data.store(flag_bit, empty_value, std::memory_order_relaxed);
+    delete new_node;
+  }
+}
+
+template <class T, class... Policies>
+bool lcrq_queue<T, Policies...>::try_pop(value_type& result) {
+  auto res = pop();
+  if (res.has_value()) {
+    result = std::move(res).value();
+    return true;
+  }
+  return false;
+}
+
+template <class T, class... Policies>
+auto lcrq_queue<T, Policies...>::pop() -> std::optional<value_type> {
+  guard_ptr h;
+  for (;;) {
+    // (8) - this acquire-load synchronizes-with the release-CAS (10)
+    h.acquire(_head, std::memory_order_acquire);
+
+    if (auto v = h->try_pop(); v != empty_value) {
+      return traits::get(from_entry_value(v));
+    }
+
+    // (9) - this acquire-load synchronizes-with the release-CAS (6)
+    auto next = h->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return std::nullopt;
+    }
+
+    // The ring has been closed, but there might be some pending push operations that
+    // have acquired an index before it was closed, so we have to check it again.
+    if (auto v = h->try_pop(); v != empty_value) {
+      return traits::get(from_entry_value(v));
+    }
+
+    marked_ptr expected = h;
+    // (10) - this release-CAS synchronizes-with the acquire-load (1, 8)
+    if (_head.compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed)) {
+      h.reclaim(); // The old node has been unlinked -> reclaim it.
+    }
+  }
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
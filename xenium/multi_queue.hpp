@@ -0,0 +1,321 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_MULTI_QUEUE_HPP
+#define XENIUM_MULTI_QUEUE_HPP
+
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/utils.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure the number of consecutive operations for which a thread in
+   * `multi_queue` sticks to the sub-queues it has chosen randomly.
+   * @tparam Value
+   */
+  template <unsigned Value>
+  struct stickiness;
+} // namespace policy
+
+/**
+ * @brief A relaxed multi-producer/multi-consumer FIFO queue that distributes its elements
+ * over a number of independent sub-queues.
+ *
+ * This is a FIFO variant of the MultiQueue proposed by Rihani et al.
+ * \[[RSD15](index.html#ref-rihani-2015)\]. Strict FIFO queues like `michael_scott_queue` or
+ * `ramalhete_queue` serialize all producers on the tail and all consumers on the head. A
+ * `multi_queue` instead consists of `c * P` sub-queues (for `P` threads and some small
+ * factor `c`); since threads typically operate on different sub-queues, throughput scales
+ * with the number of threads. The price is a relaxed ordering: elements pushed to the same
+ * sub-queue are popped in FIFO order, but elements in different sub-queues may be popped in
+ * any order.
+ *
+ * A push operation adds the element to a randomly chosen sub-queue. A pop operation picks
+ * two random sub-queues and pops from the one that contains more elements ("power of two
+ * choices"). This keeps the sub-queues balanced, which in turn bounds the expected deviation
+ * from the strict FIFO order. To improve cache locality, a thread sticks to its chosen
+ * sub-queue(s) for `stickiness` consecutive operations before choosing new ones.
+ *
+ * `try_pop` only fails if it finds all sub-queues empty. However, since the sub-queues are
+ * checked one after another, it may fail even though elements have been pushed concurrently.
+ *
+ * The sub-queues must provide a `try_pop` operation as well as either a `push` operation
+ * (unbounded queues like `michael_scott_queue`) or a `try_push` operation (bounded queues like
+ * `vyukov_bounded_queue`). In the latter case `try_push` must leave its argument untouched if
+ * it fails. The progress guarantees of `multi_queue` are the same as those of its sub-queues.
+ *
+ * Supported policies:
+ *  * `xenium::policy::container`<br>
+ *    Defines the type of the sub-queues, e.g., `michael_scott_queue<T, policy::reclaimer<R>>`.
+ *    (**required**)
+ *  * `xenium::policy::stickiness`<br>
+ *    Defines the number of consecutive operations for which a thread uses the same
+ *    sub-queue(s). (*optional*; defaults to 8)
+ *
+ * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class multi_queue {
+public:
+  using value_type = T;
+  using queue = parameter::type_param_t<policy::container, parameter::nil, Policies...>;
+  static constexpr unsigned stickiness = parameter::value_param_t<unsigned, policy::stickiness, 8, Policies...>::value;
+
+  template <class... NewPolicies>
+  using with = multi_queue<T, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<queue>::value, "container policy must be specified");
+  static_assert(std::is_same_v<typename queue::value_type, T>, "the queue's value_type must be T");
+  static_assert(stickiness > 0, "stickiness must be greater than zero");
+
+  /**
+   * @brief Constructs a new instance with the given number of sub-queues.
+   *
+   * The remaining arguments are passed to the constructor of every sub-queue, e.g., the
+   * capacity of a bounded sub-queue.
+   *
+   * @param num_queues number of sub-queues; must be at least two.
+   * @param args arguments passed to the constructor of each sub-queue.
+   */
+  template <class... Args>
+  explicit multi_queue(std::size_t num_queues, const Args&... args);
+  ~multi_queue();
+
+  multi_queue(const multi_queue&) = delete;
+  multi_queue(multi_queue&&) = delete;
+
+  multi_queue& operator=(const multi_queue&) = delete;
+  multi_queue& operator=(multi_queue&&) = delete;
+
+  /**
+   * @brief Pushes the given value to one of the sub-queues.
+   *
+   * Only available if the sub-queues are unbounded, i.e., provide a `push` operation.
+   *
+   * Progress guarantees: same as the sub-queue's `push`
+   *
+   * @param value
+   */
+  void push(value_type value);
+
+  /**
+   * @brief Tries to push the given value to one of the sub-queues.
+   *
+   * For unbounded sub-queues this operation always succeeds. For bounded sub-queues it
+   * only fails if all sub-queues are full.
+   *
+   * Progress guarantees: same as the sub-queue's `push`/`try_push`
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(value_type value);
+
+  /**
+   * @brief Tries to pop an element from one of the sub-queues.
+   *
+   * The element is not necessarily the oldest one in the queue (see class description).
+   *
+   * Progress guarantees: same as the sub-queue's `try_pop`
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(value_type& result);
+
+  /**
+   * @brief Returns the number of sub-queues.
+   */
+  [[nodiscard]] std::size_t num_queues() const noexcept { return _num_queues; }
+
+private:
+  template <class Q, class = void>
+  struct is_bounded : std::true_type {};
+  template <class Q>
+  struct is_bounded<Q, std::void_t<decltype(std::declval<Q&>().push(std::declval<value_type>()))>> :
+      std::false_type {};
+
+  struct alignas(64) sub_queue {
+    template <class... Args>
+    explicit sub_queue(const Args&... args) : impl(args...) {}
+    multi_queue::queue impl;
+    // an approximation of the number of elements in this sub-queue; only used to pick the
+    // fuller of two sub-queues, so it is updated with relaxed operations after the fact.
+    std::atomic<std::ptrdiff_t> size{0};
+  };
+
+  struct thread_state {
+    std::uint64_t rng = 0;
+    std::size_t push_queue = 0;
+    std::size_t pop_queues[2] = {0, 0};
+    unsigned push_remaining = 0;
+    unsigned pop_remaining = 0;
+
+    std::size_t next_random(std::size_t bound) noexcept {
+      if (rng == 0) {
+        rng = utils::random() | 1;
+      }
+      // xorshift64
+      rng ^= rng << 13;
+      rng ^= rng >> 7;
+      rng ^= rng << 17;
+      return static_cast<std::size_t>(rng % bound);
+    }
+  };
+
+  bool push_to(sub_queue& q, value_type& value);
+  bool pop_from(sub_queue& q, value_type& result);
+  bool push_slow(value_type& value, std::size_t start);
+
+  // The thread state is shared by all instances of the same type. This only affects the
+  // stickiness, since all indexes are reduced modulo the number of sub-queues.
+  inline static thread_local thread_state _state;
+
+  sub_queue* _queues;
+  std::size_t _num_queues;
+};
+
+template <class T, class... Policies>
+template <class... Args>
+multi_queue<T, Policies...>::multi_queue(std::size_t num_queues, const Args&... args) : _num_queues(num_queues) {
+  if (num_queues < 2) {
+    throw std::invalid_argument("multi_queue requires at least two sub-queues");
+  }
+  auto mem = ::operator new(sizeof(sub_queue) * num_queues, std::align_val_t{alignof(sub_queue)});
+  _queues = static_cast<sub_queue*>(mem);
+  std::size_t i = 0;
+  try {
+    for (; i < num_queues; ++i) {
+      new (&_queues[i]) sub_queue(args...);
+    }
+  } catch (...) {
+    while (i > 0) {
+      _queues[--i].~sub_queue();
+    }
+    ::operator delete(mem, std::align_val_t{alignof(sub_queue)});
+    throw;
+  }
+}
+
+template <class T, class... Policies>
+multi_queue<T, Policies...>::~multi_queue() {
+  for (std::size_t i = 0; i < _num_queues; ++i) {
+    _queues[i].~sub_queue();
+  }
+  ::operator delete(_queues, std::align_val_t{alignof(sub_queue)});
+}
+
+template <class T, class... Policies>
+bool multi_queue<T, Policies...>::push_to(sub_queue& q, value_type& value) {
+  if constexpr (is_bounded<queue>::value) {
+    if (!q.impl.try_push(std::move(value))) {
+      return false;
+    }
+  } else {
+    q.impl.push(std::move(value));
+  }
+  q.size.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <class T, class... Policies>
+bool multi_queue<T, Policies...>::pop_from(sub_queue& q, value_type& result) {
+  if (!q.impl.try_pop(result)) {
+    return false;
+  }
+  q.size.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <class T, class... Policies>
+void multi_queue<T, Policies...>::push(value_type value) {
+  static_assert(!is_bounded<queue>::value, "push is only available for unbounded sub-queues; use try_push instead");
+  [[maybe_unused]] bool success = try_push(std::move(value));
+  assert(success);
+}
+
+template <class T, class... Policies>
+bool multi_queue<T, Policies...>::try_push(value_type value) {
+  auto& state = _state;
+  if (state.push_remaining == 0) {
+    state.push_queue = state.next_random(_num_queues);
+    state.push_remaining = stickiness;
+  }
+  --state.push_remaining;
+  auto idx = state.push_queue % _num_queues;
+  if (push_to(_queues[idx], value)) {
+    return true;
+  }
+  // our sub-queue is full, so choose a new one for the next operation
+  state.push_remaining = 0;
+  return push_slow(value, idx);
+}
+
+template <class T, class... Policies>
+bool multi_queue<T, Policies...>::push_slow(value_type& value, std::size_t start) {
+  for (std::size_t i = 1; i < _num_queues; ++i) {
+    if (push_to(_queues[(start + i) % _num_queues], value)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class T, class... Policies>
+bool multi_queue<T, Policies...>::try_pop(value_type& result) {
+  auto& state = _state;
+  if (state.pop_remaining == 0) {
+    state.pop_queues[0] = state.next_random(_num_queues);
+    state.pop_queues[1] = (state.pop_queues[0] + 1 + state.next_random(_num_queues - 1)) % _num_queues;
+    state.pop_remaining = stickiness;
+  }
+  --state.pop_remaining;
+
+  auto* first = &_queues[state.pop_queues[0] % _num_queues];
+  auto* second = &_queues[state.pop_queues[1] % _num_queues];
+  if (first->size.load(std::memory_order_relaxed) < second->size.load(std::memory_order_relaxed)) {
+    std::swap(first, second);
+  }
+  if (pop_from(*first, result) || pop_from(*second, result)) {
+    return true;
+  }
+
+  // both sub-queues are empty, so choose new ones for the next operation and check all
+  // the other sub-queues before reporting failure.
+  state.pop_remaining = 0;
+  auto start = state.next_random(_num_queues);
+  for (std::size_t i = 0; i < _num_queues; ++i) {
+    auto& q = _queues[(start + i) % _num_queues];
+    if (&q != first && &q != second && pop_from(q, result)) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
@@ -11,14 +11,56 @@
 #include <xenium/utils.hpp>
 
 #include <xenium/detail/nikolaev_scq.hpp>
+#include <xenium/detail/nikolaev_wcq.hpp>
 
 #include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure whether `nikolaev_bounded_queue` uses the wait-free wCQ
+   * algorithm instead of the lock-free SCQ algorithm.
+   *
+   * @tparam Value
+   */
+  template <bool Value>
+  struct wait_free;
+
+  /**
+   * @brief Policy to configure the maximum number of threads that can concurrently
+   * operate on a wait-free `nikolaev_bounded_queue` with wait-free progress.
+   *
+   * @tparam Value
+   */
+  template <std::size_t Value>
+  struct max_threads;
+
+  /**
+   * @brief Policy to configure the number of fast path attempts of a push operation on a
+   * wait-free `nikolaev_bounded_queue` before it switches to the slow path.
+   *
+   * @tparam Value
+   */
+  template <unsigned Value>
+  struct enqueue_patience;
+
+  /**
+   * @brief Policy to configure the number of fast path attempts of a pop operation on a
+   * wait-free `nikolaev_bounded_queue` before it switches to the slow path.
+   *
+   * @tparam Value
+   */
+  template <unsigned Value>
+  struct dequeue_patience;
+} // namespace policy
+
 /**
  * @brief A bounded lock-free multi-producer/multi-consumer queue.
  *
@@ -28,6 +70,19 @@ namespace xenium {
  * The nikoleav_bounded_queue provides lock-free progress guarantee under the condition that
  *  the number of threads concurrently operating on the queue is less than the queue's capacity.
  *
+ * If the `wait_free` policy is set, the queue instead uses the wCQ algorithm proposed by
+ * Nikolaev and Ravindran \[[NR22](index.html#ref-nikolaev-2022)\]. Operations use the same
+ * fast path as SCQ, but fall back to a slow path with helping after a bounded number of failed
+ * attempts. This bounds the worst-case latency of operations at the cost of a slightly larger
+ * memory footprint (double-width entries and one record per thread). Threads are assigned
+ * process-wide ids; threads with an id beyond `max_threads` never take the slow path, so
+ * for them operations remain lock-free.
+ *
+ * The queue can be closed via `close`, after which all push operations fail. Consumers can
+ * use `is_drained` to distinguish a queue that is only empty for now from one that is closed
+ * and will therefore remain empty forever. To support this, every slot has an "occupied" flag
+ * that is set by a push operation before it checks whether the queue has been closed.
+ *
  * Requirements: `T` must be nothrow move constructible nothrow move assignable.
  *
  * Supported policies:
@@ -37,6 +92,19 @@ namespace xenium {
  *    Note: this policy is applied to the _internal_ queues. The Nikolaev queue internally
  *    uses two queues to manage the indexes of free/allocated slots. A push operation pops an
  *    item from the free queue, so this policy actually affects both, push and pop operations.
+ *  * `xenium::policy::wait_free`<br>
+ *    If `true`, the queue uses the wait-free wCQ algorithm. (*optional*; defaults to `false`)
+ *  * `xenium::policy::max_threads`<br>
+ *    Defines the number of thread records of a wait-free queue. This policy is ignored if
+ *    `wait_free` is `false`. (*optional*; defaults to 64)
+ *  * `xenium::policy::enqueue_patience`<br>
+ *    Defines the number of fast path attempts of the internal enqueue operations before they
+ *    switch to the slow path. This policy is ignored if `wait_free` is `false`.
+ *    (*optional*; defaults to 16)
+ *  * `xenium::policy::dequeue_patience`<br>
+ *    Defines the number of fast path attempts of the internal dequeue operations before they
+ *    switch to the slow path. This policy is ignored if `wait_free` is `false`.
+ *    (*optional*; defaults to 64)
  *
  * @tparam T
  * @tparam Policies list of policies to customize the behaviour
@@ -49,6 +117,20 @@ public:
   using value_type = T;
   static constexpr unsigned pop_retries =
     parameter::value_param_t<unsigned, policy::pop_retries, 1000, Policies...>::value;
+  static constexpr bool wait_free = parameter::value_param_t<bool, policy::wait_free, false, Policies...>::value;
+  static constexpr std::size_t max_threads =
+    parameter::value_param_t<std::size_t, policy::max_threads, 64, Policies...>::value;
+  static constexpr unsigned enqueue_patience =
+    parameter::value_param_t<unsigned, policy::enqueue_patience, 16, Policies...>::value;
+  static constexpr unsigned dequeue_patience =
+    parameter::value_param_t<unsigned, policy::dequeue_patience, 64, Policies...>::value;
+
+  template <class... NewPolicies>
+  using with = nikolaev_bounded_queue<T, NewPolicies..., Policies...>;
+
+  static_assert(max_threads > 0 && max_threads < (1 << 16), "max_threads must be in the range [1, 65535]");
+  static_assert(enqueue_patience > 0, "enqueue_patience must be greater than zero");
+  static_assert(dequeue_patience > 0, "dequeue_patience must be greater than zero");
 
   /**
    * @brief Constructs a new instance with the specified maximum size.
@@ -67,17 +149,29 @@ public:
   /**
    * @brief Tries to push a new element to the queue.
    *
-   * Progress guarantees: lock-free
+   * The element is only moved from if the operation is successful.
+   *
+   * Progress guarantees: lock-free (wait-free if the `wait_free` policy is set)
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(value_type&& value) { return do_push(std::move(value)); }
+
+  /**
+   * @brief Tries to push a copy of the given element to the queue.
+   *
+   * Progress guarantees: lock-free (wait-free if the `wait_free` policy is set)
    *
    * @param value
    * @return `true` if the operation was successful, otherwise `false`
    */
-  bool try_push(value_type value);
+  bool try_push(const value_type& value) { return do_push(value); }
 
   /**
    * @brief Tries to pop an element from the queue.
    *
-   * Progress guarantees: lock-free
+   * Progress guarantees: lock-free (wait-free if the `wait_free` policy is set)
    *
    * @param result
    * @return `true` if the operation was successful, otherwise `false`
@@ -87,12 +181,53 @@ public:
   /**
    * @brief Tries to pop an element from the queue.
    *
-   * Progress guarantees: lock-free
+   * Progress guarantees: lock-free (wait-free if the `wait_free` policy is set)
    *
    * @return the popped value if the operation was successful, otherwise `std::nullopt`
    */
   [[nodiscard]] std::optional<value_type> pop();
 
+  /**
+   * @brief Tries to pop up to `max` elements from the queue.
+   *
+   * The popped elements are move-assigned to `out`. The internal index queues do not
+   * support claiming several entries at once, so this simply performs up to `max` pop
+   * operations and stops at the first one that fails.
+   *
+   * Progress guarantees: lock-free (wait-free if the `wait_free` policy is set)
+   *
+   * @param out output iterator that receives the popped elements
+   * @param max the maximum number of elements to pop
+   * @return the number of popped elements
+   */
+  template <class OutputIt>
+  std::size_t try_pop_batch(OutputIt out, std::size_t max);
+
+  /**
+   * @brief Closes the queue, i.e., all subsequent push operations fail.
+   *
+   * Elements that have been pushed before the queue has been closed can still be popped.
+   *
+   * Progress guarantees: wait-free
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Returns `true` if the queue has been closed.
+   */
+  [[nodiscard]] bool is_closed() const noexcept { return _closed.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Returns `true` if the queue has been closed and all elements have been popped.
+   *
+   * Once this returns `true` no other element will ever be available in this queue.
+   * This has to inspect the occupied flags of all slots, so it should only be called after a
+   * pop operation has failed.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] bool is_drained() const noexcept;
+
   /**
    * @brief Returns the (rounded) capacity of the queue.
    */
@@ -100,6 +235,19 @@ public:
 
 private:
   using storage_t = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+  using index_queue = std::conditional_t<wait_free, detail::nikolaev_wcq, detail::nikolaev_scq>;
+
+  template <class Tag>
+  static index_queue make_index_queue(std::size_t capacity, std::size_t remap_shift, Tag tag) {
+    if constexpr (wait_free) {
+      return index_queue(capacity, remap_shift, max_threads, enqueue_patience, dequeue_patience, tag);
+    } else {
+      return index_queue(capacity, remap_shift, tag);
+    }
+  }
+
+  template <class U>
+  bool do_push(U&& value);
 
   template <class SuccessFunc, class EmptyFunc>
   auto do_pop(SuccessFunc successFunc, EmptyFunc emptyFunc);
@@ -107,39 +255,69 @@ private:
   const std::size_t _capacity;
   const std::size_t _remap_shift;
   std::unique_ptr<storage_t[]> _storage;
-  detail::nikolaev_scq _allocated_queue;
-  detail::nikolaev_scq _free_queue;
+  std::unique_ptr<std::atomic<bool>[]> _occupied;
+  std::atomic<bool> _closed{false};
+  index_queue _allocated_queue;
+  index_queue _free_queue;
 };
 
 template <class T, class... Policies>
 nikolaev_bounded_queue<T, Policies...>::nikolaev_bounded_queue(std::size_t capacity) :
     _capacity(utils::next_power_of_two(capacity)),
-    _remap_shift(detail::nikolaev_scq::calc_remap_shift(_capacity)),
+    _remap_shift(index_queue::calc_remap_shift(_capacity)),
     _storage(new storage_t[_capacity]),
-    _allocated_queue(_capacity, _remap_shift, detail::nikolaev_scq::empty_tag{}),
-    _free_queue(_capacity, _remap_shift, detail::nikolaev_scq::full_tag{}) {
+    _occupied(new std::atomic<bool>[_capacity]()),
+    _allocated_queue(make_index_queue(_capacity, _remap_shift, typename index_queue::empty_tag{})),
+    _free_queue(make_index_queue(_capacity, _remap_shift, typename index_queue::full_tag{})) {
   assert(capacity > 0);
 }
 
 template <class T, class... Policies>
 nikolaev_bounded_queue<T, Policies...>::~nikolaev_bounded_queue() {
   std::uint64_t eidx;
-  while (_allocated_queue.dequeue<false, pop_retries>(eidx, _capacity, _remap_shift)) {
+  while (_allocated_queue.template dequeue<false, pop_retries>(eidx, _capacity, _remap_shift)) {
     reinterpret_cast<T&>(_storage[eidx]).~T();
   }
 }
 
 template <class T, class... Policies>
-bool nikolaev_bounded_queue<T, Policies...>::try_push(value_type value) {
+template <class U>
+bool nikolaev_bounded_queue<T, Policies...>::do_push(U&& value) {
+  if (_closed.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
   std::uint64_t eidx;
   // TODO - make nonempty checks configurable
-  if (!_free_queue.dequeue<false, pop_retries>(eidx, _capacity, _remap_shift)) {
+  if (!_free_queue.template dequeue<false, pop_retries>(eidx, _capacity, _remap_shift)) {
     return false;
   }
 
   assert(eidx < _capacity);
-  new (&_storage[eidx]) T(std::move(value));
-  _allocated_queue.enqueue<false, false>(eidx, _capacity, _remap_shift);
+  // The occupied flag must be set before we check whether the queue has been closed;
+  // this store and the following load pair up with the store (2) and the loads (3) in
+  // close/is_drained: either we see that the queue has been closed, or is_drained sees our
+  // slot as occupied until the element has been popped.
+  // (1) - this seq_cst-store synchronizes-with the seq_cst-loads (3)
+  _occupied[eidx].store(true, std::memory_order_seq_cst);
+  if (_closed.load(std::memory_order_seq_cst)) {
+    _occupied[eidx].store(false, std::memory_order_relaxed);
+    _free_queue.template enqueue<false, false>(eidx, _capacity, _remap_shift);
+    return false;
+  }
+
+  if constexpr (std::is_nothrow_constructible_v<T, U&&>) {
+    new (&_storage[eidx]) T(std::forward<U>(value));
+  } else {
+    try {
+      new (&_storage[eidx]) T(std::forward<U>(value));
+    } catch (...) {
+      _occupied[eidx].store(false, std::memory_order_relaxed);
+      _free_queue.template enqueue<false, false>(eidx, _capacity, _remap_shift);
+      throw;
+    }
+  }
+  _allocated_queue.template enqueue<false, false>(eidx, _capacity, _remap_shift);
   return true;
 }
 
@@ -164,7 +342,7 @@ template <class SuccessFunc, class EmptyFunc>
 auto nikolaev_bounded_queue<T, Policies...>::do_pop(SuccessFunc successFunc, EmptyFunc emptyFunc) {
   std::uint64_t idx;
   // TODO - make nonempty checks configurable
-  if (!_allocated_queue.dequeue<false, pop_retries>(idx, _capacity, _remap_shift)) {
+  if (!_allocated_queue.template dequeue<false, pop_retries>(idx, _capacity, _remap_shift)) {
     return emptyFunc();
   }
 
@@ -172,9 +350,47 @@ auto nikolaev_bounded_queue<T, Policies...>::do_pop(SuccessFunc successFunc, Emp
   T& data = reinterpret_cast<T&>(_storage[idx]);
   auto result = successFunc(data);
   data.~T(); // NOLINT (use-after-move)
-  _free_queue.enqueue<false, false>(idx, _capacity, _remap_shift);
+  // (4) - this release-store synchronizes-with the seq_cst-loads (3)
+  _occupied[idx].store(false, std::memory_order_release);
+  _free_queue.template enqueue<false, false>(idx, _capacity, _remap_shift);
   return result;
 }
+
+template <class T, class... Policies>
+template <class OutputIt>
+std::size_t nikolaev_bounded_queue<T, Policies...>::try_pop_batch(OutputIt out, std::size_t max) {
+  std::size_t n = 0;
+  while (n < max && do_pop(
+                      [&out](auto& v) {
+                        *out = std::move(v);
+                        ++out;
+                        return true;
+                      },
+                      []() { return false; })) {
+    ++n;
+  }
+  return n;
+}
+
+template <class T, class... Policies>
+void nikolaev_bounded_queue<T, Policies...>::close() noexcept {
+  // (2) - this seq_cst-store is totally ordered with the seq_cst-load in try_push
+  _closed.store(true, std::memory_order_seq_cst);
+}
+
+template <class T, class... Policies>
+bool nikolaev_bounded_queue<T, Policies...>::is_drained() const noexcept {
+  if (!_closed.load(std::memory_order_seq_cst)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < _capacity; ++i) {
+    // (3) - this seq_cst-load synchronizes-with the seq_cst-store (1) and the release-store (4)
+    if (_occupied[i].load(std::memory_order_seq_cst)) {
+      return false;
+    }
+  }
+  return true;
+}
 } // namespace xenium
 
 #endif
\ No newline at end of file
@@ -15,9 +15,15 @@ namespace xenium::policy {
  *
  * This policy is used by the following data structures:
  *   * `michael_scott_queue`
+ *   * `hoffman_basket_queue`
  *   * `ramalhete_queue`
+ *   * `lcrq_queue`
+ *   * `treiber_stack`
  *   * `harris_michael_list_based_set`
  *   * `harris_michael_hash_map`
+ *   * `art_map`
+ *   * `btree_map`
+ *   * `concurrent_cache`
  *
  * @tparam Reclaimer
  */
@@ -29,9 +35,14 @@ struct reclaimer;
  *
  * This policy is used by the following data structures:
  *   * `michael_scott_queue`
+ *   * `hoffman_basket_queue`
  *   * `ramalhete_queue`
+ *   * `treiber_stack`
  *   * `harris_michael_list_based_set`
  *   * `harris_michael_hash_map`
+ *   * `art_map`
+ *   * `btree_map`
+ *   * `concurrent_cache`
  *
  * @tparam Backoff
  */
@@ -54,6 +65,8 @@ struct compare;
  *
  * This policy is used by the following data structures:
  *   * `chase_work_stealing_deque`
+ *   * `idempotent_work_stealing_deque`
+ *   * `concurrent_vector`
  *
  * @tparam Value
  */
@@ -66,6 +79,8 @@ struct capacity;
  *
  * This policy is used by the following data structures:
  *   * `chase_work_stealing_deque`
+ *   * `idempotent_work_stealing_deque`
+ *   * `channel`
  *
  * @tparam Container
  */
@@ -78,6 +93,7 @@ struct container;
  * This policy is used by the following data structures:
  *   * `harris_michael_hash_map`
  *   * `vyukov_hash_map`
+ *   * `concurrent_cache`
  *
  * @tparam T
  */
@@ -96,7 +112,8 @@ template <class T>
 struct allocation_strategy;
 
 /**
- * @brief Policy to configure the number of entries per allocated node in `ramalhete_queue`.
+ * @brief Policy to configure the number of entries per allocated node in `ramalhete_queue`,
+ * `nikolaev_queue` and `lcrq_queue`.
  * @tparam Value
  */
 template <unsigned Value>
@@ -122,5 +139,65 @@ struct padding_bytes;
  */
 template <unsigned Value>
 struct pop_retries;
+
+/**
+ * @brief Policy to configure the allocator for large internal arrays.
+ *
+ * This policy is used by the following data structures:
+ *   * `vyukov_hash_map`
+ *   * `vyukov_bounded_queue`
+ *   * `concurrent_vector`
+ *
+ * `xenium::detail::growing_circular_array` takes the allocator as template parameter.
+ *
+ * @tparam T the allocator (see `xenium::default_array_allocator`)
+ */
+template <class T>
+struct array_allocator;
+
+/**
+ * @brief Policy to configure the number of slots.
+ *
+ * This policy is used by the following types:
+ *   * `seqlock` - the number of internal value slots.
+ *   * `xenium::reclamation::hyaline` - the number of slots threads announce themselves in.
+ *
+ * @tparam Value
+ */
+template <unsigned Value>
+struct slots;
+
+/**
+ * @brief Policy to configure the number of retired nodes a thread collects before it scans
+ * the state of all other threads to reclaim them.
+ *
+ * This policy is used by the following reclamation schemes:
+ *   * `xenium::reclamation::interval_based`
+ *   * `xenium::reclamation::nbr`
+ *
+ * @tparam Value
+ */
+template <std::size_t Value>
+struct scan_threshold;
+
+/**
+ * @brief Policy to configure an additional byte based threshold for retired nodes.
+ *
+ * If the value is not zero, a thread also scans its retired nodes as soon as the nodes it
+ * has retired since its last scan occupy at least this number of bytes, regardless of the
+ * node based threshold. This is useful if the sizes of the retired nodes vary a lot. The
+ * size of a node is `sizeof` the node type, unless the type defines an `allocation_size()`
+ * member function that returns the actual size. (defaults to zero, i.e., disabled)
+ *
+ * This policy is used by the following reclamation schemes:
+ *   * `xenium::reclamation::hazard_pointer`
+ *   * `xenium::reclamation::hazard_eras`
+ *   * `xenium::reclamation::interval_based`
+ *   * `xenium::reclamation::nbr`
+ *
+ * @tparam Value
+ */
+template <std::size_t Value>
+struct retired_bytes_threshold;
 } // namespace xenium::policy
 #endif
@@ -15,8 +15,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <optional>
 #include <stdexcept>
+#include <type_traits>
 
 #ifdef _MSC_VER
   #pragma warning(push)
@@ -31,10 +34,15 @@ namespace xenium {
  * This is an implementation of the `FAAArrayQueue` by Ramalhete and Correia \[[Ram16](index.html#ref-ramalhete-2016)\].
  *
  * It is faster and more efficient than the `michael_scott_queue`, but less generic as it can
- * only handle pointers or trivially copyable types that are smaller than a pointer
+ * only handle pointers or trivially copyable types of at most 16 bytes
  * (i.e., `T` must be a raw pointer, a `std::unique_ptr` or a trivially copyable type like std::uint32_t).
  * Note: `std::unique_ptr` are supported for convinience, but custom deleters are not yet supported.
  *
+ * Trivially copyable types that are smaller than a pointer are packed into the entry's pointer
+ * and must therefore not be zero. Larger trivially copyable types (e.g., small task or message
+ * descriptors) are stored inline in the entries without any additional allocation; for these all
+ * values are permitted.
+ *
  * A generic version that does not have this limitation is planned for a future version.
  *
  * Supported policies:
@@ -55,7 +63,10 @@ namespace xenium {
 template <class T, class... Policies>
 class ramalhete_queue {
 private:
-  using traits = detail::pointer_queue_traits_t<T, Policies...>;
+  static constexpr bool inline_values = detail::use_inline_queue_traits_v<T>;
+  using traits = std::conditional_t<inline_values,
+                                    detail::inline_queue_traits<T, Policies...>,
+                                    detail::pointer_queue_traits_t<T, Policies...>>;
   using raw_value_type = typename traits::raw_type;
 
 public:
@@ -110,12 +121,9 @@ private:
   using marked_ptr = typename concurrent_ptr::marked_ptr;
   using guard_ptr = typename concurrent_ptr::guard_ptr;
 
-  // TODO - use type from traits
-  using marked_value = xenium::marked_ptr<std::remove_pointer_t<raw_value_type>, 1>;
-
-  struct entry {
-    std::atomic<marked_value> value;
-  };
+  struct pointer_entry;
+  struct inline_entry;
+  using entry = std::conditional_t<inline_values, inline_entry, pointer_entry>;
 
   // TODO - make this configurable via policy.
   static constexpr unsigned step_size = 11;
@@ -130,16 +138,20 @@ private:
     concurrent_ptr next;
 
     // Start with the first entry pre-filled
-    explicit node(raw_value_type item) : pop_idx{0}, push_idx{step_size}, next{nullptr} {
-      entries[0].value.store(item, std::memory_order_relaxed);
-      for (unsigned i = 1; i < entries_per_node; i++) {
-        entries[i].value.store(nullptr, std::memory_order_relaxed);
+    explicit node(const raw_value_type* item) : pop_idx{0}, push_idx{step_size}, next{nullptr} {
+      unsigned i = 0;
+      if (item != nullptr) {
+        entries[0].init(*item);
+        i = 1;
+      }
+      for (; i < entries_per_node; i++) {
+        entries[i].init_empty();
       }
     }
 
     ~node() override {
       for (unsigned i = pop_idx; i < push_idx; i += step_size) {
-        traits::delete_value(entries[i % entries_per_node].value.load(std::memory_order_relaxed).get());
+        entries[i % entries_per_node].delete_value();
       }
     }
   };
@@ -148,6 +160,96 @@ private:
   alignas(64) concurrent_ptr _tail;
 };
 
+// Entry for pointers and values that are packed into a pointer. The pointer itself
+// encodes the entry's state: nullptr marks an empty entry, the mark bit is set
+// when a pop operation has abandoned the entry.
+template <class T, class... Policies>
+struct ramalhete_queue<T, Policies...>::pointer_entry {
+  void init(raw_value_type item) { value.store(item, std::memory_order_relaxed); }
+  void init_empty() { value.store(nullptr, std::memory_order_relaxed); }
+
+  [[nodiscard]] bool is_empty() const { return value.load(std::memory_order_relaxed) == nullptr; }
+
+  bool try_store(raw_value_type item) {
+    marked_value expected = nullptr;
+    // (8) - this release-CAS synchronizes-with the acquire-load (14) and the acquire-exchange (15)
+    return value.compare_exchange_strong(expected, item, std::memory_order_release, std::memory_order_relaxed);
+  }
+
+  std::optional<value_type> take() {
+    auto v = value.load(std::memory_order_relaxed);
+    if (v != nullptr) {
+      // (14) - this acquire-load synchronizes-with the release-CAS (8)
+      std::ignore = value.load(std::memory_order_acquire);
+      return traits::get(v.get());
+    }
+
+    // (15) - this acquire-exchange synchronizes-with the release-CAS (8)
+    v = value.exchange(marked_value(nullptr, 1), std::memory_order_acquire);
+    if (v != nullptr) {
+      return traits::get(v.get());
+    }
+    return std::nullopt;
+  }
+
+  void delete_value() { traits::delete_value(value.load(std::memory_order_relaxed).get()); }
+
+private:
+  // TODO - use type from traits
+  using marked_value = xenium::marked_ptr<std::remove_pointer_t<raw_value_type>, 1>;
+  std::atomic<marked_value> value;
+};
+
+// Entry for trivially copyable values that are stored inline. Since every entry is
+// pushed to at most once, the value itself does not have to be atomic - it is written
+// before the state is set to `full`, and it is only read after `full` has been observed.
+template <class T, class... Policies>
+struct ramalhete_queue<T, Policies...>::inline_entry {
+  void init(const raw_value_type& item) {
+    std::memcpy(value, static_cast<const void*>(&item), sizeof(item));
+    state.store(full, std::memory_order_relaxed);
+  }
+  void init_empty() { state.store(empty, std::memory_order_relaxed); }
+
+  [[nodiscard]] bool is_empty() const { return state.load(std::memory_order_relaxed) == empty; }
+
+  bool try_store(const raw_value_type& item) {
+    std::memcpy(value, static_cast<const void*>(&item), sizeof(item));
+    std::uint8_t expected = empty;
+    // (8) - this release-CAS synchronizes-with the acquire-load (14) and the acquire-exchange (15)
+    return state.compare_exchange_strong(expected, full, std::memory_order_release, std::memory_order_relaxed);
+  }
+
+  std::optional<value_type> take() {
+    // (14) - this acquire-load synchronizes-with the release-CAS (8)
+    if (state.load(std::memory_order_acquire) == full) {
+      return read_value();
+    }
+
+    // (15) - this acquire-exchange synchronizes-with the release-CAS (8)
+    if (state.exchange(abandoned, std::memory_order_acquire) == full) {
+      return read_value();
+    }
+    return std::nullopt;
+  }
+
+  void delete_value() {}
+
+private:
+  static constexpr std::uint8_t empty = 0;
+  static constexpr std::uint8_t full = 1;
+  static constexpr std::uint8_t abandoned = 2;
+
+  value_type read_value() const {
+    value_type result;
+    std::memcpy(static_cast<void*>(&result), value, sizeof(result));
+    return result;
+  }
+
+  std::atomic<std::uint8_t> state;
+  alignas(T) unsigned char value[sizeof(T)];
+};
+
 template <class T, class... Policies>
 ramalhete_queue<T, Policies...>::ramalhete_queue() {
   auto n = new node(nullptr);
@@ -171,8 +273,10 @@ ramalhete_queue<T, Policies...>::~ramalhete_queue() {
 template <class T, class... Policies>
 void ramalhete_queue<T, Policies...>::push(value_type value) {
   raw_value_type raw_val = traits::get_raw(value);
-  if (raw_val == nullptr) {
-    throw std::invalid_argument("value can not be nullptr");
+  if constexpr (!inline_values) {
+    if (raw_val == nullptr) {
+      throw std::invalid_argument("value can not be nullptr");
+    }
   }
 
   backoff backoff;
@@ -190,7 +294,7 @@ void ramalhete_queue<T, Policies...>::push(value_type value) {
 
       auto next = t->next.load(std::memory_order_relaxed);
       if (next == nullptr) {
-        node* new_node = new node(raw_val);
+        node* new_node = new node(&raw_val);
         traits::release(value);
 
         marked_ptr expected = nullptr;
@@ -216,10 +320,7 @@ void ramalhete_queue<T, Policies...>::push(value_type value) {
     }
     idx %= entries_per_node;
 
-    marked_value expected = nullptr;
-    // (8) - this release-CAS synchronizes-with the acquire-load (14) and the acquire-exchange (15)
-    if (t->entries[idx].value.compare_exchange_strong(
-          expected, raw_val, std::memory_order_release, std::memory_order_relaxed)) {
+    if (t->entries[idx].try_store(raw_val)) {
       traits::release(value);
       return;
     }
@@ -276,26 +377,17 @@ auto ramalhete_queue<T, Policies...>::pop() -> std::optional<value_type> {
     }
     idx %= entries_per_node;
 
-    auto value = h->entries[idx].value.load(std::memory_order_relaxed);
+    auto& entry = h->entries[idx];
     if constexpr (pop_retries > 0) {
       unsigned cnt = 0;
       ramalhete_queue::backoff retry_backoff;
-      while (value == nullptr && ++cnt <= pop_retries) {
-        value = h->entries[idx].value.load(std::memory_order_relaxed);
+      while (entry.is_empty() && ++cnt <= pop_retries) {
         retry_backoff(); // TODO - use a backoff type that can be configured separately
       }
     }
 
-    if (value != nullptr) {
-      // (14) - this acquire-load synchronizes-with the release-CAS (8)
-      std::ignore = h->entries[idx].value.load(std::memory_order_acquire);
-      return traits::get(value.get());
-    }
-
-    // (15) - this acquire-exchange synchronizes-with the release-CAS (8)
-    value = h->entries[idx].value.exchange(marked_value(nullptr, 1), std::memory_order_acquire);
-    if (value != nullptr) {
-      return traits::get(value.get());
+    if (auto result = entry.take(); result.has_value()) {
+      return result;
     }
 
     backoff();
@@ -6,8 +6,10 @@
 #ifndef XENIUM_DETAIL_DELETABLE_OBJECT_HPP
 #define XENIUM_DETAIL_DELETABLE_OBJECT_HPP
 
+#include <cstddef>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 #ifdef _MSC_VER
   #pragma warning(push)
@@ -33,6 +35,35 @@ inline void delete_objects(deletable_object*& list) {
   list = nullptr;
 }
 
+template <class T, class = void>
+struct has_allocation_size : std::false_type {};
+
+template <class T>
+struct has_allocation_size<T, std::void_t<decltype(std::declval<const T&>().allocation_size())>> : std::true_type {};
+
+// Returns the number of bytes occupied by the given object. Types that are allocated with a
+// dynamic size (e.g., with a trailing array) can define an `allocation_size()` member function
+// that returns the actual size.
+template <class T>
+std::size_t object_size(const T& obj) noexcept {
+  if constexpr (has_allocation_size<T>::value) {
+    return obj.allocation_size();
+  } else {
+    return sizeof(T);
+  }
+}
+
+// Returns the size that a retired object contributes to a byte based threshold, or zero if
+// no such threshold is used; in this case the size does not have to be calculated at all.
+template <bool CountBytes, class T>
+std::size_t retired_size([[maybe_unused]] const T& obj) noexcept {
+  if constexpr (CountBytes) {
+    return object_size(obj);
+  } else {
+    return 0;
+  }
+}
+
 template <class Derived, class DeleterT, class Base>
 struct deletable_object_with_non_empty_deleter : Base {
   using Deleter = DeleterT;
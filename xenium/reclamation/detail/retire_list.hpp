@@ -17,6 +17,8 @@ struct retired_nodes {
 
 template <class Node = deletable_object>
 struct retire_list {
+  static constexpr bool counts_bytes = false;
+
   retire_list() {
     _nodes.first = nullptr;
     _nodes.last = nullptr;
@@ -24,7 +26,7 @@ struct retire_list {
 
   ~retire_list() { assert(_nodes.first == nullptr); }
 
-  void push(Node* node) {
+  void push(Node* node, std::size_t /*size*/ = 0) {
     node->next = _nodes.first;
     _nodes.first = node;
     if (_nodes.last == nullptr) {
@@ -32,6 +34,16 @@ struct retire_list {
     }
   }
 
+  // Prepends a chain of nodes in O(1).
+  void splice(retired_nodes<Node> nodes, std::size_t /*count*/ = 0, std::size_t /*bytes*/ = 0) {
+    assert(nodes.first != nullptr && nodes.last != nullptr);
+    nodes.last->next = _nodes.first;
+    _nodes.first = nodes.first;
+    if (_nodes.last == nullptr) {
+      _nodes.last = nodes.last;
+    }
+  }
+
   retired_nodes<Node> steal() {
     auto result = _nodes;
     _nodes.first = nullptr;
@@ -45,11 +57,19 @@ private:
   retired_nodes<Node> _nodes;
 };
 
-template <class Node = deletable_object>
+// Counts either the number of nodes or, if CountBytes is true, the number of bytes they occupy.
+template <class Node = deletable_object, bool CountBytes = false>
 struct counting_retire_list {
-  void push(Node* node) {
+  static constexpr bool counts_bytes = CountBytes;
+
+  void push(Node* node, std::size_t size = 0) {
     list.push(node);
-    ++counter;
+    counter += CountBytes ? size : 1;
+  }
+
+  void splice(retired_nodes<Node> nodes, std::size_t count, std::size_t bytes) {
+    list.splice(nodes);
+    counter += CountBytes ? bytes : count;
   }
 
   retired_nodes<Node> steal() {
@@ -62,7 +82,105 @@ struct counting_retire_list {
 
 private:
   retire_list<Node> list;
-  std::size_t counter;
+  std::size_t counter = 0;
+};
+
+// A chain of nodes that is built up by a single thread and then retired as a whole, so the
+// retire list of the reclamation scheme only has to be updated once.
+template <class Node = deletable_object>
+struct node_batch {
+  void push(Node* node, std::size_t size) {
+    list.push(node);
+    ++count;
+    bytes += size;
+  }
+
+  retired_nodes<Node> steal() {
+    count = 0;
+    bytes = 0;
+    return list.steal();
+  }
+
+  [[nodiscard]] bool empty() const { return list.empty(); }
+
+  retire_list<Node> list;
+  std::size_t count = 0;
+  std::size_t bytes = 0;
+};
+
+// The retire list of the schemes that scan once the number of retired nodes exceeds a threshold.
+// If RetiredBytesThreshold is non-zero, a scan is also due once the retired nodes occupy at least
+// that many bytes.
+template <class Node, std::size_t RetiredBytesThreshold>
+struct threshold_retire_list {
+  static constexpr bool counts_bytes = RetiredBytesThreshold != 0;
+
+  void push(Node* node, std::size_t size = 0) {
+    node->next = head;
+    head = node;
+    ++count;
+    bytes += size;
+  }
+
+  // Prepends the whole chain of the batch in O(1).
+  void splice(node_batch<Node>& batch) {
+    count += batch.count;
+    bytes += batch.bytes;
+    auto nodes = batch.steal();
+    nodes.last->next = head;
+    head = nodes.first;
+  }
+
+  [[nodiscard]] bool exceeds_threshold(std::size_t nodes_threshold) const {
+    if constexpr (counts_bytes) {
+      if (bytes >= RetiredBytesThreshold) {
+        return true;
+      }
+    }
+    return count >= nodes_threshold;
+  }
+
+  // Removes all nodes from the list and resets the counters.
+  Node* steal() {
+    auto* result = head;
+    head = nullptr;
+    count = 0;
+    bytes = 0;
+    return result;
+  }
+
+  [[nodiscard]] bool empty() const { return head == nullptr; }
+
+private:
+  Node* head = nullptr;
+  std::size_t count = 0;
+  // only maintained if counts_bytes is set
+  std::size_t bytes = 0;
+};
+
+// Collects the nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires
+// them all at once upon destruction, so the retire list of the reclamation scheme only has to
+// be updated, and its threshold only be checked, once per batch. The nodes are handed over to
+// `Reclaimer::add_retired_nodes`, which retires them in the calling thread.
+template <class Reclaimer, class Node = deletable_object>
+class retire_batch {
+public:
+  retire_batch() noexcept = default;
+  ~retire_batch() noexcept {
+    if (!nodes.empty()) {
+      Reclaimer::add_retired_nodes(nodes);
+    }
+  }
+
+  retire_batch(const retire_batch&) = delete;
+  retire_batch(retire_batch&&) = delete;
+  retire_batch& operator=(const retire_batch&) = delete;
+  retire_batch& operator=(retire_batch&&) = delete;
+
+private:
+  node_batch<Node> nodes;
+
+  friend Reclaimer;
 };
 
 template <class Node = deletable_object>
@@ -44,14 +44,16 @@ namespace reclamation {
    * abandon any remaining retired nodes when it terminates.
    *
    * @note The abandon strategy is applied for the retire list of each epoch
-   * individually. This is important in case the `when_exceeds_threshold` policy
-   * is used.
+   * individually. This is important in case the `when_exceeds_threshold` or
+   * `when_exceeds_bytes` policy is used.
    */
   namespace abandon {
     struct never;
     struct always;
     template <size_t Threshold>
     struct when_exceeds_threshold;
+    template <size_t Threshold>
+    struct when_exceeds_bytes;
   } // namespace abandon
 
   /**
@@ -136,6 +138,8 @@ namespace policy {
    *   * `xenium::reclamation::abandon::when_exceeds_threshold` - abandon the local retired nodes
    *     if the number of remaining nodes exceeds the defined threshold at the time the thread
    *     leaves the critical region.
+   *   * `xenium::reclamation::abandon::when_exceeds_bytes` - like `when_exceeds_threshold`, but
+   *     the threshold defines the number of bytes the remaining nodes occupy.
    *
    * @tparam T
    */
@@ -230,8 +234,8 @@ namespace reclamation {
    *    `one_thread` and `n_threads`. (defaults to `all_threads`)
    *  * `xenium::policy::abandon`<br>
    *    Defines when local retired nodes should be abandoned, so they can be reclaimed by some
-   *    other thread. Possible values are `never`, `always` and `when_exceeds_threshold`.
-   *    (defaults to `never`)
+   *    other thread. Possible values are `never`, `always`, `when_exceeds_threshold` and
+   *    `when_exceeds_bytes`. (defaults to `never`)
    *  * `xenium::policy::region_extension`<br>
    *    Defines the effect a `region_guard` should have. (defaults to `region_extension::eager`)
    *
@@ -273,6 +277,8 @@ namespace reclamation {
       region_guard& operator=(region_guard&&) = delete;
     };
 
+    class retire_batch;
+
     template <class T, std::size_t N = T::number_of_mark_bits>
     using concurrent_ptr = xenium::reclamation::detail::concurrent_ptr<T, N, guard_ptr>;
 
@@ -281,6 +287,8 @@ namespace reclamation {
   private:
     using epoch_t = size_t;
 
+    static constexpr bool count_retired_bytes = Traits::abandon_strategy::retire_list::counts_bytes;
+
     static constexpr epoch_t number_epochs = 3;
 
     struct thread_data;
@@ -317,6 +325,26 @@ namespace reclamation {
     friend class guard_ptr;
   };
 
+  // Collects the nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires
+  // them all at once upon destruction (see @ref retire_batch).
+  template <class Traits>
+  class generic_epoch_based<Traits>::retire_batch {
+  public:
+    retire_batch() noexcept = default;
+    ~retire_batch() noexcept;
+
+    retire_batch(const retire_batch&) = delete;
+    retire_batch(retire_batch&&) = delete;
+    retire_batch& operator=(const retire_batch&) = delete;
+    retire_batch& operator=(retire_batch&&) = delete;
+
+  private:
+    detail::node_batch<> nodes;
+
+    template <class, class>
+    friend class guard_ptr;
+  };
+
   template <class Traits>
   template <class T, class MarkedPtr>
   class generic_epoch_based<Traits>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>> {
@@ -345,6 +373,9 @@ namespace reclamation {
 
     // Reset. Deleter d will be applied some time after all owners release their ownership.
     void reclaim(Deleter d = Deleter()) noexcept;
+
+    // Like reclaim, but the node is only added to the retire list once the batch is destroyed.
+    void reclaim(retire_batch& batch, Deleter d = Deleter()) noexcept;
   };
 } // namespace reclamation
 } // namespace xenium
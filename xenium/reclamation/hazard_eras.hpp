@@ -10,6 +10,7 @@
 #include <xenium/reclamation/detail/concurrent_ptr.hpp>
 #include <xenium/reclamation/detail/deletable_object.hpp>
 #include <xenium/reclamation/detail/guard_ptr.hpp>
+#include <xenium/reclamation/detail/retire_list.hpp>
 #include <xenium/reclamation/detail/thread_block_list.hpp>
 
 #include <xenium/acquire_guard.hpp>
@@ -30,6 +31,9 @@ class bad_hazard_era_alloc : public std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
+template <class Traits>
+class interval_based;
+
 namespace detail {
   struct deletable_object_with_eras;
 
@@ -106,12 +110,15 @@ namespace he_allocation {
       detail::generic_hazard_era_allocation_strategy<K, A, B, detail::dynamic_he_thread_control_block> {};
 } // namespace he_allocation
 
-template <class AllocationStrategy = he_allocation::static_strategy<3>>
+template <class AllocationStrategy = he_allocation::static_strategy<3>, std::size_t RetiredBytesThreshold = 0>
 struct hazard_era_traits {
   using allocation_strategy = AllocationStrategy;
+  static constexpr std::size_t retired_bytes_threshold = RetiredBytesThreshold;
 
   template <class... Policies>
-  using with = hazard_era_traits<parameter::type_param_t<policy::allocation_strategy, AllocationStrategy, Policies...>>;
+  using with = hazard_era_traits<
+    parameter::type_param_t<policy::allocation_strategy, AllocationStrategy, Policies...>,
+    parameter::value_param_t<std::size_t, policy::retired_bytes_threshold, RetiredBytesThreshold, Policies...>::value>;
 };
 
 /**
@@ -129,6 +136,9 @@ struct hazard_era_traits {
  *    and 'xenium::reclamation::he_allocation::dynamic_strategy`, where both strategies
  *    can be further customized via their respective template parameters.
  *    (defaults to `xenium::reclamation::he_allocation::static_strategy<3>`)
+ *  * `xenium::policy::retired_bytes_threshold`<br>
+ *    Defines an additional threshold for the size of the nodes a thread has retired since
+ *    its last scan. (defaults to zero, i.e., only the allocation strategy's threshold is used)
  *
  * @tparam Traits
  */
@@ -160,6 +170,10 @@ public:
 
   class region_guard {};
 
+  // Collects nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires them
+  // all at once upon destruction.
+  using retire_batch = detail::retire_batch<hazard_eras, detail::deletable_object_with_eras>;
+
   template <class T, std::size_t N = T::number_of_mark_bits>
   using concurrent_ptr = detail::concurrent_ptr<T, N, guard_ptr>;
 
@@ -169,6 +183,11 @@ private:
   struct thread_data;
 
   friend struct detail::deletable_object_with_eras;
+  friend retire_batch;
+
+  static constexpr bool count_retired_bytes = Traits::retired_bytes_threshold != 0;
+
+  static void add_retired_nodes(detail::node_batch<detail::deletable_object_with_eras>& nodes) noexcept;
 
   using era_t = uint64_t;
   inline static std::atomic<era_t> era_clock{1};
@@ -233,6 +252,9 @@ public:
   // Reset. Deleter d will be applied some time after all owners release their ownership.
   void reclaim(Deleter d = Deleter()) noexcept;
 
+  // Like reclaim, but the node is only added to the retire list once the batch is destroyed.
+  void reclaim(retire_batch& batch, Deleter d = Deleter()) noexcept;
+
 private:
   using enable_concurrent_ptr = hazard_eras::enable_concurrent_ptr<T, MarkedPtr::number_of_mark_bits, Deleter>;
 
@@ -254,6 +276,8 @@ namespace detail {
     era_t retirement_era{};
     template <class>
     friend class hazard_eras;
+    template <class>
+    friend class reclamation::interval_based;
 
 #ifdef __clang__
   #pragma clang diagnostic push
@@ -10,6 +10,7 @@
 #include <xenium/reclamation/detail/concurrent_ptr.hpp>
 #include <xenium/reclamation/detail/deletable_object.hpp>
 #include <xenium/reclamation/detail/guard_ptr.hpp>
+#include <xenium/reclamation/detail/retire_list.hpp>
 #include <xenium/reclamation/detail/thread_block_list.hpp>
 
 #include <xenium/acquire_guard.hpp>
@@ -34,6 +35,21 @@ namespace detail {
   template <class Strategy, class Derived>
   struct basic_hp_thread_control_block;
 
+#ifdef WITH_PERF_COUNTER
+  struct hp_performance_counters {
+    size_t scan_calls = 0;
+    // number of non-empty hazard pointers found while gathering the protected pointers
+    size_t protected_pointers = 0;
+    // ticks spent on gathering and sorting the protected pointers
+    size_t gather_ticks = 0;
+    // number of retired nodes checked against the protected pointers
+    size_t checked_nodes = 0;
+    size_t reclaimed_nodes = 0;
+    // ticks spent on walking the retire lists and reclaiming nodes
+    size_t reclaim_ticks = 0;
+  };
+#endif
+
   template <size_t K_, size_t A, size_t B, template <class> class ThreadControlBlock>
   struct generic_hp_allocation_strategy {
     static constexpr size_t K = K_;
@@ -97,13 +113,15 @@ namespace hp_allocation {
   struct dynamic_strategy : detail::generic_hp_allocation_strategy<K, A, B, detail::dynamic_hp_thread_control_block> {};
 } // namespace hp_allocation
 
-template <class AllocationStrategy = hp_allocation::static_strategy<3>>
+template <class AllocationStrategy = hp_allocation::static_strategy<3>, std::size_t RetiredBytesThreshold = 0>
 struct hazard_pointer_traits {
   using allocation_strategy = AllocationStrategy;
+  static constexpr std::size_t retired_bytes_threshold = RetiredBytesThreshold;
 
   template <class... Policies>
-  using with =
-    hazard_pointer_traits<parameter::type_param_t<policy::allocation_strategy, AllocationStrategy, Policies...>>;
+  using with = hazard_pointer_traits<
+    parameter::type_param_t<policy::allocation_strategy, AllocationStrategy, Policies...>,
+    parameter::value_param_t<std::size_t, policy::retired_bytes_threshold, RetiredBytesThreshold, Policies...>::value>;
 };
 
 /**
@@ -121,6 +139,9 @@ struct hazard_pointer_traits {
  *    and 'xenium::reclamation::hp_allocation::dynamic_strategy`, where both strategies
  *    can be further customized via their respective template parameters.
  *    (defaults to `xenium::reclamation::he_allocation::static_strategy<3>`)
+ *  * `xenium::policy::retired_bytes_threshold`<br>
+ *    Defines an additional threshold for the size of the nodes a thread has retired since
+ *    its last scan. (defaults to zero, i.e., only the allocation strategy's threshold is used)
  *
  * @tparam Traits
  */
@@ -152,14 +173,35 @@ public:
 
   class region_guard {};
 
+  // Collects nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires them
+  // all at once upon destruction.
+  using retire_batch = detail::retire_batch<hazard_pointer>;
+
   template <class T, std::size_t N = T::number_of_mark_bits>
   using concurrent_ptr = detail::concurrent_ptr<T, N, guard_ptr>;
 
+#ifdef WITH_PERF_COUNTER
+  using performance_counters = detail::hp_performance_counters;
+  /**
+   * @brief Returns the sum of the performance counters of all threads.
+   *
+   * The counters split the cost of `scan` between gathering the protected pointers and
+   * walking the retire list.
+   */
+  static performance_counters get_performance_counters();
+#endif
+
   ALLOCATION_TRACKER;
 
 private:
   struct thread_data;
 
+  friend retire_batch;
+
+  static constexpr bool count_retired_bytes = Traits::retired_bytes_threshold != 0;
+
+  static void add_retired_nodes(detail::node_batch<>& nodes) noexcept;
+
   inline static detail::thread_block_list<thread_control_block> global_thread_block_list;
   inline static thread_local thread_data local_thread_data;
 
@@ -220,6 +262,9 @@ public:
   // Reset. Deleter d will be applied some time after all owners release their ownership.
   void reclaim(Deleter d = Deleter()) noexcept;
 
+  // Like reclaim, but the node is only retired once the batch is destroyed.
+  void reclaim(retire_batch& batch, Deleter d = Deleter()) noexcept;
+
 private:
   using enable_concurrent_ptr = hazard_pointer::enable_concurrent_ptr<T, MarkedPtr::number_of_mark_bits, Deleter>;
 
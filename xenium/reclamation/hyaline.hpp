@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_HYALINE_HPP
+#define XENIUM_HYALINE_HPP
+
+#include <xenium/acquire_guard.hpp>
+#include <xenium/marked_ptr.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/reclamation/detail/allocation_tracker.hpp>
+#include <xenium/reclamation/detail/concurrent_ptr.hpp>
+#include <xenium/reclamation/detail/deletable_object.hpp>
+#include <xenium/reclamation/detail/guard_ptr.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure the number of retired nodes `hyaline` collects in a thread-local
+   * batch before the batch is handed over to the threads that are currently active.
+   *
+   * @tparam Value
+   */
+  template <std::size_t Value>
+  struct batch_size;
+} // namespace policy
+
+namespace reclamation {
+  template <unsigned Slots = 32, std::size_t BatchSize = 64>
+  struct hyaline_traits {
+    static constexpr unsigned slots = Slots;
+    static constexpr std::size_t batch_size = BatchSize;
+
+    template <class... Policies>
+    using with =
+      hyaline_traits<parameter::value_param_t<unsigned, policy::slots, Slots, Policies...>::value,
+                     parameter::value_param_t<std::size_t, policy::batch_size, BatchSize, Policies...>::value>;
+  };
+
+  /**
+   * @brief An implementation of Hyaline as proposed by Nikolaev and Ravindran
+   * \[[NR21](index.html#ref-nikolaev-2021)\].
+   *
+   * For general information about the interface of the reclamation scheme see @ref reclamation_schemes.
+   *
+   * Hyaline combines reference counting with epoch-like critical regions, but in contrast to
+   * epoch based schemes no thread ever has to scan the state of other threads. A thread entering
+   * a critical region increments the reference counter of one of a fixed number of _slots_.
+   * Retired nodes are collected in thread-local batches; once a batch is full, it is appended
+   * to the list of every slot that currently has active threads, and the batch's reference
+   * counter is set to the number of these threads. A thread that leaves its critical region
+   * decrements the counters of all batches that have been appended to its slot in the meantime;
+   * the thread that drops a batch's counter to zero reclaims all its nodes.
+   *
+   * The work to reclaim a batch is therefore done by the last thread that could still hold a
+   * reference to it. Since threads only share a slot, but need not own one, the number of
+   * threads is not limited by the number of slots, which makes Hyaline a good fit for
+   * oversubscribed systems.
+   *
+   * @note This is the basic variant of Hyaline, _not_ the robust Hyaline-S variant that tags
+   * nodes with birth eras. Consequently, a thread that gets stalled inside a critical region
+   * holds a reference to _every_ batch that is appended to its slot while it is stalled, so
+   * the amount of unreclaimed memory is not bounded in this case - just like with epoch based
+   * schemes. Threads that are not stalled are not affected, i.e., they do not have to wait for
+   * the stalled thread, but their retired nodes still cannot be reclaimed.
+   *
+   * At most 2^16 - 1 threads can be active in the same slot at the same time.
+   *
+   * This class does not take a list of policies, but a `Traits` type that can be customized
+   * with a list of policies. Use the `with<>` template alias to pass your custom policies.
+   *
+   * The following policies are supported:
+   *  * `xenium::policy::slots`<br>
+   *    Defines the number of slots. Each thread is assigned one slot in a round-robin fashion
+   *    when it enters its first critical region. (defaults to 32)
+   *  * `xenium::policy::batch_size`<br>
+   *    Defines the number of retired nodes that are collected before the batch is handed over
+   *    to the active threads. A thread also hands over its remaining nodes when it terminates.
+   *    (defaults to 64)
+   *
+   * @tparam Traits
+   */
+  template <class Traits = hyaline_traits<>>
+  class hyaline {
+    template <class T, class MarkedPtr>
+    class guard_ptr;
+
+  public:
+    /**
+     * @brief Customize the reclamation scheme with the given policies.
+     *
+     * The given policies are applied to the current configuration, replacing previously
+     * specified policies of the same type.
+     *
+     * The resulting type is the newly configured reclamation scheme.
+     *
+     * @tparam Policies list of policies to customize the behaviour
+     */
+    template <class... Policies>
+    using with = hyaline<typename Traits::template with<Policies...>>;
+
+    template <class T, std::size_t N = 0, class Deleter = std::default_delete<T>>
+    class enable_concurrent_ptr;
+
+    struct region_guard {
+      region_guard() noexcept;
+      ~region_guard() noexcept;
+
+      region_guard(const region_guard&) = delete;
+      region_guard(region_guard&&) = delete;
+      region_guard& operator=(const region_guard&) = delete;
+      region_guard& operator=(region_guard&&) = delete;
+    };
+
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    using concurrent_ptr = xenium::reclamation::detail::concurrent_ptr<T, N, guard_ptr>;
+
+    ALLOCATION_TRACKER;
+
+  private:
+    static_assert(Traits::slots > 0, "slots must be greater than zero");
+    static_assert(Traits::batch_size > 0, "batch_size must be greater than zero");
+
+    struct batch;
+    struct slot_node;
+    struct slot;
+    struct thread_data;
+
+    inline static std::array<slot, Traits::slots> slots;
+    inline static std::atomic<unsigned> next_slot;
+    static thread_data& local_thread_data();
+
+    ALLOCATION_TRACKING_FUNCTIONS;
+  };
+
+  template <class Traits>
+  template <class T, std::size_t N, class Deleter>
+  class hyaline<Traits>::enable_concurrent_ptr :
+      private detail::deletable_object_impl<T, Deleter>,
+      private detail::tracked_object<hyaline> {
+  public:
+    static constexpr std::size_t number_of_mark_bits = N;
+
+  protected:
+    enable_concurrent_ptr() noexcept = default;
+    enable_concurrent_ptr(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr(enable_concurrent_ptr&&) noexcept = default;
+    enable_concurrent_ptr& operator=(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr& operator=(enable_concurrent_ptr&&) noexcept = default;
+    ~enable_concurrent_ptr() noexcept override = default;
+
+  private:
+    friend detail::deletable_object_impl<T, Deleter>;
+
+    template <class, class>
+    friend class guard_ptr;
+  };
+
+  template <class Traits>
+  template <class T, class MarkedPtr>
+  class hyaline<Traits>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>> {
+    using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
+    using Deleter = typename T::Deleter;
+
+  public:
+    // Guard a marked ptr.
+    explicit guard_ptr(const MarkedPtr& p = MarkedPtr()) noexcept;
+    guard_ptr(const guard_ptr& p) noexcept;
+    guard_ptr(guard_ptr&& p) noexcept;
+
+    guard_ptr& operator=(const guard_ptr& p) noexcept;
+    guard_ptr& operator=(guard_ptr&& p) noexcept;
+
+    // Atomically take snapshot of p, and *if* it points to unreclaimed object, acquire shared ownership of it.
+    void acquire(const concurrent_ptr<T>& p, std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Like acquire, but quit early if a snapshot != expected.
+    bool acquire_if_equal(const concurrent_ptr<T>& p,
+                          const MarkedPtr& expected,
+                          std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Release ownership. Postcondition: get() == nullptr.
+    void reset() noexcept;
+
+    // Reset. Deleter d will be applied some time after all owners release their ownership.
+    void reclaim(Deleter d = Deleter()) noexcept;
+  };
+} // namespace reclamation
+} // namespace xenium
+
+#define HYALINE_IMPL
+#include <xenium/reclamation/impl/hyaline.hpp>
+#undef HYALINE_IMPL
+
+#endif
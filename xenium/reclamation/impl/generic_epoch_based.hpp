@@ -115,6 +115,20 @@ namespace abandon {
       }
     }
   };
+
+  /**
+   * @brief Abandon the retired nodes upon leaving the critical region when the
+   * nodes occupy at least the specified number of bytes.
+   */
+  template <size_t Threshold>
+  struct when_exceeds_bytes {
+    using retire_list = detail::counting_retire_list<detail::deletable_object, true>;
+    static void apply(retire_list& retire_list, detail::orphan_list<>& orphans) {
+      if (retire_list.size() >= Threshold) {
+        orphans.add(retire_list.steal());
+      }
+    }
+  };
 } // namespace abandon
 
 template <class Traits>
@@ -232,10 +246,25 @@ template <class Traits>
 template <class T, class MarkedPtr>
 void generic_epoch_based<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept {
   this->ptr->set_deleter(std::move(d));
-  local_thread_data.add_retired_node(this->ptr.get());
+  local_thread_data.add_retired_node(this->ptr.get(), detail::retired_size<count_retired_bytes>(*this->ptr));
   reset();
 }
 
+template <class Traits>
+template <class T, class MarkedPtr>
+void generic_epoch_based<Traits>::guard_ptr<T, MarkedPtr>::reclaim(retire_batch& batch, Deleter d) noexcept {
+  this->ptr->set_deleter(std::move(d));
+  batch.nodes.push(this->ptr.get(), detail::retired_size<count_retired_bytes>(*this->ptr));
+  reset();
+}
+
+template <class Traits>
+generic_epoch_based<Traits>::retire_batch::~retire_batch() noexcept {
+  if (!nodes.empty()) {
+    local_thread_data.add_retired_nodes(nodes);
+  }
+}
+
 template <class Traits>
 struct generic_epoch_based<Traits>::thread_control_block : detail::thread_block_list<thread_control_block>::entry {
   thread_control_block() : is_in_critical_region(false), local_epoch(number_epochs) {}
@@ -397,7 +426,17 @@ private:
     return new_epoch;
   }
 
-  void add_retired_node(detail::deletable_object* p) { retire_lists[local_epoch_idx].push(p); }
+  void add_retired_node(detail::deletable_object* p, std::size_t size) { retire_lists[local_epoch_idx].push(p, size); }
+
+  // The nodes are added to the retire list of our current epoch, so we have to be inside a critical
+  // region to ensure that local_epoch_idx is up to date. The chain is prepended in O(1).
+  void add_retired_nodes(detail::node_batch<>& batch) {
+    enter_critical();
+    auto count = batch.count;
+    auto bytes = batch.bytes;
+    retire_lists[local_epoch_idx].splice(batch.steal(), count, bytes);
+    leave_critical();
+  }
 
   void reclaim_orphans(epoch_t epoch) {
     auto idx = epoch % number_epochs;
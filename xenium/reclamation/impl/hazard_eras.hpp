@@ -177,8 +177,32 @@ void hazard_eras<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept {
   // (3) - this release fetch-add synchronizes-with the seq-cst fence (5)
   p->retirement_era = era_clock.fetch_add(1, std::memory_order_release);
 
-  if (local_thread_data().add_retired_node(p) >= allocation_strategy::retired_nodes_threshold()) {
-    local_thread_data().scan();
+  auto& data = local_thread_data();
+  data.retire_list.push(p, detail::retired_size<count_retired_bytes>(*p));
+  if (data.exceeds_threshold()) {
+    data.scan();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void hazard_eras<Traits>::guard_ptr<T, MarkedPtr>::reclaim(retire_batch& batch, Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  // The node is already unlinked, so it is safe to take the retirement era now even though
+  // the node only gets added to our retire list later.
+  // this release fetch-add synchronizes-with the seq-cst fence (5) (see (3))
+  p->retirement_era = era_clock.fetch_add(1, std::memory_order_release);
+  batch.nodes.push(p, detail::retired_size<count_retired_bytes>(*p));
+}
+
+template <class Traits>
+void hazard_eras<Traits>::add_retired_nodes(detail::node_batch<detail::deletable_object_with_eras>& nodes) noexcept {
+  auto& data = local_thread_data();
+  data.retire_list.splice(nodes);
+  if (data.exceeds_threshold()) {
+    data.scan();
   }
 }
 
@@ -431,12 +455,11 @@ struct alignas(64) hazard_eras<Traits>::thread_data : aligned_object<thread_data
   using HE = typename thread_control_block::hazard_era*;
 
   ~thread_data() {
-    if (retire_list != nullptr) {
+    if (!retire_list.empty()) {
       scan();
-      if (retire_list != nullptr) {
-        global_thread_block_list.abandon_retired_nodes(retire_list);
+      if (!retire_list.empty()) {
+        global_thread_block_list.abandon_retired_nodes(retire_list.steal());
       }
-      retire_list = nullptr;
     }
 
     if (control_block != nullptr) {
@@ -457,10 +480,8 @@ struct alignas(64) hazard_eras<Traits>::thread_data : aligned_object<thread_data
     }
   }
 
-  std::size_t add_retired_node(detail::deletable_object_with_eras* p) {
-    p->next = retire_list;
-    retire_list = p;
-    return ++number_of_retired_nodes;
+  [[nodiscard]] bool exceeds_threshold() const {
+    return retire_list.exceeds_threshold(allocation_strategy::retired_nodes_threshold());
   }
 
   void scan() {
@@ -489,10 +510,7 @@ struct alignas(64) hazard_eras<Traits>::thread_data : aligned_object<thread_data
     auto last = std::unique(protected_eras.begin(), protected_eras.end());
     protected_eras.erase(last, protected_eras.end());
 
-    auto* list = retire_list;
-    retire_list = nullptr;
-    number_of_retired_nodes = 0;
-    reclaim_nodes(list, protected_eras);
+    reclaim_nodes(retire_list.steal(), protected_eras);
     reclaim_nodes(adopted_nodes, protected_eras);
   }
 
@@ -514,13 +532,12 @@ private:
       if (era_it == protected_eras.end() || *era_it > cur->retirement_era) {
         cur->delete_self();
       } else {
-        add_retired_node(cur);
+        retire_list.push(cur);
       }
     }
   }
 
-  detail::deletable_object_with_eras* retire_list = nullptr;
-  std::size_t number_of_retired_nodes = 0;
+  detail::threshold_retire_list<detail::deletable_object_with_eras, Traits::retired_bytes_threshold> retire_list;
   typename thread_control_block::hint hint;
 
   thread_control_block* control_block = nullptr;
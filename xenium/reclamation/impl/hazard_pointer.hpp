@@ -9,6 +9,7 @@
 
 #include <xenium/aligned_object.hpp>
 #include <xenium/detail/port.hpp>
+#include <xenium/utils.hpp>
 
 #include <algorithm>
 #include <new>
@@ -140,7 +141,25 @@ void hazard_pointer<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcep
   auto* p = this->ptr.get();
   reset();
   p->set_deleter(std::move(d));
-  if (local_thread_data.add_retired_node(p) >= allocation_strategy::retired_nodes_threshold()) {
+  local_thread_data.retire_list.push(p, detail::retired_size<count_retired_bytes>(*p));
+  if (local_thread_data.exceeds_threshold()) {
+    local_thread_data.scan();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void hazard_pointer<Traits>::guard_ptr<T, MarkedPtr>::reclaim(retire_batch& batch, Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  batch.nodes.push(p, detail::retired_size<count_retired_bytes>(*p));
+}
+
+template <class Traits>
+void hazard_pointer<Traits>::add_retired_nodes(detail::node_batch<>& nodes) noexcept {
+  local_thread_data.retire_list.splice(nodes);
+  if (local_thread_data.exceeds_threshold()) {
     local_thread_data.scan();
   }
 }
@@ -256,6 +275,11 @@ namespace detail {
     }
 
     hazard_pointer pointers[Strategy::K];
+
+  public:
+#ifdef WITH_PERF_COUNTER
+    hp_performance_counters counters;
+#endif
   };
 
   template <class Strategy>
@@ -358,12 +382,11 @@ struct alignas(64) hazard_pointer<Traits>::thread_data : aligned_object<thread_d
   using HP = typename thread_control_block::hazard_pointer*;
 
   ~thread_data() {
-    if (retire_list != nullptr) {
+    if (!retire_list.empty()) {
       scan();
-      if (retire_list != nullptr) {
-        global_thread_block_list.abandon_retired_nodes(retire_list);
+      if (!retire_list.empty()) {
+        global_thread_block_list.abandon_retired_nodes(retire_list.steal());
       }
-      retire_list = nullptr;
     }
 
     if (control_block != nullptr) {
@@ -379,14 +402,20 @@ struct alignas(64) hazard_pointer<Traits>::thread_data : aligned_object<thread_d
 
   void release_hazard_pointer(HP& hp) { control_block->release_hazard_pointer(hp, hint); }
 
-  std::size_t add_retired_node(detail::deletable_object* p) {
-    p->next = retire_list;
-    retire_list = p;
-    return ++number_of_retired_nodes;
+  [[nodiscard]] bool exceeds_threshold() const {
+    return retire_list.exceeds_threshold(allocation_strategy::retired_nodes_threshold());
   }
 
   void scan() {
-    std::vector<const detail::deletable_object*> protected_pointers;
+#ifdef WITH_PERF_COUNTER
+    ensure_has_control_block();
+    auto& counters = control_block->counters;
+    ++counters.scan_calls;
+    auto start = utils::getticks();
+#endif
+    // The buffer is reused across scans, so we only have to allocate if the number of
+    // hazard pointers has grown since the last scan.
+    protected_pointers.clear();
     protected_pointers.reserve(allocation_strategy::number_of_active_hazard_pointers());
 
     // (8) - this seq_cst-fence enforces a total order with the seq_cst-fence (4)
@@ -394,26 +423,32 @@ struct alignas(64) hazard_pointer<Traits>::thread_data : aligned_object<thread_d
 
     auto adopted_nodes = global_thread_block_list.adopt_abandoned_retired_nodes();
 
-    std::for_each(
-      global_thread_block_list.begin(), global_thread_block_list.end(), [&protected_pointers](const auto& entry) {
-        // TSan does not support explicit fences, so we cannot rely on the acquire-fence (9)
-        // but have to perform an acquire-load here to avoid false positives.
-        constexpr auto memory_order = TSAN_MEMORY_ORDER(std::memory_order_acquire, std::memory_order_relaxed);
-        if (entry.is_active(memory_order)) {
-          entry.gather_protected_pointers(protected_pointers);
-        }
-      });
+    std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(), [this](const auto& entry) {
+      // TSan does not support explicit fences, so we cannot rely on the acquire-fence (9)
+      // but have to perform an acquire-load here to avoid false positives.
+      constexpr auto memory_order = TSAN_MEMORY_ORDER(std::memory_order_acquire, std::memory_order_relaxed);
+      if (entry.is_active(memory_order)) {
+        entry.gather_protected_pointers(protected_pointers);
+      }
+    });
 
     // (9) - this acquire-fence synchronizes-with the release-store (3, 5)
     XENIUM_THREAD_FENCE(std::memory_order_acquire);
 
-    std::sort(protected_pointers.begin(), protected_pointers.end());
+    std::sort(protected_pointers.begin(), protected_pointers.end(), std::less<>{});
+
+#ifdef WITH_PERF_COUNTER
+    auto gathered = utils::getticks();
+    counters.protected_pointers += protected_pointers.size();
+    counters.gather_ticks += gathered - start;
+#endif
+
+    reclaim_nodes(retire_list.steal());
+    reclaim_nodes(adopted_nodes);
 
-    auto* list = retire_list;
-    retire_list = nullptr;
-    number_of_retired_nodes = 0;
-    reclaim_nodes(list, protected_pointers);
-    reclaim_nodes(adopted_nodes, protected_pointers);
+#ifdef WITH_PERF_COUNTER
+    counters.reclaim_ticks += utils::getticks() - gathered;
+#endif
   }
 
 private:
@@ -421,24 +456,51 @@ private:
     if (control_block == nullptr) {
       control_block = global_thread_block_list.acquire_entry();
       control_block->initialize(hint);
+#ifdef WITH_PERF_COUNTER
+      control_block->counters = detail::hp_performance_counters{}; // reset counters
+#endif
+    }
+  }
+
+  // Branch-free binary search in the sorted protected pointers. In contrast to
+  // std::binary_search the loop does not depend on the result of the comparisons, so the
+  // compiler can use conditional moves and we do not suffer from branch mispredictions.
+  [[nodiscard]] bool is_protected(const detail::deletable_object* p) const {
+    std::size_t n = protected_pointers.size();
+    if (n == 0) {
+      return false;
+    }
+    const auto* base = protected_pointers.data();
+    while (n > 1) {
+      auto half = n / 2;
+      base = std::less<>{}(p, base[half]) ? base : base + half;
+      n -= half;
     }
+    return *base == p;
   }
 
-  void reclaim_nodes(detail::deletable_object* list,
-                     const std::vector<const detail::deletable_object*>& protected_pointers) {
+  void reclaim_nodes(detail::deletable_object* list) {
     while (list != nullptr) {
       auto* cur = list;
       list = list->next;
+#ifdef WITH_PERF_COUNTER
+      ++control_block->counters.checked_nodes;
+#endif
 
-      if (std::binary_search(protected_pointers.begin(), protected_pointers.end(), cur)) {
-        add_retired_node(cur);
+      if (is_protected(cur)) {
+        retire_list.push(cur);
       } else {
+#ifdef WITH_PERF_COUNTER
+        ++control_block->counters.reclaimed_nodes;
+#endif
         cur->delete_self();
       }
     }
   }
-  detail::deletable_object* retire_list = nullptr;
-  std::size_t number_of_retired_nodes = 0;
+
+  // reused by all scans of this thread to avoid allocations
+  std::vector<const detail::deletable_object*> protected_pointers;
+  detail::threshold_retire_list<detail::deletable_object, Traits::retired_bytes_threshold> retire_list;
   typename thread_control_block::hint hint{};
 
   thread_control_block* control_block = nullptr;
@@ -447,6 +509,22 @@ private:
   ALLOCATION_COUNTER(hazard_pointer);
 };
 
+#ifdef WITH_PERF_COUNTER
+template <class Traits>
+auto hazard_pointer<Traits>::get_performance_counters() -> performance_counters {
+  performance_counters result{};
+  std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(), [&result](const auto& block) {
+    result.scan_calls += block.counters.scan_calls;
+    result.protected_pointers += block.counters.protected_pointers;
+    result.gather_ticks += block.counters.gather_ticks;
+    result.checked_nodes += block.counters.checked_nodes;
+    result.reclaimed_nodes += block.counters.reclaimed_nodes;
+    result.reclaim_ticks += block.counters.reclaim_ticks;
+  });
+  return result;
+}
+#endif
+
 #ifdef TRACK_ALLOCATIONS
 template <class Traits>
 inline void hazard_pointer<Traits>::count_allocation() {
@@ -0,0 +1,355 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef HYALINE_IMPL
+  #error "This is an impl file and must not be included directly!"
+#endif
+
+#include <xenium/detail/port.hpp>
+
+#include <cassert>
+
+namespace xenium::reclamation {
+
+// Every batch provides one node per slot, so a batch can be appended to the lists
+// of all slots without any further allocation.
+template <class Traits>
+struct hyaline<Traits>::slot_node {
+  slot_node* next;
+  batch* owner;
+};
+
+template <class Traits>
+struct hyaline<Traits>::batch {
+  // The reference counter of a batch is initialized with one `slot_reference` per slot.
+  // A slot's reference is dropped when the batch is skipped because the slot has no active
+  // threads, when the batch's node gets superseded by the node of a newer batch (at which
+  // point the number of active threads that have to traverse the node is added), or when
+  // the last active thread leaves the slot while the batch's node is the head of the list.
+  // Since a slot_reference is greater than the number of threads that can be active in a
+  // slot, the counter cannot drop to zero before all references have been accounted for.
+  std::atomic<std::int64_t> refs;
+  detail::deletable_object* nodes = nullptr;
+  std::size_t size = 0;
+  std::array<slot_node, Traits::slots> slot_nodes;
+};
+
+template <class Traits>
+struct alignas(64) hyaline<Traits>::slot {
+  // The mark holds the number of threads that are currently active in this slot.
+  std::atomic<marked_ptr<slot_node, 16>> head;
+};
+
+template <class Traits>
+struct hyaline<Traits>::thread_data {
+  ~thread_data() {
+    assert(region_entries == 0);
+    // reclaiming the nodes of a batch can retire further nodes, so we have to loop
+    while (current_batch != nullptr) {
+      auto* b = current_batch;
+      current_batch = nullptr;
+      retire(b);
+    }
+  }
+
+  void enter_region() {
+    if (++region_entries == 1) {
+      enter();
+    }
+  }
+
+  void leave_region() {
+    if (--region_entries == 0) {
+      leave();
+    }
+  }
+
+  void add_retired_node(detail::deletable_object* p) {
+    if (current_batch == nullptr) {
+      current_batch = new batch();
+    }
+
+    p->next = current_batch->nodes;
+    current_batch->nodes = p;
+    if (++current_batch->size >= Traits::batch_size) {
+      auto* b = current_batch;
+      current_batch = nullptr;
+      retire(b);
+    }
+  }
+
+private:
+  using marked_slot_ptr = marked_ptr<slot_node, 16>;
+  static constexpr std::int64_t slot_reference = std::int64_t(1) << 16;
+  static constexpr std::uintptr_t max_active_threads = slot_reference - 1;
+
+  void enter() {
+    if (slot_index == no_slot) {
+      slot_index = next_slot.fetch_add(1, std::memory_order_relaxed) % Traits::slots;
+    }
+
+    auto& head = slots[slot_index].head;
+    auto h = head.load(std::memory_order_relaxed);
+    do {
+      assert(h.mark() < max_active_threads && "too many threads are active in the same slot");
+      // TSan does not support explicit fences, so we cannot rely on the seq_cst-fences (1, 4)
+      // but have to use an acquire-CAS that synchronizes-with the CAS (5, 6) instead.
+    } while (!head.compare_exchange_weak(h,
+                                         marked_slot_ptr(h.get(), h.mark() + 1),
+                                         TSAN_MEMORY_ORDER(std::memory_order_acquire, std::memory_order_relaxed),
+                                         std::memory_order_relaxed));
+    handle = h.get();
+
+    // (1) - this seq_cst-fence enforces a total order with the seq_cst-fence (4)
+    XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+  }
+
+  void leave() {
+    auto& head = slots[slot_index].head;
+    // (2) - this acquire-load synchronizes-with the acq_rel-CAS (5)
+    auto h = head.load(std::memory_order_acquire);
+    slot_node* curr = nullptr;
+    slot_node* next = nullptr;
+    marked_slot_ptr new_head;
+    do {
+      curr = h.get();
+      // All nodes that have been appended since we entered the slot (i.e., all nodes above our
+      // handle) hold a reference for us, so it is safe to dereference curr. But as soon as we
+      // have decremented the slot's counter, curr can get reclaimed at any time.
+      if (curr != handle) {
+        next = curr->next;
+      }
+      auto active = h.mark() - 1;
+      new_head = marked_slot_ptr(active == 0 ? nullptr : curr, active);
+      // (3) - this acq_rel-CAS synchronizes-with the acq_rel-CAS (5)
+    } while (!head.compare_exchange_weak(h, new_head, std::memory_order_acq_rel, std::memory_order_acquire));
+
+    if (new_head.get() == nullptr && curr != nullptr) {
+      // we were the last active thread, so we have to drop the slot's reference to the head node
+      release(curr->owner, -slot_reference);
+    }
+
+    if (curr != handle) {
+      traverse(next);
+    }
+  }
+
+  // Drops our reference to all nodes from start down to (and including) our handle.
+  void traverse(slot_node* start) {
+    for (auto* node = start; node != nullptr;) {
+      auto* next = node->next;
+      bool last = node == handle;
+      release(node->owner, -1);
+      if (last) {
+        break;
+      }
+      node = next;
+    }
+  }
+
+  static void retire(batch* b) {
+    b->refs.store(Traits::slots * slot_reference, std::memory_order_relaxed);
+
+    // (4) - this seq_cst-fence enforces a total order with the seq_cst-fence (1)
+    XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+
+    std::int64_t skipped = 0;
+    for (unsigned i = 0; i < Traits::slots; ++i) {
+      auto& head = slots[i].head;
+      auto* node = &b->slot_nodes[i];
+      node->owner = b;
+      auto h = head.load(std::memory_order_relaxed);
+      bool appended = false;
+      for (;;) {
+        if (h.mark() == 0) {
+#ifdef XENIUM_TSAN
+          // (6) - TSan does not support explicit fences, so in order to order this slot with the
+          //       threads that left it before and the threads that enter it later we have to perform
+          //       an acq_rel-RMW that synchronizes-with the CAS (3) and the acquire-CAS in enter.
+          if (!head.compare_exchange_weak(h, h, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            continue;
+          }
+#endif
+          break;
+        }
+
+        node->next = h.get();
+        // (5) - this acq_rel-CAS synchronizes-with the acquire-load (2) and the acq_rel-CAS (3, 5)
+        if (head.compare_exchange_weak(
+              h, marked_slot_ptr(node, h.mark()), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          appended = true;
+          break;
+        }
+      }
+
+      if (!appended) {
+        skipped += slot_reference;
+      } else if (h.get() != nullptr) {
+        // The previous head has been superseded by our node, so all currently active threads
+        // will drop their reference to it when they leave; in return we drop the slot's reference.
+        release(h.get()->owner, static_cast<std::int64_t>(h.mark()) - slot_reference);
+      }
+    }
+
+    if (skipped != 0) {
+      release(b, -skipped);
+    }
+  }
+
+  static void release(batch* b, std::int64_t delta) {
+    // (7) - this acq_rel-FAA synchronizes-with all other acq_rel-FAA (7) on the same batch
+    if (b->refs.fetch_add(delta, std::memory_order_acq_rel) + delta == 0) {
+      detail::delete_objects(b->nodes);
+      delete b;
+    }
+  }
+
+  static constexpr unsigned no_slot = static_cast<unsigned>(-1);
+
+  unsigned region_entries = 0;
+  unsigned slot_index = no_slot;
+  slot_node* handle = nullptr;
+  batch* current_batch = nullptr;
+
+  friend class hyaline;
+  ALLOCATION_COUNTER(hyaline);
+};
+
+template <class Traits>
+hyaline<Traits>::region_guard::region_guard() noexcept {
+  local_thread_data().enter_region();
+}
+
+template <class Traits>
+hyaline<Traits>::region_guard::~region_guard() noexcept {
+  local_thread_data().leave_region();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+hyaline<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept : base(p) {
+  if (this->ptr) {
+    local_thread_data().enter_region();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+hyaline<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept : guard_ptr(MarkedPtr(p)) {}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+hyaline<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept : base(p.ptr) {
+  p.ptr.reset();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto hyaline<Traits>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = p.ptr;
+  if (this->ptr) {
+    local_thread_data().enter_region();
+  }
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto hyaline<Traits>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = std::move(p.ptr);
+  p.ptr.reset();
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void hyaline<Traits>::guard_ptr<T, MarkedPtr>::acquire(const concurrent_ptr<T>& p, std::memory_order order) noexcept {
+  if (p.load(std::memory_order_relaxed) == nullptr) {
+    reset();
+    return;
+  }
+
+  if (!this->ptr) {
+    local_thread_data().enter_region();
+  }
+  // (8) - this load operation potentially synchronizes-with any release operation on p.
+  this->ptr = p.load(order);
+  if (!this->ptr) {
+    local_thread_data().leave_region();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+bool hyaline<Traits>::guard_ptr<T, MarkedPtr>::acquire_if_equal(const concurrent_ptr<T>& p,
+                                                                const MarkedPtr& expected,
+                                                                std::memory_order order) noexcept {
+  auto actual = p.load(std::memory_order_relaxed);
+  if (actual == nullptr || actual != expected) {
+    reset();
+    return actual == expected;
+  }
+
+  if (!this->ptr) {
+    local_thread_data().enter_region();
+  }
+  // (9) - this load operation potentially synchronizes-with any release operation on p.
+  this->ptr = p.load(order);
+  if (!this->ptr || this->ptr != expected) {
+    local_thread_data().leave_region();
+    this->ptr.reset();
+  }
+
+  return this->ptr == expected;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void hyaline<Traits>::guard_ptr<T, MarkedPtr>::reset() noexcept {
+  if (this->ptr) {
+    local_thread_data().leave_region();
+  }
+  this->ptr.reset();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void hyaline<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept {
+  this->ptr->set_deleter(std::move(d));
+  local_thread_data().add_retired_node(this->ptr.get());
+  reset();
+}
+
+template <class Traits>
+inline typename hyaline<Traits>::thread_data& hyaline<Traits>::local_thread_data() {
+  // workaround for a Clang-8 issue that causes multiple re-initializations of thread_local variables
+  static thread_local thread_data local_thread_data;
+  return local_thread_data;
+}
+
+#ifdef TRACK_ALLOCATIONS
+template <class Traits>
+inline void hyaline<Traits>::count_allocation() {
+  local_thread_data().allocation_counter.count_allocation();
+}
+
+template <class Traits>
+inline void hyaline<Traits>::count_reclamation() {
+  local_thread_data().allocation_counter.count_reclamation();
+}
+#endif
+} // namespace xenium::reclamation
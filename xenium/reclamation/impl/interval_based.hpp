@@ -0,0 +1,370 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef INTERVAL_BASED_IMPL
+  #error "This is an impl file and must not be included directly!"
+#endif
+
+#include <xenium/aligned_object.hpp>
+#include <xenium/detail/port.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium::reclamation {
+
+template <class Traits>
+struct alignas(64) interval_based<Traits>::thread_control_block :
+    detail::thread_block_list<thread_control_block, detail::deletable_object_with_eras>::entry,
+    aligned_object<thread_control_block> {
+  // The interval of eras that is reserved by the thread. An upper era of zero signals that the
+  // thread is currently not inside a critical region; since the era_clock starts at one, every
+  // node has a construction_era greater than zero, so such a reservation cannot protect any node.
+  std::atomic<era_t> lower_era{0};
+  std::atomic<era_t> upper_era{0};
+};
+
+template <class Traits>
+struct alignas(64) interval_based<Traits>::thread_data : aligned_object<thread_data> {
+  ~thread_data() {
+    assert(region_entries == 0);
+    if (!retire_list.empty()) {
+      scan();
+      if (!retire_list.empty()) {
+        global_thread_block_list.abandon_retired_nodes(retire_list.steal());
+      }
+    }
+
+    if (control_block != nullptr) {
+      global_thread_block_list.release_entry(control_block);
+      control_block = nullptr;
+    }
+  }
+
+  void enter_region() {
+    if (++region_entries == 1) {
+      ensure_has_control_block();
+      upper_era = era_clock.load(std::memory_order_relaxed);
+      // (1) - these release-stores synchronize-with the acquire-fence (8)
+      control_block->lower_era.store(upper_era, std::memory_order_release);
+      control_block->upper_era.store(upper_era, std::memory_order_release);
+
+      // (2) - this seq_cst-fence enforces a total order with the seq_cst-fence (7)
+      XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+    }
+  }
+
+  void leave_region() {
+    assert(region_entries > 0);
+    if (--region_entries == 0) {
+      // (3) - this release-store synchronizes-with the acquire-fence (8)
+      control_block->upper_era.store(0, std::memory_order_release);
+    }
+  }
+
+  // Extends the upper bound of our reservation to the given era. Returns false if the
+  // reservation already covered the era, i.e., if the reservation did not change.
+  bool extend_reservation(era_t era) {
+    assert(region_entries > 0);
+    assert(era >= upper_era);
+    if (era == upper_era) {
+      return false;
+    }
+
+    upper_era = era;
+    // (4) - this release-store synchronizes-with the acquire-fence (8)
+    control_block->upper_era.store(era, std::memory_order_release);
+
+    // (5) - this seq_cst-fence enforces a total order with the seq_cst-fence (7)
+    //       and synchronizes-with the release-fetch-add (6)
+    XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+    return true;
+  }
+
+  [[nodiscard]] bool exceeds_threshold() const { return retire_list.exceeds_threshold(Traits::scan_threshold); }
+
+  void scan() {
+    // (7) - this seq_cst-fence enforces a total order with the seq_cst-fences (2, 5)
+    XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+
+    auto adopted_nodes = global_thread_block_list.adopt_abandoned_retired_nodes();
+
+    // The vector is kept between scans, so we only allocate when the number of threads grows.
+    reservations.clear();
+    std::for_each(
+      global_thread_block_list.begin(), global_thread_block_list.end(), [this](const thread_control_block& entry) {
+        // TSan does not support explicit fences, so we cannot rely on the acquire-fence (8)
+        // but have to perform acquire-loads here to avoid false positives.
+        constexpr auto memory_order = TSAN_MEMORY_ORDER(std::memory_order_acquire, std::memory_order_relaxed);
+        if (!entry.is_active(memory_order)) {
+          return;
+        }
+        auto lower = entry.lower_era.load(memory_order);
+        auto upper = entry.upper_era.load(memory_order);
+        if (upper != 0) {
+          reservations.push_back({lower, upper});
+        }
+      });
+
+    // (8) - this acquire-fence synchronizes-with the release-stores (1, 3, 4)
+    XENIUM_THREAD_FENCE(std::memory_order_acquire);
+
+    reclaim_nodes(retire_list.steal());
+    reclaim_nodes(adopted_nodes);
+  }
+
+private:
+  struct reservation {
+    era_t lower;
+    era_t upper;
+  };
+
+  void ensure_has_control_block() {
+    if (control_block == nullptr) {
+      control_block = global_thread_block_list.acquire_entry();
+    }
+  }
+
+  void reclaim_nodes(detail::deletable_object_with_eras* list) {
+    while (list != nullptr) {
+      auto* cur = list;
+      list = list->next;
+
+      // A node is protected by a reservation if its lifetime [construction_era, retirement_era]
+      // intersects with the reserved interval.
+      bool is_protected = std::any_of(reservations.begin(), reservations.end(), [cur](const reservation& r) {
+        return r.lower <= cur->retirement_era && cur->construction_era <= r.upper;
+      });
+      if (is_protected) {
+        retire_list.push(cur);
+      } else {
+        cur->delete_self();
+      }
+    }
+  }
+
+  unsigned region_entries = 0;
+  era_t upper_era = 0;
+  detail::threshold_retire_list<detail::deletable_object_with_eras, Traits::retired_bytes_threshold> retire_list;
+  std::vector<reservation> reservations;
+
+  thread_control_block* control_block = nullptr;
+
+  friend class interval_based;
+  ALLOCATION_COUNTER(interval_based);
+};
+
+template <class Traits>
+interval_based<Traits>::region_guard::region_guard() noexcept {
+  local_thread_data().enter_region();
+}
+
+template <class Traits>
+interval_based<Traits>::region_guard::~region_guard() noexcept {
+  local_thread_data().leave_region();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+interval_based<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept : base(p) {
+  if (this->ptr) {
+    auto& data = local_thread_data();
+    data.enter_region();
+    data.extend_reservation(era_clock.load(std::memory_order_relaxed));
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+interval_based<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept : base(p.ptr) {
+  if (this->ptr) {
+    local_thread_data().enter_region();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+interval_based<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept : base(p.ptr) {
+  p.ptr.reset();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto interval_based<Traits>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = p.ptr;
+  if (this->ptr) {
+    local_thread_data().enter_region();
+  }
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto interval_based<Traits>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = std::move(p.ptr);
+  p.ptr.reset();
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void interval_based<Traits>::guard_ptr<T, MarkedPtr>::acquire(const concurrent_ptr<T>& p,
+                                                              std::memory_order order) noexcept {
+  if (p.load(std::memory_order_relaxed) == nullptr) {
+    reset();
+    return;
+  }
+
+  if (order == std::memory_order_relaxed || order == std::memory_order_consume) {
+    // we have to use memory_order_acquire (or something stricter) to ensure that
+    // the era_clock.load cannot return an outdated value.
+    order = std::memory_order_acquire;
+  }
+
+  auto& data = local_thread_data();
+  if (!this->ptr) {
+    data.enter_region();
+  }
+
+  for (;;) {
+    // (9) - this load operation synchronizes-with any release operation on p.
+    // we have to use acquire here to ensure that the subsequent era_clock.load
+    // sees a value >= p.construction_era
+    auto value = p.load(order);
+    auto era = era_clock.load(std::memory_order_relaxed);
+    if (!data.extend_reservation(era)) {
+      this->ptr = value;
+      break;
+    }
+  }
+
+  if (!this->ptr) {
+    data.leave_region();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+bool interval_based<Traits>::guard_ptr<T, MarkedPtr>::acquire_if_equal(const concurrent_ptr<T>& p,
+                                                                       const MarkedPtr& expected,
+                                                                       std::memory_order order) noexcept {
+  if (order == std::memory_order_relaxed || order == std::memory_order_consume) {
+    // we have to use memory_order_acquire (or something stricter) to ensure that
+    // the era_clock.load cannot return an outdated value.
+    order = std::memory_order_acquire;
+  }
+
+  // (10) - this load operation synchronizes-with any release operation on p.
+  // we have to use acquire here to ensure that the subsequent era_clock.load
+  // sees a value >= p.construction_era
+  auto p1 = p.load(order);
+  if (p1 == nullptr || p1 != expected) {
+    reset();
+    return p1 == expected;
+  }
+
+  auto& data = local_thread_data();
+  if (!this->ptr) {
+    data.enter_region();
+  }
+  data.extend_reservation(era_clock.load(std::memory_order_relaxed));
+
+  this->ptr = p.load(std::memory_order_relaxed);
+  if (!this->ptr || this->ptr != p1) {
+    data.leave_region();
+    this->ptr.reset();
+    return false;
+  }
+  return true;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void interval_based<Traits>::guard_ptr<T, MarkedPtr>::reset() noexcept {
+  if (this->ptr) {
+    local_thread_data().leave_region();
+  }
+  this->ptr.reset();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void interval_based<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  // (6) - this release fetch-add synchronizes-with the seq-cst fence (5)
+  p->retirement_era = era_clock.fetch_add(1, std::memory_order_release);
+
+  auto& data = local_thread_data();
+  data.retire_list.push(p, detail::retired_size<count_retired_bytes>(*p));
+  if (data.exceeds_threshold()) {
+    data.scan();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void interval_based<Traits>::guard_ptr<T, MarkedPtr>::reclaim(retire_batch& batch, Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  // The node's lifetime ends here, even though it only gets added to our retire list
+  // once the batch is destroyed.
+  // this release fetch-add synchronizes-with the seq-cst fence (5) (see (6))
+  p->retirement_era = era_clock.fetch_add(1, std::memory_order_release);
+  batch.nodes.push(p, detail::retired_size<count_retired_bytes>(*p));
+}
+
+template <class Traits>
+void interval_based<Traits>::add_retired_nodes(
+  detail::node_batch<detail::deletable_object_with_eras>& nodes) noexcept {
+  auto& data = local_thread_data();
+  data.retire_list.splice(nodes);
+  if (data.exceeds_threshold()) {
+    data.scan();
+  }
+}
+
+template <class Traits>
+inline typename interval_based<Traits>::thread_data& interval_based<Traits>::local_thread_data() {
+  // workaround for a Clang-8 issue that causes multiple re-initializations of thread_local variables
+  static thread_local thread_data local_thread_data;
+  return local_thread_data;
+}
+
+#ifdef TRACK_ALLOCATIONS
+template <class Traits>
+inline void interval_based<Traits>::count_allocation() {
+  local_thread_data().allocation_counter.count_allocation();
+}
+
+template <class Traits>
+inline void interval_based<Traits>::count_reclamation() {
+  local_thread_data().allocation_counter.count_reclamation();
+}
+#endif
+} // namespace xenium::reclamation
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
@@ -0,0 +1,610 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef NBR_IMPL
+  #error "This is an impl file and must not be included directly!"
+#endif
+
+#include <xenium/aligned_object.hpp>
+#include <xenium/detail/port.hpp>
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium::reclamation {
+
+namespace detail {
+  // The ping state of a thread for one signal. A single signal handler per signal serves all
+  // nbr instantiations that use this signal, so the ping state is shared by all of them. Entries
+  // are never freed, so a thread that sends a ping can safely access an entry even if its owner
+  // has terminated.
+  struct alignas(64) nbr_ping_state :
+      thread_block_list<nbr_ping_state>::entry,
+      aligned_object<nbr_ping_state> {
+    std::atomic<std::uint64_t> requested{0};
+    std::atomic<std::uint64_t> acknowledged{0};
+    // The number of threads that are currently sending a signal to the owner. A terminating
+    // thread sets detached and waits until there are no more senders, so that pthread_kill is
+    // never called for a thread that no longer exists.
+    std::atomic<unsigned> senders{0};
+    std::atomic<bool> detached{false};
+    pthread_t thread{};
+  };
+
+  // Every signal has its own handler and its own thread-local ping state, so different nbr
+  // instantiations can use different signals in the same thread.
+  template <int Signal>
+  class nbr_ping {
+  public:
+    static nbr_ping_state& register_thread() {
+      static const bool installed = [] {
+        struct sigaction action {};
+        action.sa_handler = &handle_signal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        [[maybe_unused]] auto result = sigaction(Signal, &action, nullptr);
+        assert(result == 0 && "failed to install the signal handler");
+        return true;
+      }();
+      (void)installed;
+
+      static thread_local registration local_registration;
+      return *local_registration.state;
+    }
+
+    // Sends a ping to the owner of the given state. Returns the ticket that has to be
+    // acknowledged by the owner, or zero if the owner is terminating.
+    static std::uint64_t send(nbr_ping_state& state) {
+      state.senders.fetch_add(1, std::memory_order_seq_cst);
+      if (state.detached.load(std::memory_order_seq_cst)) {
+        state.senders.fetch_sub(1, std::memory_order_release);
+        return 0;
+      }
+
+      // (1) - this release-FAA synchronizes-with the acquire-load (2)
+      auto ticket = state.requested.fetch_add(1, std::memory_order_release) + 1;
+      [[maybe_unused]] auto result = pthread_kill(state.thread, Signal);
+      assert(result == 0);
+      state.senders.fetch_sub(1, std::memory_order_release);
+      return ticket;
+    }
+
+    static bool is_acknowledged(const nbr_ping_state& state, std::uint64_t ticket) {
+      // (3) - this acquire-load synchronizes-with the release-store (4)
+      return state.acknowledged.load(std::memory_order_acquire) >= ticket;
+    }
+
+  private:
+    struct registration {
+      registration() : state(states.acquire_entry()) {
+        state->thread = pthread_self();
+        state->detached.store(false, std::memory_order_seq_cst);
+        current = state;
+      }
+
+      ~registration() {
+        // This is a Dekker-style handshake with send: a sender increments senders and then
+        // checks detached, while we set detached and then check senders. Both sides use
+        // seq_cst, so at least one of them observes the other's write - either the sender
+        // sees that we are detached, or we see (and wait for) the sender.
+        state->detached.store(true, std::memory_order_seq_cst);
+        while (state->senders.load(std::memory_order_seq_cst) != 0) {
+          std::this_thread::yield();
+        }
+        current = nullptr;
+        states.release_entry(state);
+      }
+
+      nbr_ping_state* state;
+    };
+
+    static void handle_signal(int /*signal*/) {
+      auto saved_errno = errno;
+      if (auto* state = current; state != nullptr) {
+        // (2) - this acquire-load synchronizes-with the release-FAA (1)
+        auto requested = state->requested.load(std::memory_order_acquire);
+        // (4) - this release-store synchronizes-with the acquire-load (3)
+        state->acknowledged.store(requested, std::memory_order_release);
+      }
+      errno = saved_errno;
+    }
+
+    inline static thread_block_list<nbr_ping_state> states{};
+    inline static thread_local nbr_ping_state* current = nullptr;
+  };
+} // namespace detail
+
+template <class Traits>
+struct nbr<Traits>::reservation {
+  std::atomic<const detail::deletable_object*> object{nullptr};
+  reservation* next_free = nullptr;
+};
+
+template <class Traits>
+struct nbr<Traits>::reservation_block : aligned_object<reservation_block> {
+  static constexpr std::size_t size = 32;
+  std::array<reservation, size> reservations;
+  reservation_block* next = nullptr;
+};
+
+template <class Traits>
+struct alignas(64) nbr<Traits>::thread_control_block :
+    detail::thread_block_list<thread_control_block>::entry,
+    aligned_object<thread_control_block> {
+  // An odd value signals that the thread is currently inside a critical region.
+  std::atomic<unsigned> region_state{0};
+  std::atomic<detail::nbr_ping_state*> ping_state{nullptr};
+  // Reservation blocks are only ever added, so they remain with the control block
+  // and get reused by the next thread that acquires it.
+  std::atomic<reservation_block*> reservation_blocks{nullptr};
+};
+
+template <class Traits>
+struct alignas(64) nbr<Traits>::thread_data : aligned_object<thread_data> {
+  // Registering the thread here ensures that the thread's ping state outlives this object.
+  thread_data() : ping_state(ping::register_thread()) {}
+
+  ~thread_data() {
+    assert(region_entries == 0);
+    if (!retire_list.empty() || deferred_list != nullptr) {
+      scan();
+      if (deferred_list != nullptr) {
+        global_thread_block_list.abandon_retired_nodes(deferred_list);
+        deferred_list = nullptr;
+      }
+      if (!retire_list.empty()) {
+        global_thread_block_list.abandon_retired_nodes(retire_list.steal());
+      }
+    }
+
+    if (control_block != nullptr) {
+      global_thread_block_list.release_entry(control_block);
+      control_block = nullptr;
+    }
+  }
+
+  void enter_region() {
+    if (++region_entries == 1) {
+      ensure_has_control_block();
+      auto state = control_block->region_state.load(std::memory_order_relaxed);
+      control_block->region_state.store(state + 1, std::memory_order_relaxed);
+      // (5) - this seq_cst-fence enforces a total order with the seq_cst-fence (7)
+      XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+    }
+  }
+
+  void leave_region() {
+    assert(region_entries > 0);
+    if (--region_entries == 0) {
+      auto state = control_block->region_state.load(std::memory_order_relaxed);
+      // (6) - this release-store synchronizes-with the acquire-loads (8, 9)
+      control_block->region_state.store(state + 1, std::memory_order_release);
+    }
+  }
+
+  reservation* alloc_reservation() {
+    assert(region_entries > 0);
+    if (free_reservations == nullptr) {
+      add_reservation_block();
+    }
+    auto* result = free_reservations;
+    free_reservations = result->next_free;
+    return result;
+  }
+
+  void release_reservation(reservation* r) {
+    // this release-store ensures that all our accesses to the object happen-before
+    // the object gets reclaimed by a thread that sees the cleared reservation.
+    r->object.store(nullptr, std::memory_order_release);
+    r->next_free = free_reservations;
+    free_reservations = r;
+  }
+
+  [[nodiscard]] bool exceeds_threshold() const { return retire_list.exceeds_threshold(Traits::scan_threshold); }
+
+  // Reclamation happens in rounds. A round takes all nodes retired so far, pings the threads
+  // that are currently inside a critical region, and reclaims the nodes once every pinged thread
+  // has either acknowledged the ping or left its critical region. We never wait for a pinged
+  // thread; if some thread has not reacted yet, its nodes are kept and we retry on the next scan.
+  void scan() {
+    if (deferred_list != nullptr && !try_reclaim_deferred_nodes()) {
+      return;
+    }
+
+    deferred_list = retire_list.steal();
+    auto* adopted_nodes = global_thread_block_list.adopt_abandoned_retired_nodes();
+    if (adopted_nodes != nullptr) {
+      auto* last = adopted_nodes;
+      while (last->next != nullptr) {
+        last = last->next;
+      }
+      last->next = deferred_list;
+      deferred_list = adopted_nodes;
+    }
+    if (deferred_list == nullptr) {
+      return;
+    }
+
+    // (7) - this seq_cst-fence enforces a total order with the seq_cst-fence (5)
+    XENIUM_THREAD_FENCE(std::memory_order_seq_cst);
+
+    ping_threads();
+    try_reclaim_deferred_nodes();
+  }
+
+private:
+  struct pending_ping {
+    const thread_control_block* entry;
+    detail::nbr_ping_state* state;
+    unsigned region_state;
+    std::uint64_t ticket;
+  };
+
+  using ping = detail::nbr_ping<Traits::ping_signal>;
+
+  // Reclaims the nodes of the current round, unless some pinged thread has neither acknowledged
+  // its ping nor left its critical region yet.
+  bool try_reclaim_deferred_nodes() {
+    auto it = std::remove_if(pending_pings.begin(), pending_pings.end(), [](const pending_ping& p) {
+      // (9) - this acquire-load synchronizes-with the release-store (6)
+      return ping::is_acknowledged(*p.state, p.ticket) ||
+             p.entry->region_state.load(std::memory_order_acquire) != p.region_state;
+    });
+    pending_pings.erase(it, pending_pings.end());
+    if (!pending_pings.empty()) {
+      return false;
+    }
+
+    // The buffer is reused across scans, so we only have to allocate if the number of
+    // reservations has grown since the last scan.
+    protected_pointers.clear();
+    std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(), [this](const auto& entry) {
+      // TSan does not support explicit fences, so we cannot rely on the acquire-fence (10)
+      // but have to perform acquire-loads here to avoid false positives.
+      constexpr auto memory_order = TSAN_MEMORY_ORDER(std::memory_order_acquire, std::memory_order_relaxed);
+      if (!entry.is_active(memory_order)) {
+        return;
+      }
+      for (auto* block = entry.reservation_blocks.load(std::memory_order_acquire); block != nullptr;
+           block = block->next) {
+        for (auto& r : block->reservations) {
+          if (auto* obj = r.object.load(memory_order); obj != nullptr) {
+            protected_pointers.push_back(obj);
+          }
+        }
+      }
+    });
+
+    // (10) - this acquire-fence synchronizes-with the release-stores in release_reservation
+    XENIUM_THREAD_FENCE(std::memory_order_acquire);
+
+    std::sort(protected_pointers.begin(), protected_pointers.end(), std::less<>{});
+
+    auto* list = deferred_list;
+    deferred_list = nullptr;
+    reclaim_nodes(list);
+    return true;
+  }
+
+  void ensure_has_control_block() {
+    if (control_block != nullptr) {
+      return;
+    }
+
+    // The entry may have been used by another thread before, so we have to publish our ping state
+    // before the entry becomes active. Otherwise a reclaiming thread could see the entry as active
+    // but ping the previous owner.
+    control_block = global_thread_block_list.acquire_inactive_entry();
+    control_block->ping_state.store(&ping_state, std::memory_order_relaxed);
+    control_block->activate();
+    // The previous owner has released all its reservations, so we can reuse all of them.
+    for (auto* block = control_block->reservation_blocks.load(std::memory_order_relaxed); block != nullptr;
+         block = block->next) {
+      add_to_free_reservations(block);
+    }
+  }
+
+  void add_reservation_block() {
+    auto* block = new reservation_block();
+    block->next = control_block->reservation_blocks.load(std::memory_order_relaxed);
+    add_to_free_reservations(block);
+    control_block->reservation_blocks.store(block, std::memory_order_release);
+  }
+
+  void add_to_free_reservations(reservation_block* block) {
+    for (auto& r : block->reservations) {
+      r.next_free = free_reservations;
+      free_reservations = &r;
+    }
+  }
+
+  // Pings all other threads that are currently inside a critical region. The signal handler
+  // of an acknowledged ping has made all reservations of the thread visible to us, and a
+  // thread that (re-)enters a critical region after the fence (7) will see all nodes that
+  // we have removed before.
+  void ping_threads() {
+    assert(pending_pings.empty());
+    std::for_each(global_thread_block_list.begin(), global_thread_block_list.end(), [this](auto& entry) {
+      // this acquire-load synchronizes-with the release-store in activate, so we see the
+      // ping state of the current owner of the entry.
+      if (&entry == control_block || !entry.is_active(std::memory_order_acquire)) {
+        return;
+      }
+      // (8) - this acquire-load synchronizes-with the release-store (6)
+      auto state = entry.region_state.load(std::memory_order_acquire);
+      if ((state & 1) == 0) {
+        return;
+      }
+      auto* ps = entry.ping_state.load(std::memory_order_relaxed);
+      if (auto ticket = ping::send(*ps); ticket != 0) {
+        pending_pings.push_back({&entry, ps, state, ticket});
+      }
+    });
+  }
+
+  // Branch-free binary search in the sorted protected pointers (see hazard_pointer).
+  [[nodiscard]] bool is_protected(const detail::deletable_object* p) const {
+    std::size_t n = protected_pointers.size();
+    if (n == 0) {
+      return false;
+    }
+    const auto* base = protected_pointers.data();
+    while (n > 1) {
+      auto half = n / 2;
+      base = std::less<>{}(p, base[half]) ? base : base + half;
+      n -= half;
+    }
+    return *base == p;
+  }
+
+  void reclaim_nodes(detail::deletable_object* list) {
+    while (list != nullptr) {
+      auto* cur = list;
+      list = list->next;
+      if (is_protected(cur)) {
+        retire_list.push(cur);
+      } else {
+        cur->delete_self();
+      }
+    }
+  }
+
+  detail::nbr_ping_state& ping_state;
+  unsigned region_entries = 0;
+  reservation* free_reservations = nullptr;
+  detail::threshold_retire_list<detail::deletable_object, Traits::retired_bytes_threshold> retire_list;
+  // the nodes of the current reclamation round; they wait for the outstanding pending_pings
+  detail::deletable_object* deferred_list = nullptr;
+
+  // reused by all scans of this thread to avoid allocations
+  std::vector<const detail::deletable_object*> protected_pointers;
+  std::vector<pending_ping> pending_pings;
+
+  thread_control_block* control_block = nullptr;
+
+  friend class nbr;
+  ALLOCATION_COUNTER(nbr);
+};
+
+template <class Traits>
+nbr<Traits>::region_guard::region_guard() noexcept {
+  local_thread_data().enter_region();
+}
+
+template <class Traits>
+nbr<Traits>::region_guard::~region_guard() noexcept {
+  local_thread_data().leave_region();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+nbr<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const MarkedPtr& p) noexcept : base(p) {
+  if (this->ptr) {
+    auto& data = local_thread_data();
+    data.enter_region();
+    res = data.alloc_reservation();
+    res->object.store(this->ptr.get(), std::memory_order_relaxed);
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+nbr<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(const guard_ptr& p) noexcept : guard_ptr(MarkedPtr(p)) {}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+nbr<Traits>::guard_ptr<T, MarkedPtr>::guard_ptr(guard_ptr&& p) noexcept : base(p.ptr), res(p.res) {
+  p.ptr.reset();
+  p.res = nullptr;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto nbr<Traits>::guard_ptr<T, MarkedPtr>::operator=(const guard_ptr& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = p.ptr;
+  if (this->ptr) {
+    auto& data = local_thread_data();
+    data.enter_region();
+    res = data.alloc_reservation();
+    res->object.store(this->ptr.get(), std::memory_order_relaxed);
+  }
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+auto nbr<Traits>::guard_ptr<T, MarkedPtr>::operator=(guard_ptr&& p) noexcept -> guard_ptr& {
+  if (&p == this) {
+    return *this;
+  }
+
+  reset();
+  this->ptr = std::move(p.ptr);
+  res = p.res;
+  p.ptr.reset();
+  p.res = nullptr;
+
+  return *this;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void nbr<Traits>::guard_ptr<T, MarkedPtr>::acquire(const concurrent_ptr<T>& p, std::memory_order order) noexcept {
+  auto value = p.load(std::memory_order_relaxed);
+  if (value == nullptr) {
+    reset();
+    return;
+  }
+
+  auto& data = local_thread_data();
+  if (res == nullptr) {
+    data.enter_region();
+    res = data.alloc_reservation();
+  }
+
+  for (;;) {
+    // The reservation might still protect a node we have accessed before, so this has to be a
+    // release-store for the same reason as the one in release_reservation.
+    res->object.store(value.get(), std::memory_order_release);
+    // (11) - this signal-fence ensures that the reservation is stored before p is reloaded.
+    // The reservation becomes visible to other threads when the signal handler acknowledges
+    // a ping, and every ping that is handled after this point ensures that the reload sees
+    // all changes that were made before the ping was sent.
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    // (12) - this load operation potentially synchronizes-with any release operation on p.
+    auto reloaded = p.load(order);
+    if (reloaded.get() == value.get()) {
+      this->ptr = reloaded;
+      break;
+    }
+    value = reloaded;
+  }
+
+  if (this->ptr.get() == nullptr) {
+    data.release_reservation(res);
+    res = nullptr;
+    data.leave_region();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+bool nbr<Traits>::guard_ptr<T, MarkedPtr>::acquire_if_equal(const concurrent_ptr<T>& p,
+                                                            const MarkedPtr& expected,
+                                                            std::memory_order order) noexcept {
+  auto actual = p.load(std::memory_order_relaxed);
+  if (actual == nullptr || actual != expected) {
+    reset();
+    return actual == expected;
+  }
+
+  if (res == nullptr) {
+    auto& data = local_thread_data();
+    data.enter_region();
+    res = data.alloc_reservation();
+  }
+  // this release-store replaces a reservation we might have used before (see acquire)
+  res->object.store(actual.get(), std::memory_order_release);
+  // (13) - this signal-fence ensures that the reservation is stored before p is reloaded (see (11)).
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  // (14) - this load operation potentially synchronizes-with any release operation on p.
+  this->ptr = p.load(order);
+  if (this->ptr != actual) {
+    reset();
+    return false;
+  }
+  return true;
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void nbr<Traits>::guard_ptr<T, MarkedPtr>::reset() noexcept {
+  if (res != nullptr) {
+    auto& data = local_thread_data();
+    data.release_reservation(res);
+    res = nullptr;
+    data.leave_region();
+  }
+  this->ptr.reset();
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void nbr<Traits>::guard_ptr<T, MarkedPtr>::do_swap(guard_ptr& g) noexcept {
+  std::swap(res, g.res);
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void nbr<Traits>::guard_ptr<T, MarkedPtr>::reclaim(Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  auto& data = local_thread_data();
+  data.retire_list.push(p, detail::retired_size<count_retired_bytes>(*p));
+  if (data.exceeds_threshold()) {
+    data.scan();
+  }
+}
+
+template <class Traits>
+template <class T, class MarkedPtr>
+void nbr<Traits>::guard_ptr<T, MarkedPtr>::reclaim(retire_batch& batch, Deleter d) noexcept {
+  auto* p = this->ptr.get();
+  reset();
+  p->set_deleter(std::move(d));
+  batch.nodes.push(p, detail::retired_size<count_retired_bytes>(*p));
+}
+
+template <class Traits>
+void nbr<Traits>::add_retired_nodes(detail::node_batch<>& nodes) noexcept {
+  auto& data = local_thread_data();
+  data.retire_list.splice(nodes);
+  if (data.exceeds_threshold()) {
+    data.scan();
+  }
+}
+
+template <class Traits>
+inline typename nbr<Traits>::thread_data& nbr<Traits>::local_thread_data() {
+  // workaround for a Clang-8 issue that causes multiple re-initializations of thread_local variables
+  static thread_local thread_data local_thread_data;
+  return local_thread_data;
+}
+
+#ifdef TRACK_ALLOCATIONS
+template <class Traits>
+inline void nbr<Traits>::count_allocation() {
+  local_thread_data().allocation_counter.count_allocation();
+}
+
+template <class Traits>
+inline void nbr<Traits>::count_reclamation() {
+  local_thread_data().allocation_counter.count_reclamation();
+}
+#endif
+} // namespace xenium::reclamation
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_INTERVAL_BASED_HPP
+#define XENIUM_INTERVAL_BASED_HPP
+
+#include <xenium/reclamation/detail/allocation_tracker.hpp>
+#include <xenium/reclamation/detail/concurrent_ptr.hpp>
+#include <xenium/reclamation/detail/deletable_object.hpp>
+#include <xenium/reclamation/detail/guard_ptr.hpp>
+#include <xenium/reclamation/detail/retire_list.hpp>
+#include <xenium/reclamation/detail/thread_block_list.hpp>
+#include <xenium/reclamation/hazard_eras.hpp>
+
+#include <xenium/acquire_guard.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+
+#include <memory>
+
+namespace xenium {
+namespace reclamation {
+  template <std::size_t ScanThreshold = 100, std::size_t RetiredBytesThreshold = 0>
+  struct interval_based_traits {
+    static constexpr std::size_t scan_threshold = ScanThreshold;
+    static constexpr std::size_t retired_bytes_threshold = RetiredBytesThreshold;
+
+    template <class... Policies>
+    using with = interval_based_traits<
+      parameter::value_param_t<std::size_t, policy::scan_threshold, ScanThreshold, Policies...>::value,
+      parameter::
+        value_param_t<std::size_t, policy::retired_bytes_threshold, RetiredBytesThreshold, Policies...>::value>;
+  };
+
+  /**
+   * @brief An implementation of the two-global-epoch variant of interval-based reclamation
+   * (2GE-IBR) as proposed by Wen et al. \[[WIC+18](index.html#ref-wen-2018)\].
+   *
+   * For general information about the interface of the reclamation scheme see @ref reclamation_schemes.
+   *
+   * Like `hazard_eras`, every node stores the era in which it was created and the era in
+   * which it was retired; this is the same node header that `hazard_eras` uses. But instead of
+   * reserving one era per `guard_ptr`, every thread reserves a single interval of eras
+   * `[lower, upper]`. The lower bound is the era in which the thread entered its critical
+   * region; the upper bound is extended whenever a `guard_ptr` acquires a node while the global
+   * era has advanced. A retired node can be reclaimed once its lifetime interval does not
+   * intersect the reserved interval of any thread.
+   *
+   * Since the state per thread is constant, a thread can protect an unbounded number of nodes
+   * without the need to allocate additional slots, which makes this scheme a good fit for long
+   * traversals. On the other hand, a thread that stays inside its critical region for a long
+   * time prevents reclamation of all nodes that were created before its upper bound and retired
+   * after its lower bound.
+   *
+   * This class does not take a list of policies, but a `Traits` type that can be customized
+   * with a list of policies. The following policies are supported:
+   *  * `xenium::policy::scan_threshold`<br>
+   *    Defines the number of retired nodes a thread collects before it scans the reservations
+   *    of all other threads and reclaims the nodes that are no longer protected. (defaults to 100)
+   *  * `xenium::policy::retired_bytes_threshold`<br>
+   *    Defines the size of the retired nodes at which a thread scans, even if it has not yet
+   *    collected `scan_threshold` nodes. (defaults to zero, i.e., disabled)
+   *
+   * @tparam Traits
+   */
+  template <class Traits = interval_based_traits<>>
+  class interval_based {
+    template <class T, class MarkedPtr>
+    class guard_ptr;
+
+  public:
+    /**
+     * @brief Customize the reclamation scheme with the given policies.
+     *
+     * The given policies are applied to the current configuration, replacing previously
+     * specified policies of the same type.
+     *
+     * The resulting type is the newly configured reclamation scheme.
+     *
+     * @tparam Policies list of policies to customize the behaviour
+     */
+    template <class... Policies>
+    using with = interval_based<typename Traits::template with<Policies...>>;
+
+    template <class T, std::size_t N = 0, class Deleter = std::default_delete<T>>
+    class enable_concurrent_ptr;
+
+    struct region_guard {
+      region_guard() noexcept;
+      ~region_guard() noexcept;
+
+      region_guard(const region_guard&) = delete;
+      region_guard(region_guard&&) = delete;
+      region_guard& operator=(const region_guard&) = delete;
+      region_guard& operator=(region_guard&&) = delete;
+    };
+
+    // Collects nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires them
+    // all at once upon destruction.
+    using retire_batch = detail::retire_batch<interval_based, detail::deletable_object_with_eras>;
+
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    using concurrent_ptr = detail::concurrent_ptr<T, N, guard_ptr>;
+
+    ALLOCATION_TRACKER;
+
+  private:
+    static_assert(Traits::scan_threshold > 0, "scan_threshold must be greater than zero");
+
+    static constexpr bool count_retired_bytes = Traits::retired_bytes_threshold != 0;
+
+    struct thread_control_block;
+    struct thread_data;
+
+    friend retire_batch;
+    static void add_retired_nodes(detail::node_batch<detail::deletable_object_with_eras>& nodes) noexcept;
+
+    using era_t = uint64_t;
+    inline static std::atomic<era_t> era_clock{1};
+    inline static detail::thread_block_list<thread_control_block, detail::deletable_object_with_eras>
+      global_thread_block_list{};
+    static thread_data& local_thread_data();
+
+    ALLOCATION_TRACKING_FUNCTIONS;
+  };
+
+  template <class Traits>
+  template <class T, std::size_t N, class Deleter>
+  class interval_based<Traits>::enable_concurrent_ptr :
+      public detail::deletable_object_impl<T, Deleter, detail::deletable_object_with_eras>,
+      private detail::tracked_object<interval_based> {
+  public:
+    static constexpr std::size_t number_of_mark_bits = N;
+
+  protected:
+    enable_concurrent_ptr() noexcept { this->construction_era = era_clock.load(std::memory_order_relaxed); }
+    enable_concurrent_ptr(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr(enable_concurrent_ptr&&) noexcept = default;
+    enable_concurrent_ptr& operator=(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr& operator=(enable_concurrent_ptr&&) noexcept = default;
+    ~enable_concurrent_ptr() noexcept override = default;
+
+  private:
+    friend detail::deletable_object_impl<T, Deleter>;
+
+    template <class, class>
+    friend class guard_ptr;
+  };
+
+  template <class Traits>
+  template <class T, class MarkedPtr>
+  class interval_based<Traits>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>> {
+    using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
+    using Deleter = typename T::Deleter;
+
+  public:
+    // Guard a marked ptr.
+    explicit guard_ptr(const MarkedPtr& p = MarkedPtr()) noexcept;
+    guard_ptr(const guard_ptr& p) noexcept;
+    guard_ptr(guard_ptr&& p) noexcept;
+
+    guard_ptr& operator=(const guard_ptr& p) noexcept;
+    guard_ptr& operator=(guard_ptr&& p) noexcept;
+
+    // Atomically take snapshot of p, and *if* it points to unreclaimed object, acquire shared ownership of it.
+    void acquire(const concurrent_ptr<T>& p, std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Like acquire, but quit early if a snapshot != expected.
+    bool acquire_if_equal(const concurrent_ptr<T>& p,
+                          const MarkedPtr& expected,
+                          std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Release ownership. Postcondition: get() == nullptr.
+    void reset() noexcept;
+
+    // Reset. Deleter d will be applied some time after all owners release their ownership.
+    void reclaim(Deleter d = Deleter()) noexcept;
+
+    // Like reclaim, but the node is only added to the retire list once the batch is destroyed.
+    void reclaim(retire_batch& batch, Deleter d = Deleter()) noexcept;
+  };
+} // namespace reclamation
+} // namespace xenium
+
+#define INTERVAL_BASED_IMPL
+#include <xenium/reclamation/impl/interval_based.hpp>
+#undef INTERVAL_BASED_IMPL
+
+#endif
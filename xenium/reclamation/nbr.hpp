@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_NBR_HPP
+#define XENIUM_NBR_HPP
+
+#ifndef __linux__
+  #error "nbr is only supported on Linux"
+#endif
+
+#include <xenium/acquire_guard.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/reclamation/detail/allocation_tracker.hpp>
+#include <xenium/reclamation/detail/concurrent_ptr.hpp>
+#include <xenium/reclamation/detail/deletable_object.hpp>
+#include <xenium/reclamation/detail/guard_ptr.hpp>
+#include <xenium/reclamation/detail/retire_list.hpp>
+#include <xenium/reclamation/detail/thread_block_list.hpp>
+
+#include <csignal>
+#include <memory>
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure the POSIX signal `nbr` uses to ping other threads.
+   *
+   * @tparam Value
+   */
+  template <int Value>
+  struct ping_signal;
+} // namespace policy
+
+namespace reclamation {
+  template <std::size_t ScanThreshold = 256, int PingSignal = SIGUSR1, std::size_t RetiredBytesThreshold = 0>
+  struct nbr_traits {
+    static constexpr std::size_t scan_threshold = ScanThreshold;
+    static constexpr int ping_signal = PingSignal;
+    static constexpr std::size_t retired_bytes_threshold = RetiredBytesThreshold;
+
+    template <class... Policies>
+    using with = nbr_traits<
+      parameter::value_param_t<std::size_t, policy::scan_threshold, ScanThreshold, Policies...>::value,
+      parameter::value_param_t<int, policy::ping_signal, PingSignal, Policies...>::value,
+      parameter::
+        value_param_t<std::size_t, policy::retired_bytes_threshold, RetiredBytesThreshold, Policies...>::value>;
+  };
+
+  /**
+   * @brief A signal based reclamation scheme inspired by neutralization based reclamation
+   * (NBR) as proposed by Singh et al. \[[SBM21](index.html#ref-singh-2021)\].
+   *
+   * For general information about the interface of the reclamation scheme see @ref reclamation_schemes.
+   *
+   * In NBR a thread that wants to reclaim memory sends a POSIX signal to all other threads;
+   * threads that are currently in a read phase get _neutralized_, i.e., the signal handler
+   * discards all their references by restarting the read phase via `siglongjmp`. This requires
+   * that the data structure can restart an operation at any point in its read phase, which
+   * does not fit the interface of `guard_ptr` and `region_guard` in xenium, so neutralization
+   * is _not_ implemented. This implementation keeps the signals, but uses them for the opposite
+   * purpose: every `guard_ptr` announces the node it protects in a thread-local reservation
+   * _without_ any memory fence, and the reclaiming thread uses the signal to make all reservations
+   * of the pinged thread visible before it scans them. The fence that hazard pointers have to issue for every
+   * acquired node is thereby moved from the readers to the (rare) reclaiming thread.
+   *
+   * Only threads that are currently inside a critical region (i.e., that hold a `region_guard`
+   * or a non-empty `guard_ptr`) are pinged. Entering the outermost critical region costs a
+   * single memory fence, so a `region_guard` that spans a whole operation amortizes this cost
+   * over all nodes acquired during the operation. Since reservations are per node, a thread
+   * that gets stalled inside a critical region (but still handles the ping) only prevents
+   * reclamation of the nodes it actually protects.
+   *
+   * A reclaiming thread does not wait for the pinged threads. It only reclaims its retired nodes
+   * once every pinged thread has acknowledged the ping or left its critical region; until then the
+   * nodes are kept and the check is repeated on the thread's next scan. A thread that does not
+   * handle the signal (e.g., because it has blocked it) while staying inside a critical region
+   * therefore prevents the reclamation of all nodes retired in the meantime, so signals should not
+   * be blocked in threads that use this reclamation scheme. The signal handler is installed when a
+   * thread first uses the scheme; it replaces any handler previously installed for the same signal.
+   * Instantiations that use different signals are independent of each other. This scheme is only
+   * available on Linux.
+   *
+   * This class does not take a list of policies, but a `Traits` type that can be customized
+   * with a list of policies. Use the `with<>` template alias to pass your custom policies.
+   *
+   * The following policies are supported:
+   *  * `xenium::policy::scan_threshold`<br>
+   *    Defines the number of retired nodes a thread collects before it pings the other threads
+   *    and reclaims the nodes that are no longer reserved. (defaults to 256)
+   *  * `xenium::policy::ping_signal`<br>
+   *    Defines the signal that is used to ping other threads. (defaults to `SIGUSR1`)
+   *  * `xenium::policy::retired_bytes_threshold`<br>
+   *    Defines the size of the retired nodes at which a thread starts a reclamation, even if it
+   *    has not yet collected `scan_threshold` nodes. Useful if the pings are expensive compared
+   *    to the memory held by a few large nodes. (defaults to zero, i.e., disabled)
+   *
+   * @tparam Traits
+   */
+  template <class Traits = nbr_traits<>>
+  class nbr {
+    template <class T, class MarkedPtr>
+    class guard_ptr;
+
+  public:
+    /**
+     * @brief Customize the reclamation scheme with the given policies.
+     *
+     * The given policies are applied to the current configuration, replacing previously
+     * specified policies of the same type.
+     *
+     * The resulting type is the newly configured reclamation scheme.
+     *
+     * @tparam Policies list of policies to customize the behaviour
+     */
+    template <class... Policies>
+    using with = nbr<typename Traits::template with<Policies...>>;
+
+    template <class T, std::size_t N = 0, class Deleter = std::default_delete<T>>
+    class enable_concurrent_ptr;
+
+    struct region_guard {
+      region_guard() noexcept;
+      ~region_guard() noexcept;
+
+      region_guard(const region_guard&) = delete;
+      region_guard(region_guard&&) = delete;
+      region_guard& operator=(const region_guard&) = delete;
+      region_guard& operator=(region_guard&&) = delete;
+    };
+
+    // Collects nodes that are reclaimed via `guard_ptr::reclaim(retire_batch&)` and retires them
+    // all at once upon destruction.
+    using retire_batch = detail::retire_batch<nbr>;
+
+    template <class T, std::size_t N = T::number_of_mark_bits>
+    using concurrent_ptr = detail::concurrent_ptr<T, N, guard_ptr>;
+
+    ALLOCATION_TRACKER;
+
+  private:
+    static_assert(Traits::scan_threshold > 0, "scan_threshold must be greater than zero");
+
+    static constexpr bool count_retired_bytes = Traits::retired_bytes_threshold != 0;
+
+    struct reservation;
+    struct reservation_block;
+    struct thread_control_block;
+    struct thread_data;
+
+    friend retire_batch;
+    static void add_retired_nodes(detail::node_batch<>& nodes) noexcept;
+
+    inline static detail::thread_block_list<thread_control_block> global_thread_block_list{};
+    static thread_data& local_thread_data();
+
+    ALLOCATION_TRACKING_FUNCTIONS;
+  };
+
+  template <class Traits>
+  template <class T, std::size_t N, class Deleter>
+  class nbr<Traits>::enable_concurrent_ptr :
+      private detail::deletable_object_impl<T, Deleter>,
+      private detail::tracked_object<nbr> {
+  public:
+    static constexpr std::size_t number_of_mark_bits = N;
+
+  protected:
+    enable_concurrent_ptr() noexcept = default;
+    enable_concurrent_ptr(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr(enable_concurrent_ptr&&) noexcept = default;
+    enable_concurrent_ptr& operator=(const enable_concurrent_ptr&) noexcept = default;
+    enable_concurrent_ptr& operator=(enable_concurrent_ptr&&) noexcept = default;
+    ~enable_concurrent_ptr() noexcept override = default;
+
+  private:
+    friend detail::deletable_object_impl<T, Deleter>;
+
+    template <class, class>
+    friend class guard_ptr;
+  };
+
+  template <class Traits>
+  template <class T, class MarkedPtr>
+  class nbr<Traits>::guard_ptr : public detail::guard_ptr<T, MarkedPtr, guard_ptr<T, MarkedPtr>> {
+    using base = detail::guard_ptr<T, MarkedPtr, guard_ptr>;
+    using Deleter = typename T::Deleter;
+
+  public:
+    // Guard a marked ptr.
+    explicit guard_ptr(const MarkedPtr& p = MarkedPtr()) noexcept;
+    guard_ptr(const guard_ptr& p) noexcept;
+    guard_ptr(guard_ptr&& p) noexcept;
+
+    guard_ptr& operator=(const guard_ptr& p) noexcept;
+    guard_ptr& operator=(guard_ptr&& p) noexcept;
+
+    // Atomically take snapshot of p, and *if* it points to unreclaimed object, acquire shared ownership of it.
+    void acquire(const concurrent_ptr<T>& p, std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Like acquire, but quit early if a snapshot != expected.
+    bool acquire_if_equal(const concurrent_ptr<T>& p,
+                          const MarkedPtr& expected,
+                          std::memory_order order = std::memory_order_seq_cst) noexcept;
+
+    // Release ownership. Postcondition: get() == nullptr.
+    void reset() noexcept;
+
+    // Reset. Deleter d will be applied some time after all owners release their ownership.
+    void reclaim(Deleter d = Deleter()) noexcept;
+
+    // Like reclaim, but the node is only added to the retire list once the batch is destroyed.
+    void reclaim(retire_batch& batch, Deleter d = Deleter()) noexcept;
+
+  private:
+    friend base;
+    void do_swap(guard_ptr& g) noexcept;
+
+    reservation* res = nullptr;
+  };
+} // namespace reclamation
+} // namespace xenium
+
+#define NBR_IMPL
+#include <xenium/reclamation/impl/nbr.hpp>
+#undef NBR_IMPL
+
+#endif
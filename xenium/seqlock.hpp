@@ -8,6 +8,7 @@
 
 #include <xenium/detail/port.hpp>
 #include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
 
 #include <atomic>
 #include <cassert>
@@ -16,15 +17,6 @@
 
 namespace xenium {
 
-namespace policy {
-  /**
-   * @brief Policy to configure the number of slots used in `seqlock`.
-   * @tparam Value
-   */
-  template <unsigned Value>
-  struct slots;
-} // namespace policy
-
 /**
  * @brief An implementation of the sequence lock (also often referred to as "sequential lock").
  *
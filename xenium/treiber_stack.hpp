@@ -0,0 +1,319 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_TREIBER_STACK_HPP
+#define XENIUM_TREIBER_STACK_HPP
+
+#include <xenium/backoff.hpp>
+#include <xenium/detail/hardware.hpp>
+#include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
+#include <xenium/utils.hpp>
+
+#include <atomic>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+
+namespace policy {
+  /**
+   * @brief Policy to configure the number of slots in the elimination array of `treiber_stack`.
+   *
+   * If this is zero, elimination is disabled.
+   *
+   * @tparam Value
+   */
+  template <std::size_t Value>
+  struct elimination_slots;
+
+  /**
+   * @brief Policy to configure the number of iterations a push operation waits in an
+   * elimination slot of `treiber_stack` for a matching pop operation.
+   *
+   * @tparam Value
+   */
+  template <unsigned Value>
+  struct elimination_spins;
+} // namespace policy
+
+/**
+ * @brief An unbounded generic lock-free multi-producer/multi-consumer LIFO stack.
+ *
+ * This is an implementation of the classic lock-free stack proposed by Treiber
+ * \[[Tre86](index.html#ref-treiber-1986)\], optionally extended with an elimination
+ * array as proposed by Hendler et al. \[[HSY04](index.html#ref-hendler-2004)\].
+ *
+ * If the CAS on the stack's head fails due to contention, a push operation can publish
+ * its node in a randomly chosen slot of the elimination array and wait there for a short
+ * while. A pop operation that fails its CAS checks a random slot, and if it contains a node,
+ * takes it. Such a colliding push/pop pair exchanges its value without ever touching the head,
+ * so under symmetric push/pop load most of the contention on the head can be avoided.
+ *
+ * It is fully generic and can handle any type `T` that is nothrow move constructible.
+ *
+ * Supported policies:
+ *  * `xenium::policy::reclaimer`<br>
+ *    Defines the reclamation scheme to be used for internal nodes. (**required**)
+ *  * `xenium::policy::backoff`<br>
+ *    Defines the backoff strategy. It is only used if elimination is disabled.
+ *    (*optional*; defaults to `xenium::no_backoff`)
+ *  * `xenium::policy::elimination_slots`<br>
+ *    Defines the number of slots in the elimination array; zero disables elimination.
+ *    (*optional*; defaults to 0)
+ *  * `xenium::policy::elimination_spins`<br>
+ *    Defines the number of iterations a push operation waits in an elimination slot.
+ *    (*optional*; defaults to 128)
+ *
+ * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
+ */
+template <class T, class... Policies>
+class treiber_stack {
+public:
+  static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible.");
+
+  using value_type = T;
+  using reclaimer = parameter::type_param_t<policy::reclaimer, parameter::nil, Policies...>;
+  using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+  static constexpr std::size_t elimination_slots =
+    parameter::value_param_t<std::size_t, policy::elimination_slots, 0, Policies...>::value;
+  static constexpr unsigned elimination_spins =
+    parameter::value_param_t<unsigned, policy::elimination_spins, 128, Policies...>::value;
+
+  template <class... NewPolicies>
+  using with = treiber_stack<T, NewPolicies..., Policies...>;
+
+  static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
+
+  treiber_stack() = default;
+  ~treiber_stack();
+
+  treiber_stack(const treiber_stack&) = delete;
+  treiber_stack(treiber_stack&&) = delete;
+
+  treiber_stack& operator=(const treiber_stack&) = delete;
+  treiber_stack& operator=(treiber_stack&&) = delete;
+
+  /**
+   * @brief Pushes the given value to the stack.
+   *
+   * This operation always allocates a new node.
+   * Progress guarantees: lock-free (always performs a memory allocation)
+   *
+   * @param value
+   */
+  void push(T value);
+
+  /**
+   * @brief Tries to pop an object from the stack. If the operation is
+   * successful, the object will be moved to `result`.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param result
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T& result);
+
+  /**
+   * @brief Tries to pop an object from the stack.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @return the popped value if the operation was successful, otherwise `std::nullopt`
+   */
+  [[nodiscard]] std::optional<T> pop();
+
+private:
+  struct node;
+
+  using concurrent_ptr = typename reclaimer::template concurrent_ptr<node, 0>;
+  using marked_ptr = typename concurrent_ptr::marked_ptr;
+  using guard_ptr = typename concurrent_ptr::guard_ptr;
+
+  struct node : reclaimer::template enable_concurrent_ptr<node> {
+    explicit node(T&& v) { new (&_data) T(std::move(v)); }
+
+    // The value is moved out and destroyed as soon as the node has been popped,
+    // but the node itself may only be reclaimed later, so we use raw storage.
+    T& value() { return reinterpret_cast<T&>(_data); }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _data;
+    concurrent_ptr next;
+  };
+
+  static void take_value(node& n, T& result) {
+    auto& data = n.value();
+    result = std::move(data);
+    data.~T();
+  }
+
+  static void take_value(node& n, std::optional<T>& result) {
+    auto& data = n.value();
+    result.emplace(std::move(data));
+    data.~T();
+  }
+
+  struct alignas(64) elimination_slot {
+    std::atomic<node*> value{nullptr};
+  };
+
+  struct empty_elimination_array {};
+  using elimination_array =
+    std::conditional_t<(elimination_slots > 0), elimination_slot[elimination_slots], empty_elimination_array>;
+
+  template <class Result>
+  bool do_pop(Result& result);
+
+  bool try_eliminate_push(node* n);
+  node* try_eliminate_pop();
+
+  alignas(64) concurrent_ptr _head;
+  elimination_array _elimination;
+};
+
+template <class T, class... Policies>
+treiber_stack<T, Policies...>::~treiber_stack() {
+  // (1) - this acquire-load synchronizes-with the release-CAS (2, 4)
+  auto n = _head.load(std::memory_order_acquire);
+  while (n) {
+    auto next = n->next.load(std::memory_order_relaxed);
+    n->value().~T();
+    delete n.get();
+    n = next;
+  }
+}
+
+template <class T, class... Policies>
+void treiber_stack<T, Policies...>::push(T value) {
+  node* n = new node(std::move(value));
+
+  backoff backoff;
+  marked_ptr h = _head.load(std::memory_order_relaxed);
+  for (;;) {
+    n->next.store(h, std::memory_order_relaxed);
+    // (2) - this release-CAS synchronizes-with the acquire-load (1, 3)
+    if (_head.compare_exchange_weak(h, n, std::memory_order_release, std::memory_order_relaxed)) {
+      return;
+    }
+
+    if constexpr (elimination_slots > 0) {
+      if (try_eliminate_push(n)) {
+        return;
+      }
+      h = _head.load(std::memory_order_relaxed);
+    } else {
+      backoff();
+    }
+  }
+}
+
+template <class T, class... Policies>
+bool treiber_stack<T, Policies...>::try_pop(T& result) {
+  return do_pop(result);
+}
+
+template <class T, class... Policies>
+std::optional<T> treiber_stack<T, Policies...>::pop() {
+  std::optional<T> result;
+  do_pop(result);
+  return result;
+}
+
+template <class T, class... Policies>
+template <class Result>
+bool treiber_stack<T, Policies...>::do_pop(Result& result) {
+  backoff backoff;
+  guard_ptr h;
+  for (;;) {
+    // (3) - this acquire-load synchronizes-with the release-CAS (2, 4)
+    h.acquire(_head, std::memory_order_acquire);
+    if (h.get() == nullptr) {
+      return false;
+    }
+
+    // h is protected by our guard_ptr, so the node cannot be reclaimed (and reused)
+    // while we are accessing it. This also prevents the ABA problem on _head.
+    auto next = h->next.load(std::memory_order_relaxed);
+    marked_ptr expected(h.get());
+    // (4) - this release-CAS synchronizes-with the acquire-load (1, 3)
+    if (_head.compare_exchange_weak(expected, next, std::memory_order_release, std::memory_order_relaxed)) {
+      // We have unlinked the node, so no other thread will ever access its value.
+      take_value(*h, result);
+      h.reclaim();
+      return true;
+    }
+
+    if constexpr (elimination_slots > 0) {
+      if (node* n = try_eliminate_pop()) {
+        take_value(*n, result);
+        // The node has never been part of the stack, so we can delete it immediately.
+        delete n;
+        return true;
+      }
+    } else {
+      backoff();
+    }
+  }
+}
+
+template <class T, class... Policies>
+bool treiber_stack<T, Policies...>::try_eliminate_push(node* n) {
+  auto& slot = _elimination[utils::random() % elimination_slots].value;
+  node* expected = nullptr;
+  // (5) - this release-CAS synchronizes-with the acquire-CASes (6, 7)
+  if (!slot.compare_exchange_strong(expected, n, std::memory_order_release, std::memory_order_relaxed)) {
+    return false; // slot is occupied by another push operation
+  }
+
+  for (unsigned i = 0; i < elimination_spins; ++i) {
+    if (slot.load(std::memory_order_relaxed) != n) {
+      return true; // our node has been taken by a pop operation
+    }
+    detail::hardware_pause();
+  }
+
+  // Try to withdraw our node. If this fails, a pop operation has taken it in the meantime.
+  // Even if it succeeds, our node may have been taken and deleted by a pop operation, and
+  // the address may have been reused by another push operation that has placed its own node
+  // in this slot. In this case we withdraw (and later push) the other operation's node, while
+  // that operation assumes its node has been taken. This is fine, since the value still ends
+  // up on the stack exactly once, but we must see the other operation's writes to the node.
+  // (7) - this acquire-CAS synchronizes-with the release-CAS (5)
+  expected = n;
+  return !slot.compare_exchange_strong(expected, nullptr, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+template <class T, class... Policies>
+auto treiber_stack<T, Policies...>::try_eliminate_pop() -> node* {
+  auto& slot = _elimination[utils::random() % elimination_slots].value;
+  node* n = slot.load(std::memory_order_relaxed);
+  if (n == nullptr) {
+    return nullptr;
+  }
+
+  // Note that n might already have been taken (and deleted) by some other pop operation,
+  // and the address might even be reused for a new node. This is fine, because we do not
+  // access the node unless we have successfully taken it from the slot.
+  // (6) - this acquire-CAS synchronizes-with the release-CAS (5)
+  if (!slot.compare_exchange_strong(n, nullptr, std::memory_order_acquire, std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return n;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif
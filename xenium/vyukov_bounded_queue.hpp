@@ -7,12 +7,15 @@
 #define XENIUM_VYUKOV_BOUNDED_QUEUE_HPP
 
 #include <type_traits>
+#include <xenium/array_allocator.hpp>
 #include <xenium/parameter.hpp>
+#include <xenium/policy.hpp>
 #include <xenium/utils.hpp>
 
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 
@@ -55,7 +58,20 @@ namespace policy {
  * would keep spinning until T1 has finished, while `try_pop_weak` would immediately
  * return false, even though the queue is not empty.
  *
+ * The queue can be closed via `close`, after which all push operations fail. Consumers can
+ * use `is_drained` to distinguish a queue that is only empty for now from one that is closed
+ * and will therefore remain empty forever.
+ *
+ * Supported policies:
+ *  * `xenium::policy::default_to_weak`<br>
+ *    If true, `try_push`/`try_pop` forward to `try_push_weak`/`try_pop_weak`.
+ *    (*optional*; defaults to false)
+ *  * `xenium::policy::array_allocator`<br>
+ *    Defines the allocator for the internal ring buffer.
+ *    (*optional*; defaults to `xenium::default_array_allocator`)
+ *
  * @tparam T type of the stored elements.
+ * @tparam Policies list of policies to customize the behaviour
  */
 template <class T, class... Policies>
 struct vyukov_bounded_queue {
@@ -65,7 +81,7 @@ public:
 
   static constexpr bool default_to_weak =
     parameter::value_param_t<bool, policy::default_to_weak, false, Policies...>::value;
-  ;
+  using array_allocator = parameter::type_param_t<policy::array_allocator, default_array_allocator, Policies...>;
 
   /**
    * @brief Constructs a new instance with the specified maximum size.
@@ -245,14 +261,62 @@ public:
     return do_try_pop<true>([](T& v) { return std::optional<T>(std::move(v)); }, []() { return std::optional<T>(); });
   }
 
+  /**
+   * @brief Tries to pop up to `max` elements from the queue.
+   *
+   * All popped elements are claimed with a single CAS operation. The popped elements are
+   * move-assigned to `out` in FIFO order. Like `try_pop_weak`, this operation only takes elements
+   * whose push operations have already finished, so it may return zero even though the
+   * queue is not empty.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param out output iterator that receives the popped elements
+   * @param max the maximum number of elements to pop
+   * @return the number of popped elements
+   */
+  template <class OutputIt>
+  std::size_t try_pop_batch(OutputIt out, std::size_t max);
+
+  /**
+   * @brief Closes the queue, i.e., all subsequent push operations fail.
+   *
+   * Elements that have been pushed before the queue has been closed can still be popped.
+   *
+   * Progress guarantees: wait-free
+   */
+  void close() noexcept { enqueue_pos.fetch_or(closed_bit, std::memory_order_relaxed); }
+
+  /**
+   * @brief Returns `true` if the queue has been closed.
+   */
+  [[nodiscard]] bool is_closed() const noexcept {
+    return (enqueue_pos.load(std::memory_order_relaxed) & closed_bit) != 0;
+  }
+
+  /**
+   * @brief Returns `true` if the queue has been closed and all elements have been popped.
+   *
+   * Once this returns `true` no other element will ever be available in this queue.
+   *
+   * Progress guarantees: wait-free
+   */
+  [[nodiscard]] bool is_drained() const noexcept {
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    return (pos & closed_bit) != 0 && dequeue_pos.load(std::memory_order_relaxed) == (pos & ~closed_bit);
+  }
+
 private:
   template <bool Weak, class... Args>
   bool do_try_push(Args&&... args) {
     cell* c;
     std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
     for (;;) {
+      if (pos & closed_bit) {
+        return false;
+      }
       c = &cells[pos & index_mask];
-      // (3) - this acquire-load synchronizes-with the release-store (2)
+      // (3) - this acquire-load synchronizes-with the release-store (2, 6)
       std::size_t seq = c->sequence.load(std::memory_order_acquire);
       if (seq == pos) {
         if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
@@ -274,7 +338,7 @@ private:
       }
     }
     assign_value(c->data, std::forward<Args>(args)...);
-    // (4) - this release-store synchronizes-with the acquire-load (1)
+    // (4) - this release-store synchronizes-with the acquire-load (1, 5)
     c->sequence.store(pos + 1, std::memory_order_release);
     return true;
   }
@@ -300,7 +364,7 @@ private:
           pos = dequeue_pos.load(std::memory_order_relaxed);
         } else {
           auto pos2 = dequeue_pos.load(std::memory_order_relaxed);
-          if (pos2 == pos && enqueue_pos.load(std::memory_order_relaxed) == pos) {
+          if (pos2 == pos && (enqueue_pos.load(std::memory_order_relaxed) & ~closed_bit) == pos) {
             return emptyFunc();
           }
           pos = pos2;
@@ -326,13 +390,19 @@ private:
     new (&v) T{std::forward<Args>(args)...};
   }
 
+  // the MSB of enqueue_pos signals that the queue has been closed; once it is set the
+  // CAS in do_try_push can no longer succeed, so enqueue_pos cannot change anymore.
+  static constexpr std::size_t closed_bit = ~(std::numeric_limits<std::size_t>::max() >> 1);
+
   // TODO - add optional padding via policy
   struct cell {
     std::atomic<std::size_t> sequence;
     storage_t data;
   };
 
-  std::unique_ptr<cell[]> cells;
+  static_assert(alignof(cell) <= default_array_allocator::alignment, "T must not be over-aligned.");
+
+  cell* cells;
   const std::size_t index_mask;
   alignas(64) std::atomic<size_t> enqueue_pos;
   alignas(64) std::atomic<size_t> dequeue_pos;
@@ -340,10 +410,14 @@ private:
 
 template <class T, class... Policies>
 vyukov_bounded_queue<T, Policies...>::vyukov_bounded_queue(std::size_t size) :
-    cells(new cell[size]),
+    cells(static_cast<cell*>(array_allocator::allocate(size * sizeof(cell)))),
     index_mask(size - 1) {
   assert(size >= 2 && utils::is_power_of_two(size));
+  if (cells == nullptr) {
+    throw std::bad_alloc();
+  }
   for (std::size_t i = 0; i < size; ++i) {
+    new (&cells[i]) cell;
     cells[i].sequence.store(i, std::memory_order_relaxed);
   }
   enqueue_pos.store(0, std::memory_order_relaxed);
@@ -353,7 +427,7 @@ vyukov_bounded_queue<T, Policies...>::vyukov_bounded_queue(std::size_t size) :
 template <class T, class... Policies>
 vyukov_bounded_queue<T, Policies...>::~vyukov_bounded_queue() {
   std::size_t deq_pos = dequeue_pos.load(std::memory_order_relaxed);
-  std::size_t enq_pos = enqueue_pos.load(std::memory_order_relaxed);
+  std::size_t enq_pos = enqueue_pos.load(std::memory_order_relaxed) & ~closed_bit;
 
   for (; deq_pos != enq_pos; ++deq_pos) {
     auto c = &cells[deq_pos & index_mask];
@@ -361,6 +435,52 @@ vyukov_bounded_queue<T, Policies...>::~vyukov_bounded_queue() {
     assert(seq == deq_pos + 1);
     reinterpret_cast<T&>(c->data).~T();
   }
+  // cells are trivially destructible, so we can simply release the memory
+  array_allocator::deallocate(cells);
+}
+
+template <class T, class... Policies>
+template <class OutputIt>
+std::size_t vyukov_bounded_queue<T, Policies...>::try_pop_batch(OutputIt out, std::size_t max) {
+  std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+  std::size_t n;
+  for (;;) {
+    // count the consecutive cells starting at pos that have already been written
+    n = 0;
+    std::size_t seq = 0;
+    while (n < max && n <= index_mask) {
+      // (5) - this acquire-load synchronizes-with the release-store (4)
+      seq = cells[(pos + n) & index_mask].sequence.load(std::memory_order_acquire);
+      if (seq != pos + n + 1) {
+        break;
+      }
+      ++n;
+    }
+
+    if (n == 0) {
+      if (max == 0 || seq < pos + 1) {
+        return 0;
+      }
+      // some other thread has already popped the element at pos
+      pos = dequeue_pos.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    if (dequeue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    auto c = &cells[(pos + i) & index_mask];
+    auto& v = reinterpret_cast<T&>(c->data);
+    *out = std::move(v);
+    ++out;
+    v.~T();
+    // (6) - this release-store synchronizes-with the acquire-load (3)
+    c->sequence.store(pos + i + index_mask + 1, std::memory_order_release);
+  }
+  return n;
 }
 
 } // namespace xenium
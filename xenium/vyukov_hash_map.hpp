@@ -7,6 +7,7 @@
 #define XENIUM_VYUKOV_HASH_MAP_HPP
 
 #include <xenium/acquire_guard.hpp>
+#include <xenium/array_allocator.hpp>
 #include <xenium/backoff.hpp>
 #include <xenium/hash.hpp>
 #include <xenium/parameter.hpp>
@@ -15,6 +16,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <limits>
 
 namespace xenium {
 
@@ -29,6 +31,19 @@ namespace policy {
    */
   template <class T>
   struct value_reclaimer;
+
+  /**
+   * @brief Policy to configure the load factor (in percent) below which `vyukov_hash_map`
+   * automatically shrinks its bucket array.
+   *
+   * If this policy is not specified (or set to zero), the map never shrinks automatically;
+   * it can still be shrunk explicitly by calling `shrink_to_fit`.
+   *
+   * @tparam Value the load factor in percent, i.e., the number of entries relative to the
+   *   number of buckets.
+   */
+  template <unsigned Value>
+  struct shrink_threshold;
 } // namespace policy
 
 namespace impl {
@@ -123,9 +138,20 @@ namespace detail {
  *  * `xenium::policy::reclaimer`<br>
  *    Defines the reclamation scheme to be used for internal allocations. (**required**)
  *  * `xenium::policy::hash`<br>
- *    Defines the hash function. (*optional*; defaults to `xenium::hash<Key>`)
+ *    Defines the hash function. (*optional*; defaults to `xenium::hash<Key>`)<br>
+ *    If the hash function defines the member type `is_transparent`, `find`, `try_get_value`,
+ *    `erase` and `contains` also accept keys of any type `K` that can be compared with `Key`
+ *    (e.g., `std::string_view` for `std::string` keys). `hash(k)` must return the same value
+ *    for all equivalent keys, regardless of their type.
  *  * `xenium::policy::backoff`<br>
  *    Defines the backoff strategy. (*optional*; defaults to `xenium::no_backoff`)
+ *  * `xenium::policy::shrink_threshold`<br>
+ *    Defines the load factor (in percent) below which the map shrinks automatically during
+ *    `erase`/`extract`. The map never shrinks below its initial capacity this way.
+ *    (*optional*; defaults to 0, i.e., no automatic shrinking)
+ *  * `xenium::policy::array_allocator`<br>
+ *    Defines the allocator for the internal bucket arrays; for very large maps consider using
+ *    `xenium::huge_page_array_allocator`. (*optional*; defaults to `xenium::default_array_allocator`)
  *
  * @tparam Key
  * @tparam Value
@@ -137,6 +163,9 @@ struct vyukov_hash_map {
   using value_reclaimer = parameter::type_param_t<policy::value_reclaimer, parameter::nil, Policies...>;
   using hash = parameter::type_param_t<policy::hash, xenium::hash<Key>, Policies...>;
   using backoff = parameter::type_param_t<policy::backoff, no_backoff, Policies...>;
+  using array_allocator = parameter::type_param_t<policy::array_allocator, default_array_allocator, Policies...>;
+  static constexpr unsigned shrink_threshold =
+    parameter::value_param_t<unsigned, policy::shrink_threshold, 0, Policies...>::value;
 
   template <class... NewPolicies>
   using with = vyukov_hash_map<Key, Value, NewPolicies..., Policies...>;
@@ -144,6 +173,9 @@ struct vyukov_hash_map {
   static_assert(parameter::is_set<reclaimer>::value, "reclaimer policy must be specified");
 
 private:
+  template <class K>
+  using enable_if_transparent = std::enable_if_t<detail::is_transparent_key<hash, Key, K>::value, int>;
+
   using traits = typename impl::vyukov_hash_map_traits<Key,
                                                        Value,
                                                        value_reclaimer,
@@ -239,7 +271,23 @@ public:
    * @param key key of the element to remove
    * @return `true` if an element was removed, otherwise `false`
    */
-  bool erase(const key_type& key);
+  bool erase(const key_type& key) { return do_erase(key); }
+
+  /**
+   * @brief Removes the element with the key equivalent to key (if one exists).
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   * It allows to remove elements without constructing an instance of `Key`.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key key of the element to remove
+   * @return `true` if an element was removed, otherwise `false`
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  bool erase(const K& key) {
+    return do_erase(key);
+  }
 
   /**
    * @brief Removes the specified element from the container.
@@ -265,10 +313,54 @@ public:
    * @param result reference to an accessor to be set if a matching element is found
    * @return `true` if an element was found, otherwise `false`
    */
-  bool try_get_value(const key_type& key, accessor& result) const;
+  bool try_get_value(const key_type& key, accessor& result) const { return do_try_get_value(key, result); }
+
+  /**
+   * @brief Provides an accessor to the value associated with the specified key,
+   * if such an element exists in the map.
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   * It allows to look up elements without constructing an instance of `Key`.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to search for
+   * @param result reference to an accessor to be set if a matching element is found
+   * @return `true` if an element was found, otherwise `false`
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  bool try_get_value(const K& key, accessor& result) const {
+    return do_try_get_value(key, result);
+  }
+
+  /**
+   * @brief Checks if there is an element with key equivalent to key in the container.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to search for
+   * @return `true` if there is such an element, otherwise `false`
+   */
+  bool contains(const key_type& key) const {
+    accessor acc;
+    return do_try_get_value(key, acc);
+  }
 
-  // TODO - implement contains
-  // bool contains(const key_type& key) const;
+  /**
+   * @brief Checks if there is an element with key equivalent to key in the container.
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param key key of the element to search for
+   * @return `true` if there is such an element, otherwise `false`
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  bool contains(const K& key) const {
+    accessor acc;
+    return do_try_get_value(key, acc);
+  }
 
   /**
    * @brief Finds an element with key equivalent to key.
@@ -279,7 +371,23 @@ public:
    * @return iterator to an element with key equivalent to key if such element is found,
    * otherwise past-the-end iterator
    */
-  iterator find(const key_type& key);
+  iterator find(const key_type& key) { return do_find(key); }
+
+  /**
+   * @brief Finds an element with key equivalent to key.
+   *
+   * This overload only participates in overload resolution if `hash` is transparent.
+   *
+   * Progress guarantees: blocking
+   *
+   * @param key key of the element to search for
+   * @return iterator to an element with key equivalent to key if such element is found,
+   * otherwise past-the-end iterator
+   */
+  template <class K, enable_if_transparent<K> = 0>
+  iterator find(const K& key) {
+    return do_find(key);
+  }
 
   /**
    * @brief Returns an iterator to the first element of the container.
@@ -300,6 +408,27 @@ public:
    */
   iterator end() { return iterator(); }
 
+  /**
+   * @brief Tries to reduce the number of buckets to fit the number of entries
+   * currently stored in the map.
+   *
+   * Like a grow operation, this replaces the internal bucket array with a newly
+   * allocated one; the old array is released via the reclaimer, so concurrent
+   * `try_get_value` calls are not affected. However, all buckets are locked while
+   * the entries are moved to the new array, so this must not be called while
+   * holding an iterator on the same map.
+   * If the entries do not fit into a smaller array (e.g., because of a bad hash
+   * distribution), the map remains unchanged. The bucket array never shrinks below
+   * the initial capacity the map has been constructed with.
+   *
+   * No iterators or accessors are invalidated.
+   *
+   * Progress guarantees: blocking
+   *
+   * @return `true` if the bucket array was replaced by a smaller one, otherwise `false`
+   */
+  bool shrink_to_fit();
+
 private:
   struct unlocker;
 
@@ -325,21 +454,43 @@ private:
   static constexpr std::uint32_t item_count_mask = (1u << item_counter_bits) - 1;
   static constexpr std::uint32_t delete_item_mask = item_count_mask << item_counter_bits;
 
-  static constexpr std::align_val_t cacheline_size{64};
-
   block_ptr data_block;
   std::atomic<int> resize_lock;
 
+  // only maintained if automatic shrinking is enabled
+  std::atomic<std::size_t> approximate_size{0};
+  // after a failed automatic shrink, the size the map has to drop below before we try again
+  std::atomic<std::size_t> shrink_retry_size{std::numeric_limits<std::size_t>::max()};
+
+  // the bucket count of the current data_block; updated whenever the table is resized
+  std::atomic<std::uint32_t> current_bucket_count{0};
+  std::uint32_t min_bucket_count;
+
   block* allocate_block(std::uint32_t bucket_count);
 
   bucket& lock_bucket(hash_t hash, guarded_block& block, bucket_state& state);
   void grow(bucket& bucket, bucket_state state);
   void do_grow();
+  bool do_shrink(std::uint32_t min_bucket_count);
+  void try_auto_shrink();
+  void update_size(std::ptrdiff_t delta);
+
+  static void lock_all_buckets(block* b);
+  static void unlock_all_buckets(block* b);
+  static bool migrate_entries(block* old_block, block* new_block);
+  void replace_block(block* old_block, block* new_block);
 
   template <bool AcquireAccessor, class Factory, class Callback>
   bool do_get_or_emplace(Key&& key, Factory&& factory, Callback&& callback);
 
-  bool do_extract(const key_type& key, accessor& result);
+  template <class K>
+  bool do_erase(const K& key);
+  template <class K>
+  bool do_extract(const K& key, accessor& result);
+  template <class K>
+  bool do_try_get_value(const K& key, accessor& result) const;
+  template <class K>
+  iterator do_find(const K& key);
 
   static extension_item* allocate_extension_item(block* b, hash_t hash);
   static void free_extension_item(extension_item* item);
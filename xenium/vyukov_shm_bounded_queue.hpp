@@ -0,0 +1,284 @@
+//
+// Copyright (c) 2018-2020 Manuel Pöter.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+//
+
+#ifndef XENIUM_VYUKOV_SHM_BOUNDED_QUEUE_HPP
+#define XENIUM_VYUKOV_SHM_BOUNDED_QUEUE_HPP
+
+#include <xenium/utils.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable : 4324) // structure was padded due to alignment specifier
+#endif
+
+namespace xenium {
+/**
+ * @brief A bounded multi-producer/multi-consumer FIFO queue that lives in a caller-provided
+ * memory region, so it can be placed in shared memory and used by several processes.
+ *
+ * This is a variant of `vyukov_bounded_queue`. The queue consists of a header followed by the
+ * ring buffer of cells; neither contains any pointers, so the region can be mapped at different
+ * addresses in different processes (e.g., via `shm_open`/`mmap`). One process initializes the
+ * region via `create`, all other processes use `attach`. The header contains a magic number, a
+ * layout version as well as the size and alignment of `T`, so `attach` can reject regions that
+ * were created with an incompatible layout. The `vyukov_shm_bounded_queue` object itself is only a
+ * lightweight handle that can be freely copied; it does not own the memory region.
+ *
+ * Since a process may die in the middle of an operation, push and pop operations have the
+ * semantics of `vyukov_bounded_queue::try_push_weak`/`try_pop_weak`, i.e., they never wait for
+ * a pending operation of some other thread. A process that dies during a push leaves a cell that
+ * is never published, which eventually stalls the queue, but never blocks any other process.
+ *
+ * `T` must be trivially copyable, and the used atomics must be lock-free, since only then they
+ * can be used for synchronization across processes.
+ *
+ * @tparam T type of the stored elements; must be trivially copyable.
+ */
+template <class T>
+class vyukov_shm_bounded_queue {
+public:
+  static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free.");
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free.");
+
+  using value_type = T;
+
+  /**
+   * @brief The version of the memory layout; `attach` rejects regions with a different version.
+   */
+  static constexpr std::uint32_t layout_version = 1;
+
+  /**
+   * @brief The required alignment of the memory region.
+   */
+  static constexpr std::size_t alignment = 64;
+
+  /**
+   * @brief Returns the size of the memory region required for a queue with the given capacity.
+   * @param capacity must be a power of two greater one.
+   */
+  static constexpr std::size_t required_size(std::size_t capacity) noexcept {
+    return sizeof(header) + capacity * sizeof(cell);
+  }
+
+  /**
+   * @brief Initializes a new queue in the given memory region.
+   *
+   * The region must not be used by any other thread or process while it is initialized.
+   * Throws an `std::invalid_argument` exception if the region is too small or not properly
+   * aligned, or if `capacity` is not a power of two greater one.
+   *
+   * @param memory pointer to the memory region; must be aligned to `alignment`.
+   * @param size size of the memory region in bytes.
+   * @param capacity max number of elements in the queue; must be a power of two greater one.
+   * @return a handle to the new queue.
+   */
+  static vyukov_shm_bounded_queue create(void* memory, std::size_t size, std::size_t capacity);
+
+  /**
+   * @brief Attaches to a queue that has been initialized via `create`.
+   *
+   * Throws an `std::invalid_argument` exception if the region is too small or not properly
+   * aligned, if it has not (yet) been initialized, or if it has been initialized with an
+   * incompatible layout (i.e., a different layout version or a different type `T`).
+   *
+   * @param memory pointer to the memory region; must be aligned to `alignment`.
+   * @param size size of the memory region in bytes.
+   * @return a handle to the queue.
+   */
+  static vyukov_shm_bounded_queue attach(void* memory, std::size_t size);
+
+  /**
+   * @brief Tries to push a new element to the queue.
+   *
+   * Fails if the queue is full or a pop operation on the cell to be pushed to is still pending.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param value
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  bool try_push(const T& value) noexcept;
+
+  /**
+   * @brief Tries to pop an element from the queue.
+   *
+   * Fails if the queue is empty or a push operation on the element to be popped is still pending.
+   *
+   * Progress guarantees: lock-free
+   *
+   * @param result the value popped from the queue if the operation was successful
+   * @return `true` if the operation was successful, otherwise `false`
+   */
+  [[nodiscard]] bool try_pop(T& result) noexcept;
+
+  /**
+   * @brief Returns the capacity of the queue.
+   */
+  [[nodiscard]] std::size_t capacity() const noexcept { return _index_mask + 1; }
+
+private:
+  // the ASCII string "XNMSHMVQ"
+  static constexpr std::uint64_t magic_number = 0x51564d48534d4e58;
+  static constexpr std::uint32_t initialized = 1;
+
+  struct header {
+    // written before `state` is set to `initialized` and never changed afterwards
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint32_t value_alignment;
+    std::atomic<std::uint32_t> state;
+    alignas(64) std::atomic<std::uint64_t> enqueue_pos;
+    alignas(64) std::atomic<std::uint64_t> dequeue_pos;
+  };
+
+  struct cell {
+    std::atomic<std::uint64_t> sequence;
+    T data;
+  };
+
+  static_assert(alignof(cell) <= alignment, "T must not be over-aligned.");
+  static_assert(sizeof(header) % alignof(cell) == 0, "cells must be properly aligned.");
+
+  vyukov_shm_bounded_queue(void* memory, std::size_t capacity) noexcept :
+      _header(static_cast<header*>(memory)),
+      _cells(reinterpret_cast<cell*>(static_cast<char*>(memory) + sizeof(header))),
+      _index_mask(capacity - 1) {}
+
+  static void check_region(void* memory, std::size_t size);
+
+  header* _header;
+  cell* _cells;
+  std::size_t _index_mask;
+};
+
+template <class T>
+void vyukov_shm_bounded_queue<T>::check_region(void* memory, std::size_t size) {
+  if (memory == nullptr || reinterpret_cast<std::uintptr_t>(memory) % alignment != 0) {
+    throw std::invalid_argument("memory region is not properly aligned");
+  }
+  if (size < sizeof(header)) {
+    throw std::invalid_argument("memory region is too small");
+  }
+}
+
+template <class T>
+auto vyukov_shm_bounded_queue<T>::create(void* memory, std::size_t size, std::size_t capacity)
+  -> vyukov_shm_bounded_queue {
+  check_region(memory, size);
+  if (capacity < 2 || !utils::is_power_of_two(capacity)) {
+    throw std::invalid_argument("capacity must be a power of two greater one");
+  }
+  if (size < required_size(capacity)) {
+    throw std::invalid_argument("memory region is too small");
+  }
+
+  auto h = new (memory) header;
+  // the region may contain a queue from an earlier run, so first mark it as uninitialized
+  h->state.store(0, std::memory_order_relaxed);
+  h->magic = magic_number;
+  h->capacity = capacity;
+  h->version = layout_version;
+  h->value_size = sizeof(T);
+  h->value_alignment = alignof(T);
+  h->enqueue_pos.store(0, std::memory_order_relaxed);
+  h->dequeue_pos.store(0, std::memory_order_relaxed);
+
+  vyukov_shm_bounded_queue result(memory, capacity);
+  for (std::size_t i = 0; i < capacity; ++i) {
+    auto c = new (&result._cells[i]) cell;
+    c->sequence.store(i, std::memory_order_relaxed);
+  }
+  // (1) - this release-store synchronizes-with the acquire-load (2)
+  h->state.store(initialized, std::memory_order_release);
+  return result;
+}
+
+template <class T>
+auto vyukov_shm_bounded_queue<T>::attach(void* memory, std::size_t size) -> vyukov_shm_bounded_queue {
+  check_region(memory, size);
+  auto h = static_cast<header*>(memory);
+  // (2) - this acquire-load synchronizes-with the release-store (1)
+  if (h->state.load(std::memory_order_acquire) != initialized || h->magic != magic_number) {
+    throw std::invalid_argument("memory region does not contain an initialized queue");
+  }
+  if (h->version != layout_version) {
+    throw std::invalid_argument("memory region contains a queue with a different layout version");
+  }
+  if (h->value_size != sizeof(T) || h->value_alignment != alignof(T)) {
+    throw std::invalid_argument("memory region contains a queue for a different value type");
+  }
+  if (h->capacity < 2 || !utils::is_power_of_two(h->capacity) ||
+      size < required_size(static_cast<std::size_t>(h->capacity))) {
+    throw std::invalid_argument("memory region is too small");
+  }
+  return vyukov_shm_bounded_queue(memory, static_cast<std::size_t>(h->capacity));
+}
+
+template <class T>
+bool vyukov_shm_bounded_queue<T>::try_push(const T& value) noexcept {
+  cell* c;
+  std::uint64_t pos = _header->enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    c = &_cells[pos & _index_mask];
+    // (3) - this acquire-load synchronizes-with the release-store (6)
+    std::uint64_t seq = c->sequence.load(std::memory_order_acquire);
+    if (seq == pos) {
+      if (_header->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else {
+      if (seq < pos) {
+        return false;
+      }
+      pos = _header->enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  c->data = value;
+  // (4) - this release-store synchronizes-with the acquire-load (5)
+  c->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+bool vyukov_shm_bounded_queue<T>::try_pop(T& result) noexcept {
+  cell* c;
+  std::uint64_t pos = _header->dequeue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    c = &_cells[pos & _index_mask];
+    // (5) - this acquire-load synchronizes-with the release-store (4)
+    std::uint64_t seq = c->sequence.load(std::memory_order_acquire);
+    if (seq == pos + 1) {
+      if (_header->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else {
+      if (seq < pos + 1) {
+        return false;
+      }
+      pos = _header->dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  result = c->data;
+  // (6) - this release-store synchronizes-with the acquire-load (3)
+  c->sequence.store(pos + _index_mask + 1, std::memory_order_release);
+  return true;
+}
+} // namespace xenium
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+#endif